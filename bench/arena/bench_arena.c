@@ -0,0 +1,122 @@
+#define BENCH_COUNT_ALLOCS
+#include <types/arena.h>
+#include <types/string.h>
+#include "../bench_framework.h"
+
+#define STRINGS_PER_REQUEST 256
+#define REQUESTS            20000
+
+static char *g_fields[] = {
+    "GET", "/api/v1/users", "Host", "example.org", "Accept",
+    "application/json, text/plain, */*", "User-Agent",
+    "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36", "id"
+};
+
+// ============================================================================
+// Request workload
+// ============================================================================
+
+// One request: builds STRINGS_PER_REQUEST short lived strings (a field, a
+// separator and a number appended, some growing past the inline capacity),
+// then throws them all away. Deleting an arena string is a no-op, the memory
+// comes back when the arena is reset once per request.
+static void run_request(const allocator *alloc, string **strings, ui64 request)
+{
+    ui64    i;
+
+    for (i = 0; i < STRINGS_PER_REQUEST; i++)
+    {
+        strings[i] = String()->new_in(alloc, g_fields[i % 9]);
+        String()->append(strings[i], VAL_CHAR('='));
+        String()->append(strings[i], VAL_ULLONG(request * STRINGS_PER_REQUEST + i));
+        BENCH_SINK(String()->len(strings[i]));
+    }
+    for (i = 0; i < STRINGS_PER_REQUEST; i++)
+        String()->del(&strings[i]);
+}
+
+static void bench_requests(int use_arena)
+{
+    string              *strings[STRINGS_PER_REQUEST];
+    arena               *a;
+    const allocator     *alloc;
+    double              start;
+    double              elapsed;
+    unsigned long long  allocs;
+    ui64                r;
+
+    a = use_arena ? Arena()->new(0) : NULL;
+    alloc = use_arena ? Arena()->allocator(a) : NULL;
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (r = 0; r < REQUESTS; r++)
+    {
+        run_request(alloc, strings, r);
+        Arena()->reset(a);
+    }
+    elapsed = bench_now() - start;
+    allocs = g_bench_allocs - allocs;
+    print_bench_ops(use_arena ? "arena strings, reset per request"
+        : "malloc strings, del per string", elapsed,
+        (double)REQUESTS * STRINGS_PER_REQUEST);
+    print_bench_value("  ns per request",
+        elapsed / (double)REQUESTS * 1e9, "");
+    print_bench_value("  allocations per request",
+        (double)allocs / (double)REQUESTS, "");
+    Arena()->del(&a);
+}
+
+// ============================================================================
+// Raw allocation
+// ============================================================================
+
+static void bench_raw_alloc(int use_arena, ui64 size, ui64 n)
+{
+    arena   *a;
+    void    *ptrs[64];
+    double  start;
+    double  elapsed;
+    ui64    i;
+    char    label[64];
+
+    a = Arena()->new(0);
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        ptrs[i & 63] = use_arena ? Arena()->alloc(a, size) : malloc(size);
+        BENCH_SINK(ptrs[i & 63]);
+        if ((i & 63) == 63)
+        {
+            if (use_arena)
+                Arena()->reset(a);
+            else
+                for (int j = 0; j < 64; j++)
+                    free(ptrs[j]);
+        }
+    }
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "%s %llu B", use_arena ? "Arena()->alloc" : "malloc + free",
+        (unsigned long long)size);
+    print_bench_ops(label, elapsed, (double)n);
+    Arena()->del(&a);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    print_bench_header("Request workload (256 strings per request)");
+    bench_requests(0);
+    bench_requests(1);
+
+    print_bench_header("Raw allocation");
+    bench_raw_alloc(0, 32, 10000000);
+    bench_raw_alloc(1, 32, 10000000);
+    bench_raw_alloc(0, 200, 10000000);
+    bench_raw_alloc(1, 200, 10000000);
+
+    print_bench_footer();
+    return (0);
+}
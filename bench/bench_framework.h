@@ -0,0 +1,126 @@
+#ifndef BENCH_FRAMEWORK_H
+# define BENCH_FRAMEWORK_H
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+
+// Colors
+# define RED     "\033[0;31m"
+# define GREEN   "\033[0;32m"
+# define YELLOW  "\033[0;33m"
+# define BLUE    "\033[0;34m"
+# define RESET   "\033[0m"
+# define BOLD    "\033[1m"
+
+// Results are folded into this sink so the compiler can't drop the measured work
+static volatile unsigned long long  g_bench_sink = 0;
+
+# define BENCH_SINK(x) (g_bench_sink += (unsigned long long)(x))
+
+// Allocation counting: a bench defining BENCH_COUNT_ALLOCS before including this
+// header interposes the glibc allocator, so every malloc/calloc/realloc made by
+// the library is counted in g_bench_allocs.
+# ifdef BENCH_COUNT_ALLOCS
+
+static unsigned long long   g_bench_allocs = 0;
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void    *malloc(size_t size)
+{
+    g_bench_allocs++;
+    return (__libc_malloc(size));
+}
+
+void    *calloc(size_t count, size_t size)
+{
+    g_bench_allocs++;
+    return (__libc_calloc(count, size));
+}
+
+void    *realloc(void *ptr, size_t size)
+{
+    g_bench_allocs++;
+    return (__libc_realloc(ptr, size));
+}
+
+# endif
+
+// Syscall counting: a bench defining BENCH_COUNT_SYSCALLS before including this
+// header interposes write and writev, so every one the library issues is
+// counted in g_bench_syscalls.
+# ifdef BENCH_COUNT_SYSCALLS
+
+#  include <sys/syscall.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+
+static unsigned long long   g_bench_syscalls = 0;
+
+ssize_t write(int fd, const void *buf, size_t count)
+{
+    g_bench_syscalls++;
+    return (syscall(SYS_write, fd, buf, count));
+}
+
+ssize_t writev(int fd, const struct iovec *iov, int count)
+{
+    g_bench_syscalls++;
+    return (syscall(SYS_writev, fd, iov, count));
+}
+
+# endif
+
+// Monotonic clock in seconds
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec + (double)ts.tv_nsec / 1e9);
+}
+
+// Benchmark section header
+__attribute__((unused))
+static void print_bench_header(const char *name)
+{
+    printf(BOLD BLUE "\n▸ %s\n" RESET, name);
+    printf("───────────────────────────────────────────────────────────────\n");
+}
+
+// Prints the time per operation and the number of operations per second
+__attribute__((unused))
+static void print_bench_ops(const char *label, double seconds, double ops)
+{
+    printf("  %-40s " GREEN "%10.2f ns/op" RESET "  %12.0f ops/s\n",
+        label, seconds / ops * 1e9, ops / seconds);
+}
+
+// Prints the throughput of an operation that processed `bytes` bytes
+__attribute__((unused))
+static void print_bench_throughput(const char *label, double seconds, double bytes)
+{
+    printf("  %-40s " GREEN "%10.2f GB/s" RESET "  %12.3f ms\n",
+        label, bytes / seconds / 1e9, seconds * 1e3);
+}
+
+// Prints a free form measurement (counters, ratios, ...)
+__attribute__((unused))
+static void print_bench_value(const char *label, double value, const char *unit)
+{
+    printf("  %-40s " YELLOW "%10.2f %s" RESET "\n", label, value, unit);
+}
+
+// Prints the bench footer
+__attribute__((unused))
+static void print_bench_footer(void)
+{
+    printf(BOLD "\n═══════════════════════════════════════════════════════════════\n" RESET);
+    printf(GREEN BOLD "  ✓ Benchmarks finished (sink: %llu)\n\n" RESET, g_bench_sink);
+}
+
+#endif
@@ -0,0 +1,179 @@
+#define BENCH_COUNT_ALLOCS
+#include <types/intern.h>
+#include <pthread.h>
+#include <stdio.h>
+#include "../bench_framework.h"
+
+#define DISTINCT    3000
+#define FIELDS      4000000
+#define BATCH       64
+#define THREADS     4
+
+static char g_names[DISTINCT][48];
+static char *g_fields[FIELDS];
+
+// A log pipeline: a few thousand field names and values repeated millions of
+// times, in a scattered order
+static void make_fields(void)
+{
+    ui64    i;
+
+    for (i = 0; i < DISTINCT; i++)
+        snprintf(g_names[i], sizeof(g_names[i]), i % 3 ? "service.%llu.status"
+            : "k8s.pod.label.app.kubernetes.io/name-%llu", (unsigned long long)i);
+    for (i = 0; i < FIELDS; i++)
+        g_fields[i] = g_names[(i * 2654435761ULL >> 7) % DISTINCT];
+}
+
+// ============================================================================
+// Building the fields
+// ============================================================================
+
+static void bench_new_string(void)
+{
+    string              *s;
+    double              start;
+    unsigned long long  allocs;
+    ui64                i;
+
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (i = 0; i < FIELDS; i++)
+    {
+        s = String()->new(g_fields[i]);
+        BENCH_SINK(String()->len(s));
+        String()->del(&s);
+    }
+    print_bench_ops("String()->new + del per field", bench_now() - start, FIELDS);
+    print_bench_value("  allocations per field",
+        (double)(g_bench_allocs - allocs) / FIELDS, "");
+}
+
+static void bench_intern(void)
+{
+    intern_pool         *pool;
+    double              start;
+    unsigned long long  allocs;
+    ui64                i;
+
+    pool = Intern()->new();
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (i = 0; i < FIELDS; i++)
+        BENCH_SINK(Intern()->intern(pool, VAL_PCHAR(g_fields[i])));
+    print_bench_ops("Intern()->intern per field", bench_now() - start, FIELDS);
+    print_bench_value("  allocations per field",
+        (double)(g_bench_allocs - allocs) / FIELDS, "");
+    print_bench_value("  strings kept", (double)Intern()->len(pool), "");
+    Intern()->del(&pool);
+}
+
+static void bench_intern_many(void)
+{
+    intern_pool     *pool;
+    typed_value     vals[BATCH];
+    const string    *out[BATCH];
+    double          start;
+    ui64            i;
+    ui64            j;
+
+    pool = Intern()->new();
+    start = bench_now();
+    for (i = 0; i < FIELDS; i += BATCH)
+    {
+        for (j = 0; j < BATCH; j++)
+            vals[j] = VAL_PCHAR(g_fields[i + j]);
+        BENCH_SINK(Intern()->intern_many(pool, vals, BATCH, out));
+    }
+    print_bench_ops("Intern()->intern_many, 64 per call", bench_now() - start, FIELDS);
+    Intern()->del(&pool);
+}
+
+static void *intern_thread(void *pool)
+{
+    ui64    i;
+
+    for (i = 0; i < FIELDS / THREADS; i++)
+        BENCH_SINK(Intern()->intern(pool, VAL_PCHAR(g_fields[i * THREADS])));
+    return (NULL);
+}
+
+static void bench_intern_threads(void)
+{
+    pthread_t   threads[THREADS];
+    intern_pool *pool;
+    double      start;
+    int         t;
+
+    pool = Intern()->new();
+    start = bench_now();
+    for (t = 0; t < THREADS; t++)
+        pthread_create(&threads[t], NULL, intern_thread, pool);
+    for (t = 0; t < THREADS; t++)
+        pthread_join(threads[t], NULL);
+    print_bench_ops("Intern()->intern, 4 threads sharing a pool",
+        bench_now() - start, FIELDS);
+    Intern()->del(&pool);
+}
+
+// ============================================================================
+// Comparing
+// ============================================================================
+
+static void bench_equality(void)
+{
+    intern_pool     *pool;
+    string          *owned[DISTINCT];
+    const string    *interned[DISTINCT];
+    double          start;
+    ui64            i;
+    ui64            a;
+    ui64            b;
+
+    pool = Intern()->new();
+    for (i = 0; i < DISTINCT; i++)
+    {
+        owned[i] = String()->new(g_names[i]);
+        interned[i] = Intern()->intern(pool, VAL_STR(owned[i]));
+    }
+    start = bench_now();
+    for (i = 0; i < FIELDS; i++)
+    {
+        a = (i * 2654435761ULL >> 7) % DISTINCT;
+        b = (a + (i & 1) * 3) % DISTINCT;
+        BENCH_SINK(String()->equals(owned[a], VAL_STR(owned[b])));
+    }
+    print_bench_ops("String()->equals, same length keys", bench_now() - start, FIELDS);
+    start = bench_now();
+    for (i = 0; i < FIELDS; i++)
+    {
+        a = (i * 2654435761ULL >> 7) % DISTINCT;
+        b = (a + (i & 1) * 3) % DISTINCT;
+        BENCH_SINK(interned[a] == interned[b]);
+    }
+    print_bench_ops("interned pointer compare", bench_now() - start, FIELDS);
+    for (i = 0; i < DISTINCT; i++)
+        String()->del(&owned[i]);
+    Intern()->del(&pool);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    make_fields();
+
+    print_bench_header("Log fields (4M fields, 3000 distinct)");
+    bench_new_string();
+    bench_intern();
+    bench_intern_many();
+    bench_intern_threads();
+
+    print_bench_header("Equality");
+    bench_equality();
+
+    print_bench_footer();
+    return (0);
+}
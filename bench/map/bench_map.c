@@ -0,0 +1,134 @@
+#include <types/map.h>
+#include <stdio.h>
+#include "../bench_framework.h"
+
+#define KEYS    100000
+#define LOOKUPS 2000000
+
+// ============================================================================
+// Hashing
+// ============================================================================
+
+// FNV-1a, the usual one byte at a time hash, as a reference
+static ui64 fnv1a(const char *p, ui64 n)
+{
+    ui64    h;
+    ui64    i;
+
+    h = 0xcbf29ce484222325ULL;
+    for (i = 0; i < n; i++)
+        h = (h ^ (unsigned char)p[i]) * 0x100000001b3ULL;
+    return (h);
+}
+
+static void bench_hash(ui64 size, ui64 iterations)
+{
+    char    *buf;
+    double  start;
+    ui64    i;
+    char    label[64];
+
+    buf = malloc(size);
+    for (i = 0; i < size; i++)
+        buf[i] = (char)('a' + i % 26);
+    start = bench_now();
+    for (i = 0; i < iterations; i++)
+        BENCH_SINK(fnv1a(buf + (i & 1), size - 1));
+    snprintf(label, sizeof(label), "FNV-1a byte loop %6llu B", (unsigned long long)size);
+    print_bench_throughput(label, bench_now() - start, (double)(size - 1) * iterations);
+    start = bench_now();
+    for (i = 0; i < iterations; i++)
+        BENCH_SINK(memoryhash(buf + (i & 1), size - 1));
+    snprintf(label, sizeof(label), "memoryhash       %6llu B", (unsigned long long)size);
+    print_bench_throughput(label, bench_now() - start, (double)(size - 1) * iterations);
+    free(buf);
+}
+
+// ============================================================================
+// Map
+// ============================================================================
+
+static string   **make_keys(const char *prefix)
+{
+    string  **keys;
+    char    buf[128];
+    ui64    i;
+
+    keys = malloc(sizeof(*keys) * KEYS);
+    for (i = 0; i < KEYS; i++)
+    {
+        snprintf(buf, sizeof(buf), "%s%llu", prefix, (unsigned long long)i);
+        keys[i] = String()->new(buf);
+    }
+    return (keys);
+}
+
+static void free_keys(string **keys)
+{
+    ui64    i;
+
+    for (i = 0; i < KEYS; i++)
+        String()->del(&keys[i]);
+    free(keys);
+}
+
+static void bench_map(const char *name, const char *prefix)
+{
+    string  **keys;
+    string  **misses;
+    map     *m;
+    double  start;
+    ui64    i;
+    char    label[96];
+
+    keys = make_keys(prefix);
+    misses = make_keys("missing/");
+    m = Map()->new();
+    start = bench_now();
+    for (i = 0; i < KEYS; i++)
+        Map()->set(m, VAL_STR(keys[i]), keys[i]);
+    snprintf(label, sizeof(label), "%s: set", name);
+    print_bench_ops(label, bench_now() - start, KEYS);
+    start = bench_now();
+    for (i = 0; i < LOOKUPS; i++)
+        BENCH_SINK(Map()->get(m, VAL_PCHAR(String()->view(keys[(i * 7919) % KEYS]).ptr)));
+    snprintf(label, sizeof(label), "%s: get, char * key (hashed)", name);
+    print_bench_ops(label, bench_now() - start, LOOKUPS);
+    start = bench_now();
+    for (i = 0; i < LOOKUPS; i++)
+        BENCH_SINK(Map()->get(m, VAL_STR(keys[(i * 7919) % KEYS])));
+    snprintf(label, sizeof(label), "%s: get, string key (cached)", name);
+    print_bench_ops(label, bench_now() - start, LOOKUPS);
+    start = bench_now();
+    for (i = 0; i < LOOKUPS; i++)
+        BENCH_SINK(Map()->get(m, VAL_STR(misses[(i * 7919) % KEYS])));
+    snprintf(label, sizeof(label), "%s: get, missing key", name);
+    print_bench_ops(label, bench_now() - start, LOOKUPS);
+    start = bench_now();
+    for (i = 0; i < KEYS; i++)
+        Map()->remove(m, VAL_STR(keys[i]));
+    snprintf(label, sizeof(label), "%s: remove", name);
+    print_bench_ops(label, bench_now() - start, KEYS);
+    Map()->del(&m);
+    free_keys(keys);
+    free_keys(misses);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    print_bench_header("memoryhash vs FNV-1a");
+    bench_hash(16, 20000000);
+    bench_hash(64, 10000000);
+    bench_hash(1024, 1000000);
+
+    print_bench_header("Map() with 100000 keys");
+    bench_map("short keys", "id:");
+    bench_map("long keys ", "/api/v1/organizations/acme/projects/website/deployments/");
+
+    print_bench_footer();
+    return (0);
+}
@@ -0,0 +1,165 @@
+#define BENCH_COUNT_ALLOCS
+#include <types/matcher.h>
+#include <types/tokenizer.h>
+#include <types/string_view.h>
+#include "../bench_framework.h"
+
+#define LOG_SIZE    (64ULL << 20)
+#define KEYWORDS    300
+#define LINE_A      "2024-05-01T12:00:00Z level=info request=184467 path=/api/v1/orders status=200\n"
+#define LINE_B      "2024-05-01T12:00:01Z level=warn request=184468 path=/api/v1/users status=503 timeout\n"
+
+static char g_words[KEYWORDS][16];
+static const char *g_keywords[KEYWORDS];
+
+// Builds KEYWORDS needles: made up words, and a few that occur in LINE_B
+static void make_keywords(void)
+{
+    unsigned    seed;
+    int         i;
+    int         k;
+
+    seed = 7;
+    for (i = 0; i < KEYWORDS; i++)
+    {
+        for (k = 0; k < 8 + i % 5; k++)
+        {
+            seed = seed * 1103515245 + 12345;
+            g_words[i][k] = (char)('a' + (seed >> 16) % 26);
+        }
+        g_words[i][k] = '\0';
+        g_keywords[i] = g_words[i];
+    }
+    g_keywords[KEYWORDS / 2] = "timeout";
+    g_keywords[KEYWORDS - 1] = "status=503";
+}
+
+// Builds a LOG_SIZE log, one line in eight matches a keyword
+static string *make_log(void)
+{
+    string  *log;
+    ui64    i;
+
+    log = String()->new("");
+    String()->reserve(log, LOG_SIZE + sizeof(LINE_B));
+    for (i = 0; String()->len(log) < LOG_SIZE; i++)
+        String()->append(log, VAL_PCHAR(i % 8 ? LINE_A : LINE_B));
+    return (log);
+}
+
+// ============================================================================
+// Which lines hold a keyword
+// ============================================================================
+
+// One index_of per keyword and per line: KEYWORDS passes over every line
+static void bench_index_of(string *log)
+{
+    tokenizer           lines;
+    string_view         line;
+    ui64                hits;
+    ui64                scanned;
+    int                 k;
+    double              start;
+
+    hits = 0;
+    scanned = 0;
+    start = bench_now();
+    lines = Tokenizer()->new(VAL_STR(log), VAL_CHAR('\n'));
+    // A sixteenth of the log is enough to time it
+    while (scanned < LOG_SIZE / 16 && Tokenizer()->next(&lines, &line))
+    {
+        for (k = 0; k < KEYWORDS; k++)
+        {
+            if (View()->index_of(line, VAL_PCHAR(g_keywords[k])) >= 0)
+            {
+                hits++;
+                break ;
+            }
+        }
+        scanned += line.len + 1;
+    }
+    print_bench_throughput("View()->index_of per keyword", bench_now() - start,
+        (double)scanned);
+    BENCH_SINK(hits);
+}
+
+static void bench_matcher_find(string *log, matcher *m)
+{
+    tokenizer           lines;
+    string_view         line;
+    match               hit;
+    ui64                hits;
+    unsigned long long  allocs;
+    double              start;
+
+    hits = 0;
+    allocs = g_bench_allocs;
+    start = bench_now();
+    lines = Tokenizer()->new(VAL_STR(log), VAL_CHAR('\n'));
+    while (Tokenizer()->next(&lines, &line))
+        hits += (ui64)Matcher()->find(m, VAL_VIEW(line), 0, &hit);
+    print_bench_throughput("Matcher()->find per line", bench_now() - start,
+        (double)String()->len(log));
+    print_bench_value("  allocations", (double)(g_bench_allocs - allocs), "");
+    print_bench_value("  matching lines", (double)hits, "");
+    BENCH_SINK(hits);
+}
+
+// ============================================================================
+// Every match in the whole log
+// ============================================================================
+
+static void bench_matcher_count(string *log, matcher *m)
+{
+    ui64    counts[KEYWORDS];
+    double  start;
+
+    start = bench_now();
+    BENCH_SINK(Matcher()->count(m, VAL_STR(log), counts));
+    print_bench_throughput("Matcher()->count over the log", bench_now() - start,
+        (double)String()->len(log));
+    BENCH_SINK(counts[KEYWORDS - 1]);
+}
+
+static void bench_matcher_new(void)
+{
+    matcher *m;
+    double  start;
+    int     i;
+
+    start = bench_now();
+    for (i = 0; i < 100; i++)
+    {
+        m = Matcher()->new_pchars(g_keywords, KEYWORDS);
+        BENCH_SINK(Matcher()->len(m));
+        Matcher()->del(&m);
+    }
+    print_bench_ops("Matcher()->new_pchars, 300 keywords", bench_now() - start, 100);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    string  *log;
+    matcher *m;
+
+    make_keywords();
+    log = make_log();
+    m = Matcher()->new_pchars(g_keywords, KEYWORDS);
+
+    print_bench_header("Lines holding one of 300 keywords (64 MB log)");
+    bench_index_of(log);
+    bench_matcher_find(log, m);
+
+    print_bench_header("Every match of 300 keywords (64 MB log)");
+    bench_matcher_count(log, m);
+    bench_matcher_new();
+
+    Matcher()->del(&m);
+    String()->del(&log);
+    print_bench_footer();
+    return (0);
+}
@@ -0,0 +1,202 @@
+#define _GNU_SOURCE
+#define BENCH_COUNT_ALLOCS
+#include <types/reader.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include "../bench_framework.h"
+
+#define LOG_SIZE    (256ULL << 20)
+#define LINE        "2024-05-01T12:00:00Z level=info request=184467 path=/api/v1/orders status=200\n"
+
+static char g_path[] = "/tmp/bench_reader_XXXXXX";
+
+// Writes a LOG_SIZE log file made of LINE
+static void make_log(void)
+{
+    string  *chunk;
+    int     fd;
+    ui64    written;
+
+    fd = mkstemp(g_path);
+    chunk = String()->new("");
+    while (String()->len(chunk) < (1 << 20))
+        String()->append(chunk, VAL_PCHAR(LINE));
+    for (written = 0; written < LOG_SIZE; written += String()->len(chunk))
+        String()->write(fd, chunk);
+    String()->del(&chunk);
+    close(fd);
+}
+
+// ============================================================================
+// Reading a whole file
+// ============================================================================
+
+static void bench_read_file(void)
+{
+    string              *s;
+    double              start;
+    unsigned long long  allocs;
+
+    allocs = g_bench_allocs;
+    start = bench_now();
+    s = String()->read_file(g_path);
+    print_bench_throughput("String()->read_file 256 MB", bench_now() - start,
+        (double)String()->len(s));
+    print_bench_value("  allocations", (double)(g_bench_allocs - allocs), "");
+    String()->del(&s);
+}
+
+// The size is unknown through a pipe: the buffer grows geometrically
+static void bench_read_fd_pipe(void)
+{
+    string              *s;
+    double              start;
+    unsigned long long  allocs;
+    FILE                *cat;
+    char                cmd[64];
+
+    snprintf(cmd, sizeof(cmd), "cat %s", g_path);
+    cat = popen(cmd, "r");
+    allocs = g_bench_allocs;
+    start = bench_now();
+    s = String()->read_fd(fileno(cat));
+    print_bench_throughput("String()->read_fd 256 MB from a pipe", bench_now() - start,
+        (double)String()->len(s));
+    print_bench_value("  allocations", (double)(g_bench_allocs - allocs), "");
+    String()->del(&s);
+    pclose(cat);
+}
+
+// Private resident memory in MB: what this process holds on its own, the page
+// cache shared with other readers of a file left out
+static double private_mb(void)
+{
+    unsigned long   size;
+    unsigned long   resident;
+    unsigned long   shared;
+    FILE            *statm;
+
+    statm = fopen("/proc/self/statm", "r");
+    if (!statm || fscanf(statm, "%lu %lu %lu", &size, &resident, &shared) != 3)
+        resident = shared = 0;
+    if (statm)
+        fclose(statm);
+    return ((double)(resident - shared) * (double)sysconf(_SC_PAGESIZE) / (1 << 20));
+}
+
+// Loads the file and scans all of it, as a lookup in a dictionary would
+static void bench_load_and_scan(const char *label, string *(*load)(const char *))
+{
+    string  *s;
+    double  start;
+    double  before;
+
+    before = private_mb();
+    start = bench_now();
+    s = load(g_path);
+    BENCH_SINK(String()->index_of(s, VAL_PCHAR("status=404")));
+    print_bench_throughput(label, bench_now() - start, (double)String()->len(s));
+    print_bench_value("  private memory", private_mb() - before, "MB");
+    String()->del(&s);
+}
+
+// ============================================================================
+// Reading line by line
+// ============================================================================
+
+// libc baseline: one buffer reused by getline
+static void bench_getline(void)
+{
+    FILE    *file;
+    char    *line;
+    size_t  cap;
+    ssize_t len;
+    ui64    total;
+    double  start;
+
+    file = fopen(g_path, "r");
+    line = NULL;
+    cap = 0;
+    total = 0;
+    start = bench_now();
+    while ((len = getline(&line, &cap, file)) > 0)
+        total += (ui64)len;
+    print_bench_throughput("getline", bench_now() - start, (double)total);
+    BENCH_SINK(total);
+    free(line);
+    fclose(file);
+}
+
+// A new string per line, what the library allowed before Reader()
+static void bench_string_per_line(void)
+{
+    FILE                *file;
+    char                buf[4096];
+    string              *line;
+    ui64                total;
+    double              start;
+    unsigned long long  allocs;
+
+    file = fopen(g_path, "r");
+    total = 0;
+    allocs = g_bench_allocs;
+    start = bench_now();
+    while (fgets(buf, sizeof(buf), file))
+    {
+        line = String()->new(buf);
+        total += String()->len(line);
+        String()->del(&line);
+    }
+    print_bench_throughput("fgets + String()->new per line", bench_now() - start,
+        (double)total);
+    print_bench_value("  allocations", (double)(g_bench_allocs - allocs), "");
+    fclose(file);
+}
+
+static void bench_reader_line(void)
+{
+    reader              *r;
+    string              *line;
+    ui64                total;
+    double              start;
+    unsigned long long  allocs;
+    int                 fd;
+
+    fd = open(g_path, O_RDONLY);
+    line = String()->new("");
+    total = 0;
+    allocs = g_bench_allocs;
+    start = bench_now();
+    r = Reader()->new(fd);
+    while (Reader()->line(r, line))
+        total += String()->len(line) + 1;
+    Reader()->del(&r);
+    print_bench_throughput("Reader()->line", bench_now() - start, (double)total);
+    print_bench_value("  allocations", (double)(g_bench_allocs - allocs), "");
+    String()->del(&line);
+    close(fd);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    make_log();
+
+    print_bench_header("Reading a 256 MB log file");
+    bench_read_file();
+    bench_read_fd_pipe();
+    bench_load_and_scan("String()->read_file + index_of", String()->read_file);
+    bench_load_and_scan("String()->map_file + index_of", String()->map_file);
+
+    print_bench_header("Line by line over a 256 MB log file");
+    bench_getline();
+    bench_string_per_line();
+    bench_reader_line();
+
+    unlink(g_path);
+    print_bench_footer();
+    return (0);
+}
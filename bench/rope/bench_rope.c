@@ -0,0 +1,174 @@
+#define BENCH_COUNT_ALLOCS
+#include <types/rope.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include "../bench_framework.h"
+
+#define DOC_SIZE    (256ULL << 20)
+#define LINE        "2024-05-01T12:00:00Z order=184467 status=shipped total=129.90 EUR\n"
+#define LINE_LEN    (sizeof(LINE) - 1)
+#define INSERTS     100000
+
+// ============================================================================
+// Building a large document
+// ============================================================================
+
+// The contiguous baseline: every growth reallocates (and may copy) the whole
+// document built so far
+static void bench_string_build(void)
+{
+    string              *s;
+    double              start;
+    unsigned long long  allocs;
+    ui64                i;
+
+    s = String()->new("");
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (i = 0; i < DOC_SIZE / LINE_LEN; i++)
+        String()->append(s, VAL_PCHAR(LINE));
+    print_bench_throughput("String()->append 256 MB of lines",
+        bench_now() - start, (double)String()->len(s));
+    print_bench_value("  allocations", (double)(g_bench_allocs - allocs), "");
+    String()->del(&s);
+}
+
+static void bench_rope_build(void)
+{
+    rope                *r;
+    double              start;
+    unsigned long long  allocs;
+    ui64                i;
+
+    r = Rope()->new();
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (i = 0; i < DOC_SIZE / LINE_LEN; i++)
+        Rope()->append(r, VAL_PCHAR(LINE));
+    print_bench_throughput("Rope()->append 256 MB of lines",
+        bench_now() - start, (double)Rope()->len(r));
+    print_bench_value("  allocations", (double)(g_bench_allocs - allocs), "");
+    Rope()->del(&r);
+}
+
+// ============================================================================
+// Editing a large document
+// ============================================================================
+
+static rope *make_document(void)
+{
+    rope    *r;
+    ui64    i;
+
+    r = Rope()->new();
+    for (i = 0; i < DOC_SIZE / LINE_LEN; i++)
+        Rope()->append(r, VAL_PCHAR(LINE));
+    return (r);
+}
+
+// Inserts a short line at scattered positions, a flat buffer would move half
+// of the document on every insert
+static void bench_rope_insert(rope *r)
+{
+    double  start;
+    ui64    i;
+
+    start = bench_now();
+    for (i = 0; i < INSERTS; i++)
+        Rope()->insert(r, (i * 2654435761ULL) % Rope()->len(r), VAL_PCHAR("# note\n"));
+    print_bench_ops("Rope()->insert into 256 MB", bench_now() - start, INSERTS);
+}
+
+static void bench_rope_substring(rope *r)
+{
+    rope    *sub;
+    double  start;
+    ui64    i;
+
+    start = bench_now();
+    for (i = 0; i < INSERTS; i++)
+    {
+        sub = Rope()->substring(r, (i * 2654435761ULL) % (Rope()->len(r) / 2),
+            Rope()->len(r) / 4);
+        BENCH_SINK(Rope()->len(sub));
+        Rope()->del(&sub);
+    }
+    print_bench_ops("Rope()->substring of 64 MB", bench_now() - start, INSERTS);
+}
+
+static void bench_rope_concat(rope *r)
+{
+    rope    *doc;
+    double  start;
+    ui64    i;
+
+    doc = Rope()->new();
+    start = bench_now();
+    for (i = 0; i < INSERTS; i++)
+        Rope()->concat(doc, r);
+    print_bench_ops("Rope()->concat a 256 MB rope", bench_now() - start, INSERTS);
+    BENCH_SINK(Rope()->len(doc));
+    Rope()->del(&doc);
+}
+
+// ============================================================================
+// Reading a large document
+// ============================================================================
+
+static void bench_rope_index_of(rope *r)
+{
+    double  start;
+
+    Rope()->append(r, VAL_PCHAR("status=lost"));
+    start = bench_now();
+    BENCH_SINK(Rope()->index_of(r, VAL_PCHAR("status=lost")));
+    print_bench_throughput("Rope()->index_of, match at the end",
+        bench_now() - start, (double)Rope()->len(r));
+}
+
+static void bench_rope_write(rope *r)
+{
+    string  *flat;
+    double  start;
+    int     fd;
+
+    fd = open("/dev/null", O_WRONLY);
+    start = bench_now();
+    Rope()->write(fd, r);
+    print_bench_throughput("Rope()->write (writev) to /dev/null",
+        bench_now() - start, (double)Rope()->len(r));
+    start = bench_now();
+    flat = Rope()->flatten(r);
+    String()->write(fd, flat);
+    print_bench_throughput("Rope()->flatten + String()->write",
+        bench_now() - start, (double)Rope()->len(r));
+    String()->del(&flat);
+    close(fd);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    rope    *r;
+
+    print_bench_header("Building a 256 MB report");
+    bench_string_build();
+    bench_rope_build();
+
+    r = make_document();
+    print_bench_header("Editing a 256 MB rope");
+    bench_rope_insert(r);
+    bench_rope_substring(r);
+    bench_rope_concat(r);
+
+    print_bench_header("Reading a 256 MB rope");
+    bench_rope_index_of(r);
+    bench_rope_write(r);
+    Rope()->del(&r);
+
+    print_bench_footer();
+    return (0);
+}
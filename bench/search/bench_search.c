@@ -0,0 +1,144 @@
+#define _GNU_SOURCE
+#include <types/search.h>
+#include "../bench_framework.h"
+
+#define HAY_SIZE    (8ULL << 20)
+#define ROUNDS      8
+
+// The previous index_of: a byte by byte scan restarted at every position.
+static i64 naive_search(const char *h, ui64 n, const char *nd, ui64 m)
+{
+    ui64    i;
+    ui64    j;
+
+    for (i = 0; i + m <= n; i++)
+    {
+        j = 0;
+        while (j < m && h[i + j] == nd[j])
+            j++;
+        if (j == m)
+            return ((i64)i);
+    }
+    return (-1);
+}
+
+// Log-like text: words from a small vocabulary, so needles keep hitting
+// partial matches the way they do in real logs. Needles get a '|' in the
+// middle, which the haystack never contains, so they only match where planted.
+static void fill_log(char *buf, ui64 n, unsigned seed)
+{
+    static const char   *words[] = {"GET ", "POST ", "/api/v1/", "users ",
+        "200 ", "404 ", "host=", "10.0.0.", "INFO ", "WARN ", "latency=",
+        "ms ", "request_id=", "abcdef", "\n"};
+    ui64                i;
+    ui64                len;
+
+    i = 0;
+    while (i < n)
+    {
+        seed = seed * 1103515245u + 12345u;
+        len = strlen(words[(seed >> 16) % 15]);
+        if (i + len > n)
+            len = n - i;
+        memcpy(buf + i, words[(seed >> 16) % 15], len);
+        i += len;
+    }
+}
+
+static void bench_needle(char *hay, ui64 m)
+{
+    char    *needle;
+    pattern *pat;
+    double  start;
+    double  elapsed;
+    int     r;
+    char    label[64];
+
+    needle = malloc(m + 1);
+    fill_log(needle, m, 7);
+    needle[m / 2] = '|';
+    needle[m] = '\0';
+    memcpy(hay + HAY_SIZE - m - 1, needle, m);
+    start = bench_now();
+    for (r = 0; r < ROUNDS; r++)
+        BENCH_SINK(search_forward(hay, HAY_SIZE, needle, m, 0));
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "search_forward   m=%4llu", m);
+    print_bench_throughput(label, elapsed, (double)HAY_SIZE * ROUNDS);
+    pat = Pattern()->new(VAL_PCHAR(needle));
+    start = bench_now();
+    for (r = 0; r < ROUNDS; r++)
+        BENCH_SINK(Pattern()->find(pat, hay, HAY_SIZE, 0));
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "Pattern()->find  m=%4llu", m);
+    print_bench_throughput(label, elapsed, (double)HAY_SIZE * ROUNDS);
+    start = bench_now();
+    for (r = 0; r < ROUNDS; r++)
+        BENCH_SINK(Pattern()->rfind(pat, hay, HAY_SIZE - m - 1, HAY_SIZE));
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "Pattern()->rfind m=%4llu (miss)", m);
+    print_bench_throughput(label, elapsed, (double)HAY_SIZE * ROUNDS);
+    start = bench_now();
+    for (r = 0; r < ROUNDS; r++)
+        BENCH_SINK(memmem(hay, HAY_SIZE, needle, m));
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "libc memmem      m=%4llu", m);
+    print_bench_throughput(label, elapsed, (double)HAY_SIZE * ROUNDS);
+    start = bench_now();
+    BENCH_SINK(naive_search(hay, HAY_SIZE, needle, m));
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "naive scan       m=%4llu", m);
+    print_bench_throughput(label, elapsed, (double)HAY_SIZE);
+    Pattern()->del(&pat);
+    memset(hay + HAY_SIZE - m - 1, '#', m);
+    free(needle);
+}
+
+// Many short lines searched with the same needle: the compiled pattern skips
+// building the tables on every call.
+static void bench_many_lines(char *hay)
+{
+    pattern     *pat;
+    const char  *needle;
+    double      start;
+    double      elapsed;
+    ui64        i;
+
+    needle = "request_id=abcdef/api/v1/users 404 host=10.0.0.GET POST latency=";
+    pat = Pattern()->new(VAL_PCHAR(needle));
+    start = bench_now();
+    for (i = 0; i + 128 <= HAY_SIZE; i += 128)
+        BENCH_SINK(search_forward(hay + i, 128, needle, strlen(needle), 0));
+    elapsed = bench_now() - start;
+    print_bench_ops("128 B lines, search_forward", elapsed, (double)(HAY_SIZE / 128));
+    start = bench_now();
+    for (i = 0; i + 128 <= HAY_SIZE; i += 128)
+        BENCH_SINK(Pattern()->find(pat, hay + i, 128, 0));
+    elapsed = bench_now() - start;
+    print_bench_ops("128 B lines, compiled pattern", elapsed, (double)(HAY_SIZE / 128));
+    Pattern()->del(&pat);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    static const ui64   lengths[] = {1, 4, 16, 32, 64, 200, 300, 1000};
+    char                *hay;
+    ui64                i;
+
+    hay = malloc(HAY_SIZE);
+    if (!hay)
+        return (1);
+    fill_log(hay, HAY_SIZE, 42);
+    print_bench_header("Substring search over an 8 MB log buffer");
+    for (i = 0; i < sizeof(lengths) / sizeof(*lengths); i++)
+        bench_needle(hay, lengths[i]);
+    print_bench_header("Repeated searches over short lines");
+    bench_many_lines(hay);
+    free(hay);
+    print_bench_footer();
+    return (0);
+}
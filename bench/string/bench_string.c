@@ -0,0 +1,841 @@
+#define BENCH_COUNT_ALLOCS
+#include <types/string.h>
+#include <types/string_view.h>
+#include "../bench_framework.h"
+
+// ============================================================================
+// Append growth
+// ============================================================================
+
+// Appends `n` single characters and reports the cost per append and how many
+// times the buffer had to grow. With geometric growth the cost per append stays
+// flat while `n` grows by orders of magnitude.
+static void bench_append_char(ui64 n, int exact_fit)
+{
+    string  *s;
+    double  start;
+    double  elapsed;
+    ui64    growths;
+    ui64    last;
+    ui64    i;
+    char    label[64];
+
+    s = String()->new("");
+    growths = 0;
+    last = String()->capacity(s);
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        if (exact_fit)
+            String()->reserve(s, String()->len(s) + 1);
+        String()->append(s, VAL_CHAR('x'));
+        if (String()->capacity(s) != last)
+        {
+            growths++;
+            last = String()->capacity(s);
+        }
+    }
+    elapsed = bench_now() - start;
+    BENCH_SINK(String()->len(s));
+    snprintf(label, sizeof(label), "%s append char x %llu",
+        exact_fit ? "exact-fit" : "geometric", n);
+    print_bench_ops(label, elapsed, (double)n);
+    snprintf(label, sizeof(label), "  buffer growths");
+    print_bench_value(label, (double)growths, "");
+    String()->del(&s);
+}
+
+// Builds a 1 MB string from 16 byte chunks, the log formatter pattern.
+static void bench_append_pchar(ui64 total)
+{
+    string      *s;
+    double      start;
+    double      elapsed;
+    ui64        i;
+    const char  *chunk;
+
+    chunk = "0123456789abcdef";
+    s = String()->new("");
+    start = bench_now();
+    for (i = 0; i < total / 16; i++)
+        String()->append(s, VAL_PCHAR(chunk));
+    elapsed = bench_now() - start;
+    BENCH_SINK(String()->len(s));
+    print_bench_ops("append 16B pchar up to 1 MB", elapsed, (double)(total / 16));
+    String()->del(&s);
+}
+
+// ============================================================================
+// Construction (small-string optimization)
+// ============================================================================
+
+// Creates and destroys `n` strings from `text`, reporting allocations per
+// string and construction throughput.
+static void bench_new_del(const char *label, char *text, ui64 n)
+{
+    string              *s;
+    double              start;
+    double              elapsed;
+    unsigned long long  allocs;
+    ui64                i;
+    char                buf[64];
+
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        s = String()->new(text);
+        BENCH_SINK(String()->len(s));
+        String()->del(&s);
+    }
+    elapsed = bench_now() - start;
+    allocs = g_bench_allocs - allocs;
+    print_bench_ops(label, elapsed, (double)n);
+    snprintf(buf, sizeof(buf), "  allocations per string");
+    print_bench_value(buf, (double)allocs / (double)n, "");
+}
+
+// The previous layout: one block for the header and one for the characters.
+static void bench_two_block_baseline(char *text, ui64 n)
+{
+    char                **blocks;
+    double              start;
+    double              elapsed;
+    unsigned long long  allocs;
+    ui64                len;
+    ui64                i;
+
+    allocs = g_bench_allocs;
+    len = strlen(text);
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        blocks = calloc(1, 3 * sizeof(char *));
+        blocks[0] = calloc(1, len + 1);
+        memcpy(blocks[0], text, len);
+        BENCH_SINK(blocks[0][0]);
+        free(blocks[0]);
+        free(blocks);
+    }
+    elapsed = bench_now() - start;
+    allocs = g_bench_allocs - allocs;
+    print_bench_ops("two-block baseline, 8 byte token", elapsed, (double)n);
+    print_bench_value("  allocations per string", (double)allocs / (double)n, "");
+}
+
+// ============================================================================
+// Integer appends
+// ============================================================================
+
+// Appends `n` integers spread across every digit count, either through a
+// temporary heap string (the old llong_to_ascii path) or formatted straight
+// into the string buffer.
+static void bench_append_numbers(ui64 n, int via_temp)
+{
+    string              *s;
+    char                *tmp;
+    double              start;
+    double              elapsed;
+    unsigned long long  allocs;
+    long long           value;
+    ui64                i;
+
+    s = String()->new("");
+    String()->reserve(s, (int)(n * 21));
+    allocs = g_bench_allocs;
+    value = 1;
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        if (via_temp)
+        {
+            tmp = llong_to_ascii(value);
+            String()->append(s, VAL_PCHAR(tmp));
+            free(tmp);
+        }
+        else
+            String()->append(s, VAL_LLONG(value));
+        value = value * 7 + 3;
+        if (value > 1000000000000000000LL)
+            value = (long long)i;
+    }
+    elapsed = bench_now() - start;
+    allocs = g_bench_allocs - allocs;
+    BENCH_SINK(String()->len(s));
+    print_bench_ops(via_temp ? "llong_to_ascii + append pchar + free"
+        : "append VAL_LLONG (in place)", elapsed, (double)n);
+    print_bench_value("  allocations per number", (double)allocs / (double)n, "");
+    String()->del(&s);
+}
+
+// ============================================================================
+// Floating point appends
+// ============================================================================
+
+// Appends `n` metric samples (latencies in seconds, ratios, counters), either
+// printed with snprintf into a stack buffer then appended, or written straight
+// into the string. `precision` < 0 asks for round-trip output (%.17g for
+// snprintf, which is not the shortest), otherwise that many decimals.
+static void bench_append_doubles(ui64 n, int via_snprintf, int precision)
+{
+    string              *s;
+    char                tmp[64];
+    char                label[64];
+    double              start;
+    double              elapsed;
+    double              value;
+    ui64                i;
+    int                 len;
+
+    s = String()->new("");
+    String()->reserve(s, (int)(n * 25));
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        value = (i % 3 == 0) ? (double)(i % 10007) * 0.001
+            : (i % 3 == 1) ? 1.0 / (double)(i + 1) : (double)(i * 37);
+        if (via_snprintf)
+        {
+            if (precision < 0)
+                len = snprintf(tmp, sizeof(tmp), "%.17g", value);
+            else
+                len = snprintf(tmp, sizeof(tmp), "%.*f", precision, value);
+            String()->append(s, VAL_VIEW(((string_view){tmp, (ui64)len})));
+        }
+        else if (precision < 0)
+            String()->append(s, VAL_DOUBLE(value));
+        else
+            String()->append(s, VAL_DOUBLE_FIXED(value, precision));
+    }
+    elapsed = bench_now() - start;
+    BENCH_SINK(String()->len(s));
+    if (precision < 0)
+        snprintf(label, sizeof(label), "%s", via_snprintf
+            ? "snprintf %.17g + append" : "append VAL_DOUBLE (shortest)");
+    else
+        snprintf(label, sizeof(label), via_snprintf ? "snprintf %%.%df + append"
+            : "append VAL_DOUBLE_FIXED(x, %d)", precision);
+    print_bench_ops(label, elapsed, (double)n);
+    print_bench_value("  bytes per number", (double)String()->len(s) / (double)n, "");
+    String()->del(&s);
+}
+
+// ============================================================================
+// Number parsing
+// ============================================================================
+
+// `n` numeric fields of an ingest feed, one per line: integers of 1 to 18
+// digits, or doubles written the shortest way and with 3 decimals
+static string *make_fields(ui64 n, int doubles, string_view *fields)
+{
+    string      *s;
+    string_view rest;
+    ui64        r;
+    ui64        i;
+
+    s = String()->new("");
+    r = 88172645463325252ULL;
+    for (i = 0; i < n; i++)
+    {
+        r ^= r << 13;
+        r ^= r >> 7;
+        r ^= r << 17;
+        if (!doubles)
+            String()->append(s, VAL_LLONG((long long)(r % 1000000000000000000ULL
+                / ((r >> 60) ? 1 : 1000000000000ULL)) * (i % 4 ? 1 : -1)));
+        else if (i % 2)
+            String()->append(s, VAL_DOUBLE((double)(r >> 11) / (double)(1 + r % 100003)));
+        else
+            String()->append(s, VAL_DOUBLE_FIXED((double)(r % 10000000) / 1000.0, 3));
+        String()->append(s, VAL_CHAR('\n'));
+    }
+    rest = String()->view(s);
+    for (i = 0; i < n; i++)
+        View()->split(&rest, VAL_CHAR('\n'), &fields[i]);
+    return (s);
+}
+
+static void bench_parse_fields(ui64 n, int doubles, int via_libc)
+{
+    string_view *fields;
+    string      *s;
+    double      start;
+    double      sum;
+    long long   ll;
+    double      d;
+    ui64        i;
+
+    fields = malloc(n * sizeof(*fields));
+    s = make_fields(n, doubles, fields);
+    sum = 0;
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        // Fields end with a newline, which stops strtoll / strtod
+        if (doubles && via_libc)
+            sum += strtod(fields[i].ptr, NULL);
+        else if (doubles)
+            sum += View()->to_double(fields[i], &d) == PARSE_OK ? d : 0;
+        else if (via_libc)
+            sum += (double)strtoll(fields[i].ptr, NULL, 10);
+        else
+            sum += View()->to_llong(fields[i], &ll) == PARSE_OK ? (double)ll : 0;
+    }
+    print_bench_ops(doubles ? (via_libc ? "strtod" : "View()->to_double")
+        : (via_libc ? "strtoll" : "View()->to_llong"), bench_now() - start, (double)n);
+    BENCH_SINK(sum);
+    String()->del(&s);
+    free(fields);
+}
+
+// ============================================================================
+// Batch append
+// ============================================================================
+
+// Builds `n` log lines of ten pieces each on a fresh string, either with one
+// append per piece or with a single append_many.
+static void bench_log_lines(ui64 n, int batched)
+{
+    string              *line;
+    string              *host;
+    double              start;
+    double              elapsed;
+    unsigned long long  allocs;
+    ui64                i;
+
+    host = String()->new("api-gateway-eu-west-1.internal");
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        line = String()->new("");
+        if (batched)
+            APPEND_MANY(line, VAL_PCHAR("ts="), VAL_ULLONG(1700000000000ULL + i),
+                VAL_PCHAR(" host="), VAL_STR(host), VAL_PCHAR(" status="),
+                VAL_INT(200 + (int)(i % 5)), VAL_PCHAR(" bytes="), VAL_ULLONG(i * 37),
+                VAL_PCHAR(" path=/v1/items/"), VAL_HEX(i));
+        else
+        {
+            String()->append(line, VAL_PCHAR("ts="));
+            String()->append(line, VAL_ULLONG(1700000000000ULL + i));
+            String()->append(line, VAL_PCHAR(" host="));
+            String()->append(line, VAL_STR(host));
+            String()->append(line, VAL_PCHAR(" status="));
+            String()->append(line, VAL_INT(200 + (int)(i % 5)));
+            String()->append(line, VAL_PCHAR(" bytes="));
+            String()->append(line, VAL_ULLONG(i * 37));
+            String()->append(line, VAL_PCHAR(" path=/v1/items/"));
+            String()->append(line, VAL_HEX(i));
+        }
+        BENCH_SINK(String()->len(line));
+        String()->del(&line);
+    }
+    elapsed = bench_now() - start;
+    allocs = g_bench_allocs - allocs;
+    print_bench_ops(batched ? "APPEND_MANY, 10 pieces" : "chained append, 10 pieces",
+        elapsed, (double)n);
+    print_bench_value("  allocations per line", (double)allocs / (double)n, "");
+    String()->del(&host);
+}
+
+// ============================================================================
+// Character class predicates
+// ============================================================================
+
+// The previous is_alpha: one chained range check per byte
+static int naive_is_alpha(const char *ptr, ui64 len)
+{
+    while (len--)
+    {
+        if ((*ptr < 'A' || *ptr > 'Z') && (*ptr < 'a' || *ptr > 'z'))
+            return (0);
+        ptr++;
+    }
+    return (1);
+}
+
+// The previous is_ascii: one compare per byte
+static int naive_is_ascii(const char *ptr, ui64 len)
+{
+    while (len--)
+    {
+        if ((unsigned char)*ptr > 127)
+            return (0);
+        ptr++;
+    }
+    return (1);
+}
+
+// Runs `pred` over a string of `size` matching bytes, so the whole payload is
+// always scanned.
+static void bench_predicate(const char *label, int (*pred)(string *),
+    int (*naive)(const char *, ui64), char fill, ui64 size, int rounds)
+{
+    string  *s;
+    char    *text;
+    double  start;
+    double  elapsed;
+    int     r;
+
+    text = malloc(size + 1);
+    memset(text, fill, size);
+    text[size] = '\0';
+    s = String()->new(text);
+    start = bench_now();
+    for (r = 0; r < rounds; r++)
+    {
+        if (naive)
+            BENCH_SINK(naive(text, size));
+        else
+            BENCH_SINK(pred(s));
+    }
+    elapsed = bench_now() - start;
+    print_bench_throughput(label, elapsed, (double)size * rounds);
+    String()->del(&s);
+    free(text);
+}
+
+// ============================================================================
+// Case conversion
+// ============================================================================
+
+// The previous to_lower: one branchy range check per byte
+static void naive_lower(char *ptr, ui64 len)
+{
+    while (len--)
+    {
+        if (*ptr >= 'A' && *ptr <= 'Z')
+            *ptr = *ptr + 'a' - 'A';
+        ptr++;
+    }
+}
+
+// Case folds a `size` byte mixed case payload `rounds` times
+static void bench_case_bulk(const char *label, int naive, ui64 size, int rounds)
+{
+    string  *s;
+    char    *text;
+    double  start;
+    double  elapsed;
+    ui64    i;
+    int     r;
+
+    text = malloc(size + 1);
+    for (i = 0; i < size; i++)
+        text[i] = "Host: Example.ORG\r\n"[i % 19];
+    text[size] = '\0';
+    s = String()->new(text);
+    start = bench_now();
+    for (r = 0; r < rounds; r++)
+    {
+        if (naive)
+            naive_lower(text, size);
+        else
+            String()->to_lower(s);
+        BENCH_SINK(naive ? (ui64)text[r] : String()->len(s));
+    }
+    elapsed = bench_now() - start;
+    print_bench_throughput(label, elapsed, (double)size * rounds);
+    String()->del(&s);
+    free(text);
+}
+
+// Normalizes `n` header names, either cloning then folding in place or folding
+// into one reused destination string
+static void bench_case_headers(ui64 n, int into)
+{
+    static char         *names[] = {"Content-Type", "Accept-Encoding",
+        "X-Forwarded-For", "Authorization", "Cache-Control", "User-Agent"};
+    string              *src[6];
+    string              *dst;
+    double              start;
+    double              elapsed;
+    unsigned long long  allocs;
+    ui64                i;
+
+    for (i = 0; i < 6; i++)
+        src[i] = String()->new(names[i]);
+    dst = String()->new("");
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        if (into)
+            String()->to_lower_into(src[i % 6], dst);
+        else
+        {
+            String()->del(&dst);
+            dst = String()->clone(src[i % 6]);
+            String()->to_lower(dst);
+        }
+        BENCH_SINK(String()->len(dst));
+    }
+    elapsed = bench_now() - start;
+    allocs = g_bench_allocs - allocs;
+    print_bench_ops(into ? "to_lower_into reused string" : "clone + to_lower + del",
+        elapsed, (double)n);
+    print_bench_value("  allocations per header", (double)allocs / (double)n, "");
+    for (i = 0; i < 6; i++)
+        String()->del(&src[i]);
+    String()->del(&dst);
+}
+
+// ============================================================================
+// Equality and ordering
+// ============================================================================
+
+// The previous equals_string: strlen then a byte by byte loop
+static int naive_equals(const char *a, ui64 a_len, const char *b)
+{
+    ui64    i;
+
+    if (strlen(b) != a_len)
+        return (0);
+    for (i = 0; i < a_len; i++)
+        if (a[i] != b[i])
+            return (0);
+    return (1);
+}
+
+// Compares two equal strings of `size` bytes (the worst case: every byte is
+// read) with each method
+static void bench_equals(ui64 size, ui64 rounds)
+{
+    string  *a;
+    string  *b;
+    char    *text;
+    char    *copy;
+    char    label[64];
+    double  start;
+    ui64    r;
+    int     method;
+
+    text = malloc(size + 1);
+    for (r = 0; r < size; r++)
+        text[r] = (char)('a' + r % 23);
+    text[size] = '\0';
+    copy = strdup(text);
+    a = String()->new(text);
+    b = String()->new(copy);
+    for (method = 0; method < 5; method++)
+    {
+        start = bench_now();
+        for (r = 0; r < rounds; r++)
+        {
+            if (method == 0)
+                BENCH_SINK(naive_equals(text, size, copy));
+            else if (method == 1)
+                BENCH_SINK(strcmp(text, copy));
+            else if (method == 2)
+                BENCH_SINK(memcmp(text, copy, size));
+            else if (method == 3)
+                BENCH_SINK(String()->equals(a, VAL_STR(b)));
+            else
+                BENCH_SINK(String()->compare(a, VAL_STR(b)));
+        }
+        snprintf(label, sizeof(label), "%-22s %6llu B",
+            (char *[]){"byte loop equals", "libc strcmp", "libc memcmp",
+            "String()->equals", "String()->compare"}[method],
+            (unsigned long long)size);
+        print_bench_ops(label, bench_now() - start, (double)rounds);
+    }
+    String()->del(&a);
+    String()->del(&b);
+    free(text);
+    free(copy);
+}
+
+// Strings of different lengths are told apart without reading them
+static void bench_equals_length_mismatch(ui64 rounds)
+{
+    string  *a;
+    string  *b;
+    double  start;
+    ui64    r;
+
+    a = String()->new("x-request-id: 7f3a9c1e-5b2d-4e8f-a6c0-d1b2e3f4a5b6");
+    b = String()->new("x-request-id: 7f3a9c1e-5b2d-4e8f-a6c0-d1b2e3f4a5b67");
+    start = bench_now();
+    for (r = 0; r < rounds; r++)
+        BENCH_SINK(String()->equals(a, VAL_STR(b)));
+    print_bench_ops("String()->equals, lengths differ", bench_now() - start,
+        (double)rounds);
+    start = bench_now();
+    for (r = 0; r < rounds; r++)
+        BENCH_SINK(String()->equals_ignore_case(a, VAL_PCHAR("X-Request-ID: "
+            "7F3A9C1E-5B2D-4E8F-A6C0-D1B2E3F4A5B6")));
+    print_bench_ops("String()->equals_ignore_case, 50 B", bench_now() - start,
+        (double)rounds);
+    String()->del(&a);
+    String()->del(&b);
+}
+
+// ============================================================================
+// Cloning for worker queues
+// ============================================================================
+
+// Clones a `size` byte payload `n` times and deletes the clones, the way jobs
+// are handed to workers that only read them. `clone` copies the bytes, `share`
+// bumps a reference count.
+static void bench_clone(ui64 size, ui64 n, int shared)
+{
+    string              *s;
+    string              *c;
+    double              start;
+    unsigned long long  allocs;
+    ui64                i;
+    char                label[64];
+
+    s = String()->new("");
+    for (i = 0; i < size; i++)
+        String()->append(s, VAL_CHAR((char)('a' + i % 26)));
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        c = shared ? String()->share(s) : String()->clone(s);
+        BENCH_SINK(String()->len(c));
+        String()->del(&c);
+    }
+    snprintf(label, sizeof(label), "String()->%s + del, %llu B",
+        shared ? "share" : "clone", size);
+    print_bench_ops(label, bench_now() - start, (double)n);
+    print_bench_value("  allocations per clone",
+        (double)(g_bench_allocs - allocs) / n, "");
+    String()->del(&s);
+}
+
+// A shared clone pays for the copy on its first change only
+static void bench_share_then_write(ui64 size, ui64 n)
+{
+    string  *s;
+    string  *c;
+    double  start;
+    ui64    i;
+
+    s = String()->new("");
+    for (i = 0; i < size; i++)
+        String()->append(s, VAL_CHAR('x'));
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        c = String()->share(s);
+        String()->append(c, VAL_CHAR('!'));
+        BENCH_SINK(String()->len(c));
+        String()->del(&c);
+    }
+    print_bench_ops("String()->share + append + del, 4096 B",
+        bench_now() - start, (double)n);
+    String()->del(&s);
+}
+
+// ============================================================================
+// String()->format
+// ============================================================================
+
+#define METRIC_FMT "http_requests_total{host=\"%s\",code=\"%d\"} %llu %08llx\n"
+
+// Formats `n` exporter lines, each on a fresh string, either with snprintf
+// into a stack buffer then append, or with String()->format in place.
+static void bench_format(ui64 n, int via_snprintf)
+{
+    string              *line;
+    char                tmp[256];
+    double              start;
+    double              elapsed;
+    unsigned long long  allocs;
+    ui64                i;
+    int                 len;
+
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (i = 0; i < n; i++)
+    {
+        line = String()->new("");
+        if (via_snprintf)
+        {
+            len = snprintf(tmp, sizeof(tmp), METRIC_FMT, "api-gateway-eu-west-1",
+                200 + (int)(i % 5), (unsigned long long)(i * 37),
+                (unsigned long long)i);
+            String()->append(line, VAL_VIEW(((string_view){tmp, (ui64)len})));
+        }
+        else
+            String()->format(line, "http_requests_total{host=\"%s\",code=\"%d\"} %v %08x\n",
+                VAL_PCHAR("api-gateway-eu-west-1"), VAL_INT(200 + (int)(i % 5)),
+                VAL_ULLONG(i * 37), VAL_ULLONG(i));
+        BENCH_SINK(String()->len(line));
+        String()->del(&line);
+    }
+    elapsed = bench_now() - start;
+    print_bench_ops(via_snprintf ? "snprintf + append, 4 fields"
+        : "String()->format, 4 fields", elapsed, (double)n);
+    print_bench_value("  allocations per line",
+        (double)(g_bench_allocs - allocs) / (double)n, "");
+}
+
+// ============================================================================
+// String()->replace_all
+// ============================================================================
+
+#define REDACT_LINE "ts=1714564800 user=alice token=sk_live_0123456789abcdef path=/v1/charges\n"
+
+static string *make_redact_log(ui64 size)
+{
+    string  *log;
+
+    log = String()->new("");
+    while (String()->len(log) < size)
+        String()->append(log, VAL_PCHAR(REDACT_LINE));
+    return (log);
+}
+
+// The usual way without replace_all: index_of and append into a new string
+static string *naive_replace_all(const string *s, const char *needle,
+    const char *with)
+{
+    string          *out;
+    string_view     view;
+    i64             idx;
+    i64             from;
+
+    out = String()->new("");
+    view = String()->view(s);
+    from = 0;
+    while ((idx = String()->index_of_from(s, VAL_PCHAR(needle), from)) >= 0)
+    {
+        String()->append(out, VAL_VIEW(((string_view){view.ptr + from,
+            (ui64)(idx - from)})));
+        String()->append(out, VAL_PCHAR(with));
+        from = idx + (i64)strlen(needle);
+    }
+    String()->append(out, VAL_VIEW(((string_view){view.ptr + from,
+        view.len - (ui64)from})));
+    return (out);
+}
+
+// Redacts every token of a `size` byte log, `rounds` times over fresh copies
+static void bench_replace_all(ui64 size, int rounds, const char *with, int naive)
+{
+    string              *log;
+    string              *s;
+    string              *out;
+    double              elapsed;
+    double              start;
+    unsigned long long  allocs;
+    int                 r;
+    char                label[80];
+
+    log = make_redact_log(size);
+    elapsed = 0;
+    allocs = 0;
+    for (r = 0; r < rounds; r++)
+    {
+        s = String()->clone(log);
+        allocs -= g_bench_allocs;
+        start = bench_now();
+        if (naive)
+        {
+            out = naive_replace_all(s, "sk_live_0123456789abcdef", with);
+            String()->del(&s);
+            s = out;
+        }
+        else
+            BENCH_SINK(String()->replace_all(s, VAL_PCHAR("sk_live_0123456789abcdef"),
+                VAL_PCHAR(with)));
+        elapsed += bench_now() - start;
+        allocs += g_bench_allocs;
+        BENCH_SINK(String()->len(s));
+        String()->del(&s);
+    }
+    snprintf(label, sizeof(label), "%s, token -> %zu B",
+        naive ? "index_of + append" : "String()->replace_all", strlen(with));
+    print_bench_throughput(label, elapsed, (double)size * rounds);
+    print_bench_value("  allocations per pass", (double)allocs / rounds, "");
+    String()->del(&log);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    ui64    n;
+
+    print_bench_header("String()->append growth (amortized O(1))");
+    for (n = 1000; n <= 1000000; n *= 10)
+        bench_append_char(n, 0);
+    for (n = 1000; n <= 100000; n *= 10)
+        bench_append_char(n, 1);
+    bench_append_pchar(1 << 20);
+
+    print_bench_header("String()->new / del (small-string optimization)");
+    bench_two_block_baseline("user_id=", 1000000);
+    bench_new_del("new+del 8 byte token (inline)", "user_id=", 1000000);
+    bench_new_del("new+del 23 byte token (inline)", "abcdefghijklmnopqrstuvw", 1000000);
+    bench_new_del("new+del 40 byte string (heap)",
+        "abcdefghijklmnopqrstuvwxyz0123456789ABCD", 1000000);
+
+    print_bench_header("String()->append integers");
+    bench_append_numbers(1000000, 1);
+    bench_append_numbers(1000000, 0);
+
+    print_bench_header("String()->append doubles vs snprintf");
+    bench_append_doubles(1000000, 1, -1);
+    bench_append_doubles(1000000, 0, -1);
+    bench_append_doubles(1000000, 1, 3);
+    bench_append_doubles(1000000, 0, 3);
+
+    print_bench_header("Parsing numeric fields vs strtoll / strtod");
+    bench_parse_fields(1000000, 0, 1);
+    bench_parse_fields(1000000, 0, 0);
+    bench_parse_fields(1000000, 1, 1);
+    bench_parse_fields(1000000, 1, 0);
+
+    print_bench_header("String()->append_many (one growth per line)");
+    bench_log_lines(1000000, 0);
+    bench_log_lines(1000000, 1);
+
+    print_bench_header("String()->is_* predicates over 4 MB");
+    bench_predicate("byte loop is_ascii", NULL, naive_is_ascii, 'a', 4 << 20, 50);
+    bench_predicate("String()->is_ascii", String()->is_ascii, NULL, 'a', 4 << 20, 50);
+    bench_predicate("byte loop is_alpha", NULL, naive_is_alpha, 'q', 4 << 20, 50);
+    bench_predicate("String()->is_alpha", String()->is_alpha, NULL, 'q', 4 << 20, 50);
+    bench_predicate("String()->is_alnum", String()->is_alnum, NULL, '7', 4 << 20, 50);
+    bench_predicate("String()->is_digit", String()->is_digit, NULL, '7', 4 << 20, 50);
+    bench_predicate("String()->is_printable", String()->is_printable, NULL, '~', 4 << 20, 50);
+    bench_predicate("String()->is_space", String()->is_space, NULL, ' ', 4 << 20, 50);
+    bench_predicate("String()->is_lower", String()->is_lower, NULL, 'q', 4 << 20, 50);
+
+    print_bench_header("String()->to_lower (case folding)");
+    bench_case_bulk("byte loop to_lower, 4 MB", 1, 4 << 20, 50);
+    bench_case_bulk("String()->to_lower, 4 MB", 0, 4 << 20, 50);
+    bench_case_headers(1000000, 0);
+    bench_case_headers(1000000, 1);
+
+    print_bench_header("String()->equals / compare vs libc");
+    bench_equals(16, 20000000);
+    bench_equals(256, 5000000);
+    bench_equals(64 << 10, 20000);
+    bench_equals_length_mismatch(20000000);
+
+    print_bench_header("String()->clone vs String()->share (copy-on-write)");
+    bench_clone(64, 5000000, 0);
+    bench_clone(64, 5000000, 1);
+    bench_clone(4096, 1000000, 0);
+    bench_clone(4096, 1000000, 1);
+    bench_share_then_write(4096, 1000000);
+
+    print_bench_header("String()->format vs snprintf + append");
+    bench_format(2000000, 1);
+    bench_format(2000000, 0);
+
+    print_bench_header("String()->replace_all, redacting a 16 MB log");
+    bench_replace_all(16 << 20, 10, "***", 1);
+    bench_replace_all(16 << 20, 10, "***", 0);
+    bench_replace_all(16 << 20, 10, "<redacted:api-token-value>", 1);
+    bench_replace_all(16 << 20, 10, "<redacted:api-token-value>", 0);
+
+    print_bench_footer();
+    return (0);
+}
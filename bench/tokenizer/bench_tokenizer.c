@@ -0,0 +1,192 @@
+#define BENCH_COUNT_ALLOCS
+#include <types/tokenizer.h>
+#include <types/string_view.h>
+#include "../bench_framework.h"
+
+#define CSV_SIZE    (1ULL << 30)
+#define ROW         "184467,2024-05-01T12:00:00Z,alice@example.com,42.50,,EUR,ok\n"
+#define FIELDS      7
+
+// Builds a CSV_SIZE text made of ROW
+static string *make_csv(void)
+{
+    string  *csv;
+
+    csv = String()->new("");
+    String()->reserve(csv, CSV_SIZE + sizeof(ROW));
+    while (String()->len(csv) < CSV_SIZE)
+        String()->append(csv, VAL_PCHAR(ROW));
+    return (csv);
+}
+
+// Prints the throughput and checks every field was seen
+static void report(const char *label, double seconds, string *csv, ui64 fields,
+    unsigned long long allocs)
+{
+    print_bench_throughput(label, seconds, (double)String()->len(csv));
+    print_bench_value("  allocations", (double)(g_bench_allocs - allocs), "");
+    if (fields != String()->len(csv) / (sizeof(ROW) - 1) * FIELDS)
+        printf(RED "  wrong field count: %llu\n" RESET, fields);
+    BENCH_SINK(fields);
+}
+
+// ============================================================================
+// Rows, then fields
+// ============================================================================
+
+// libc baseline: memchr for every field and every row
+static void bench_memchr(string *csv)
+{
+    string_view         all;
+    const char          *row;
+    const char          *row_end;
+    const char          *field;
+    const char          *comma;
+    ui64                fields;
+    unsigned long long  allocs;
+    double              start;
+
+    all = String()->view(csv);
+    fields = 0;
+    allocs = g_bench_allocs;
+    start = bench_now();
+    for (row = all.ptr; row < all.ptr + all.len; row = row_end + 1)
+    {
+        row_end = memchr(row, '\n', (size_t)(all.ptr + all.len - row));
+        if (!row_end)
+            row_end = all.ptr + all.len;
+        for (field = row; ; field = comma + 1)
+        {
+            comma = memchr(field, ',', (size_t)(row_end - field));
+            BENCH_SINK(comma ? comma - field : row_end - field);
+            fields++;
+            if (!comma)
+                break ;
+        }
+    }
+    report("memchr per field", bench_now() - start, csv, fields, allocs);
+}
+
+static void bench_view_split(string *csv)
+{
+    string_view         rest;
+    string_view         row;
+    string_view         field;
+    ui64                fields;
+    unsigned long long  allocs;
+    double              start;
+
+    rest = String()->view(csv);
+    fields = 0;
+    allocs = g_bench_allocs;
+    start = bench_now();
+    while (View()->split(&rest, VAL_CHAR('\n'), &row))
+    {
+        // The text ends with '\n': skip the empty last row
+        if (!row.len)
+            continue ;
+        while (View()->split(&row, VAL_CHAR(','), &field))
+        {
+            BENCH_SINK(field.len);
+            fields++;
+        }
+    }
+    report("View()->split", bench_now() - start, csv, fields, allocs);
+}
+
+static void bench_tokenizer_rows(string *csv)
+{
+    tokenizer           rows;
+    tokenizer           cols;
+    string_view         row;
+    string_view         field;
+    ui64                fields;
+    unsigned long long  allocs;
+    double              start;
+
+    fields = 0;
+    allocs = g_bench_allocs;
+    start = bench_now();
+    rows = Tokenizer()->new(VAL_STR(csv), VAL_CHAR('\n'));
+    while (Tokenizer()->next(&rows, &row))
+    {
+        if (!row.len)
+            continue ;
+        cols = Tokenizer()->new(VAL_VIEW(row), VAL_CHAR(','));
+        while (Tokenizer()->next(&cols, &field))
+        {
+            BENCH_SINK(field.len);
+            fields++;
+        }
+    }
+    report("Tokenizer()->next rows then fields", bench_now() - start, csv,
+        fields, allocs);
+}
+
+// ============================================================================
+// Every field in one pass
+// ============================================================================
+
+static void bench_tokenizer_any_of(string *csv)
+{
+    tokenizer           tok;
+    ui64                offset;
+    ui64                len;
+    ui64                fields;
+    unsigned long long  allocs;
+    double              start;
+
+    fields = 0;
+    allocs = g_bench_allocs;
+    start = bench_now();
+    tok = Tokenizer()->any_of(VAL_STR(csv), VAL_PCHAR(",\n"));
+    while (Tokenizer()->next_span(&tok, &offset, &len))
+    {
+        BENCH_SINK(len);
+        fields++;
+    }
+    // The empty token after the last '\n' is not a field
+    report("Tokenizer()->any_of(\",\\n\") next_span", bench_now() - start, csv,
+        fields - 1, allocs);
+}
+
+static void bench_tokenizer_sequence(string *csv)
+{
+    tokenizer           tok;
+    string_view         token;
+    ui64                tokens;
+    double              start;
+
+    tokens = 0;
+    start = bench_now();
+    tok = Tokenizer()->new(VAL_STR(csv), VAL_PCHAR("Z,alice"));
+    while (Tokenizer()->next(&tok, &token))
+        tokens++;
+    print_bench_throughput("Tokenizer()->new multi-byte separator",
+        bench_now() - start, (double)String()->len(csv));
+    BENCH_SINK(tokens);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    string  *csv;
+
+    csv = make_csv();
+
+    print_bench_header("Splitting 1 GB of CSV into rows and fields");
+    bench_memchr(csv);
+    bench_view_split(csv);
+    bench_tokenizer_rows(csv);
+
+    print_bench_header("Splitting 1 GB of CSV in one pass");
+    bench_tokenizer_any_of(csv);
+    bench_tokenizer_sequence(csv);
+
+    String()->del(&csv);
+    print_bench_footer();
+    return (0);
+}
@@ -0,0 +1,179 @@
+#include <types/utils.h>
+#include "../bench_framework.h"
+
+// Every measurement moves about this many bytes in total, split in calls of
+// the size under test.
+#define BENCH_TOTAL_BYTES (256ULL << 20)
+
+static const ui64   g_sizes[] = {16, 64, 256, 4096, 65536, 1 << 20};
+
+// ============================================================================
+// memorycopy vs memcpy / memmove
+// ============================================================================
+
+static void bench_copy(unsigned char *dst, unsigned char *src, ui64 size)
+{
+    double  start;
+    double  elapsed;
+    ui64    rounds;
+    ui64    i;
+    char    label[64];
+
+    rounds = BENCH_TOTAL_BYTES / size;
+    start = bench_now();
+    for (i = 0; i < rounds; i++)
+    {
+        memorycopy(dst, src, size);
+        BENCH_SINK(dst[i & (size - 1)]);
+    }
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "memorycopy %7llu B", size);
+    print_bench_throughput(label, elapsed, (double)(rounds * size));
+    start = bench_now();
+    for (i = 0; i < rounds; i++)
+    {
+        memcpy(dst, src, size);
+        BENCH_SINK(dst[i & (size - 1)]);
+    }
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "libc memcpy %7llu B", size);
+    print_bench_throughput(label, elapsed, (double)(rounds * size));
+}
+
+static void bench_copy_overlap(unsigned char *buf, ui64 size)
+{
+    double  start;
+    double  elapsed;
+    ui64    rounds;
+    ui64    i;
+    char    label[64];
+
+    rounds = BENCH_TOTAL_BYTES / size;
+    start = bench_now();
+    for (i = 0; i < rounds; i++)
+    {
+        memorycopy(buf + 1 + (i & 1), buf + 2 - (i & 1), size);
+        BENCH_SINK(buf[i & (size - 1)]);
+    }
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "memorycopy overlap %7llu B", size);
+    print_bench_throughput(label, elapsed, (double)(rounds * size));
+    start = bench_now();
+    for (i = 0; i < rounds; i++)
+    {
+        memmove(buf + 1 + (i & 1), buf + 2 - (i & 1), size);
+        BENCH_SINK(buf[i & (size - 1)]);
+    }
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "libc memmove overlap %7llu B", size);
+    print_bench_throughput(label, elapsed, (double)(rounds * size));
+}
+
+// ============================================================================
+// memoryset vs memset
+// ============================================================================
+
+static void bench_set(unsigned char *dst, ui64 size)
+{
+    double  start;
+    double  elapsed;
+    ui64    rounds;
+    ui64    i;
+    char    label[64];
+
+    rounds = BENCH_TOTAL_BYTES / size;
+    start = bench_now();
+    for (i = 0; i < rounds; i++)
+    {
+        memoryset(dst, (int)i, size);
+        BENCH_SINK(dst[i & (size - 1)]);
+    }
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "memoryset %7llu B", size);
+    print_bench_throughput(label, elapsed, (double)(rounds * size));
+    start = bench_now();
+    for (i = 0; i < rounds; i++)
+    {
+        memset(dst, (int)i, size);
+        BENCH_SINK(dst[i & (size - 1)]);
+    }
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "libc memset %7llu B", size);
+    print_bench_throughput(label, elapsed, (double)(rounds * size));
+}
+
+// ============================================================================
+// stringlen vs strlen
+// ============================================================================
+
+static void bench_len(char *buf, ui64 size)
+{
+    double  start;
+    double  elapsed;
+    ui64    rounds;
+    ui64    i;
+    char    label[64];
+
+    memset(buf, 'a', size - 1);
+    buf[size - 1] = '\0';
+    rounds = BENCH_TOTAL_BYTES / size;
+    start = bench_now();
+    for (i = 0; i < rounds; i++)
+    {
+        BENCH_SINK(stringlen(buf));
+        __asm__ volatile ("" : : "r"(buf) : "memory");
+    }
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "stringlen %7llu B", size);
+    print_bench_throughput(label, elapsed, (double)(rounds * size));
+    start = bench_now();
+    for (i = 0; i < rounds; i++)
+    {
+        BENCH_SINK(strlen(buf));
+        __asm__ volatile ("" : : "r"(buf) : "memory");
+    }
+    elapsed = bench_now() - start;
+    snprintf(label, sizeof(label), "libc strlen %7llu B", size);
+    print_bench_throughput(label, elapsed, (double)(rounds * size));
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    unsigned char   *src;
+    unsigned char   *dst;
+    ui64            max;
+    ui64            i;
+
+    max = g_sizes[sizeof(g_sizes) / sizeof(*g_sizes) - 1];
+    src = malloc(max + 64);
+    dst = malloc(max + 64);
+    if (!src || !dst)
+        return (1);
+    memset(src, 'x', max + 64);
+    memset(dst, 'y', max + 64);
+    printf("  dispatch: %s\n", cpu_supports(CPU_AVX2) ? "AVX2"
+        : cpu_supports(CPU_SSE2) ? "SSE2" : "word-at-a-time");
+
+    print_bench_header("memorycopy vs libc");
+    for (i = 0; i < sizeof(g_sizes) / sizeof(*g_sizes); i++)
+        bench_copy(dst, src, g_sizes[i]);
+    for (i = 0; i < sizeof(g_sizes) / sizeof(*g_sizes); i++)
+        bench_copy_overlap(src, g_sizes[i]);
+
+    print_bench_header("memoryset vs libc");
+    for (i = 0; i < sizeof(g_sizes) / sizeof(*g_sizes); i++)
+        bench_set(dst, g_sizes[i]);
+
+    print_bench_header("stringlen vs libc");
+    for (i = 0; i < sizeof(g_sizes) / sizeof(*g_sizes); i++)
+        bench_len((char *)dst, g_sizes[i]);
+
+    free(src);
+    free(dst);
+    print_bench_footer();
+    return (0);
+}
@@ -0,0 +1,105 @@
+#define BENCH_COUNT_SYSCALLS
+#include <types/writer.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include "../bench_framework.h"
+
+#define LINES   1000000
+#define BATCH   64
+
+// ============================================================================
+// Emitting log lines
+// ============================================================================
+
+// Reports the time per line and how many syscalls a million lines took
+static void report(const char *label, double start, unsigned long long syscalls)
+{
+    print_bench_ops(label, bench_now() - start, LINES);
+    print_bench_value("  syscalls per million lines",
+        (double)(g_bench_syscalls - syscalls) * 1e6 / LINES, "");
+}
+
+// Each line is built in a string and written on its own
+static void bench_write_per_line(int fd)
+{
+    string              *line;
+    double              start;
+    unsigned long long  syscalls;
+    ui64                i;
+
+    syscalls = g_bench_syscalls;
+    start = bench_now();
+    for (i = 0; i < LINES; i++)
+    {
+        line = String()->new("");
+        APPEND_MANY(line, VAL_PCHAR("level=info request="), VAL_ULLONG(i),
+            VAL_PCHAR(" status=200\n"));
+        String()->write(fd, line);
+        String()->del(&line);
+    }
+    report("String()->write, one per line", start, syscalls);
+}
+
+// Lines are kept as strings and sent BATCH at a time through one writev
+static void bench_write_many(int fd)
+{
+    string              *lines[BATCH];
+    double              start;
+    unsigned long long  syscalls;
+    ui64                i;
+    ui64                j;
+
+    syscalls = g_bench_syscalls;
+    start = bench_now();
+    for (i = 0; i < LINES; i += BATCH)
+    {
+        for (j = 0; j < BATCH; j++)
+        {
+            lines[j] = String()->new("");
+            APPEND_MANY(lines[j], VAL_PCHAR("level=info request="), VAL_ULLONG(i + j),
+                VAL_PCHAR(" status=200\n"));
+        }
+        String()->write_many(fd, lines, BATCH);
+        for (j = 0; j < BATCH; j++)
+            String()->del(&lines[j]);
+    }
+    report("String()->write_many, 64 per writev", start, syscalls);
+}
+
+// The pieces go straight into the writer buffer, no string is built
+static void bench_writer(int fd)
+{
+    writer              *w;
+    double              start;
+    unsigned long long  syscalls;
+    ui64                i;
+
+    w = Writer()->new(fd);
+    syscalls = g_bench_syscalls;
+    start = bench_now();
+    for (i = 0; i < LINES; i++)
+        Writer()->write_many(w, (const typed_value[]){VAL_PCHAR("level=info request="),
+            VAL_ULLONG(i), VAL_PCHAR(" status=200\n")}, 3);
+    Writer()->flush(w);
+    report("Writer(), 64 KB buffer", start, syscalls);
+    Writer()->del(&w);
+}
+
+// ============================================================================
+// Main Bench Runner
+// ============================================================================
+
+int main(void)
+{
+    int fd;
+
+    fd = open("/dev/null", O_WRONLY);
+    print_bench_header("1M log lines to /dev/null");
+    bench_write_per_line(fd);
+    bench_write_many(fd);
+    bench_writer(fd);
+    close(fd);
+
+    print_bench_footer();
+    return (0);
+}
@@ -0,0 +1,20 @@
+#ifndef TYPES_ALLOCATOR_H
+# define TYPES_ALLOCATOR_H
+
+# include <types/utils.h>
+
+// Memory backend a string (or any other type) can be created from. `ctx` is
+// handed back to every callback. A NULL `free` means the memory is released in
+// bulk by the owner of the allocator (i.e: an arena), so freeing single blocks
+// is skipped entirely.
+typedef struct allocator
+{
+    void    *(*alloc)(void *ctx, ui64 size);
+    void    *(*resize)(void *ctx, void *ptr, ui64 old_size, ui64 new_size);
+    void    (*free)(void *ctx, void *ptr, ui64 size);
+    void    *ctx;
+}   allocator;
+
+const allocator *heap_allocator(void);
+
+#endif
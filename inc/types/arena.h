@@ -0,0 +1,26 @@
+#ifndef TYPES_ARENA_H
+# define TYPES_ARENA_H
+
+# include <types/allocator.h>
+
+// Default size of the blocks an arena carves its allocations from
+# define ARENA_BLOCK_SIZE 65536
+// Every allocation is aligned to this many bytes
+# define ARENA_ALIGNMENT 16
+
+typedef struct arena arena;
+
+typedef struct arena_methods
+{
+    arena           *(*new)(ui64);
+    void            (*del)(arena **);
+    void            (*reset)(arena *);
+    void            *(*alloc)(arena *, ui64);
+    ui64            (*used)(const arena *);
+    const allocator *(*allocator)(arena *);
+}   arena_funcs;
+
+
+const arena_funcs *Arena(void);
+
+#endif
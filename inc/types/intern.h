@@ -0,0 +1,30 @@
+#ifndef TYPES_INTERN_H
+# define TYPES_INTERN_H
+
+# include <types/string.h>
+
+// Independent locks of a pool, threads interning different contents rarely
+// wait on each other
+# define INTERN_SHARDS 16
+
+// An intern pool keeps a single copy of every distinct content it is given
+// and always hands that same copy back, so interned strings are equal exactly
+// when their pointers are. The copies are owned by the pool and must not be
+// changed, they live until the pool is deleted. Every method is thread-safe.
+typedef struct intern_pool intern_pool;
+
+typedef struct intern_methods
+{
+    intern_pool     *(*new)(void);
+    void            (*del)(intern_pool **);
+    ui64            (*len)(intern_pool *);
+    const string    *(*intern)(intern_pool *, typed_value);
+    ui64            (*intern_many)(intern_pool *, const typed_value *, ui64,
+                        const string **);
+    const string    *(*find)(intern_pool *, typed_value);
+}   intern_funcs;
+
+
+const intern_funcs *Intern(void);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef TYPES_MAP_H
+# define TYPES_MAP_H
+
+# include <types/string.h>
+
+// Slots are probed a group of this many control bytes at a time
+# define MAP_GROUP_WIDTH 16
+
+// Hash map from string keys to pointers. Keys are copied into the map (with
+// their hash cached), values are stored as given and never freed by the map.
+// Keys can be given as any typed value: strings, char pointers, views or
+// numbers, which stand for the same bytes as when they are appended.
+typedef struct map map;
+
+typedef struct map_methods
+{
+    map     *(*new)(void);
+    map     *(*new_in)(const allocator *);
+    void    (*del)(map **);
+    ui64    (*len)(const map *);
+    int     (*reserve)(map *, ui64);
+    int     (*set)(map *, typed_value, void *);
+    void    *(*get)(const map *, typed_value);
+    int     (*has)(const map *, typed_value);
+    int     (*remove)(map *, typed_value);
+    void    (*clear)(map *);
+    int     (*next)(const map *, ui64 *, const string **, void **);
+}   map_funcs;
+
+
+const map_funcs *Map(void);
+
+#endif
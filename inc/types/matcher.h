@@ -0,0 +1,41 @@
+#ifndef TYPES_MATCHER_H
+# define TYPES_MATCHER_H
+
+# include <types/string.h>
+
+// A matcher looks for many needles at once: it is compiled once from a list of
+// typed values (Aho-Corasick) and then finds every needle in a text with a
+// single pass, one table lookup per byte whatever the number of needles. The
+// needles are copied, empty ones never match. Matches may overlap, and are
+// reported in the order they end: among matches ending at the same byte, the
+// longest comes first, then needles with the same bytes by increasing id.
+typedef struct matcher matcher;
+
+// A needle found in a text: `id` is its index in the list the matcher was
+// built from, `start` the offset of its first byte in the text
+typedef struct match
+{
+    ui64    start;
+    ui64    len;
+    ui64    id;
+}   match;
+
+typedef struct matcher_methods
+{
+    matcher *(*new)(const typed_value *, ui64);
+    matcher *(*new_pchars)(const char *const *, ui64);
+    void    (*del)(matcher **);
+    ui64    (*len)(const matcher *);
+    int     (*find)(const matcher *, typed_value, ui64, match *);
+    ui64    (*find_all)(const matcher *, typed_value, match *, ui64);
+    ui64    (*count)(const matcher *, typed_value, ui64 *);
+}   matcher_funcs;
+
+
+// Compiles a matcher from its needles (i.e: MATCHER_OF(VAL_PCHAR("error"), VAL_PCHAR("fatal")))
+# define MATCHER_OF(...) Matcher()->new((const typed_value[]){__VA_ARGS__}, \
+    sizeof((typed_value[]){__VA_ARGS__}) / sizeof(typed_value))
+
+const matcher_funcs *Matcher(void);
+
+#endif
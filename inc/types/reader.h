@@ -0,0 +1,31 @@
+#ifndef TYPES_READER_H
+# define TYPES_READER_H
+
+# include <types/string.h>
+
+// Bytes a reader asks for with each read
+# define READER_BUFFER_SIZE (64 * 1024)
+
+// A reader splits what comes out of a file descriptor into lines (or records
+// ending with any delimiter) with one read per buffer, not per line. Each line
+// replaces the content of a string given by the caller, which keeps its buffer
+// from one line to the next: reading a whole file allocates nothing once that
+// string has grown to the longest line. The delimiter is not part of the line,
+// the last line may not end with one. Interrupted reads are retried; the first
+// other error is kept (see `error`) and ends the lines.
+typedef struct reader reader;
+
+typedef struct reader_methods
+{
+    reader  *(*new)(int);
+    reader  *(*new_sized)(int, ui64);
+    void    (*del)(reader **);
+    int     (*line)(reader *, string *);
+    int     (*until)(reader *, string *, char);
+    int     (*error)(const reader *);
+}   reader_funcs;
+
+
+const reader_funcs *Reader(void);
+
+#endif
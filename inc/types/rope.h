@@ -0,0 +1,38 @@
+#ifndef TYPES_ROPE_H
+# define TYPES_ROPE_H
+
+# include <types/string.h>
+
+// Capacity of the chunks appends are written into: an eighth of the rope, so
+// large documents use fewer and larger chunks, within these bounds
+# define ROPE_CHUNK_SIZE 4096
+# define ROPE_CHUNK_MAX (1 << 20)
+
+// A rope holds a very large text as a balanced tree of chunks instead of one
+// contiguous buffer, so it never reallocates nor moves what it already holds.
+// Appending fills the last chunk in place, concat, insert and substring are
+// O(log n) and share chunks instead of copying them (shared chunks are
+// reference counted and never written). The text is read chunk by chunk with
+// `next` (i.e: to feed writev) and only made contiguous by `flatten`.
+typedef struct rope rope;
+
+typedef struct rope_methods
+{
+    rope    *(*new)(void);
+    void    (*del)(rope **);
+    ui64    (*len)(const rope *);
+    void    (*append)(rope *, typed_value);
+    void    (*concat)(rope *, const rope *);
+    void    (*insert)(rope *, ui64, typed_value);
+    rope    *(*substring)(const rope *, ui64, ui64);
+    int     (*next)(const rope *, ui64 *, string_view *);
+    i64     (*index_of)(const rope *, typed_value);
+    i64     (*index_of_from)(const rope *, typed_value, i64);
+    string  *(*flatten)(const rope *);
+    int     (*write)(int, const rope *);
+}   rope_funcs;
+
+
+const rope_funcs *Rope(void);
+
+#endif
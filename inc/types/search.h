@@ -0,0 +1,27 @@
+#ifndef TYPES_SEARCH_H
+# define TYPES_SEARCH_H
+
+# include <types/string.h>
+
+// Needles up to this length are matched with the SIMD first/last byte filter
+# define SEARCH_FILTER_MAX 32
+// Needles at least this long are matched with Two-Way (linear worst case)
+# define SEARCH_TWOWAY_MIN 256
+
+typedef struct pattern_methods
+{
+    pattern *(*new)(typed_value);
+    void    (*del)(pattern **);
+    ui64    (*len)(const pattern *);
+    i64     (*find)(const pattern *, const char *, ui64, ui64);
+    i64     (*rfind)(const pattern *, const char *, ui64, ui64);
+}   pattern_funcs;
+
+
+i64             search_forward(const char *hay, ui64 hay_len,
+                    const char *needle, ui64 needle_len, ui64 from);
+i64             search_backward(const char *hay, ui64 hay_len,
+                    const char *needle, ui64 needle_len, ui64 from);
+const pattern_funcs *Pattern(void);
+
+#endif
@@ -2,48 +2,117 @@
 # define TYPES_STRING_H
 
 # include <types/utils.h>
+# include <types/allocator.h>
 
 typedef struct string string;
+typedef struct pattern pattern;
+
+// Non-owning reference to `len` bytes, see <types/string_view.h>
+typedef struct string_view {
+    const char  *ptr;
+    ui64        len;
+}   string_view;
 
 typedef enum {
     TYPE_STRING,
     TYPE_PCHAR,
     TYPE_CHAR,
     TYPE_INT,
-    TYPE_LLONG
+    TYPE_LLONG,
+    TYPE_PATTERN,
+    TYPE_UINT,
+    TYPE_ULLONG,
+    TYPE_HEX,
+    TYPE_FIXED,
+    TYPE_VIEW,
+    TYPE_DOUBLE,
+    TYPE_FLOAT
 }   append_type;
 
-// Tagged union - bundles type and value together (type-safe)
+// Tagged union - bundles type and value together (type-safe). It is kept at 16
+// bytes so it is passed in two registers: wider payloads live behind a pointer
+// (views) or in the spare word next to the tag (fixed widths, precisions).
 typedef struct {
     append_type type;
+    int         width;
     union {
-        int         as_int;
-        char        as_char;
-        long long   as_llong;
-        const char  *as_pchar;
-        string      *as_str;
+        int                 as_int;
+        char                as_char;
+        long long           as_llong;
+        unsigned int        as_uint;
+        unsigned long long  as_ullong;
+        double              as_double;
+        float               as_float;
+        const char          *as_pchar;
+        string              *as_str;
+        const string_view   *as_view;
+        const pattern       *as_pattern;
     };
 }   typed_value;
 
 // Helper macros - user can ONLY create valid type+value combinations
-# define VAL_INT(n)    ((typed_value){TYPE_INT,    {.as_int = (n)}})
-# define VAL_CHAR(c)   ((typed_value){TYPE_CHAR,   {.as_char = (c)}})
-# define VAL_LLONG(l)  ((typed_value){TYPE_LLONG,  {.as_llong = (l)}})
-# define VAL_PCHAR(s)  ((typed_value){TYPE_PCHAR,  {.as_pchar = (s)}})
-# define VAL_STR(s)    ((typed_value){TYPE_STRING, {.as_str = (s)}})
+# define VAL_INT(n)    ((typed_value){TYPE_INT,    0, {.as_int = (n)}})
+# define VAL_CHAR(c)   ((typed_value){TYPE_CHAR,   0, {.as_char = (c)}})
+# define VAL_LLONG(l)  ((typed_value){TYPE_LLONG,  0, {.as_llong = (l)}})
+# define VAL_PCHAR(s)  ((typed_value){TYPE_PCHAR,  0, {.as_pchar = (s)}})
+# define VAL_STR(s)    ((typed_value){TYPE_STRING, 0, {.as_str = (s)}})
+# define VAL_PATTERN(p) ((typed_value){TYPE_PATTERN, 0, {.as_pattern = (p)}})
+# define VAL_UINT(n)   ((typed_value){TYPE_UINT,   0, {.as_uint = (n)}})
+# define VAL_ULLONG(n) ((typed_value){TYPE_ULLONG, 0, {.as_ullong = (n)}})
+// Lowercase hexadecimal, without prefix
+# define VAL_HEX(n)    ((typed_value){TYPE_HEX,    0, {.as_ullong = (n)}})
+// Decimal, zero padded to at least w characters (i.e: VAL_FIXED(7, 3)-> "007")
+# define VAL_FIXED(n, w) ((typed_value){TYPE_FIXED, (w), {.as_llong = (n)}})
+// Shortest decimal reading back as the same value (i.e: VAL_DOUBLE(0.1)-> "0.1",
+// VAL_DOUBLE(1e22)-> "1e+22"), without locale nor allocation
+# define VAL_DOUBLE(d) ((typed_value){TYPE_DOUBLE, -1, {.as_double = (d)}})
+# define VAL_FLOAT(f)  ((typed_value){TYPE_FLOAT,  -1, {.as_float = (f)}})
+// p digits after the point, correctly rounded (i.e: VAL_DOUBLE_FIXED(2.5, 2)-> "2.50")
+# define VAL_DOUBLE_FIXED(d, p) ((typed_value){TYPE_DOUBLE, (p), {.as_double = (d)}})
+# define VAL_FLOAT_FIXED(f, p)  ((typed_value){TYPE_FLOAT,  (p), {.as_float = (f)}})
+// The view is copied into a compound literal, which lives until the end of the
+// enclosing block: build the value where it is used
+# define VAL_VIEW(v)   ((typed_value){TYPE_VIEW,   0, \
+    {.as_view = (const string_view[]){(v)}}})
 
 typedef struct string_metohods 
 {
     string  *(*new)(char *);
+    string  *(*new_in)(const allocator *, char *);
+    string  *(*read_fd)(int);
+    string  *(*read_file)(const char *);
+    string  *(*map_file)(const char *);
     ui64    (*len)(const string *);
-    void    (*write)(int, const string *);
+    ui64    (*capacity)(const string *);
+    int     (*reserve)(string *, ui64);
+    void    (*shrink_to_fit)(string *);
+    int     (*write)(int, const string *);
+    int     (*write_many)(int, string *const *, ui64);
     void    (*del)(string **);
     void    (*append)(string *, typed_value);
+    void    (*append_many)(string *, const typed_value *, ui64);
     string  *(*clone)(string *);
+    string  *(*share)(string *);
+    string_view (*view)(const string *);
+    int     (*equals)(const string *, typed_value);
+    int     (*equals_ignore_case)(const string *, typed_value);
+    int     (*compare)(const string *, typed_value);
+    ui64    (*hash)(const string *);
     void    (*to_lower)(string *);
     void    (*to_upper)(string *);
-    int     (*index_of)(const string *, typed_value);
-    int     (*last_index_of)(const string *, typed_value);
+    void    (*to_lower_into)(const string *, string *);
+    void    (*to_upper_into)(const string *, string *);
+    i64     (*index_of)(const string *, typed_value);
+    i64     (*last_index_of)(const string *, typed_value);
+    i64     (*index_of_from)(const string *, typed_value, i64);
+    i64     (*last_index_of_from)(const string *, typed_value, i64);
+    int     (*replace)(string *, typed_value, typed_value);
+    ui64    (*replace_all)(string *, typed_value, typed_value);
+    int     (*format)(string *, const char *, ...);
+    parse_status (*to_int)(const string *, int *);
+    parse_status (*to_llong)(const string *, long long *);
+    parse_status (*to_ulong)(const string *, unsigned long *);
+    parse_status (*to_double)(const string *, double *);
     int     (*is_null)(string *);
     int     (*is_alpha)(string *);
     int     (*is_alnum)(string *);
@@ -59,8 +128,15 @@ typedef struct string_metohods
 }   str_funcs;
 
 
+// Appends every value with a single growth (i.e: APPEND_MANY(s, VAL_PCHAR("ts="), VAL_INT(42)))
+# define APPEND_MANY(str, ...) String()->append_many((str), \
+    (const typed_value[]){__VA_ARGS__}, \
+    sizeof((typed_value[]){__VA_ARGS__}) / sizeof(typed_value))
+
 string      *new_string(char *s);
+string      *new_string_in(const allocator *alloc, char *s);
 int         equals_string(const string *, const char *);
-str_funcs   *String(void);
+int         string_format(string *, const char *, ...);
+const str_funcs *String(void);
 
 #endif
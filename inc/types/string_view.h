@@ -0,0 +1,37 @@
+#ifndef TYPES_STRING_VIEW_H
+# define TYPES_STRING_VIEW_H
+
+# include <types/string.h>
+
+// A string_view borrows the bytes it points to: it never allocates nor frees,
+// and it is only valid while the referenced memory is. Views are passed by
+// value, and a NULL `ptr` stands for "no view" (i.e: a finished split).
+
+typedef struct view_methods
+{
+    string_view (*new)(const char *);
+    string_view (*from)(const char *, ui64);
+    string_view (*of)(typed_value);
+    string_view (*substr)(string_view, ui64, ui64);
+    int         (*split)(string_view *, typed_value, string_view *);
+    string_view (*trim)(string_view);
+    string_view (*trim_left)(string_view);
+    string_view (*trim_right)(string_view);
+    int         (*starts_with)(string_view, typed_value);
+    int         (*ends_with)(string_view, typed_value);
+    i64         (*index_of)(string_view, typed_value);
+    i64         (*last_index_of)(string_view, typed_value);
+    int         (*equals)(string_view, typed_value);
+    int         (*compare)(string_view, string_view);
+    string      *(*to_string)(string_view);
+    parse_status (*to_int)(string_view, int *);
+    parse_status (*to_llong)(string_view, long long *);
+    parse_status (*to_ulong)(string_view, unsigned long *);
+    parse_status (*to_double)(string_view, double *);
+    int         (*write)(int, string_view);
+}   view_funcs;
+
+
+const view_funcs *View(void);
+
+#endif
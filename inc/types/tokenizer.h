@@ -0,0 +1,49 @@
+#ifndef TYPES_TOKENIZER_H
+# define TYPES_TOKENIZER_H
+
+# include <types/string.h>
+
+// Bytes whose separators are found with a single scan
+# define TOKENIZER_BLOCK 64
+
+// A tokenizer walks a text token by token without allocating anything: it
+// lives on the stack and every token is a view of (or an offset and a length
+// into) the text, which must outlive it, as must a string or pattern used as
+// separator. Tokens end at a byte, at any byte of a set, or at a multi-byte
+// separator. As with View()->split, consecutive separators yield empty tokens
+// and a text ending with a separator yields a last empty token. An empty or
+// invalid separator never matches: the whole text is the only token.
+// Byte and set separators are searched TOKENIZER_BLOCK bytes at a time with
+// SIMD: one scan gives the position of every separator in the block as a bit
+// mask, from which the next tokens are read without touching the bytes again.
+typedef struct tokenizer
+{
+    // Internal state, only meant to be used through Tokenizer()
+    const char      *ptr;
+    ui64            len;
+    ui64            pos;
+    ui64            base;
+    ui64            mask;
+    int             kind;
+    int             done;
+    const char      *sep;
+    ui64            sep_len;
+    const pattern   *pat;
+    unsigned char   set_low[16];
+    unsigned char   set_high[16];
+    unsigned char   byte;
+    char            digits[NUMBER_MAX_WIDTH];
+}   tokenizer;
+
+typedef struct tokenizer_methods
+{
+    tokenizer   (*new)(typed_value, typed_value);
+    tokenizer   (*any_of)(typed_value, typed_value);
+    int         (*next)(tokenizer *, string_view *);
+    int         (*next_span)(tokenizer *, ui64 *, ui64 *);
+}   tokenizer_funcs;
+
+
+const tokenizer_funcs *Tokenizer(void);
+
+#endif
@@ -5,11 +5,71 @@
 # include <unistd.h>
 
 typedef unsigned long long ui64;
+typedef long long i64;
+
+// Most characters an integer formatter writes, fixed widths are clamped to it
+# define NUMBER_MAX_WIDTH 64
+// Most digits a double is written with after the point
+# define DOUBLE_MAX_PRECISION 40
+
+// What a parser made of its input: on PARSE_OVERFLOW the output holds the
+// nearest value it can, on the other errors it is left untouched
+typedef enum {
+    PARSE_OK,
+    PARSE_EMPTY,
+    PARSE_INVALID,
+    PARSE_OVERFLOW
+}   parse_status;
+
+typedef enum {
+    CPU_SSE2 = 1 << 0,
+    CPU_AVX2 = 1 << 1
+}   cpu_feature;
+
+// Every byte belongs to exactly one primitive class, the others are unions
+typedef enum {
+    CHAR_LOWER = 1 << 0,
+    CHAR_UPPER = 1 << 1,
+    CHAR_DIGIT = 1 << 2,
+    CHAR_BLANK = 1 << 3,
+    CHAR_SPACE = 1 << 4,
+    CHAR_PUNCT = 1 << 5,
+    CHAR_CNTRL = 1 << 6,
+    CHAR_HIGH = 1 << 7,
+    CHAR_ALPHA = CHAR_LOWER | CHAR_UPPER,
+    CHAR_ALNUM = CHAR_ALPHA | CHAR_DIGIT,
+    CHAR_WHITESPACE = CHAR_BLANK | CHAR_SPACE,
+    CHAR_PRINT = CHAR_ALNUM | CHAR_BLANK | CHAR_PUNCT,
+    CHAR_ASCII = 0x7f,
+    CHAR_ANY = 0xff
+}   char_class;
 
 void  memorycopy(void *dst, void *src, ui64 bytes);
 ui64  stringlen(char *s);
 void  memoryset(void *ptr, int c, ui64 bytes);
+void  *memorychr(const void *ptr, int c, ui64 bytes);
+void  *memoryrchr(const void *ptr, int c, ui64 bytes);
+int   memorycompare(const void *a, const void *b, ui64 bytes);
 char  *int_to_ascii(int n);
 char  *llong_to_ascii(long long n);
+ui64  count_digits(unsigned long long n);
+ui64  format_ullong(char *dst, unsigned long long n);
+ui64  format_llong(char *dst, long long n);
+ui64  format_hex(char *dst, unsigned long long n);
+ui64  format_fixed(char *dst, long long n, int width);
+ui64  format_double(char *dst, double x, int precision);
+ui64  format_float(char *dst, float x, int precision);
+parse_status  parse_int(const char *ptr, ui64 len, int *out);
+parse_status  parse_llong(const char *ptr, ui64 len, long long *out);
+parse_status  parse_ulong(const char *ptr, ui64 len, unsigned long *out);
+parse_status  parse_double(const char *ptr, ui64 len, double *out);
+int   cpu_supports(cpu_feature feature);
+int   char_class_of(int c);
+ui64  memoryspan(const void *ptr, ui64 bytes, int classes);
+ui64  memorycspan(const void *ptr, ui64 bytes, int classes);
+void  memorylower(void *dst, const void *src, ui64 bytes);
+void  memoryupper(void *dst, const void *src, ui64 bytes);
+int   memorycasecompare(const void *a, const void *b, ui64 bytes);
+ui64  memoryhash(const void *ptr, ui64 bytes);
 
 #endif
@@ -0,0 +1,31 @@
+#ifndef TYPES_WRITER_H
+# define TYPES_WRITER_H
+
+# include <types/string.h>
+
+// Bytes a writer gathers before they are written
+# define WRITER_BUFFER_SIZE (64 * 1024)
+
+// A writer coalesces many small writes to a file descriptor into a single
+// buffer, which is written with one syscall when it is full or flushed. Values
+// at least as large as the buffer skip it: they go out in the same writev as
+// what was buffered. Short writes and EINTR are resumed; the first other error
+// is kept (see `error`) and every later write fails. Deleting a writer flushes
+// it, flush before to know whether that worked.
+typedef struct writer writer;
+
+typedef struct writer_methods
+{
+    writer  *(*new)(int);
+    writer  *(*new_sized)(int, ui64);
+    void    (*del)(writer **);
+    int     (*write)(writer *, typed_value);
+    int     (*write_many)(writer *, const typed_value *, ui64);
+    int     (*flush)(writer *);
+    int     (*error)(const writer *);
+}   writer_funcs;
+
+
+const writer_funcs *Writer(void);
+
+#endif
@@ -0,0 +1,37 @@
+#include <types/allocator.h>
+
+static void *heap_alloc(void *ctx, ui64 size)
+{
+  (void)ctx;
+  return (malloc(size));
+}
+
+static void *heap_resize(void *ctx, void *ptr, ui64 old_size, ui64 new_size)
+{
+  (void)ctx;
+  (void)old_size;
+  return (realloc(ptr, new_size));
+}
+
+static void heap_free(void *ctx, void *ptr, ui64 size)
+{
+  (void)ctx;
+  (void)size;
+  free(ptr);
+}
+
+/// @brief Returns the allocator backed by malloc/realloc/free. It is used by
+/// every type created without an explicit allocator.
+/// @param  
+/// @return allocator
+const allocator *heap_allocator(void)
+{
+  static const allocator  heap = {
+    .alloc = &heap_alloc,
+    .resize = &heap_resize,
+    .free = &heap_free,
+    .ctx = NULL
+  };
+
+  return (&heap);
+}
@@ -0,0 +1,258 @@
+#include <types/arena.h>
+
+// Allocations bigger than this share of the block size get a block of their own,
+// so a single large string doesn't waste the rest of the current block.
+# define ARENA_LARGE_DIVISOR 4
+
+typedef struct arena_block
+{
+  struct arena_block  *next;
+  ui64                size;
+  ui64                used;
+}   arena_block;
+
+// `head` is the block allocations are bumped from. Dedicated blocks for large
+// allocations are linked after it so the head keeps serving small requests.
+struct arena {
+  allocator   alloc;
+  arena_block *head;
+  ui64        block_size;
+  ui64        used;
+  char        *last;
+};
+
+/// @brief Rounds `size` up to ARENA_ALIGNMENT.
+/// @param size 
+/// @return the aligned size, 0 on overflow
+static ui64 align_size(ui64 size)
+{
+  if (size + ARENA_ALIGNMENT - 1 < size)
+    return (0);
+  return ((size + ARENA_ALIGNMENT - 1) & ~(ui64)(ARENA_ALIGNMENT - 1));
+}
+
+/// @brief Returns the first usable byte of a block, right after its aligned header.
+/// @param block 
+/// @return pointer to the block data
+static char *block_data(arena_block *block)
+{
+  return ((char *)block + align_size(sizeof(arena_block)));
+}
+
+/// @brief Allocates a block able to hold `size` bytes.
+/// @param size 
+/// @return block or NULL on allocation failure
+static arena_block  *new_block(ui64 size)
+{
+  arena_block *block;
+  ui64        header;
+
+  header = align_size(sizeof(arena_block));
+  if (size + header < size)
+    return (NULL);
+  block = malloc(header + size);
+  if (!block)
+    return (NULL);
+  block->next = NULL;
+  block->size = size;
+  block->used = 0;
+  return (block);
+}
+
+/// @brief Hands out `size` bytes from the arena. The memory stays valid until
+/// the arena is reset or deleted, it can't be released on its own.
+/// @param a 
+/// @param size 
+/// @return pointer aligned to ARENA_ALIGNMENT or NULL on allocation failure
+void  *arena_alloc(arena *a, ui64 size)
+{
+  arena_block *block;
+  char        *ptr;
+
+  if (!a)
+    return (NULL);
+  size = align_size(size ? size : 1);
+  if (!size)
+    return (NULL);
+  if (a->head && a->head->size - a->head->used >= size)
+  {
+    ptr = block_data(a->head) + a->head->used;
+    a->head->used += size;
+    a->used += size;
+    a->last = ptr;
+    return (ptr);
+  }
+  if (size > a->block_size / ARENA_LARGE_DIVISOR)
+  {
+    block = new_block(size);
+    if (!block)
+      return (NULL);
+    block->used = size;
+    if (a->head)
+    {
+      block->next = a->head->next;
+      a->head->next = block;
+    }
+    else
+      a->head = block;
+    a->used += size;
+    return (block_data(block));
+  }
+  block = new_block(a->block_size);
+  if (!block)
+    return (NULL);
+  block->next = a->head;
+  a->head = block;
+  return (arena_alloc(a, size));
+}
+
+static void *arena_alloc_callback(void *ctx, ui64 size)
+{
+  return (arena_alloc(ctx, size));
+}
+
+/// @brief Grows or shrinks an arena allocation. The most recent allocation is
+/// resized in place while it fits in the current block; anything else is copied
+/// into a new allocation (the old bytes are reclaimed with the arena).
+/// @param ctx the arena
+/// @param ptr 
+/// @param old_size 
+/// @param new_size 
+/// @return the resized allocation or NULL on allocation failure
+static void *arena_resize(void *ctx, void *ptr, ui64 old_size, ui64 new_size)
+{
+  arena *a;
+  char  *copy;
+  ui64  offset;
+  ui64  aligned;
+
+  a = ctx;
+  if (!ptr)
+    return (arena_alloc(a, new_size));
+  aligned = align_size(new_size ? new_size : 1);
+  if (aligned && ptr == a->last && a->head)
+  {
+    offset = (ui64)((char *)ptr - block_data(a->head));
+    if (a->head->size - offset >= aligned)
+    {
+      a->used = a->used - (a->head->used - offset) + aligned;
+      a->head->used = offset + aligned;
+      return (ptr);
+    }
+  }
+  if (new_size <= old_size)
+    return (ptr);
+  copy = arena_alloc(a, new_size);
+  if (!copy)
+    return (NULL);
+  memorycopy(copy, ptr, old_size);
+  return (copy);
+}
+
+/// @brief Creates an empty arena. Blocks are only allocated on first use.
+/// @param block_size size of the blocks allocations are carved from,
+/// 0 for ARENA_BLOCK_SIZE
+/// @return arena or NULL on allocation failure
+arena *new_arena(ui64 block_size)
+{
+  arena *a;
+
+  a = malloc(sizeof(arena));
+  if (!a)
+    return (NULL);
+  a->alloc.alloc = &arena_alloc_callback;
+  a->alloc.resize = &arena_resize;
+  a->alloc.free = NULL;
+  a->alloc.ctx = a;
+  a->head = NULL;
+  a->block_size = block_size ? align_size(block_size) : ARENA_BLOCK_SIZE;
+  if (!a->block_size)
+    a->block_size = ARENA_BLOCK_SIZE;
+  a->used = 0;
+  a->last = NULL;
+  return (a);
+}
+
+/// @brief Frees every block but the current one, which is kept for reuse. Every
+/// allocation made from the arena (strings included) is invalidated at once.
+/// @param a 
+void  reset_arena(arena *a)
+{
+  arena_block *block;
+  arena_block *next;
+
+  if (!a || !a->head)
+    return ;
+  block = a->head->next;
+  while (block)
+  {
+    next = block->next;
+    free(block);
+    block = next;
+  }
+  a->head->next = NULL;
+  a->head->used = 0;
+  a->used = 0;
+  a->last = NULL;
+}
+
+/// @brief Frees the arena and every allocation made from it, then sets the
+/// pointer to NULL.
+/// @param a 
+void  dealloc_arena(arena **a)
+{
+  arena_block *block;
+  arena_block *next;
+
+  if (!a || !*a)
+    return ;
+  block = (*a)->head;
+  while (block)
+  {
+    next = block->next;
+    free(block);
+    block = next;
+  }
+  free(*a);
+  *a = NULL;
+}
+
+/// @brief Reads how many bytes were handed out since the arena was created or
+/// last reset, alignment padding included.
+/// @param a 
+/// @return unsigned long long
+ui64  get_arena_used(const arena *a)
+{
+  if (!a)
+    return (0);
+  return (a->used);
+}
+
+/// @brief Returns the allocator interface of the arena, so types such as
+/// string can be created from it. It lives as long as the arena does.
+/// @param a 
+/// @return allocator or NULL
+const allocator *get_arena_allocator(arena *a)
+{
+  if (!a)
+    return (NULL);
+  return (&a->alloc);
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the arena type.
+/// @param  
+/// @return arena_funcs
+const arena_funcs *Arena(void)
+{
+  static const arena_funcs  arena_functions = {
+    .new = &new_arena,
+    .del = &dealloc_arena,
+    .reset = &reset_arena,
+    .alloc = &arena_alloc,
+    .used = &get_arena_used,
+    .allocator = &get_arena_allocator
+  };
+
+  return (&arena_functions);
+}
@@ -0,0 +1,12 @@
+#ifndef IO_INTERNAL_H
+# define IO_INTERNAL_H
+
+# include <types/utils.h>
+# include <sys/uio.h>
+
+// Buffers handed to a single writev call (the Linux IOV_MAX)
+# define WRITE_IOV_MAX 1024
+
+int write_fully(int fd, struct iovec *iov, int count);
+
+#endif
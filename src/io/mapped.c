@@ -0,0 +1,107 @@
+#include "../string/string_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/// @brief Bytes reserved for a mapped file of `len` bytes: a page in front
+/// holding the buffer header, then the file and its terminator rounded up to
+/// whole pages.
+static ui64 mapping_size(ui64 len, ui64 page)
+{
+  return (page + ((len + page) & ~(page - 1)));
+}
+
+/// @brief Maps `len` bytes of `fd` read-only, right after a writable header
+/// page. The byte after the file is always a zero: either the end of its last
+/// page, or the first byte of the anonymous page left after it.
+/// @param fd 
+/// @param len size of the file, not 0
+/// @return the buffer or NULL on error (errno tells which)
+static string_buffer  *map_buffer(int fd, ui64 len)
+{
+  string_buffer *buf;
+  char          *base;
+  ui64          page;
+  int           err;
+
+  page = (ui64)sysconf(_SC_PAGESIZE);
+  base = mmap(NULL, mapping_size(len, page), PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    return (NULL);
+  if (mmap(base + page, len, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0)
+    == MAP_FAILED)
+  {
+    err = errno;
+    munmap(base, mapping_size(len, page));
+    errno = err;
+    return (NULL);
+  }
+  buf = (string_buffer *)(base + page - sizeof(string_buffer));
+  buf->refs = STRING_BUFFER_MAPPED | 1;
+  return (buf);
+}
+
+/// @brief Unmaps a buffer made by map_buffer, once no string uses it anymore.
+/// @param buf 
+/// @param capacity length of the mapped file
+void  unmap_buffer(string_buffer *buf, ui64 capacity)
+{
+  ui64  page;
+
+  page = (ui64)sysconf(_SC_PAGESIZE);
+  munmap((char *)buf + sizeof(string_buffer) - page,
+    mapping_size(capacity, page));
+}
+
+/// @brief Creates a string over the file at `path` mapped in memory, instead of
+/// a copy of it: nothing is read up front, pages are loaded on first access and
+/// come from the page cache, shared with every other reader of the file. The
+/// mapping is read-only. Every method that only reads (len, view, index_of,
+/// is_*, hash, write, share...) uses it in place; the first change (append,
+/// to_lower, reserve...) moves the string into a heap copy, as for a shared
+/// buffer. Deleting the last string using the mapping unmaps it.
+/// Files that can't be mapped (empty, pipes, /proc) are read instead.
+/// @param path 
+/// @return string or NULL on error (errno tells which)
+/// @attention The file must not be truncated while mapped: reading pages past
+/// its new end raises SIGBUS.
+string  *map_file_to_string(const char *path)
+{
+  struct stat   st;
+  string_buffer *buf;
+  string        *str;
+  int           fd;
+  int           err;
+
+  if (!path)
+  {
+    errno = EINVAL;
+    return (NULL);
+  }
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return (NULL);
+  if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size <= 0)
+    str = read_fd_to_string(fd);
+  else
+  {
+    str = NULL;
+    buf = map_buffer(fd, (ui64)st.st_size);
+    if (buf)
+      str = new_string_len(heap_allocator(), "", 0);
+    if (str)
+    {
+      str->s = buf->data;
+      str->len = (ui64)st.st_size;
+      str->capacity = str->len;
+    }
+    else if (buf)
+      unmap_buffer(buf, (ui64)st.st_size);
+  }
+  err = errno;
+  close(fd);
+  errno = err;
+  return (str);
+}
@@ -0,0 +1,169 @@
+#include "io_internal.h"
+#include "../string/string_internal.h"
+#include <types/reader.h>
+#include <errno.h>
+
+struct reader {
+  int   fd;
+  int   error;
+  ui64  start;
+  ui64  end;
+  ui64  capacity;
+  char  buf[];
+};
+
+/// @brief Creates a reader from `fd` with a buffer of `size` bytes.
+/// @param fd 
+/// @param size buffer size, at least 1
+/// @return reader or NULL on allocation failure
+reader  *new_reader_sized(int fd, ui64 size)
+{
+  reader  *r;
+
+  if (!size)
+    size = 1;
+  if (sizeof(reader) + size < size)
+    return (NULL);
+  r = malloc(sizeof(reader) + size);
+  if (!r)
+    return (NULL);
+  r->fd = fd;
+  r->error = 0;
+  r->start = 0;
+  r->end = 0;
+  r->capacity = size;
+  return (r);
+}
+
+/// @brief Creates a reader from `fd` with a buffer of READER_BUFFER_SIZE bytes.
+/// The file descriptor is borrowed, it is not closed by the reader.
+/// @param fd 
+/// @return reader or NULL on allocation failure
+reader  *new_reader(int fd)
+{
+  return (new_reader_sized(fd, READER_BUFFER_SIZE));
+}
+
+/// @brief Deletes the reader and sets the pointer to NULL. Bytes read but not
+/// returned yet are lost.
+/// @param r 
+void  dealloc_reader(reader **r)
+{
+  if (!r || !*r)
+    return ;
+  free(*r);
+  *r = NULL;
+}
+
+/// @brief Refills the (fully consumed) buffer.
+/// @param r 
+/// @return number of bytes read, 0 at the end of the input or on error
+static ui64 fill_reader(reader *r)
+{
+  ssize_t n;
+
+  r->start = 0;
+  r->end = 0;
+  do
+    n = read(r->fd, r->buf, r->capacity);
+  while (n < 0 && errno == EINTR);
+  if (n < 0)
+  {
+    r->error = errno;
+    return (0);
+  }
+  r->end = (ui64)n;
+  return (r->end);
+}
+
+/// @brief Appends `len` buffered bytes to the record being read.
+/// @param r 
+/// @param line 
+/// @param bytes 
+/// @param len 
+/// @return 1, or 0 with ENOMEM recorded when `line` could not grow
+static int  append_record(reader *r, string *line, const char *bytes, ui64 len)
+{
+  ui64  before;
+
+  before = line->len;
+  append_bytes_to_string(line, bytes, len);
+  if (line->len == before + len)
+    return (1);
+  r->error = ENOMEM;
+  return (0);
+}
+
+/// @brief Reads the next record ending with `delim` into `line`, without the
+/// delimiter. The delimiter is searched with memorychr over the buffered bytes
+/// and every byte is copied once, straight into `line`: a record spanning
+/// several buffers is gathered in `line` itself.
+/// @param r 
+/// @param line string whose content is replaced, its buffer is reused
+/// @param delim 
+/// @return 1 if a record was read, 0 at the end of the input or on error (a
+/// failed read, or ENOMEM when `line` can't hold the record)
+int read_until(reader *r, string *line, char delim)
+{
+  const char  *hit;
+  int         found;
+
+  if (!r || !line || r->error || !assign_bytes_to_string(line, "", 0))
+    return (0);
+  found = 0;
+  while (r->start < r->end || fill_reader(r))
+  {
+    found = 1;
+    hit = memorychr(r->buf + r->start, delim, r->end - r->start);
+    if (hit)
+    {
+      if (!append_record(r, line, r->buf + r->start,
+        (ui64)(hit - (r->buf + r->start))))
+        return (0);
+      r->start = (ui64)(hit - r->buf) + 1;
+      return (1);
+    }
+    if (!append_record(r, line, r->buf + r->start, r->end - r->start))
+      return (0);
+    r->start = r->end;
+  }
+  return (found && !r->error);
+}
+
+/// @brief Reads the next line into `line`, without its '\n'.
+/// @param r 
+/// @param line string whose content is replaced, its buffer is reused
+/// @return 1 if a line was read, 0 at the end of the input or on error
+/// @attention i.e: 'while (Reader()->line(r, line)) ...'
+int read_line(reader *r, string *line)
+{
+  return (read_until(r, line, '\n'));
+}
+
+/// @brief Reads the error that stopped the reader.
+/// @param r 
+/// @return the errno of the failed read, 0 if none failed
+int get_reader_error(const reader *r)
+{
+  if (!r)
+    return (EINVAL);
+  return (r->error);
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the reader type.
+/// @param  
+/// @return reader_funcs
+const reader_funcs  *Reader(void)
+{
+  static const reader_funcs reader_functions = {
+    .new = &new_reader,
+    .new_sized = &new_reader_sized,
+    .del = &dealloc_reader,
+    .line = &read_line,
+    .until = &read_until,
+    .error = &get_reader_error
+  };
+
+  return (&reader_functions);
+}
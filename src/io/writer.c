@@ -0,0 +1,215 @@
+#include "io_internal.h"
+#include "../string/string_internal.h"
+#include <types/writer.h>
+#include <errno.h>
+
+struct writer {
+  int   fd;
+  int   error;
+  ui64  len;
+  ui64  capacity;
+  char  buf[];
+};
+
+/// @brief Writes every byte of `count` buffers with as few writev calls as
+/// possible: calls are resumed after a short write (from the first byte left)
+/// and after EINTR, at most WRITE_IOV_MAX buffers go in each call.
+/// @param fd
+/// @param iov buffers, advanced in place past what was written
+/// @param count number of buffers
+/// @return 1 once everything is written, 0 on error (errno is kept)
+int write_fully(int fd, struct iovec *iov, int count)
+{
+  ssize_t written;
+
+  while (count > 0)
+  {
+    written = writev(fd, iov, count < WRITE_IOV_MAX ? count : WRITE_IOV_MAX);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue ;
+      return (0);
+    }
+    while (count > 0 && (ui64)written >= iov->iov_len)
+    {
+      written -= (ssize_t)iov->iov_len;
+      iov++;
+      count--;
+    }
+    if (count > 0)
+    {
+      iov->iov_base = (char *)iov->iov_base + written;
+      iov->iov_len -= (ui64)written;
+    }
+  }
+  return (1);
+}
+
+/// @brief Creates a writer to `fd` with a buffer of `size` bytes.
+/// @param fd
+/// @param size buffer size, 0 writes every value straight away
+/// @return writer or NULL on allocation failure
+writer  *new_writer_sized(int fd, ui64 size)
+{
+  writer  *w;
+
+  if (sizeof(writer) + size < size)
+    return (NULL);
+  w = malloc(sizeof(writer) + size);
+  if (!w)
+    return (NULL);
+  w->fd = fd;
+  w->error = 0;
+  w->len = 0;
+  w->capacity = size;
+  return (w);
+}
+
+/// @brief Creates a writer to `fd` with a buffer of WRITER_BUFFER_SIZE bytes.
+/// The file descriptor is borrowed, it is not closed by the writer.
+/// @param fd
+/// @return writer or NULL on allocation failure
+writer  *new_writer(int fd)
+{
+  return (new_writer_sized(fd, WRITER_BUFFER_SIZE));
+}
+
+/// @brief Writes out what the writer holds.
+/// @param w
+/// @return 1 on success, 0 on error (now or in an earlier write)
+int flush_writer(writer *w)
+{
+  struct iovec  iov;
+
+  if (!w || w->error)
+    return (0);
+  if (!w->len)
+    return (1);
+  iov.iov_base = w->buf;
+  iov.iov_len = w->len;
+  w->len = 0;
+  if (!write_fully(w->fd, &iov, 1))
+  {
+    w->error = errno;
+    return (0);
+  }
+  return (1);
+}
+
+/// @brief Flushes the writer, deletes it and sets the pointer to NULL.
+/// @param w
+void  dealloc_writer(writer **w)
+{
+  if (!w || !*w)
+    return ;
+  flush_writer(*w);
+  free(*w);
+  *w = NULL;
+}
+
+/// @brief Buffers `len` bytes. When they don't fit the buffer is written first,
+/// and bytes that could fill it on their own are written along with it, in a
+/// single writev and without being copied.
+static int  write_bytes(writer *w, const char *bytes, ui64 len)
+{
+  struct iovec  iov[2];
+
+  if (len <= w->capacity - w->len)
+  {
+    memorycopy(w->buf + w->len, (void *)bytes, len);
+    w->len += len;
+    return (1);
+  }
+  if (len < w->capacity)
+  {
+    if (!flush_writer(w))
+      return (0);
+    memorycopy(w->buf, (void *)bytes, len);
+    w->len = len;
+    return (1);
+  }
+  iov[0].iov_base = w->buf;
+  iov[0].iov_len = w->len;
+  iov[1].iov_base = (void *)bytes;
+  iov[1].iov_len = len;
+  w->len = 0;
+  if (!write_fully(w->fd, iov, 2))
+  {
+    w->error = errno;
+    return (0);
+  }
+  return (1);
+}
+
+/// @brief Writes the bytes of the given value argument, as String()->append
+/// would add them. Numbers are formatted straight into the buffer.
+/// @param w
+/// @param val typed_value containing type and value
+/// @return 1 on success, 0 on error or if the value holds nothing
+int write_to_writer(writer *w, typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+
+  if (!w || w->error || val.type == TYPE_PATTERN)
+    return (0);
+  if (w->capacity - w->len >= NUMBER_MAX_WIDTH)
+  {
+    len = format_number(w->buf + w->len, val);
+    w->len += len;
+    if (len)
+      return (1);
+  }
+  if (!typed_value_bytes(val, buf, &bytes, &len))
+    return (0);
+  return (write_bytes(w, bytes, len));
+}
+
+/// @brief Writes `count` values in order, i.e: the pieces of a log line.
+/// @param w
+/// @param vals array of typed values
+/// @param count number of values
+/// @return 1 if every value was written, 0 otherwise
+int write_many_to_writer(writer *w, const typed_value *vals, ui64 count)
+{
+  ui64  i;
+  int   ok;
+
+  if (!w || !vals)
+    return (0);
+  ok = 1;
+  for (i = 0; i < count; i++)
+    ok &= write_to_writer(w, vals[i]);
+  return (ok);
+}
+
+/// @brief Reads the error that stopped the writer.
+/// @param w
+/// @return the errno of the first failed write, 0 if none failed
+int get_writer_error(const writer *w)
+{
+  if (!w)
+    return (EINVAL);
+  return (w->error);
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the writer type.
+/// @param
+/// @return writer_funcs
+const writer_funcs  *Writer(void)
+{
+  static const writer_funcs writer_functions = {
+    .new = &new_writer,
+    .new_sized = &new_writer_sized,
+    .del = &dealloc_writer,
+    .write = &write_to_writer,
+    .write_many = &write_many_to_writer,
+    .flush = &flush_writer,
+    .error = &get_writer_error
+  };
+
+  return (&writer_functions);
+}
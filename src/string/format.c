@@ -0,0 +1,402 @@
+#include "string_internal.h"
+#include <stdarg.h>
+
+// Widths and precisions are clamped to it
+# define FORMAT_MAX_WIDTH (1 << 24)
+
+// Output of a format pass: pieces are written while they fit in `room`, and
+// `len` keeps counting past it, so a pass that runs out of room still measures
+// the whole output. Bytes of an argument found in [old_base, old_base +
+// old_len) belong to the string itself, they are read from `base` instead
+// once its buffer moved.
+typedef struct format_out {
+  char        *dst;
+  ui64        room;
+  ui64        len;
+  const char  *old_base;
+  const char  *base;
+  ui64        old_len;
+}   format_out;
+
+// One conversion: %[flags][width][.precision]conversion
+typedef struct format_spec {
+  int   left;
+  int   zero;
+  int   plus;
+  int   alt;
+  ui64  width;
+  i64   precision;
+  char  conv;
+}   format_spec;
+
+/// @brief Writes `n` bytes if they fit, and counts them.
+static void put_bytes(format_out *out, const char *bytes, ui64 n)
+{
+  if (out->len + n <= out->room)
+  {
+    if (bytes >= out->old_base && bytes < out->old_base + out->old_len)
+      bytes = out->base + (bytes - out->old_base);
+    if (n <= 16)
+    {
+      while (n--)
+        out->dst[out->len++] = *bytes++;
+      return ;
+    }
+    memorycopy(out->dst + out->len, (void *)bytes, n);
+  }
+  out->len += n;
+}
+
+/// @brief Writes `n` copies of `c` if they fit, and counts them.
+static void put_fill(format_out *out, char c, ui64 n)
+{
+  if (n && out->len + n <= out->room)
+    memoryset(out->dst + out->len, c, n);
+  out->len += n;
+}
+
+/// @brief Reads a width or precision given as `*`: any integer value.
+/// @return the value, 0 for a value that is not an integer
+static i64  star_value(typed_value val)
+{
+  switch (val.type)
+  {
+    case TYPE_INT:
+      return (val.as_int);
+    case TYPE_UINT:
+      return ((i64)val.as_uint);
+    case TYPE_LLONG:
+    case TYPE_FIXED:
+      return (val.as_llong);
+    case TYPE_ULLONG:
+    case TYPE_HEX:
+      return ((i64)val.as_ullong);
+    default:
+      return (0);
+  }
+}
+
+/// @brief Parses the flags, width and precision of a conversion, the ones given
+/// as `*` are taken from the arguments.
+/// @return the character after the conversion, or NULL if it is not valid
+static const char *parse_spec(const char *fmt, format_spec *spec, va_list *ap)
+{
+  i64   star;
+
+  *spec = (format_spec){0, 0, 0, 0, 0, -1, 0};
+  for (;; fmt++)
+  {
+    if (*fmt == '-')
+      spec->left = 1;
+    else if (*fmt == '0')
+      spec->zero = 1;
+    else if (*fmt == '+')
+      spec->plus = 1;
+    else if (*fmt == '#')
+      spec->alt = 1;
+    else
+      break ;
+  }
+  if (*fmt == '*')
+  {
+    star = star_value(va_arg(*ap, typed_value));
+    spec->left |= (star < 0);
+    spec->width = star < 0 ? 0ULL - (ui64)star : (ui64)star;
+    fmt++;
+  }
+  for (; *fmt >= '0' && *fmt <= '9'; fmt++)
+    if (spec->width < FORMAT_MAX_WIDTH)
+      spec->width = spec->width * 10 + (ui64)(*fmt - '0');
+  if (*fmt == '.')
+  {
+    spec->precision = 0;
+    if (*++fmt == '*')
+    {
+      star = star_value(va_arg(*ap, typed_value));
+      spec->precision = star < 0 ? -1 : star;
+      fmt++;
+    }
+    for (; *fmt >= '0' && *fmt <= '9'; fmt++)
+      if (spec->precision < FORMAT_MAX_WIDTH)
+        spec->precision = spec->precision * 10 + (*fmt - '0');
+  }
+  if (spec->width > FORMAT_MAX_WIDTH)
+    spec->width = FORMAT_MAX_WIDTH;
+  if (spec->precision > FORMAT_MAX_WIDTH)
+    spec->precision = FORMAT_MAX_WIDTH;
+  spec->conv = *fmt;
+  switch (spec->conv)
+  {
+    case 'v':
+    case 's':
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'c':
+    case 'x':
+    case 'X':
+      return (fmt + 1);
+    default:
+      return (NULL);
+  }
+}
+
+/// @brief Writes the digits of an integer value, without sign: in hexadecimal
+/// for %x and %X (negative values as their two's complement, like printf),
+/// otherwise the way append writes the value.
+/// @param digits at least NUMBER_MAX_WIDTH bytes
+/// @param negative receives 1 for a negative decimal
+/// @return number of digits, 0 if the value is not an integer
+static ui64 number_digits(typed_value val, char conv, char *digits, int *negative)
+{
+  unsigned long long  n;
+  ui64                len;
+  ui64                i;
+
+  *negative = 0;
+  if (val.type == TYPE_INT && (conv == 'x' || conv == 'X'))
+    val = (typed_value){TYPE_UINT, 0, {.as_uint = (unsigned int)val.as_int}};
+  if (val.type == TYPE_INT)
+    val = (typed_value){TYPE_LLONG, 0, {.as_llong = val.as_int}};
+  if (val.type == TYPE_UINT)
+    val = (typed_value){TYPE_ULLONG, 0, {.as_ullong = val.as_uint}};
+  if (val.type == TYPE_LLONG || val.type == TYPE_FIXED)
+  {
+    n = (unsigned long long)val.as_llong;
+    if (conv != 'x' && conv != 'X' && val.as_llong < 0)
+    {
+      *negative = 1;
+      n = 0ULL - n;
+    }
+  }
+  else if (val.type == TYPE_ULLONG || val.type == TYPE_HEX)
+    n = val.as_ullong;
+  else
+    return (0);
+  if (conv != 'x' && conv != 'X' && val.type != TYPE_HEX)
+    return (format_ullong(digits, n));
+  len = format_hex(digits, n);
+  for (i = 0; conv == 'X' && i < len; i++)
+    if (digits[i] >= 'a')
+      digits[i] -= 'a' - 'A';
+  return (len);
+}
+
+/// @brief Writes a double or float value, with the precision (when there is
+/// one) as its number of digits after the point, then padded to the width.
+static void put_real(format_out *out, const format_spec *spec, typed_value val)
+{
+  char  digits[NUMBER_MAX_WIDTH];
+  ui64  len;
+  ui64  sign;
+  ui64  pad;
+  int   plus;
+  int   zero;
+
+  if (spec->precision >= 0)
+    val.width = (int)spec->precision;
+  len = format_number(digits, val);
+  sign = (digits[0] == '-');
+  plus = spec->plus && !sign;
+  zero = spec->zero && !spec->left && digits[len - 1] >= '0'
+    && digits[len - 1] <= '9';
+  pad = 0;
+  if (spec->width > len + plus)
+    pad = spec->width - (len + plus);
+  if (!spec->left && !zero)
+    put_fill(out, ' ', pad);
+  if (sign || plus)
+    put_bytes(out, sign ? "-" : "+", 1);
+  if (zero)
+    put_fill(out, '0', pad);
+  put_bytes(out, digits + sign, len - sign);
+  if (spec->left)
+    put_fill(out, ' ', pad);
+}
+
+/// @brief Writes an integer value: sign, 0x prefix, precision zeros, then
+/// padded to the width. Doubles and floats are written by put_real.
+/// @return 1, or 0 if the value is not a number
+static int  put_number(format_out *out, const format_spec *spec, typed_value val)
+{
+  char  digits[NUMBER_MAX_WIDTH];
+  char  prefix[3];
+  ui64  prefix_len;
+  ui64  len;
+  ui64  zeros;
+  ui64  pad;
+  int   negative;
+
+  if (val.type == TYPE_DOUBLE || val.type == TYPE_FLOAT)
+  {
+    put_real(out, spec, val);
+    return (1);
+  }
+  len = number_digits(val, spec->conv, digits, &negative);
+  if (!len)
+    return (0);
+  prefix_len = 0;
+  if (negative || (spec->plus && (val.type == TYPE_INT || val.type == TYPE_LLONG
+    || val.type == TYPE_FIXED) && spec->conv != 'x' && spec->conv != 'X'))
+    prefix[prefix_len++] = negative ? '-' : '+';
+  if (spec->alt && (spec->conv == 'x' || spec->conv == 'X' || val.type == TYPE_HEX))
+  {
+    prefix[prefix_len++] = '0';
+    prefix[prefix_len++] = spec->conv == 'X' ? 'X' : 'x';
+  }
+  zeros = 0;
+  if (val.type == TYPE_FIXED && (ui64)val.width > len)
+    zeros = (ui64)val.width - len;
+  if (spec->precision > 0 && (ui64)spec->precision > len + zeros)
+    zeros = (ui64)spec->precision - len;
+  pad = 0;
+  if (spec->width > prefix_len + zeros + len)
+    pad = spec->width - (prefix_len + zeros + len);
+  if (spec->zero && !spec->left && spec->precision < 0)
+  {
+    zeros += pad;
+    pad = 0;
+  }
+  if (!spec->left)
+    put_fill(out, ' ', pad);
+  put_bytes(out, prefix, prefix_len);
+  put_fill(out, '0', zeros);
+  put_bytes(out, digits, len);
+  if (spec->left)
+    put_fill(out, ' ', pad);
+  return (1);
+}
+
+/// @brief Writes the bytes of a text value, two hexadecimal digits per byte for
+/// %x and %X. The precision limits the number of bytes taken from the value.
+static void put_text(format_out *out, const format_spec *spec, const char *bytes,
+  ui64 len)
+{
+  const char  *digits;
+  char        pair[2];
+  ui64        width;
+
+  if (spec->precision >= 0 && (ui64)spec->precision < len)
+    len = (ui64)spec->precision;
+  width = len;
+  if (spec->conv == 'x' || spec->conv == 'X')
+    width = len * 2;
+  if (!spec->left && spec->width > width)
+    put_fill(out, ' ', spec->width - width);
+  if (width == len)
+    put_bytes(out, bytes, len);
+  else
+  {
+    digits = spec->conv == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+    if (bytes >= out->old_base && bytes < out->old_base + out->old_len)
+      bytes = out->base + (bytes - out->old_base);
+    while (len--)
+    {
+      pair[0] = digits[(unsigned char)*bytes >> 4];
+      pair[1] = digits[(unsigned char)*bytes++ & 15];
+      put_bytes(out, pair, 2);
+    }
+  }
+  if (spec->left && spec->width > width)
+    put_fill(out, ' ', spec->width - width);
+}
+
+/// @brief Runs the format once over its arguments.
+/// @return 1, or 0 on an invalid conversion
+static int  format_pass(format_out *out, const char *fmt, va_list *ap)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  format_spec spec;
+  typed_value val;
+  const char  *bytes;
+  const char  *run;
+  ui64        len;
+
+  while (*fmt)
+  {
+    run = fmt;
+    while (*fmt && *fmt != '%')
+      fmt++;
+    put_bytes(out, run, (ui64)(fmt - run));
+    if (!*fmt)
+      break ;
+    if (fmt[1] == '%')
+    {
+      put_bytes(out, fmt, 1);
+      fmt += 2;
+      continue ;
+    }
+    fmt = parse_spec(fmt + 1, &spec, ap);
+    if (!fmt)
+      return (0);
+    val = va_arg(*ap, typed_value);
+    if (put_number(out, &spec, val))
+      continue ;
+    len = 0;
+    bytes = buf;
+    if (val.type == TYPE_PATTERN && val.as_pattern)
+      bytes = pattern_needle(val.as_pattern, &len);
+    else if (!typed_value_bytes(val, buf, &bytes, &len))
+      len = 0;
+    put_text(out, &spec, bytes, len);
+  }
+  return (1);
+}
+
+/// @brief Appends formatted text to the string, printf style, with every
+/// argument given as a typed value: the value decides how it is written, so %v,
+/// %s, %d, %i, %u and %c all write it the way append would. %x and %X write
+/// integers in hexadecimal, and the bytes of text values as pairs of hex
+/// digits. Flags '-' (left align), '0' (zero padding), '+' (sign) and '#' (0x
+/// prefix), a width and a precision (least digits for integers, digits after
+/// the point for doubles and floats, most bytes for text) are accepted, either
+/// can be '*' and taken from an integer argument.
+/// The text is formatted straight into the spare capacity of the string (grown
+/// first if the format text alone would not fit). When it does not fit, that
+/// pass has measured it, so the buffer grows once and a second pass writes it.
+/// Arguments may reference the string itself.
+/// @param str
+/// @param fmt format, '%%' writes a '%'
+/// @param ... one typed value per conversion (and per '*')
+/// @return 1 on success, 0 on an invalid conversion or allocation failure (the
+/// string is then unchanged)
+/// @attention i.e: 'string_format(s, "%-6v|%04x", VAL_PCHAR("id"), VAL_INT(255))-> "id    |00ff"'
+int string_format(string *str, const char *fmt, ...)
+{
+  format_out  out;
+  const char  *old_base;
+  va_list     ap;
+  ui64        fmt_len;
+  int         ok;
+
+  if (!str || !str->s || !fmt)
+    return (0);
+  old_base = str->s;
+  fmt_len = stringlen((char *)fmt);
+  if (string_spare(str) < fmt_len)
+    reserve_spare(str, fmt_len + NUMBER_MAX_WIDTH);
+  out = (format_out){str->s + str->len, string_spare(str), 0, old_base, str->s,
+    str->len};
+  va_start(ap, fmt);
+  ok = format_pass(&out, fmt, &ap);
+  va_end(ap);
+  if (!ok)
+    return (0);
+  if (out.len > out.room)
+  {
+    if (!reserve_spare(str, out.len))
+      return (0);
+    out = (format_out){str->s + str->len, out.len, 0, old_base, str->s,
+      str->len};
+    va_start(ap, fmt);
+    format_pass(&out, fmt, &ap);
+    va_end(ap);
+  }
+  // Nothing written: a shared or mapped buffer must stay untouched
+  if (!out.len)
+    return (1);
+  str->len += out.len;
+  str->s[str->len] = '\0';
+  str->hash = 0;
+  return (1);
+}
@@ -0,0 +1,221 @@
+#include "string_internal.h"
+#include <types/intern.h>
+#include <pthread.h>
+
+// Values resolved per batch by intern_many, before any lock is taken
+# define INTERN_BATCH 64
+
+// A shard is a Map() whose keys are the canonical strings (values are unused)
+// and the lock guarding it. Shards are cache line aligned so threads working
+// on different shards don't share a line.
+typedef struct intern_shard
+{
+  pthread_mutex_t lock;
+  map             *keys;
+}   __attribute__((aligned(64))) intern_shard;
+
+struct intern_pool {
+  intern_shard  shards[INTERN_SHARDS];
+};
+
+/// @brief Picks the shard of a hash from its high half, the map of the shard
+/// probes with the low bits.
+static ui64 shard_of(ui64 hash)
+{
+  return ((hash >> 32) % INTERN_SHARDS);
+}
+
+/// @brief Creates an empty pool.
+/// @param
+/// @return intern_pool or NULL on allocation or lock initialization failure
+intern_pool *new_intern_pool(void)
+{
+  intern_pool *pool;
+  int         i;
+
+  pool = aligned_alloc(64, sizeof(intern_pool));
+  if (!pool)
+    return (NULL);
+  for (i = 0; i < INTERN_SHARDS; i++)
+  {
+    pool->shards[i].keys = Map()->new();
+    if (!pool->shards[i].keys
+      || pthread_mutex_init(&pool->shards[i].lock, NULL) != 0)
+    {
+      Map()->del(&pool->shards[i].keys);
+      while (--i >= 0)
+      {
+        pthread_mutex_destroy(&pool->shards[i].lock);
+        Map()->del(&pool->shards[i].keys);
+      }
+      free(pool);
+      return (NULL);
+    }
+  }
+  return (pool);
+}
+
+/// @brief Deletes the pool and every string it interned, and sets the pointer
+/// to NULL. No other thread may use the pool meanwhile.
+/// @param pool
+void  dealloc_intern_pool(intern_pool **pool)
+{
+  int i;
+
+  if (!pool || !*pool)
+    return ;
+  for (i = 0; i < INTERN_SHARDS; i++)
+  {
+    pthread_mutex_destroy(&(*pool)->shards[i].lock);
+    Map()->del(&(*pool)->shards[i].keys);
+  }
+  free(*pool);
+  *pool = NULL;
+}
+
+/// @brief Counts the distinct contents interned so far.
+/// @param pool
+/// @return unsigned long long
+ui64  get_intern_pool_len(intern_pool *pool)
+{
+  ui64  len;
+  int   i;
+
+  if (!pool)
+    return (0);
+  len = 0;
+  for (i = 0; i < INTERN_SHARDS; i++)
+  {
+    pthread_mutex_lock(&pool->shards[i].lock);
+    len += Map()->len(pool->shards[i].keys);
+    pthread_mutex_unlock(&pool->shards[i].lock);
+  }
+  return (len);
+}
+
+/// @brief Looks the content up in its shard, under the shard lock.
+static const string *intern_bytes(intern_pool *pool, const char *bytes,
+  ui64 len, ui64 hash, int insert)
+{
+  intern_shard  *shard;
+  const string  *canonical;
+
+  shard = &pool->shards[shard_of(hash)];
+  pthread_mutex_lock(&shard->lock);
+  canonical = map_key_of(shard->keys, bytes, len, hash, insert);
+  pthread_mutex_unlock(&shard->lock);
+  return (canonical);
+}
+
+/// @brief Returns the canonical string holding the bytes of the value, copying
+/// them into the pool the first time they are seen. Interning a string reuses
+/// its cached hash.
+/// @param pool
+/// @param val typed_value containing type and value
+/// @return the interned string, NULL on allocation failure or invalid value
+/// @attention i.e: 'intern(pool, VAL_PCHAR("level")) == intern(pool, VAL_STR(s))'
+const string  *intern_value(intern_pool *pool, typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  ui64        hash;
+
+  if (!pool || !typed_value_key(val, buf, &bytes, &len, &hash))
+    return (NULL);
+  return (intern_bytes(pool, bytes, len, hash, 1));
+}
+
+/// @brief Same as intern_value, but values that were never interned are not
+/// added.
+/// @param pool
+/// @param val typed_value containing type and value
+/// @return the interned string or NULL
+const string  *find_interned_value(intern_pool *pool, typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  ui64        hash;
+
+  if (!pool || !typed_value_key(val, buf, &bytes, &len, &hash))
+    return (NULL);
+  return (intern_bytes(pool, bytes, len, hash, 0));
+}
+
+/// @brief Interns `count` values at once into `out`. Values are hashed before
+/// any lock is taken and grouped by shard, then every shard a batch touches is
+/// locked once for all of its values, instead of once per value.
+/// @param pool
+/// @param vals array of typed values
+/// @param count number of values
+/// @param out receives the interned strings, NULL for the values that failed
+/// @return number of values interned
+ui64  intern_many_values(intern_pool *pool, const typed_value *vals,
+  ui64 count, const string **out)
+{
+  char          bufs[INTERN_BATCH][NUMBER_MAX_WIDTH];
+  const char    *bytes[INTERN_BATCH];
+  ui64          lens[INTERN_BATCH];
+  ui64          hashes[INTERN_BATCH];
+  unsigned char shards[INTERN_BATCH];
+  unsigned char order[INTERN_BATCH];
+  unsigned char ends[INTERN_SHARDS + 1];
+  ui64          done;
+  ui64          n;
+  ui64          i;
+  int           s;
+
+  if (!pool || !vals || !out)
+    return (0);
+  done = 0;
+  for (; count; vals += n, out += n, count -= n)
+  {
+    n = count < INTERN_BATCH ? count : INTERN_BATCH;
+    memoryset(ends, 0, sizeof(ends));
+    for (i = 0; i < n; i++)
+    {
+      out[i] = NULL;
+      shards[i] = INTERN_SHARDS;
+      if (typed_value_key(vals[i], bufs[i], &bytes[i], &lens[i], &hashes[i]))
+        shards[i] = (unsigned char)shard_of(hashes[i]);
+      ends[shards[i]]++;
+    }
+    // Counting sort of the batch by shard, invalid values sort last
+    for (s = 1; s <= INTERN_SHARDS; s++)
+      ends[s] += ends[s - 1];
+    for (i = n; i-- > 0;)
+      order[--ends[shards[i]]] = (unsigned char)i;
+    for (s = 0; s < INTERN_SHARDS; s++)
+    {
+      if (ends[s] == ends[s + 1])
+        continue ;
+      pthread_mutex_lock(&pool->shards[s].lock);
+      for (i = ends[s]; i < ends[s + 1]; i++)
+        out[order[i]] = map_key_of(pool->shards[s].keys, bytes[order[i]],
+          lens[order[i]], hashes[order[i]], 1);
+      pthread_mutex_unlock(&pool->shards[s].lock);
+    }
+    for (i = 0; i < n; i++)
+      done += (out[i] != NULL);
+  }
+  return (done);
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the intern_pool type.
+/// @param
+/// @return intern_funcs
+const intern_funcs  *Intern(void)
+{
+  static const intern_funcs intern_functions = {
+    .new = &new_intern_pool,
+    .del = &dealloc_intern_pool,
+    .len = &get_intern_pool_len,
+    .intern = &intern_value,
+    .intern_many = &intern_many_values,
+    .find = &find_interned_value
+  };
+
+  return (&intern_functions);
+}
@@ -0,0 +1,497 @@
+#include "string_internal.h"
+#include <types/map.h>
+
+# ifdef __SSE2__
+#  include <emmintrin.h>
+#  define MAP_SSE2 1
+# endif
+
+// Control byte of a free slot that never held a key, probes stop at it
+# define CTRL_EMPTY 0x80
+// Control byte of a removed key, probes walk past it
+# define CTRL_DELETED 0xfe
+// Smallest table, at least one group so every probe reads real control bytes
+# define MAP_MIN_CAPACITY MAP_GROUP_WIDTH
+
+typedef struct map_slot
+{
+  ui64    hash;
+  string  *key;
+  void    *value;
+}   map_slot;
+
+// Open addressing table in the Swiss table style: every slot has a control
+// byte, CTRL_EMPTY, CTRL_DELETED or the low 7 bits of its key hash, so a group
+// of 16 candidates is filtered with one compare before any key is read. The
+// first MAP_GROUP_WIDTH control bytes are mirrored after the last one, a group
+// load starting near the end never wraps. Slots keep the full hash: keys are
+// compared only when hashes match, and growing never hashes a key again.
+struct map {
+  map_slot        *slots;
+  unsigned char   *ctrl;
+  ui64            capacity;
+  ui64            len;
+  ui64            growth_left;
+  const allocator *alloc;
+};
+
+/// @brief Most keys a table of `capacity` slots holds before it grows (7/8).
+static ui64 max_load(ui64 capacity)
+{
+  return (capacity - capacity / 8);
+}
+
+/// @brief Bytes of a table of `capacity` slots: the slots, then the control bytes.
+static ui64 table_size(ui64 capacity)
+{
+  return (capacity * sizeof(map_slot) + capacity + MAP_GROUP_WIDTH);
+}
+
+// ============================================================================
+// Groups
+// ============================================================================
+
+/// @brief Bit i is set when the control byte i of the group equals `c`.
+static unsigned group_match(const unsigned char *ctrl, unsigned char c)
+{
+# ifdef MAP_SSE2
+  return ((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+    _mm_loadu_si128((const __m128i *)ctrl), _mm_set1_epi8((char)c))));
+# else
+  unsigned  mask;
+  int       i;
+
+  mask = 0;
+  for (i = 0; i < MAP_GROUP_WIDTH; i++)
+    mask |= (unsigned)(ctrl[i] == c) << i;
+  return (mask);
+# endif
+}
+
+/// @brief Bit i is set when the slot i of the group holds no key (empty or
+/// deleted), both have their high bit set.
+static unsigned group_match_free(const unsigned char *ctrl)
+{
+# ifdef MAP_SSE2
+  return ((unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl)));
+# else
+  unsigned  mask;
+  int       i;
+
+  mask = 0;
+  for (i = 0; i < MAP_GROUP_WIDTH; i++)
+    mask |= (unsigned)(ctrl[i] >> 7) << i;
+  return (mask);
+# endif
+}
+
+/// @brief Writes the control byte of slot `i`, and its mirror after the table.
+static void set_ctrl(map *m, ui64 i, unsigned char c)
+{
+  m->ctrl[i] = c;
+  m->ctrl[((i - MAP_GROUP_WIDTH) & (m->capacity - 1)) + MAP_GROUP_WIDTH] = c;
+}
+
+// ============================================================================
+// Probing
+// ============================================================================
+
+/// @brief Walks the probe sequence of `hash` (groups at triangular offsets,
+/// which visits every group of a power of two table) until the key is found
+/// or a group with an empty slot ends the search.
+/// @return slot index or -1
+static i64  find_slot(const map *m, ui64 hash, const char *bytes, ui64 len)
+{
+  map_slot  *slot;
+  unsigned  match;
+  ui64      mask;
+  ui64      pos;
+  ui64      step;
+  ui64      i;
+
+  if (!m->capacity)
+    return (-1);
+  mask = m->capacity - 1;
+  pos = (hash >> 7) & mask;
+  step = 0;
+  while (1)
+  {
+    match = group_match(m->ctrl + pos, (unsigned char)(hash & 0x7f));
+    while (match)
+    {
+      i = (pos + __builtin_ctz(match)) & mask;
+      slot = &m->slots[i];
+      if (slot->hash == hash && slot->key->len == len
+        && memorycompare(slot->key->s, bytes, len) == 0)
+        return ((i64)i);
+      match &= match - 1;
+    }
+    if (group_match(m->ctrl + pos, CTRL_EMPTY))
+      return (-1);
+    step += MAP_GROUP_WIDTH;
+    pos = (pos + step) & mask;
+  }
+}
+
+/// @brief Finds the first free slot (empty or deleted) on the probe sequence
+/// of `hash`. The load factor guarantees there is one.
+static ui64 find_free(const map *m, ui64 hash)
+{
+  unsigned  match;
+  ui64      mask;
+  ui64      pos;
+  ui64      step;
+
+  mask = m->capacity - 1;
+  pos = (hash >> 7) & mask;
+  step = 0;
+  while (1)
+  {
+    match = group_match_free(m->ctrl + pos);
+    if (match)
+      return ((pos + __builtin_ctz(match)) & mask);
+    step += MAP_GROUP_WIDTH;
+    pos = (pos + step) & mask;
+  }
+}
+
+/// @brief Moves every key into a new table of `capacity` slots, using the
+/// hashes stored in the slots. Deleted slots are dropped on the way.
+/// @return 1 on success, 0 on allocation failure (the map is left unchanged)
+static int  rehash(map *m, ui64 capacity)
+{
+  map       old;
+  ui64      i;
+  ui64      j;
+
+  old = *m;
+  m->slots = m->alloc->alloc(m->alloc->ctx, table_size(capacity));
+  if (!m->slots)
+  {
+    m->slots = old.slots;
+    return (0);
+  }
+  m->ctrl = (unsigned char *)(m->slots + capacity);
+  m->capacity = capacity;
+  memoryset(m->ctrl, CTRL_EMPTY, capacity + MAP_GROUP_WIDTH);
+  for (i = 0; i < old.capacity; i++)
+  {
+    if (old.ctrl[i] & 0x80)
+      continue ;
+    j = find_free(m, old.slots[i].hash);
+    set_ctrl(m, j, old.ctrl[i]);
+    m->slots[j] = old.slots[i];
+  }
+  m->growth_left = max_load(capacity) - m->len;
+  if (old.capacity && m->alloc->free)
+    m->alloc->free(m->alloc->ctx, old.slots, table_size(old.capacity));
+  return (1);
+}
+
+// ============================================================================
+// Methods
+// ============================================================================
+
+/// @brief Creates an empty map whose table, keys and struct are allocated from
+/// `alloc`. Nothing but the struct is allocated until the first key is set.
+/// @param alloc allocator to use, NULL for the heap
+/// @return map or NULL on allocation failure
+map *new_map_in(const allocator *alloc)
+{
+  map *m;
+
+  if (!alloc)
+    alloc = heap_allocator();
+  m = alloc->alloc(alloc->ctx, sizeof(map));
+  if (!m)
+    return (NULL);
+  m->slots = NULL;
+  m->ctrl = NULL;
+  m->capacity = 0;
+  m->len = 0;
+  m->growth_left = 0;
+  m->alloc = alloc;
+  return (m);
+}
+
+/// @brief Creates an empty map on the heap.
+/// @param
+/// @return map or NULL on allocation failure
+map *new_map(void)
+{
+  return (new_map_in(heap_allocator()));
+}
+
+/// @brief Deletes every key the map owns, then the map itself, and sets the
+/// pointer to NULL. Values are not freed.
+/// @param m
+void  dealloc_map(map **m)
+{
+  const allocator *alloc;
+  ui64            i;
+
+  if (!m || !*m)
+    return ;
+  alloc = (*m)->alloc;
+  for (i = 0; i < (*m)->capacity; i++)
+    if (!((*m)->ctrl[i] & 0x80))
+      dealloc_string(&(*m)->slots[i].key);
+  if (alloc->free)
+  {
+    if ((*m)->capacity)
+      alloc->free(alloc->ctx, (*m)->slots, table_size((*m)->capacity));
+    alloc->free(alloc->ctx, *m, sizeof(map));
+  }
+  *m = NULL;
+}
+
+/// @brief Reads how many keys the map holds.
+/// @param m
+/// @return unsigned long long
+ui64  get_map_len(const map *m)
+{
+  if (!m)
+    return (0);
+  return (m->len);
+}
+
+/// @brief Grows the table so it can hold at least `count` keys without growing
+/// again.
+/// @param m
+/// @param count
+/// @return 1 on success, 0 on allocation failure or NULL map
+int reserve_map(map *m, ui64 count)
+{
+  ui64  capacity;
+
+  if (!m)
+    return (0);
+  capacity = m->capacity ? m->capacity : MAP_MIN_CAPACITY;
+  while (max_load(capacity) < count)
+  {
+    if (capacity > ((ui64)-1 >> 1) / sizeof(map_slot))
+      return (0);
+    capacity <<= 1;
+  }
+  if (capacity == m->capacity)
+    return (1);
+  return (rehash(m, capacity));
+}
+
+/// @brief Finds the slot of the key, inserting a copy of it with a NULL value
+/// when it is missing.
+/// @return slot index or -1 on allocation failure
+static i64  insert_key(map *m, const char *bytes, ui64 len, ui64 hash)
+{
+  string  *copy;
+  i64     found;
+  ui64    i;
+
+  found = find_slot(m, hash, bytes, len);
+  if (found >= 0)
+    return (found);
+  // A full table doubles, one mostly made of deleted slots is rebuilt in place
+  if (!m->growth_left && !rehash(m, m->len < max_load(m->capacity) / 2
+      ? m->capacity : (m->capacity ? m->capacity << 1 : MAP_MIN_CAPACITY)))
+    return (-1);
+  copy = new_string_len(m->alloc, bytes, len);
+  if (!copy)
+    return (-1);
+  copy->hash = hash;
+  i = find_free(m, hash);
+  if (m->ctrl[i] == CTRL_EMPTY)
+    m->growth_left--;
+  set_ctrl(m, i, (unsigned char)(hash & 0x7f));
+  m->slots[i] = (map_slot){hash, copy, NULL};
+  m->len++;
+  return ((i64)i);
+}
+
+/// @brief Returns the copy of the key the map owns, for callers that hand the
+/// keys out themselves (i.e: the intern pool). The key is inserted with a NULL
+/// value when `insert` is set and it is missing.
+/// @param m
+/// @param bytes
+/// @param len
+/// @param hash memoryhash() of the bytes
+/// @param insert
+/// @return the map key, NULL if it is missing or on allocation failure
+string  *map_key_of(map *m, const char *bytes, ui64 len, ui64 hash, int insert)
+{
+  i64 found;
+
+  if (insert)
+    found = insert_key(m, bytes, len, hash);
+  else
+    found = find_slot(m, hash, bytes, len);
+  if (found < 0)
+    return (NULL);
+  return (m->slots[found].key);
+}
+
+/// @brief Associates `value` with the key, replacing the value of a key that
+/// is already in the map. New keys are copied, so the caller keeps its own.
+/// @param m
+/// @param key typed_value holding the key
+/// @param value
+/// @return 1 on success, 0 on allocation failure or invalid key
+/// @attention i.e: 'set_map_value(m, VAL_PCHAR("host"), ptr)'
+int set_map_value(map *m, typed_value key, void *value)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  ui64        hash;
+  i64         found;
+
+  if (!m || !typed_value_key(key, buf, &bytes, &len, &hash))
+    return (0);
+  found = insert_key(m, bytes, len, hash);
+  if (found < 0)
+    return (0);
+  m->slots[found].value = value;
+  return (1);
+}
+
+/// @brief Looks the key up.
+/// @param m
+/// @param key typed_value holding the key
+/// @return the value, NULL if the key is not in the map (use has() to tell a
+/// missing key from a NULL value)
+void  *get_map_value(const map *m, typed_value key)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  ui64        hash;
+  i64         found;
+
+  if (!m || !m->len || !typed_value_key(key, buf, &bytes, &len, &hash))
+    return (NULL);
+  found = find_slot(m, hash, bytes, len);
+  if (found < 0)
+    return (NULL);
+  return (m->slots[found].value);
+}
+
+/// @brief Tells if the key is in the map.
+/// @param m
+/// @param key typed_value holding the key
+/// @return 1 or 0
+int has_map_key(const map *m, typed_value key)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  ui64        hash;
+
+  if (!m || !m->len || !typed_value_key(key, buf, &bytes, &len, &hash))
+    return (0);
+  return (find_slot(m, hash, bytes, len) >= 0);
+}
+
+/// @brief Removes the key (and deletes the map copy of it). The slot becomes
+/// empty again when no probe sequence can run through it, deleted otherwise.
+/// @param m
+/// @param key typed_value holding the key
+/// @return 1 if the key was removed, 0 if it was not in the map
+int remove_map_key(map *m, typed_value key)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  ui64        hash;
+  i64         found;
+  unsigned    before;
+  unsigned    after;
+
+  if (!m || !m->len || !typed_value_key(key, buf, &bytes, &len, &hash))
+    return (0);
+  found = find_slot(m, hash, bytes, len);
+  if (found < 0)
+    return (0);
+  dealloc_string(&m->slots[found].key);
+  m->len--;
+  // Probes stop at the first group holding an empty slot: if the run of full
+  // slots around this one is shorter than a group, no probe went past it
+  before = group_match(m->ctrl + ((found - MAP_GROUP_WIDTH) & (m->capacity - 1)),
+    CTRL_EMPTY);
+  after = group_match(m->ctrl + found, CTRL_EMPTY);
+  if (before && after && __builtin_ctz(after)
+    + (__builtin_clz(before) - (32 - MAP_GROUP_WIDTH)) < MAP_GROUP_WIDTH)
+  {
+    set_ctrl(m, found, CTRL_EMPTY);
+    m->growth_left++;
+  }
+  else
+    set_ctrl(m, found, CTRL_DELETED);
+  return (1);
+}
+
+/// @brief Removes every key, the table keeps its capacity.
+/// @param m
+void  clear_map(map *m)
+{
+  ui64  i;
+
+  if (!m || !m->capacity)
+    return ;
+  for (i = 0; i < m->capacity; i++)
+    if (!(m->ctrl[i] & 0x80))
+      dealloc_string(&m->slots[i].key);
+  memoryset(m->ctrl, CTRL_EMPTY, m->capacity + MAP_GROUP_WIDTH);
+  m->len = 0;
+  m->growth_left = max_load(m->capacity);
+}
+
+/// @brief Iterates over the keys in table order. `it` must start at 0; the
+/// map must not be changed during the iteration.
+/// @param m
+/// @param it iteration cursor
+/// @param key receives the key (may be NULL), owned by the map
+/// @param value receives the value (may be NULL)
+/// @return 1 while there is an entry, 0 at the end
+/// @attention i.e: 'while (Map()->next(m, &it, &key, &value)) ...'
+int next_map_entry(const map *m, ui64 *it, const string **key, void **value)
+{
+  ui64  i;
+
+  if (!m || !it)
+    return (0);
+  for (i = *it; i < m->capacity; i++)
+  {
+    if (m->ctrl[i] & 0x80)
+      continue ;
+    if (key)
+      *key = m->slots[i].key;
+    if (value)
+      *value = m->slots[i].value;
+    *it = i + 1;
+    return (1);
+  }
+  *it = m->capacity;
+  return (0);
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the map type.
+/// @param
+/// @return map_funcs
+const map_funcs *Map(void)
+{
+  static const map_funcs  map_functions = {
+    .new = &new_map,
+    .new_in = &new_map_in,
+    .del = &dealloc_map,
+    .len = &get_map_len,
+    .reserve = &reserve_map,
+    .set = &set_map_value,
+    .get = &get_map_value,
+    .has = &has_map_key,
+    .remove = &remove_map_key,
+    .clear = &clear_map,
+    .next = &next_map_entry
+  };
+
+  return (&map_functions);
+}
@@ -0,0 +1,489 @@
+#include "string_internal.h"
+#include <types/matcher.h>
+#include <types/string_view.h>
+
+// Set on a transition entering a state where at least one needle ends, so the
+// scan loop tests a single bit per byte
+# define MATCHER_OUTPUT (1U << 31)
+// End of a list of needle ids
+# define MATCHER_NONE 0xffffffffU
+
+typedef enum {
+  SCAN_FIRST,
+  SCAN_ALL,
+  SCAN_COUNT
+} scan_mode;
+
+// The automaton is a complete DFA (failure links folded into the transitions)
+// flattened in one array: the row of a state holds one entry per byte class,
+// and entries hold the row offset of the next state, so a step is one load
+// with no multiplication. Bytes that appear in no needle share class 0, which
+// keeps rows as short as the needles' alphabet.
+// `own` gives the first needle ending exactly at a state (longest first, since
+// a state spells one needle), `same` the next needle with the same bytes, and
+// `dict` the nearest state down the failure chain where a needle ends (0 for
+// none, the root never has one): following them lists every match ending at a
+// byte, longest first.
+struct matcher {
+  unsigned        *delta;
+  unsigned        *own;
+  unsigned        *dict;
+  unsigned        *same;
+  ui64            *lens;
+  ui64            states;
+  ui64            classes;
+  ui64            count;
+  unsigned short  class_of[256];
+};
+
+// Needles being compiled: either typed values or C strings
+typedef struct needle_list {
+  const typed_value *vals;
+  const char *const *strs;
+  ui64              count;
+}   needle_list;
+
+/// @brief Resolves needle `i` of the list into its bytes.
+/// @return 1, or 0 if the needle holds nothing searchable
+static int  needle_bytes(const needle_list *list, ui64 i, char *buf,
+  const char **bytes, ui64 *len)
+{
+  typed_value val;
+
+  val = list->vals ? list->vals[i] : VAL_PCHAR(list->strs[i]);
+  if (val.type == TYPE_PATTERN)
+  {
+    if (!val.as_pattern)
+      return (0);
+    *bytes = pattern_needle(val.as_pattern, len);
+    return (1);
+  }
+  return (typed_value_bytes(val, buf, bytes, len));
+}
+
+/// @brief Frees the matcher and its tables.
+/// @param m 
+void  dealloc_matcher(matcher **m)
+{
+  if (!m || !*m)
+    return ;
+  free((*m)->delta);
+  free((*m)->own);
+  free((*m)->dict);
+  free((*m)->same);
+  free((*m)->lens);
+  free(*m);
+  *m = NULL;
+}
+
+/// @brief Gives every byte used by a needle its own class, the others share
+/// class 0, and sums the needle lengths.
+/// @return the total length, an upper bound of the number of trie states - 1
+static ui64 build_classes(matcher *m, const needle_list *list)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  ui64        total;
+  ui64        i;
+  ui64        k;
+
+  total = 0;
+  for (i = 0; i < list->count; i++)
+  {
+    if (!needle_bytes(list, i, buf, &bytes, &len))
+      len = 0;
+    m->lens[i] = len;
+    total += len;
+    for (k = 0; k < len; k++)
+      m->class_of[(unsigned char)bytes[k]] = 1;
+  }
+  m->classes = 1;
+  for (k = 0; k < 256; k++)
+  {
+    if (m->class_of[k])
+      m->class_of[k] = (unsigned short)m->classes++;
+  }
+  return (total);
+}
+
+/// @brief Adds needle `id` to the trie. Missing edges are still 0 (the root is
+/// never a child), new states are appended.
+static void insert_needle(matcher *m, const char *bytes, ui64 len, unsigned id)
+{
+  ui64      s;
+  ui64      k;
+  unsigned  *last;
+
+  s = 0;
+  for (k = 0; k < len; k++)
+  {
+    if (!m->delta[s + m->class_of[(unsigned char)bytes[k]]])
+    {
+      m->own[m->states] = MATCHER_NONE;
+      m->dict[m->states] = 0;
+      m->delta[s + m->class_of[(unsigned char)bytes[k]]]
+        = (unsigned)(m->states++ * m->classes);
+    }
+    s = m->delta[s + m->class_of[(unsigned char)bytes[k]]];
+  }
+  last = &m->own[s / m->classes];
+  while (*last != MATCHER_NONE)
+    last = &m->same[*last];
+  *last = id;
+}
+
+/// @brief Renumbers the trie states breadth first. The scan spends most of its
+/// time in shallow states, they end up packed at the start of the table
+/// instead of spread between the deep states of every needle.
+/// @return 1, or 0 on allocation failure
+static int  sort_states(matcher *m)
+{
+  unsigned  *order;
+  unsigned  *rank;
+  unsigned  *delta;
+  unsigned  *own;
+  ui64      head;
+  ui64      tail;
+  ui64      c;
+  ui64      i;
+
+  order = malloc(m->states * sizeof(unsigned));
+  rank = malloc(m->states * sizeof(unsigned));
+  delta = malloc(m->states * m->classes * sizeof(unsigned));
+  own = malloc(m->states * sizeof(unsigned));
+  if (!order || !rank || !delta || !own)
+  {
+    free(order);
+    free(rank);
+    free(delta);
+    free(own);
+    return (0);
+  }
+  order[0] = 0;
+  head = 0;
+  tail = 1;
+  while (head < tail)
+  {
+    rank[order[head]] = (unsigned)head;
+    for (c = 0; c < m->classes; c++)
+    {
+      if (m->delta[order[head] * m->classes + c])
+        order[tail++] = m->delta[order[head] * m->classes + c] / m->classes;
+    }
+    head++;
+  }
+  for (i = 0; i < m->states; i++)
+  {
+    for (c = 0; c < m->classes; c++)
+      delta[i * m->classes + c] = m->delta[order[i] * m->classes + c]
+        ? (unsigned)(rank[m->delta[order[i] * m->classes + c] / m->classes]
+          * m->classes) : 0;
+    own[i] = m->own[order[i]];
+  }
+  free(m->delta);
+  free(m->own);
+  free(order);
+  free(rank);
+  m->delta = delta;
+  m->own = own;
+  return (1);
+}
+
+/// @brief Turns the trie into the complete DFA, breadth first: the failure
+/// state of a child is where its parent's failure state goes with the same
+/// byte, and a missing edge copies the failure state's transition. Both are
+/// final by then since failure states are shallower.
+/// @return 1, or 0 on allocation failure
+static int  link_failures(matcher *m)
+{
+  unsigned  *fail;
+  unsigned  *queue;
+  ui64      head;
+  ui64      tail;
+  ui64      u;
+  ui64      c;
+  unsigned  v;
+  unsigned  f;
+
+  fail = malloc(m->states * sizeof(unsigned));
+  queue = malloc(m->states * sizeof(unsigned));
+  if (!fail || !queue)
+  {
+    free(fail);
+    free(queue);
+    return (0);
+  }
+  fail[0] = 0;
+  queue[0] = 0;
+  head = 0;
+  tail = 1;
+  while (head < tail)
+  {
+    u = queue[head++];
+    for (c = 0; c < m->classes; c++)
+    {
+      v = m->delta[u + c];
+      f = (u == 0) ? 0 : m->delta[fail[u / m->classes] + c];
+      if (!v)
+      {
+        m->delta[u + c] = f;
+        continue ;
+      }
+      fail[v / m->classes] = f;
+      m->dict[v / m->classes] = (m->own[f / m->classes] != MATCHER_NONE)
+        ? f / m->classes : m->dict[f / m->classes];
+      queue[tail++] = v;
+    }
+  }
+  free(fail);
+  free(queue);
+  return (1);
+}
+
+/// @brief Flags every transition entering a state where a needle ends.
+static void flag_outputs(matcher *m)
+{
+  ui64  i;
+  ui64  s;
+
+  for (i = 0; i < m->states * m->classes; i++)
+  {
+    s = m->delta[i] / m->classes;
+    if (m->own[s] != MATCHER_NONE || m->dict[s])
+      m->delta[i] |= MATCHER_OUTPUT;
+  }
+}
+
+/// @brief Compiles the needles of the list into a matcher.
+/// @return matcher or NULL if no needle is searchable or allocation failed
+static matcher  *compile_matcher(const needle_list *list)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  matcher     *m;
+  unsigned    *shrink;
+  ui64        max_states;
+  ui64        i;
+
+  if (!list->count || list->count >= MATCHER_NONE)
+    return (NULL);
+  m = calloc(1, sizeof(matcher));
+  if (!m)
+    return (NULL);
+  m->count = list->count;
+  m->lens = malloc(list->count * sizeof(ui64));
+  m->same = malloc(list->count * sizeof(unsigned));
+  if (!m->lens || !m->same)
+  {
+    dealloc_matcher(&m);
+    return (NULL);
+  }
+  max_states = build_classes(m, list) + 1;
+  if (max_states == 1 || max_states >= MATCHER_OUTPUT / m->classes)
+  {
+    dealloc_matcher(&m);
+    return (NULL);
+  }
+  m->delta = calloc(max_states * m->classes, sizeof(unsigned));
+  m->own = malloc(max_states * sizeof(unsigned));
+  m->dict = malloc(max_states * sizeof(unsigned));
+  if (!m->delta || !m->own || !m->dict)
+  {
+    dealloc_matcher(&m);
+    return (NULL);
+  }
+  m->own[0] = MATCHER_NONE;
+  m->dict[0] = 0;
+  m->states = 1;
+  for (i = 0; i < list->count; i++)
+  {
+    m->same[i] = MATCHER_NONE;
+    if (m->lens[i] && needle_bytes(list, i, buf, &bytes, &m->lens[i]))
+      insert_needle(m, bytes, m->lens[i], (unsigned)i);
+  }
+  if (!sort_states(m) || !link_failures(m))
+  {
+    dealloc_matcher(&m);
+    return (NULL);
+  }
+  flag_outputs(m);
+  shrink = realloc(m->delta, m->states * m->classes * sizeof(unsigned));
+  if (shrink)
+    m->delta = shrink;
+  return (m);
+}
+
+/// @brief Compiles a matcher from a list of needles.
+/// @param vals needles, any typed value index_of accepts
+/// @param count 
+/// @return matcher or NULL if no needle is searchable or allocation failed
+matcher *new_matcher(const typed_value *vals, ui64 count)
+{
+  needle_list list;
+
+  if (!vals)
+    return (NULL);
+  list = (needle_list){vals, NULL, count};
+  return (compile_matcher(&list));
+}
+
+/// @brief Compiles a matcher from an array of null terminated strings, a NULL
+/// entry never matches.
+/// @param strs 
+/// @param count 
+/// @return matcher or NULL if no needle is searchable or allocation failed
+matcher *new_matcher_pchars(const char *const *strs, ui64 count)
+{
+  needle_list list;
+
+  if (!strs)
+    return (NULL);
+  list = (needle_list){NULL, strs, count};
+  return (compile_matcher(&list));
+}
+
+/// @brief Reads the number of needles the matcher was built from.
+/// @param m 
+/// @return unsigned long long
+ui64  get_matcher_len(const matcher *m)
+{
+  if (!m)
+    return (0);
+  return (m->count);
+}
+
+/// @brief Reports every needle ending right before `end` at state `s`.
+/// @return number of matches reported
+static ui64 report_matches(const matcher *m, ui64 s, ui64 end, scan_mode mode,
+  match *out, ui64 cap, ui64 found, ui64 *counts)
+{
+  ui64      n;
+  unsigned  id;
+
+  n = 0;
+  if (m->own[s] == MATCHER_NONE)
+    s = m->dict[s];
+  while (s)
+  {
+    for (id = m->own[s]; id != MATCHER_NONE; id = m->same[id])
+    {
+      if (mode != SCAN_COUNT && found + n < cap)
+        out[found + n] = (match){end - m->lens[id], m->lens[id], id};
+      else if (mode == SCAN_COUNT && counts)
+        counts[id]++;
+      n++;
+      if (mode == SCAN_FIRST)
+        return (n);
+    }
+    s = m->dict[s];
+  }
+  return (n);
+}
+
+/// @brief Runs the automaton over the text, one table lookup per byte.
+/// @return number of matches found (1 at most for SCAN_FIRST)
+static ui64 scan_text(const matcher *m, string_view text, ui64 from,
+  scan_mode mode, match *out, ui64 cap, ui64 *counts)
+{
+  const unsigned char *p;
+  ui64                found;
+  ui64                i;
+  unsigned            s;
+  unsigned            e;
+
+  p = (const unsigned char *)text.ptr;
+  found = 0;
+  s = 0;
+  for (i = from; i < text.len; i++)
+  {
+    // At the root, bytes that start no needle are skipped by a loop whose
+    // loads don't wait on each other, unlike the state chain below
+    while (!s && !m->delta[m->class_of[p[i]]] && i + 1 < text.len)
+      i++;
+    e = m->delta[s + m->class_of[p[i]]];
+    s = e & ~MATCHER_OUTPUT;
+    if (e & MATCHER_OUTPUT)
+    {
+      found += report_matches(m, s / m->classes, i + 1, mode, out, cap, found,
+        counts);
+      if (mode == SCAN_FIRST)
+        return (found);
+    }
+  }
+  return (found);
+}
+
+/// @brief Finds the first match in the text starting at or after `from`: the
+/// one that ends first, the longest one if several end at the same byte.
+/// @param m 
+/// @param text string, pointer to char or view to search
+/// @param from 
+/// @param out receives the match
+/// @return 1 if a needle was found, 0 otherwise
+/// @attention i.e: 'if (Matcher()->find(m, VAL_STR(line), 0, &hit)) ...'
+int find_matcher(const matcher *m, typed_value text, ui64 from, match *out)
+{
+  string_view view;
+
+  view = View()->of(text);
+  if (!m || !out || !view.ptr || from > view.len)
+    return (0);
+  return (scan_text(m, view, from, SCAN_FIRST, out, 1, NULL) != 0);
+}
+
+/// @brief Finds every match in the text, overlapping ones included. The first
+/// `cap` are stored in `out`, all of them are counted.
+/// @param m 
+/// @param text string, pointer to char or view to search
+/// @param out receives the matches, may be NULL when `cap` is 0
+/// @param cap 
+/// @return the number of matches, possibly more than `cap`
+ui64  find_all_matcher(const matcher *m, typed_value text, match *out, ui64 cap)
+{
+  string_view view;
+
+  view = View()->of(text);
+  if (!m || !view.ptr || (!out && cap))
+    return (0);
+  return (scan_text(m, view, 0, SCAN_ALL, out, cap, NULL));
+}
+
+/// @brief Counts the matches of every needle in the text.
+/// @param m 
+/// @param text string, pointer to char or view to search
+/// @param counts Matcher()->len(m) counters, set to the matches of each
+/// needle, may be NULL
+/// @return the total number of matches
+ui64  count_matcher(const matcher *m, typed_value text, ui64 *counts)
+{
+  string_view view;
+
+  if (!m)
+    return (0);
+  if (counts)
+    memoryset(counts, 0, m->count * sizeof(ui64));
+  view = View()->of(text);
+  if (!view.ptr)
+    return (0);
+  return (scan_text(m, view, 0, SCAN_COUNT, NULL, 0, counts));
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the matcher type.
+/// @param  
+/// @return matcher_funcs
+const matcher_funcs *Matcher(void)
+{
+  static const matcher_funcs  matcher_functions = {
+    .new = &new_matcher,
+    .new_pchars = &new_matcher_pchars,
+    .del = &dealloc_matcher,
+    .len = &get_matcher_len,
+    .find = &find_matcher,
+    .find_all = &find_all_matcher,
+    .count = &count_matcher
+  };
+
+  return (&matcher_functions);
+}
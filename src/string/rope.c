@@ -0,0 +1,694 @@
+#include "string_internal.h"
+#include "../io/io_internal.h"
+#include <types/rope.h>
+#include <types/search.h>
+// Deepest tree whose last chunk is filled in place (a balanced tree of that
+// height holds far more chunks than memory can)
+# define ROPE_MAX_HEIGHT 96
+
+// A node is either a leaf (height 1) holding `len` bytes at `bytes`, or a
+// concatenation (height > 1) of `left` and `right`. A leaf either owns its
+// bytes, stored in `data` with room for `capacity`, or is a slice of the leaf
+// `right` owns. Nodes are shared between ropes and counted by `refs`, only a
+// node referenced once (and every node above it) may be written.
+typedef struct rope_node rope_node;
+
+struct rope_node {
+  ui64        refs;
+  ui64        len;
+  ui64        capacity;
+  int         height;
+  rope_node   *left;
+  rope_node   *right;
+  const char  *bytes;
+  char        data[];
+};
+
+struct rope {
+  rope_node *root;
+};
+
+/// @brief Height of a tree, 0 for the empty one.
+static int  height_of(const rope_node *n)
+{
+  return (n ? n->height : 0);
+}
+
+/// @brief Tells if the node is referenced from a single place.
+static int  is_unique(const rope_node *n)
+{
+  return (__atomic_load_n(&n->refs, __ATOMIC_ACQUIRE) == 1);
+}
+
+/// @brief Takes one more reference on the node.
+static rope_node  *retain(rope_node *n)
+{
+  if (n)
+    __atomic_add_fetch(&n->refs, 1, __ATOMIC_RELAXED);
+  return (n);
+}
+
+/// @brief Drops a reference on the node, the last one frees it and releases
+/// its children (or the leaf it slices).
+static void release(rope_node *n)
+{
+  if (!n || (!is_unique(n)
+      && __atomic_sub_fetch(&n->refs, 1, __ATOMIC_ACQ_REL) != 0))
+    return ;
+  if (n->height > 1)
+    release(n->left);
+  release(n->right);
+  free(n);
+}
+
+/// @brief Creates a leaf owning room for `capacity` bytes, holding a copy of
+/// the first `len` of them.
+static rope_node  *new_leaf(const char *bytes, ui64 len, ui64 capacity)
+{
+  rope_node *n;
+
+  n = malloc(sizeof(rope_node) + capacity);
+  if (!n)
+    return (NULL);
+  n->refs = 1;
+  n->len = len;
+  n->capacity = capacity;
+  n->height = 1;
+  n->left = NULL;
+  n->right = NULL;
+  n->bytes = n->data;
+  memorycopy(n->data, (void *)bytes, len);
+  return (n);
+}
+
+/// @brief Creates a leaf for `len` bytes of `leaf` starting at `offset`,
+/// without copying them.
+static rope_node  *slice_leaf(rope_node *leaf, ui64 offset, ui64 len)
+{
+  rope_node *n;
+
+  n = malloc(sizeof(rope_node));
+  if (!n)
+    return (NULL);
+  n->refs = 1;
+  n->len = len;
+  n->capacity = 0;
+  n->height = 1;
+  n->left = NULL;
+  n->right = retain(leaf->right ? leaf->right : leaf);
+  n->bytes = leaf->bytes + offset;
+  return (n);
+}
+
+/// @brief Creates the concatenation of two non empty trees, taking over both
+/// references. On failure both are released.
+/// @return 1 on success, 0 on allocation failure
+static int  pair(rope_node *a, rope_node *b, rope_node **out)
+{
+  rope_node *n;
+
+  n = malloc(sizeof(rope_node));
+  if (!n)
+  {
+    release(a);
+    release(b);
+    return (0);
+  }
+  n->refs = 1;
+  n->len = a->len + b->len;
+  n->capacity = 0;
+  n->height = (a->height > b->height ? a->height : b->height) + 1;
+  n->left = a;
+  n->right = b;
+  n->bytes = NULL;
+  *out = n;
+  return (1);
+}
+
+/// @brief Gives the children of a concatenation, taking over the reference on
+/// it. A node nobody else references is taken apart without touching counts.
+static void unpair(rope_node *n, rope_node **a, rope_node **b)
+{
+  *a = n->left;
+  *b = n->right;
+  if (is_unique(n))
+  {
+    free(n);
+    return ;
+  }
+  retain(*a);
+  retain(*b);
+  release(n);
+}
+
+/// @brief Concatenates two trees whose heights differ by at most 2, rotating
+/// once (or twice) to bring them back within 1 of each other.
+/// @return 1 on success, 0 on allocation failure (both trees are released)
+static int  rebalance(rope_node *a, rope_node *b, rope_node **out)
+{
+  rope_node *x;
+  rope_node *y;
+  rope_node *z;
+
+  y = NULL;
+  if (height_of(b) > height_of(a) + 1)
+  {
+    unpair(b, &x, &b);
+    if (height_of(x) > height_of(b))
+      unpair(x, &x, &y);
+    if (!pair(a, x, &z))
+    {
+      release(y);
+      release(b);
+      return (0);
+    }
+  }
+  else if (height_of(a) > height_of(b) + 1)
+  {
+    unpair(a, &z, &x);
+    if (height_of(x) > height_of(z))
+      unpair(x, &y, &x);
+    if (!pair(x, b, &b))
+    {
+      release(z);
+      release(y);
+      return (0);
+    }
+    if (y && !pair(z, y, &z))
+    {
+      release(b);
+      return (0);
+    }
+    return (pair(z, b, out));
+  }
+  else
+    return (pair(a, b, out));
+  if (y && !pair(y, b, &b))
+  {
+    release(z);
+    return (0);
+  }
+  return (pair(z, b, out));
+}
+
+/// @brief Concatenates two trees of any heights: the shorter one is joined
+/// along the facing spine of the taller one, so the cost is the difference of
+/// their heights. Takes over both references (either may be empty).
+/// @return 1 on success, 0 on allocation failure (both trees are released)
+static int  join(rope_node *l, rope_node *r, rope_node **out)
+{
+  rope_node *a;
+  rope_node *b;
+
+  if (!l || !r)
+  {
+    *out = l ? l : r;
+    return (1);
+  }
+  if (l->height > r->height + 1)
+  {
+    unpair(l, &a, &b);
+    if (!join(b, r, &b))
+    {
+      release(a);
+      return (0);
+    }
+  }
+  else if (r->height > l->height + 1)
+  {
+    unpair(r, &a, &b);
+    if (!join(l, a, &a))
+    {
+      release(b);
+      return (0);
+    }
+  }
+  else
+    return (pair(l, r, out));
+  return (rebalance(a, b, out));
+}
+
+/// @brief Splits a tree into its first `pos` bytes and the rest, taking over
+/// the reference on it. Only the leaf holding `pos` is sliced, every other
+/// chunk is shared.
+/// @return 1 on success, 0 on allocation failure (the tree is released)
+static int  split(rope_node *n, ui64 pos, rope_node **l, rope_node **r)
+{
+  rope_node *a;
+  rope_node *b;
+  rope_node *m;
+
+  *l = NULL;
+  *r = NULL;
+  if (!n || !pos || pos >= n->len)
+  {
+    if (pos)
+      *l = n;
+    else
+      *r = n;
+    return (1);
+  }
+  if (n->height == 1)
+  {
+    *l = slice_leaf(n, 0, pos);
+    *r = slice_leaf(n, pos, n->len - pos);
+    release(n);
+    if (*l && *r)
+      return (1);
+    release(*l);
+    release(*r);
+    *l = NULL;
+    *r = NULL;
+    return (0);
+  }
+  unpair(n, &a, &b);
+  if (pos <= a->len)
+  {
+    if (!split(a, pos, l, &m))
+      release(b);
+    else if (join(m, b, r))
+      return (1);
+  }
+  else
+  {
+    if (!split(b, pos - a->len, &m, r))
+      release(a);
+    else if (join(a, m, l))
+      return (1);
+  }
+  release(*l);
+  release(*r);
+  *l = NULL;
+  *r = NULL;
+  return (0);
+}
+
+/// @brief Finds the leaf holding byte `pos` (which must be in the tree).
+/// @param n
+/// @param pos
+/// @param offset receives the position of `pos` inside the leaf
+/// @return the leaf
+static const rope_node  *leaf_at(const rope_node *n, ui64 pos, ui64 *offset)
+{
+  while (n->height > 1)
+  {
+    if (pos < n->left->len)
+      n = n->left;
+    else
+    {
+      pos -= n->left->len;
+      n = n->right;
+    }
+  }
+  *offset = pos;
+  return (n);
+}
+
+/// @brief Copies `len` bytes starting at `pos` into `dst`.
+static void copy_range(const rope_node *n, ui64 pos, ui64 len, char *dst)
+{
+  const rope_node *leaf;
+  ui64            offset;
+  ui64            take;
+
+  while (len)
+  {
+    leaf = leaf_at(n, pos, &offset);
+    take = leaf->len - offset < len ? leaf->len - offset : len;
+    memorycopy(dst, (void *)(leaf->bytes + offset), take);
+    dst += take;
+    pos += take;
+    len -= take;
+  }
+}
+
+/// @brief Creates an empty rope.
+/// @param
+/// @return rope or NULL on allocation failure
+rope  *new_rope(void)
+{
+  rope  *r;
+
+  r = malloc(sizeof(rope));
+  if (!r)
+    return (NULL);
+  r->root = NULL;
+  return (r);
+}
+
+/// @brief Deletes the rope and sets the pointer to NULL. Chunks still shared
+/// with other ropes are kept for them.
+/// @param r
+void  dealloc_rope(rope **r)
+{
+  if (!r || !*r)
+    return ;
+  release((*r)->root);
+  free(*r);
+  *r = NULL;
+}
+
+/// @brief Reads the length of the rope.
+/// @param r
+/// @return unsigned long long
+ui64  get_rope_len(const rope *r)
+{
+  if (!r || !r->root)
+    return (0);
+  return (r->root->len);
+}
+
+/// @brief Writes as many bytes as fit into the last chunk, in place. It is only
+/// possible when that chunk and every node above it belong to this rope alone.
+/// @return number of bytes written
+static ui64 fill_last_chunk(rope *r, const char *bytes, ui64 len)
+{
+  rope_node *spine[ROPE_MAX_HEIGHT];
+  rope_node *n;
+  ui64      add;
+  int       depth;
+
+  if (!r->root || r->root->height > ROPE_MAX_HEIGHT)
+    return (0);
+  depth = 0;
+  for (n = r->root; n->height > 1; n = n->right)
+  {
+    if (!is_unique(n))
+      return (0);
+    spine[depth++] = n;
+  }
+  if (!is_unique(n) || n->right || n->len >= n->capacity)
+    return (0);
+  add = n->capacity - n->len < len ? n->capacity - n->len : len;
+  memorycopy(n->data + n->len, (void *)bytes, add);
+  n->len += add;
+  while (depth)
+    spine[--depth]->len += add;
+  return (add);
+}
+
+/// @brief Replaces the tree of the rope by `l` + `m` + `r`, taking over the
+/// three references. On allocation failure the rope is left unchanged.
+static void set_root(rope *rp, rope_node *l, rope_node *m, rope_node *r)
+{
+  rope_node *root;
+
+  if (!join(l, m, &root))
+  {
+    release(r);
+    return ;
+  }
+  if (!join(root, r, &root))
+    return ;
+  release(rp->root);
+  rp->root = root;
+}
+
+/// @brief Appends raw bytes: the last chunk is filled in place first, then the
+/// rest goes into a new chunk sized after the rope (see ROPE_CHUNK_SIZE).
+static void append_bytes_to_rope(rope *r, const char *bytes, ui64 len)
+{
+  rope_node *leaf;
+  ui64      capacity;
+  ui64      done;
+
+  if (!len || get_rope_len(r) + len < len)
+    return ;
+  done = fill_last_chunk(r, bytes, len);
+  if (done == len)
+    return ;
+  capacity = get_rope_len(r) / 8;
+  if (capacity < ROPE_CHUNK_SIZE)
+    capacity = ROPE_CHUNK_SIZE;
+  if (capacity > ROPE_CHUNK_MAX)
+    capacity = ROPE_CHUNK_MAX;
+  if (capacity < len - done)
+    capacity = len - done;
+  leaf = new_leaf(bytes + done, len - done, capacity);
+  if (!leaf)
+    return ;
+  set_root(r, retain(r->root), leaf, NULL);
+}
+
+/// @brief Appends the given value argument to the rope, like String()->append.
+/// @param r
+/// @param val typed_value containing type and value
+void  append_to_rope(rope *r, typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+
+  if (!r || val.type == TYPE_PATTERN || !typed_value_bytes(val, buf, &bytes, &len))
+    return ;
+  append_bytes_to_rope(r, bytes, len);
+}
+
+/// @brief Appends the content of `src` to `dst` in O(log n), sharing the chunks
+/// of `src` instead of copying them. Both may be the same rope.
+/// @param dst
+/// @param src
+void  concat_rope(rope *dst, const rope *src)
+{
+  if (!dst || !src || !src->root)
+    return ;
+  set_root(dst, retain(dst->root), retain(src->root), NULL);
+}
+
+/// @brief Inserts the given value argument at byte `pos` in O(log n): the tree
+/// is split at `pos` and joined back around a chunk holding the value.
+/// @param r
+/// @param pos positions past the end append
+/// @param val typed_value containing type and value
+void  insert_into_rope(rope *r, ui64 pos, typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  rope_node   *leaf;
+  rope_node   *left;
+  rope_node   *right;
+
+  if (!r || val.type == TYPE_PATTERN || !typed_value_bytes(val, buf, &bytes, &len)
+    || !len || get_rope_len(r) + len < len)
+    return ;
+  if (pos >= get_rope_len(r))
+  {
+    append_bytes_to_rope(r, bytes, len);
+    return ;
+  }
+  leaf = new_leaf(bytes, len, len);
+  if (!leaf)
+    return ;
+  if (!split(retain(r->root), pos, &left, &right))
+  {
+    release(leaf);
+    return ;
+  }
+  set_root(r, left, leaf, right);
+}
+
+/// @brief Creates a rope holding `len` bytes of `r` starting at `start`, in
+/// O(log n): the chunks are shared, only the two at the ends are sliced.
+/// @param r
+/// @param start
+/// @param len clamped to the end of the rope
+/// @return rope or NULL on allocation failure or NULL rope
+rope  *substring_rope(const rope *r, ui64 start, ui64 len)
+{
+  rope      *sub;
+  rope_node *head;
+  rope_node *tail;
+
+  if (!r)
+    return (NULL);
+  sub = new_rope();
+  if (!sub || start >= get_rope_len(r) || !len)
+    return (sub);
+  if (!split(retain(r->root), start, &head, &tail))
+  {
+    dealloc_rope(&sub);
+    return (NULL);
+  }
+  release(head);
+  if (!split(tail, len, &sub->root, &tail))
+  {
+    dealloc_rope(&sub);
+    return (NULL);
+  }
+  release(tail);
+  return (sub);
+}
+
+/// @brief Iterates over the chunks of the rope in order. `it` is the position
+/// of the next byte to read: start it at 0, a chunk is given from there to the
+/// end of the chunk holding it (so it can also resume mid-chunk).
+/// @param r
+/// @param it
+/// @param chunk receives a view of the chunk, valid until the rope changes
+/// @return 1 if a chunk was given, 0 past the end
+/// @attention i.e: 'for (it = 0; Rope()->next(r, &it, &chunk);) use(chunk)'
+int next_rope_chunk(const rope *r, ui64 *it, string_view *chunk)
+{
+  const rope_node *leaf;
+  ui64            offset;
+
+  if (!r || !it || !chunk || *it >= get_rope_len(r))
+    return (0);
+  leaf = leaf_at(r->root, *it, &offset);
+  chunk->ptr = leaf->bytes + offset;
+  chunk->len = leaf->len - offset;
+  *it += chunk->len;
+  return (1);
+}
+
+/// @brief Returns the index of the first match of the given value argument at
+/// or after `from` (a TYPE_PATTERN value reuses its precompiled search tables
+/// inside chunks). Each chunk is searched in place, and matches crossing into
+/// the next chunks are looked for in a copy of the bytes around the boundary
+/// (at most twice the needle length).
+/// @param r
+/// @param val typed_value containing type and value
+/// @param from first index considered (negative values start at 0)
+/// @return index of the match or -1 (an empty needle never matches)
+i64 index_of_rope_from(const rope *r, typed_value val, i64 from)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  char        small[256];
+  char        *window;
+  const char  *needle;
+  ui64        len;
+  ui64        it;
+  ui64        start;
+  ui64        end;
+  string_view chunk;
+  i64         found;
+
+  if (!r)
+    return (-1);
+  if (val.type == TYPE_PATTERN)
+  {
+    if (!val.as_pattern)
+      return (-1);
+    needle = pattern_needle(val.as_pattern, &len);
+  }
+  else if (!typed_value_bytes(val, buf, &needle, &len))
+    return (-1);
+  if (from < 0)
+    from = 0;
+  if (!len || (ui64)from > get_rope_len(r)
+    || len > get_rope_len(r) - (ui64)from)
+    return (-1);
+  window = len <= sizeof(small) / 2 ? small : malloc(2 * len);
+  if (!window)
+    return (-1);
+  found = -1;
+  it = (ui64)from;
+  while (found < 0 && next_rope_chunk(r, &it, &chunk))
+  {
+    start = it - chunk.len;
+    if (val.type == TYPE_PATTERN)
+      found = Pattern()->find(val.as_pattern, chunk.ptr, chunk.len, 0);
+    else
+      found = search_forward(chunk.ptr, chunk.len, needle, len, 0);
+    if (found >= 0)
+      found += (i64)start;
+    else if (len > 1 && it < get_rope_len(r))
+    {
+      start = it - (len - 1 < chunk.len ? len - 1 : chunk.len);
+      end = it + len - 1 < get_rope_len(r) ? it + len - 1 : get_rope_len(r);
+      copy_range(r->root, start, end - start, window);
+      found = search_forward(window, end - start, needle, len, 0);
+      if (found >= 0)
+        found += (i64)start;
+    }
+  }
+  if (window != small)
+    free(window);
+  return (found);
+}
+
+/// @brief Returns the index of the first match of the given value argument.
+/// @param r
+/// @param val typed_value containing type and value
+/// @return index of the match or -1
+i64 index_of_rope(const rope *r, typed_value val)
+{
+  return (index_of_rope_from(r, val, 0));
+}
+
+/// @brief Copies the whole rope into a new contiguous string. Meant to be done
+/// once, when a single buffer is really needed.
+/// @param r
+/// @return string or NULL on allocation failure or NULL rope
+string  *flatten_rope(const rope *r)
+{
+  string  *str;
+
+  if (!r)
+    return (NULL);
+  str = new_string_len(heap_allocator(), "", 0);
+  if (!str || !String()->reserve(str, get_rope_len(r)))
+  {
+    String()->del(&str);
+    return (NULL);
+  }
+  if (r->root)
+    copy_range(r->root, 0, r->root->len, str->s);
+  str->len = get_rope_len(r);
+  str->s[str->len] = '\0';
+  return (str);
+}
+
+/// @brief Writes the rope into the file descriptor with writev, up to
+/// WRITE_IOV_MAX chunks per call and nothing copied. Short writes and EINTR are
+/// resumed where they stopped.
+/// @param fd
+/// @param r
+/// @return 1 on success, 0 on error (errno tells which)
+int write_rope(int fd, const rope *r)
+{
+  struct iovec  iov[WRITE_IOV_MAX];
+  string_view   chunk;
+  ui64          it;
+  int           count;
+
+  if (!r)
+    return (write_fully(fd, &(struct iovec){"NULL", 4}, 1));
+  it = 0;
+  while (it < get_rope_len(r))
+  {
+    for (count = 0; count < WRITE_IOV_MAX && next_rope_chunk(r, &it, &chunk); count++)
+    {
+      iov[count].iov_base = (void *)chunk.ptr;
+      iov[count].iov_len = chunk.len;
+    }
+    if (!write_fully(fd, iov, count))
+      return (0);
+  }
+  return (1);
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the rope type.
+/// @param
+/// @return rope_funcs
+const rope_funcs  *Rope(void)
+{
+  static const rope_funcs rope_functions = {
+    .new = &new_rope,
+    .del = &dealloc_rope,
+    .len = &get_rope_len,
+    .append = &append_to_rope,
+    .concat = &concat_rope,
+    .insert = &insert_into_rope,
+    .substring = &substring_rope,
+    .next = &next_rope_chunk,
+    .index_of = &index_of_rope,
+    .index_of_from = &index_of_rope_from,
+    .flatten = &flatten_rope,
+    .write = &write_rope
+  };
+
+  return (&rope_functions);
+}
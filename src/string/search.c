@@ -0,0 +1,658 @@
+#include "string_internal.h"
+#include <types/search.h>
+
+# if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#  define SEARCH_X86 1
+# endif
+
+typedef enum {
+  SEARCH_BYTE,
+  SEARCH_FILTER,
+  SEARCH_HORSPOOL,
+  SEARCH_TWOWAY
+} search_kind;
+
+// Critical factorization of a needle, as used by the Two-Way algorithm
+typedef struct {
+  ui64  ms;
+  ui64  period;
+  ui64  mem0;
+} twoway_params;
+
+// A needle compiled once with every table its search strategies need, so the
+// same needle can be looked for many times without any setup cost.
+struct pattern {
+  unsigned char *needle;
+  ui64          len;
+  search_kind   kind;
+  search_kind   rkind;
+  twoway_params tw;
+  ui64          shift[256];
+  ui64          rshift[256];
+};
+
+typedef ui64 __attribute__((may_alias, aligned(1)))  uword;
+
+/// @brief Compares `n` bytes, a word at a time.
+/// @return 1 if equal, 0 otherwise
+static int  bytes_equal(const unsigned char *a, const unsigned char *b, ui64 n)
+{
+  while (n >= 8)
+  {
+    if (*(const uword *)a != *(const uword *)b)
+      return (0);
+    a += 8;
+    b += 8;
+    n -= 8;
+  }
+  while (n--)
+  {
+    if (*a++ != *b++)
+      return (0);
+  }
+  return (1);
+}
+
+/// @brief Tells if the SIMD filter can run on this CPU.
+static int  has_filter(void)
+{
+# ifdef SEARCH_X86
+  return (cpu_supports(CPU_SSE2));
+# else
+  return (0);
+# endif
+}
+
+/// @brief Picks the forward strategy from the needle length.
+static search_kind  forward_kind(ui64 m)
+{
+  if (m == 1)
+    return (SEARCH_BYTE);
+  if (m <= SEARCH_FILTER_MAX && has_filter())
+    return (SEARCH_FILTER);
+  if (m < SEARCH_TWOWAY_MIN)
+    return (SEARCH_HORSPOOL);
+  return (SEARCH_TWOWAY);
+}
+
+/// @brief Picks the backward strategy from the needle length.
+static search_kind  backward_kind(ui64 m)
+{
+  if (m == 1)
+    return (SEARCH_BYTE);
+  if (m <= SEARCH_FILTER_MAX && has_filter())
+    return (SEARCH_FILTER);
+  return (SEARCH_HORSPOOL);
+}
+
+// ============================================================================
+// First/last byte filter
+// ============================================================================
+
+/// @brief Checks the candidates left by the vector loops one position at a time.
+static i64  filter_forward_tail(const unsigned char *h, ui64 n,
+  const unsigned char *nd, ui64 m, ui64 i)
+{
+  for (; i + m <= n; i++)
+  {
+    if (h[i] == nd[0] && h[i + m - 1] == nd[m - 1]
+      && bytes_equal(h + i + 1, nd + 1, m - 2))
+      return ((i64)i);
+  }
+  return (-1);
+}
+
+/// @brief Checks the candidates left by the vector loops, from `j` down to 0.
+static i64  filter_backward_tail(const unsigned char *h,
+  const unsigned char *nd, ui64 m, i64 j)
+{
+  for (; j >= 0; j--)
+  {
+    if (h[j] == nd[0] && h[j + m - 1] == nd[m - 1]
+      && bytes_equal(h + j + 1, nd + 1, m - 2))
+      return (j);
+  }
+  return (-1);
+}
+
+# ifdef SEARCH_X86
+
+__attribute__((target("sse2")))
+static i64  filter_forward_sse2(const unsigned char *h, ui64 n,
+  const unsigned char *nd, ui64 m, ui64 i)
+{
+  __m128i   first;
+  __m128i   last;
+  unsigned  mask;
+
+  first = _mm_set1_epi8((char)nd[0]);
+  last = _mm_set1_epi8((char)nd[m - 1]);
+  while (i + m - 1 + 16 <= n)
+  {
+    mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(
+      _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(h + i))),
+      _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i *)(h + i + m - 1)))));
+    while (mask)
+    {
+      if (bytes_equal(h + i + __builtin_ctz(mask) + 1, nd + 1, m - 2))
+        return ((i64)(i + __builtin_ctz(mask)));
+      mask &= mask - 1;
+    }
+    i += 16;
+  }
+  return (filter_forward_tail(h, n, nd, m, i));
+}
+
+__attribute__((target("sse2")))
+static i64  filter_backward_sse2(const unsigned char *h,
+  const unsigned char *nd, ui64 m, i64 j)
+{
+  __m128i   first;
+  __m128i   last;
+  unsigned  mask;
+  int       bit;
+
+  first = _mm_set1_epi8((char)nd[0]);
+  last = _mm_set1_epi8((char)nd[m - 1]);
+  while (j >= 15)
+  {
+    mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(
+      _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(h + j - 15))),
+      _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i *)(h + j - 15 + m - 1)))));
+    while (mask)
+    {
+      bit = 31 - __builtin_clz(mask);
+      if (bytes_equal(h + j - 15 + bit + 1, nd + 1, m - 2))
+        return (j - 15 + bit);
+      mask &= ~(1u << bit);
+    }
+    j -= 16;
+  }
+  return (filter_backward_tail(h, nd, m, j));
+}
+
+__attribute__((target("avx2")))
+static i64  filter_forward_avx2(const unsigned char *h, ui64 n,
+  const unsigned char *nd, ui64 m, ui64 i)
+{
+  __m256i   first;
+  __m256i   last;
+  unsigned  mask;
+
+  first = _mm256_set1_epi8((char)nd[0]);
+  last = _mm256_set1_epi8((char)nd[m - 1]);
+  while (i + m - 1 + 32 <= n)
+  {
+    mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(
+      _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(h + i))),
+      _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i *)(h + i + m - 1)))));
+    while (mask)
+    {
+      if (bytes_equal(h + i + __builtin_ctz(mask) + 1, nd + 1, m - 2))
+        return ((i64)(i + __builtin_ctz(mask)));
+      mask &= mask - 1;
+    }
+    i += 32;
+  }
+  _mm256_zeroupper();
+  return (filter_forward_tail(h, n, nd, m, i));
+}
+
+__attribute__((target("avx2")))
+static i64  filter_backward_avx2(const unsigned char *h,
+  const unsigned char *nd, ui64 m, i64 j)
+{
+  __m256i   first;
+  __m256i   last;
+  unsigned  mask;
+  int       bit;
+
+  first = _mm256_set1_epi8((char)nd[0]);
+  last = _mm256_set1_epi8((char)nd[m - 1]);
+  while (j >= 31)
+  {
+    mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(
+      _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(h + j - 31))),
+      _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i *)(h + j - 31 + m - 1)))));
+    while (mask)
+    {
+      bit = 31 - __builtin_clz(mask);
+      if (bytes_equal(h + j - 31 + bit + 1, nd + 1, m - 2))
+        return (j - 31 + bit);
+      mask &= ~(1u << bit);
+    }
+    j -= 32;
+  }
+  _mm256_zeroupper();
+  return (filter_backward_tail(h, nd, m, j));
+}
+
+# endif
+
+/// @brief Finds the first candidate whose first and last bytes match, 16 or 32
+/// positions per step, and only then compares the middle of the needle.
+static i64  filter_forward(const unsigned char *h, ui64 n,
+  const unsigned char *nd, ui64 m, ui64 from)
+{
+# ifdef SEARCH_X86
+  if (cpu_supports(CPU_AVX2))
+    return (filter_forward_avx2(h, n, nd, m, from));
+  return (filter_forward_sse2(h, n, nd, m, from));
+# else
+  return (filter_forward_tail(h, n, nd, m, from));
+# endif
+}
+
+/// @brief Mirror of filter_forward(), scanning candidates from `from` down to 0.
+static i64  filter_backward(const unsigned char *h,
+  const unsigned char *nd, ui64 m, ui64 from)
+{
+# ifdef SEARCH_X86
+  if (cpu_supports(CPU_AVX2))
+    return (filter_backward_avx2(h, nd, m, (i64)from));
+  return (filter_backward_sse2(h, nd, m, (i64)from));
+# else
+  return (filter_backward_tail(h, nd, m, (i64)from));
+# endif
+}
+
+// ============================================================================
+// Boyer-Moore-Horspool
+// ============================================================================
+
+/// @brief Bad character table: how far the window can move when its last byte is c.
+static void horspool_table(ui64 *shift, const unsigned char *nd, ui64 m)
+{
+  ui64  k;
+
+  for (k = 0; k < 256; k++)
+    shift[k] = m;
+  for (k = 0; k + 1 < m; k++)
+    shift[nd[k]] = m - 1 - k;
+}
+
+/// @brief Backward bad character table: how far the window can move to the
+/// left when its first byte is c.
+static void horspool_rtable(ui64 *rshift, const unsigned char *nd, ui64 m)
+{
+  ui64  k;
+
+  for (k = 0; k < 256; k++)
+    rshift[k] = m;
+  for (k = m - 1; k >= 1; k--)
+    rshift[nd[k]] = k;
+}
+
+static i64  horspool_forward(const unsigned char *h, ui64 n,
+  const unsigned char *nd, ui64 m, ui64 i, const ui64 *shift)
+{
+  unsigned char last;
+  unsigned char c;
+
+  last = nd[m - 1];
+  while (i + m <= n)
+  {
+    c = h[i + m - 1];
+    if (c == last && bytes_equal(h + i, nd, m - 1))
+      return ((i64)i);
+    i += shift[c];
+  }
+  return (-1);
+}
+
+static i64  horspool_backward(const unsigned char *h,
+  const unsigned char *nd, ui64 m, i64 j, const ui64 *rshift)
+{
+  unsigned char first;
+  unsigned char c;
+
+  first = nd[0];
+  while (j >= 0)
+  {
+    c = h[j];
+    if (c == first && bytes_equal(h + j + 1, nd + 1, m - 1))
+      return (j);
+    j -= (i64)rshift[c];
+  }
+  return (-1);
+}
+
+// ============================================================================
+// Two-Way
+// ============================================================================
+
+/// @brief Computes the maximal suffix of the needle for one byte ordering.
+/// @param reverse compare with the opposite ordering
+/// @param period receives the period of the suffix
+/// @return the position right before the suffix ((ui64)-1 if it is the whole needle)
+static ui64 maximal_suffix(const unsigned char *nd, ui64 m, int reverse, ui64 *period)
+{
+  ui64  ip;
+  ui64  jp;
+  ui64  k;
+  ui64  p;
+
+  ip = (ui64)-1;
+  jp = 0;
+  k = 1;
+  p = 1;
+  while (jp + k < m)
+  {
+    if (nd[ip + k] == nd[jp + k])
+    {
+      if (k == p)
+      {
+        jp += p;
+        k = 1;
+      }
+      else
+        k++;
+    }
+    else if ((nd[ip + k] > nd[jp + k]) ^ reverse)
+    {
+      jp += k;
+      k = 1;
+      p = jp - ip;
+    }
+    else
+    {
+      ip = jp++;
+      k = 1;
+      p = 1;
+    }
+  }
+  *period = p;
+  return (ip);
+}
+
+/// @brief Critical factorization of the needle and the shift table used to skip
+/// over bytes the needle doesn't contain (shift[c] is the last index of c plus 1).
+static void twoway_prepare(twoway_params *tw, ui64 *shift,
+  const unsigned char *nd, ui64 m)
+{
+  ui64  ms;
+  ui64  ms2;
+  ui64  p;
+  ui64  p2;
+  ui64  k;
+
+  for (k = 0; k < 256; k++)
+    shift[k] = 0;
+  for (k = 0; k < m; k++)
+    shift[nd[k]] = k + 1;
+  ms = maximal_suffix(nd, m, 0, &p);
+  ms2 = maximal_suffix(nd, m, 1, &p2);
+  if (ms2 + 1 > ms + 1)
+  {
+    ms = ms2;
+    p = p2;
+  }
+  if (!bytes_equal(nd, nd + p, ms + 1))
+  {
+    tw->mem0 = 0;
+    p = (ms > m - ms - 1 ? ms : m - ms - 1) + 1;
+  }
+  else
+    tw->mem0 = m - p;
+  tw->ms = ms;
+  tw->period = p;
+}
+
+static i64  twoway_forward(const unsigned char *h, ui64 n,
+  const unsigned char *nd, ui64 m, ui64 i,
+  const twoway_params *tw, const ui64 *shift)
+{
+  ui64  mem;
+  ui64  k;
+
+  mem = 0;
+  while (i + m <= n)
+  {
+    k = m - shift[h[i + m - 1]];
+    if (k)
+    {
+      i += (k < mem ? mem : k);
+      mem = 0;
+      continue ;
+    }
+    k = (tw->ms + 1 > mem ? tw->ms + 1 : mem);
+    while (k < m && nd[k] == h[i + k])
+      k++;
+    if (k < m)
+    {
+      i += k - tw->ms;
+      mem = 0;
+      continue ;
+    }
+    k = tw->ms + 1;
+    while (k > mem && nd[k - 1] == h[i + k - 1])
+      k--;
+    if (k <= mem)
+      return ((i64)i);
+    i += tw->period;
+    mem = tw->mem0;
+  }
+  return (-1);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/// @brief Finds the first occurrence of `needle` in `hay` starting at or after
+/// `from`. The strategy is picked from the needle length: a vectorized byte scan,
+/// the SIMD first/last byte filter, Boyer-Moore-Horspool or Two-Way.
+/// @param hay 
+/// @param hay_len 
+/// @param needle 
+/// @param needle_len 
+/// @param from 
+/// @return index of the match or -1 (an empty needle never matches)
+i64 search_forward(const char *hay, ui64 hay_len,
+  const char *needle, ui64 needle_len, ui64 from)
+{
+  const unsigned char *h;
+  const unsigned char *nd;
+  const unsigned char *hit;
+  ui64                shift[256];
+  twoway_params       tw;
+
+  if (!hay || !needle || !needle_len || from > hay_len
+    || needle_len > hay_len - from)
+    return (-1);
+  h = (const unsigned char *)hay;
+  nd = (const unsigned char *)needle;
+  switch (forward_kind(needle_len))
+  {
+    case SEARCH_BYTE:
+      hit = memorychr(h + from, nd[0], hay_len - from);
+      return (hit ? (i64)(hit - h) : -1);
+    case SEARCH_FILTER:
+      return (filter_forward(h, hay_len, nd, needle_len, from));
+    case SEARCH_HORSPOOL:
+      horspool_table(shift, nd, needle_len);
+      return (horspool_forward(h, hay_len, nd, needle_len, from, shift));
+    default:
+      twoway_prepare(&tw, shift, nd, needle_len);
+      return (twoway_forward(h, hay_len, nd, needle_len, from, &tw, shift));
+  }
+}
+
+/// @brief Finds the last occurrence of `needle` in `hay` that starts at or before
+/// `from` (clamped to the last possible start).
+/// @param hay 
+/// @param hay_len 
+/// @param needle 
+/// @param needle_len 
+/// @param from 
+/// @return index of the match or -1 (an empty needle never matches)
+i64 search_backward(const char *hay, ui64 hay_len,
+  const char *needle, ui64 needle_len, ui64 from)
+{
+  const unsigned char *h;
+  const unsigned char *nd;
+  const unsigned char *hit;
+  ui64                rshift[256];
+
+  if (!hay || !needle || !needle_len || needle_len > hay_len)
+    return (-1);
+  if (from > hay_len - needle_len)
+    from = hay_len - needle_len;
+  h = (const unsigned char *)hay;
+  nd = (const unsigned char *)needle;
+  switch (backward_kind(needle_len))
+  {
+    case SEARCH_BYTE:
+      hit = memoryrchr(h, nd[0], from + 1);
+      return (hit ? (i64)(hit - h) : -1);
+    case SEARCH_FILTER:
+      return (filter_backward(h, nd, needle_len, from));
+    default:
+      horspool_rtable(rshift, nd, needle_len);
+      return (horspool_backward(h, nd, needle_len, (i64)from, rshift));
+  }
+}
+
+/// @brief Compiles a needle once: it is copied and every table its forward and
+/// backward strategies need is built up front.
+/// @param val typed_value holding the needle (TYPE_PATTERN is not accepted)
+/// @return pattern or NULL if the needle is empty or allocation failed
+pattern *new_pattern(typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  pattern     *pat;
+
+  if (val.type == TYPE_PATTERN || !typed_value_bytes(val, buf, &bytes, &len) || !len)
+    return (NULL);
+  pat = malloc(sizeof(pattern));
+  if (!pat)
+    return (NULL);
+  pat->needle = malloc(len + 1);
+  if (!pat->needle)
+  {
+    free(pat);
+    return (NULL);
+  }
+  memorycopy(pat->needle, (void *)bytes, len);
+  pat->needle[len] = '\0';
+  pat->len = len;
+  pat->kind = forward_kind(len);
+  pat->rkind = backward_kind(len);
+  if (pat->kind == SEARCH_TWOWAY)
+    twoway_prepare(&pat->tw, pat->shift, pat->needle, len);
+  else if (pat->kind == SEARCH_HORSPOOL)
+    horspool_table(pat->shift, pat->needle, len);
+  if (pat->rkind == SEARCH_HORSPOOL)
+    horspool_rtable(pat->rshift, pat->needle, len);
+  return (pat);
+}
+
+/// @brief Frees the pattern and sets the pointer to NULL.
+/// @param pat 
+void  dealloc_pattern(pattern **pat)
+{
+  if (!pat || !*pat)
+    return ;
+  free((*pat)->needle);
+  free(*pat);
+  *pat = NULL;
+}
+
+/// @brief Reads the needle length of the pattern.
+/// @param pat 
+/// @return unsigned long long
+ui64  get_pattern_len(const pattern *pat)
+{
+  if (!pat)
+    return (0);
+  return (pat->len);
+}
+
+/// @brief Finds the first occurrence of the compiled needle in `hay` starting at
+/// or after `from`.
+/// @param pat 
+/// @param hay 
+/// @param hay_len 
+/// @param from 
+/// @return index of the match or -1
+i64 find_pattern(const pattern *pat, const char *hay, ui64 hay_len, ui64 from)
+{
+  const unsigned char *h;
+  const unsigned char *hit;
+
+  if (!pat || !hay || from > hay_len || pat->len > hay_len - from)
+    return (-1);
+  h = (const unsigned char *)hay;
+  switch (pat->kind)
+  {
+    case SEARCH_BYTE:
+      hit = memorychr(h + from, pat->needle[0], hay_len - from);
+      return (hit ? (i64)(hit - h) : -1);
+    case SEARCH_FILTER:
+      return (filter_forward(h, hay_len, pat->needle, pat->len, from));
+    case SEARCH_HORSPOOL:
+      return (horspool_forward(h, hay_len, pat->needle, pat->len, from, pat->shift));
+    default:
+      return (twoway_forward(h, hay_len, pat->needle, pat->len, from,
+        &pat->tw, pat->shift));
+  }
+}
+
+/// @brief Finds the last occurrence of the compiled needle in `hay` that starts
+/// at or before `from`.
+/// @param pat 
+/// @param hay 
+/// @param hay_len 
+/// @param from 
+/// @return index of the match or -1
+i64 rfind_pattern(const pattern *pat, const char *hay, ui64 hay_len, ui64 from)
+{
+  const unsigned char *h;
+  const unsigned char *hit;
+
+  if (!pat || !hay || pat->len > hay_len)
+    return (-1);
+  if (from > hay_len - pat->len)
+    from = hay_len - pat->len;
+  h = (const unsigned char *)hay;
+  switch (pat->rkind)
+  {
+    case SEARCH_BYTE:
+      hit = memoryrchr(h, pat->needle[0], from + 1);
+      return (hit ? (i64)(hit - h) : -1);
+    case SEARCH_FILTER:
+      return (filter_backward(h, pat->needle, pat->len, from));
+    default:
+      return (horspool_backward(h, pat->needle, pat->len, (i64)from, pat->rshift));
+  }
+}
+
+/// @brief Gives the bytes the pattern was compiled from.
+/// @param pat 
+/// @param len receives the needle length
+/// @return the needle
+const char  *pattern_needle(const pattern *pat, ui64 *len)
+{
+  *len = pat->len;
+  return ((const char *)pat->needle);
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the pattern type.
+/// @param  
+/// @return pattern_funcs
+const pattern_funcs *Pattern(void)
+{
+  static const pattern_funcs  pattern_functions = {
+    .new = &new_pattern,
+    .del = &dealloc_pattern,
+    .len = &get_pattern_len,
+    .find = &find_pattern,
+    .rfind = &rfind_pattern
+  };
+
+  return (&pattern_functions);
+}
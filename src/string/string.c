@@ -1,47 +1,252 @@
-#include <types/string.h>
+#include "string_internal.h"
+#include "../io/io_internal.h"
+#include <types/search.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
-struct string {
-  char  *s;
-  ui64  len;
-  ui64  capacity;
-};
+/// @brief Tells if the string content is stored inline in the struct.
+/// @param str 
+/// @return 1 or 0
+static int  is_inline(const string *str)
+{
+  return (str->s == str->sso);
+}
 
-/// @brief This function aims to initialize a new string by using the pointer to char passed as parameter.
-/// @param s 
-/// @return string (i.e: 'new_string("hello")-> string(hello)')
-string  *new_string(char *s)
+/// @brief Returns the header in front of a heap buffer.
+/// @param str 
+/// @return string_buffer
+static string_buffer  *buffer_of(const string *str)
 {
-  string  *str;
+  return ((string_buffer *)(str->s - sizeof(string_buffer)));
+}
 
-  str = calloc(1, sizeof(string));
-  if (!str)
+/// @brief Tells if the heap buffer of the string is also used by other strings,
+/// in which case it must not be written.
+/// @param str 
+/// @return 1 or 0
+static int  is_shared(const string *str)
+{
+  return (!is_inline(str)
+    && __atomic_load_n(&buffer_of(str)->refs, __ATOMIC_ACQUIRE) > 1);
+}
+
+/// @brief Allocates a heap buffer for `capacity` characters plus the terminator,
+/// referenced by a single string.
+/// @param alloc 
+/// @param capacity 
+/// @return the characters of the buffer or NULL on allocation failure
+static char *alloc_buffer(const allocator *alloc, ui64 capacity)
+{
+  string_buffer *buf;
+
+  buf = alloc->alloc(alloc->ctx, sizeof(string_buffer) + capacity + 1);
+  if (!buf)
     return (NULL);
+  buf->refs = 1;
+  return (buf->data);
+}
 
-  str->len = stringlen(s);
-  str->capacity = str->len;
-  str->s = calloc(1, str->len + 1);
+/// @brief Drops the reference the string holds on its heap buffer, the last
+/// reference frees it (or unmaps it, for a mapped file). A buffer that is not
+/// shared is freed without any atomic read-modify-write.
+/// @param str 
+static void release_buffer(string *str)
+{
+  const allocator *alloc;
+  string_buffer   *buf;
+  ui64            refs;
 
-  if (!str->s)
+  alloc = str->alloc;
+  buf = buffer_of(str);
+  refs = 0;
+  if (__atomic_load_n(&buf->refs, __ATOMIC_ACQUIRE) != 1)
+    refs = __atomic_sub_fetch(&buf->refs, 1, __ATOMIC_ACQ_REL);
+  if (refs == STRING_BUFFER_MAPPED)
+    unmap_buffer(buf, str->capacity);
+  else if (!refs && alloc->free)
+    alloc->free(alloc->ctx, buf, sizeof(string_buffer) + str->capacity + 1);
+}
+
+/// @brief Computes the capacity a string should grow to in order to hold at least
+/// `needed` characters. The buffer grows by 1.5x (never below STRING_MIN_CAPACITY),
+/// which keeps a sequence of appends amortized O(1).
+/// @param capacity current capacity
+/// @param needed minimum number of characters that must fit
+/// @return the new capacity, excluding the terminator
+static ui64 grow_capacity(ui64 capacity, ui64 needed)
+{
+  ui64  new_capacity;
+
+  new_capacity = capacity + (capacity >> 1);
+  if (new_capacity < capacity || new_capacity < needed)
+    new_capacity = needed;
+  if (new_capacity < STRING_MIN_CAPACITY)
+    new_capacity = STRING_MIN_CAPACITY;
+  if (new_capacity + 1 < new_capacity)
+    new_capacity = needed;
+  return (new_capacity);
+}
+
+/// @brief Moves the string content into a buffer of exactly `capacity` characters
+/// (plus the terminator). Inline strings are moved out of the struct the first
+/// time they outgrow it, and strings sharing their buffer move into a copy of
+/// their own.
+/// @param str 
+/// @param capacity at least the length of the string
+/// @return 1 on success, 0 on allocation failure
+static int  resize_buffer(string *str, ui64 capacity)
+{
+  const allocator *alloc;
+  string_buffer   *buf;
+  char            *ptr;
+
+  alloc = str->alloc;
+  if (is_inline(str) || is_shared(str))
   {
-    free(str);
+    ptr = alloc_buffer(alloc, capacity);
+    if (!ptr)
+      return (0);
+    memorycopy(ptr, str->s, str->len + 1);
+    if (!is_inline(str))
+      release_buffer(str);
+  }
+  else
+  {
+    buf = alloc->resize(alloc->ctx, buffer_of(str),
+      sizeof(string_buffer) + str->capacity + 1,
+      sizeof(string_buffer) + capacity + 1);
+    if (!buf)
+      return (0);
+    ptr = buf->data;
+  }
+  str->s = ptr;
+  str->capacity = capacity;
+  return (1);
+}
+
+/// @brief Makes sure the string can hold `needed` characters plus the terminator,
+/// growing the buffer geometrically when it can't. Every function that writes
+/// the content goes through here, so a shared buffer is copied before it is
+/// written (copy-on-write).
+/// @param str 
+/// @param needed 
+/// @return 1 on success, 0 on overflow or allocation failure
+static int  ensure_capacity(string *str, ui64 needed)
+{
+  if (needed <= str->capacity)
+  {
+    if (!is_shared(str))
+      return (1);
+    return (resize_buffer(str, str->capacity));
+  }
+  if (needed + 1 < needed)
+    return (0);
+  return (resize_buffer(str, grow_capacity(str->capacity, needed)));
+}
+
+/// @brief Tells how many characters can be written past the content of the
+/// string without growing or copying its buffer: none while it is shared.
+/// @param str 
+/// @return number of spare characters, the terminator excluded
+ui64  string_spare(const string *str)
+{
+  if (is_shared(str))
+    return (0);
+  return (str->capacity - str->len);
+}
+
+/// @brief Makes room for `add_len` characters past the content, the way append
+/// grows the string (a shared buffer is copied first).
+/// @param str 
+/// @param add_len 
+/// @return 1 on success, 0 on overflow or allocation failure
+int reserve_spare(string *str, ui64 add_len)
+{
+  if (str->len + add_len < str->len)
+    return (0);
+  return (ensure_capacity(str, str->len + add_len));
+}
+
+/// @brief Creates a string holding a copy of the first `len` bytes of `s`, with
+/// the struct and buffer taken from `alloc`. Short contents are stored inline so
+/// only the struct itself is allocated.
+/// @param alloc 
+/// @param s 
+/// @param len 
+/// @return string or NULL on allocation failure
+string  *new_string_len(const allocator *alloc, const char *s, ui64 len)
+{
+  string  *str;
+
+  str = alloc->alloc(alloc->ctx, sizeof(string));
+  if (!str)
     return (NULL);
+  str->len = len;
+  str->alloc = alloc;
+  str->hash = 0;
+  if (len <= STRING_SSO_CAPACITY)
+  {
+    str->s = str->sso;
+    str->capacity = STRING_SSO_CAPACITY;
+  }
+  else
+  {
+    str->s = alloc_buffer(alloc, len);
+    if (!str->s)
+    {
+      if (alloc->free)
+        alloc->free(alloc->ctx, str, sizeof(string));
+      return (NULL);
+    }
+    str->capacity = len;
   }
-  memorycopy(str->s, s, str->len);
+  memorycopy(str->s, (void *)s, len);
+  str->s[len] = '\0';
   return (str);
 }
 
+/// @brief This function aims to initialize a new string by using the pointer to char passed as parameter.
+/// @param s 
+/// @return string (i.e: 'new_string("hello")-> string(hello)')
+string  *new_string(char *s)
+{
+  return (new_string_len(heap_allocator(), s, stringlen(s)));
+}
+
+/// @brief Same as new_string, but the string (and every buffer it grows into)
+/// is allocated from `alloc`, i.e: 'new_string_in(Arena()->allocator(a), "hello")'.
+/// @param alloc allocator to use, NULL for the heap
+/// @param s 
+/// @return string or NULL on allocation failure
+string  *new_string_in(const allocator *alloc, char *s)
+{
+  if (!alloc)
+    alloc = heap_allocator();
+  return (new_string_len(alloc, s, stringlen(s)));
+}
+
 /// @brief Takes a pointer to a pointer to a string and deallocates the internal string,
 /// set the memory to zero and the pointer to pointer to string to NULL. This allows to
 /// avoid segmentation faults due to read after free or double free. It can still segfaults
-/// if deferencing after calling this function.
+/// if deferencing after calling this function. Strings whose allocator frees in bulk
+/// (i.e: arena strings) are left untouched, only the pointer is cleared. A buffer
+/// shared with other strings is only freed with the last of them.
 /// @param str 
 void  dealloc_string(string **str)
 {
+  const allocator *alloc;
+
   if (!str || !*str)
     return ;
-  free((*str)->s);
-  memoryset(*str, 0, sizeof(string));
-  free(*str);
+  alloc = (*str)->alloc;
+  if (!is_inline(*str))
+    release_buffer(*str);
+  if (alloc->free)
+  {
+    memoryset(*str, 0, sizeof(string));
+    alloc->free(alloc->ctx, *str, sizeof(string));
+  }
   *str = NULL;
 }
 
@@ -55,44 +260,229 @@ ui64  get_string_len(const string *str)
   return (str->len);
 }
 
-/// @brief It writes the given string into the file descriptor given as argument.
-/// @param fd 
+/// @brief Reads how many characters the string can hold before it needs to grow.
+/// @param str 
+/// @return unsigned long long, the terminator is not counted.
+ui64  get_string_capacity(const string *str)
+{
+  if (!str)
+    return (0);
+  return (str->capacity);
+}
+
+/// @brief Grows the string buffer so it can hold at least `capacity` characters
+/// without reallocating. It never shrinks the buffer.
 /// @param str 
-void  print_string(int fd, const string *str)
+/// @param capacity 
+/// @return 1 on success, 0 on allocation failure or NULL string
+int  reserve_string(string *str, ui64 capacity)
 {
   if (!str || !str->s)
+    return (0);
+  if (capacity <= str->capacity)
+    return (1);
+  if (capacity + 1 < capacity)
+    return (0);
+  return (resize_buffer(str, capacity));
+}
+
+/// @brief Releases the unused capacity of the string, so the buffer is exactly
+/// as big as its content plus the terminator. Contents short enough to be
+/// stored inline are moved back into the struct. A shared buffer is left as is,
+/// shrinking it would mean copying it.
+/// @param str 
+void  shrink_string(string *str)
+{
+  if (!str || !str->s || is_inline(str) || str->capacity == str->len)
+    return ;
+  if (str->len <= STRING_SSO_CAPACITY)
   {
-    write(fd, "NULL", 4);
+    memorycopy(str->sso, str->s, str->len + 1);
+    release_buffer(str);
+    str->s = str->sso;
+    str->capacity = STRING_SSO_CAPACITY;
     return ;
   }
-  write(fd, str->s, str->len);
+  if (!is_shared(str))
+    resize_buffer(str, str->len);
 }
 
-/// @brief This function concatenated a string to another.
+/// @brief Reads everything left in `fd` into a new string. The buffer is sized
+/// from fstat for regular files, so they are read without any reallocation;
+/// pipes, sockets and files growing meanwhile grow it geometrically.
+/// @param fd 
+/// @return string or NULL on error (errno tells which)
+string  *read_fd_to_string(int fd)
+{
+  struct stat st;
+  string      *str;
+  ssize_t     n;
+  ui64        capacity;
+
+  capacity = READ_MIN_CAPACITY;
+  if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0)
+  {
+    n = (ssize_t)lseek(fd, 0, SEEK_CUR);
+    if (n >= 0 && n < st.st_size)
+      capacity = (ui64)(st.st_size - n) + 1;
+  }
+  str = new_string_len(heap_allocator(), "", 0);
+  if (!str || !reserve_string(str, capacity))
+  {
+    dealloc_string(&str);
+    return (NULL);
+  }
+  for (;;)
+  {
+    if (str->len == str->capacity && !ensure_capacity(str, str->len + 1))
+      break ;
+    n = read(fd, str->s + str->len, str->capacity - str->len);
+    if (n < 0 && errno == EINTR)
+      continue ;
+    if (n <= 0)
+    {
+      str->s[str->len] = '\0';
+      if (!n)
+        return (str);
+      break ;
+    }
+    str->len += (ui64)n;
+  }
+  n = errno;
+  dealloc_string(&str);
+  errno = (int)n;
+  return (NULL);
+}
+
+/// @brief Reads the whole file at `path` into a new string, see read_fd_to_string.
+/// @param path 
+/// @return string or NULL on error (errno tells which)
+string  *read_file_to_string(const char *path)
+{
+  string  *str;
+  int     fd;
+  int     err;
+
+  if (!path)
+  {
+    errno = EINVAL;
+    return (NULL);
+  }
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return (NULL);
+  str = read_fd_to_string(fd);
+  err = errno;
+  close(fd);
+  errno = err;
+  return (str);
+}
+
+/// @brief Replaces the content of the string with `len` bytes, reusing its
+/// buffer: it only grows when the bytes don't fit.
 /// @param str 
-/// @param to_append 
-/// @attention i.e: 'append_str_to_string(string("hello "), string("world"))-> "hello world"'
-void    append_str_to_string(string *str, string *to_append)
+/// @param bytes 
+/// @param len 
+/// @return 1 on success, 0 on allocation failure
+int assign_bytes_to_string(string *str, const char *bytes, ui64 len)
 {
-  char  *ptr;
-  ui64  total_len;
+  if (!ensure_capacity(str, len))
+    return (0);
+  memorycopy(str->s, (void *)bytes, len);
+  str->len = len;
+  str->s[len] = '\0';
+  str->hash = 0;
+  return (1);
+}
 
-  total_len = str->len + to_append->len;
-  if (!str || !to_append)
+/// @brief Points `iov` at the content of the string, "NULL" for a NULL string.
+static void string_iovec(const string *str, struct iovec *iov)
+{
+  if (!str || !str->s)
+  {
+    iov->iov_base = "NULL";
+    iov->iov_len = 4;
     return ;
-  if (!to_append->s || to_append->len == 0 || total_len < str->len)
-    return;
-  if (str->capacity <= total_len)
+  }
+  iov->iov_base = str->s;
+  iov->iov_len = str->len;
+}
+
+/// @brief It writes the given string into the file descriptor given as argument.
+/// Short writes and EINTR are resumed until the whole string is written.
+/// @param fd 
+/// @param str 
+/// @return 1 on success, 0 on error (errno tells which)
+int print_string(int fd, const string *str)
+{
+  struct iovec  iov;
+
+  string_iovec(str, &iov);
+  return (write_fully(fd, &iov, 1));
+}
+
+/// @brief Writes `count` strings one after the other with a single writev call
+/// (one per WRITE_IOV_MAX strings), instead of one write per string. Short
+/// writes and EINTR are resumed where they stopped.
+/// @param fd 
+/// @param strs array of strings, NULL ones are written as "NULL"
+/// @param count number of strings
+/// @return 1 on success, 0 on error (errno tells which)
+/// @attention i.e: 'print_many_strings(1, (string *[]){key, sep, value}, 3)'
+int print_many_strings(int fd, string *const *strs, ui64 count)
+{
+  struct iovec  iov[WRITE_IOV_MAX];
+  ui64          n;
+  ui64          i;
+
+  if (!strs)
+    return (0);
+  for (; count; strs += n, count -= n)
   {
-    ptr = realloc(str->s, total_len + 1);
-    if (!ptr)
-      return;
-    str->s = ptr;
-    str->capacity = total_len;
+    n = count < WRITE_IOV_MAX ? count : WRITE_IOV_MAX;
+    for (i = 0; i < n; i++)
+      string_iovec(strs[i], &iov[i]);
+    if (!write_fully(fd, iov, (int)n))
+      return (0);
   }
-  memorycopy(str->s + str->len, to_append->s, to_append->len);
+  return (1);
+}
+
+/// @brief Appends `add_len` raw bytes to the string. The bytes may live inside
+/// the string itself (i.e: a view of it), they are located again after growing.
+/// @param str 
+/// @param bytes 
+/// @param add_len 
+void  append_bytes_to_string(string *str, const char *bytes, ui64 add_len)
+{
+  ui64  total_len;
+  ui64  offset;
+  int   inside;
+
+  total_len = str->len + add_len;
+  if (!add_len || total_len < str->len)
+    return ;
+  inside = (bytes >= str->s && bytes < str->s + str->len);
+  offset = inside ? (ui64)(bytes - str->s) : 0;
+  if (!ensure_capacity(str, total_len))
+    return ;
+  if (inside)
+    bytes = str->s + offset;
+  memorycopy(str->s + str->len, (void *)bytes, add_len);
   str->len = total_len;
   str->s[total_len] = '\0';
+  str->hash = 0;
+}
+
+/// @brief This function concatenated a string to another.
+/// @param str 
+/// @param to_append 
+/// @attention i.e: 'append_str_to_string(string("hello "), string("world"))-> "hello world"'
+void    append_str_to_string(string *str, string *to_append)
+{
+  if (!str || !to_append || !to_append->s)
+    return ;
+  append_bytes_to_string(str, to_append->s, to_append->len);
 }
 
 /// @brief This function concatenated a pointer to char to a string.
@@ -101,29 +491,9 @@ void    append_str_to_string(string *str, string *to_append)
 /// @attention i.e: 'append_str_to_string(string("hello "), "world")-> "hello world"'
 void    append_pchar_to_string(string *str, const char *to_append)
 {
-  ui64  add_len;
-  ui64  total_len;
-  char  *ptr;
-
   if (!str || !to_append)
     return ;
-  add_len = stringlen((char *)to_append);
-  if (!add_len)
-    return ;
-  total_len = str->len + add_len;
-  if (total_len < str->len)
-    return ;
-  if (str->capacity <= total_len)
-  {
-    ptr = realloc(str->s, total_len + 1);
-    if (!ptr)
-      return;
-    str->s = ptr;
-    str->capacity = total_len;
-  }
-  memorycopy(str->s + str->len, (void *)to_append, add_len);
-  str->len = total_len;
-  str->s[total_len] = '\0';
+  append_bytes_to_string(str, to_append, stringlen((char *)to_append));
 }
 
 /// @brief This function concatenated a single character to a string.
@@ -132,103 +502,81 @@ void    append_pchar_to_string(string *str, const char *to_append)
 /// @attention i.e: 'append_str_to_string(string("hello"), !)-> "hello!"'
 void  append_char_to_string(string *str, char c)
 {
-  char  *ptr;
-  void  *src;
-
   if (!str || str->len + 1 < str->len)
     return ;
-  if (str->capacity <= str->len + 1)
-  {
-    ptr = realloc(str->s, str->len + 1);
-    if (!ptr)
-      return ;
-    str->s = ptr;
-    str->capacity = str->len + 1;
-  }
-  src = &c;
-  memorycopy(str->s + str->len, src, 1);
+  if (!ensure_capacity(str, str->len + 1))
+    return ;
+  str->s[str->len] = c;
   str->len += 1;
   str->s[str->len] = '\0';
+  str->hash = 0;
 }
 
-/// @brief This function concatenated an integer to a string.
-/// @param str 
-/// @param to_append 
-/// @attention i.e: 'append_str_to_string(string("hello "), 1337)-> "hello 1337"'
-void  append_int_to_string(string *str, int n)
+/// @brief Writes a numeric typed value into `dst` (no terminator). With a NULL
+/// `dst` it only measures, so callers can size their buffer first.
+/// @param dst 
+/// @param val typed_value holding a numeric type
+/// @return number of characters (at most NUMBER_MAX_WIDTH), 0 for non numeric
+/// values
+ui64  format_number(char *dst, typed_value val)
 {
-  char  *ptr;
-  char  *num;
-  ui64  add_len;
-  ui64  total_len;
-
-  if (!str)
-    return ;
-  num = int_to_ascii(n);
-  if (!num)
-    return ;
-  add_len = stringlen(num);
-  total_len = str->len + add_len;
-  if (!add_len || total_len < str->len)
-  {
-    free(num);
-    return ;
-  }
-  if (str->capacity <= total_len)
+  switch (val.type)
   {
-    ptr = realloc(str->s, total_len + 1);
-    if (!ptr)
-    {
-      free(num);
-      return ;
-    }
-    str->s = ptr;
-    str->capacity = total_len;
+    case TYPE_INT:
+      return (format_llong(dst, val.as_int));
+    case TYPE_LLONG:
+      return (format_llong(dst, val.as_llong));
+    case TYPE_UINT:
+      return (format_ullong(dst, val.as_uint));
+    case TYPE_ULLONG:
+      return (format_ullong(dst, val.as_ullong));
+    case TYPE_HEX:
+      return (format_hex(dst, val.as_ullong));
+    case TYPE_FIXED:
+      return (format_fixed(dst, val.as_llong, val.width));
+    case TYPE_DOUBLE:
+      return (format_double(dst, val.as_double, val.width));
+    case TYPE_FLOAT:
+      return (format_float(dst, val.as_float, val.width));
+    default:
+      return (0);
   }
-  memorycopy(str->s + str->len, (void *)num, add_len);
-  free(num);
-  str->len = total_len;
-  str->s[total_len] = '\0';
 }
 
-/// @brief This function concatenated a long long to a string.
+/// @brief This function concatenated a number to a string. The digits are
+/// written straight into the string buffer, no temporary is allocated: in a
+/// single pass when NUMBER_MAX_WIDTH characters are spare, otherwise the number
+/// is measured first.
 /// @param str 
-/// @param to_append 
-/// @attention i.e: 'append_str_to_string(string("hello "), 4294967296)-> "hello 4294967296"'
-void  append_llong_to_string(string *str, long long l)
+/// @param val typed_value holding a numeric type
+/// @attention i.e: 'append_number_to_string(string("hello "), VAL_INT(1337))-> "hello 1337"'
+void  append_number_to_string(string *str, typed_value val)
 {
-  char  *ptr;
-  char  *num;
   ui64  add_len;
   ui64  total_len;
 
   if (!str)
     return ;
-  num = llong_to_ascii(l);
-  if (!num)
+  if (string_spare(str) >= NUMBER_MAX_WIDTH)
+  {
+    add_len = format_number(str->s + str->len, val);
+    if (!add_len)
+      return ;
+    str->len += add_len;
+    str->s[str->len] = '\0';
+    str->hash = 0;
     return ;
-  add_len = stringlen(num);
+  }
+  add_len = format_number(NULL, val);
   total_len = str->len + add_len;
   if (!add_len || total_len < str->len)
-  {
-    free(num);
     return ;
-  }
-  if (str->capacity <= total_len)
-  {
-    ptr = realloc(str->s, total_len + 1);
-    if (!ptr)
-    {
-      free(num);
-      return ;
-    }
-    str->s = ptr;
-    str->capacity = total_len;
-  }
-  memorycopy(str->s + str->len, (void *)num, add_len);
-  free(num);
+  if (!ensure_capacity(str, total_len))
+    return ;
+  format_number(str->s + str->len, val);
   str->len = total_len;
   str->s[total_len] = '\0';
+  str->hash = 0;
 }
 
 /// @brief Appends the given value argument into the string.
@@ -249,237 +597,690 @@ void  append_to_string(string *str, typed_value val)
     case TYPE_CHAR:
       append_char_to_string(str, val.as_char);
       break ;
-    case TYPE_INT:
-      append_int_to_string(str, val.as_int);
+    case TYPE_VIEW:
+      if (val.as_view && val.as_view->ptr)
+        append_bytes_to_string(str, val.as_view->ptr, val.as_view->len);
       break ;
+    case TYPE_INT:
     case TYPE_LLONG:
-      append_llong_to_string(str, val.as_llong);
+    case TYPE_UINT:
+    case TYPE_ULLONG:
+    case TYPE_HEX:
+    case TYPE_FIXED:
+    case TYPE_DOUBLE:
+    case TYPE_FLOAT:
+      append_number_to_string(str, val);
       break ;
     default:
         break ;
   }
 }
 
+/// @brief Appends `count` values at once: every piece is measured first, the
+/// buffer grows once and the pieces are written in a single pass. Values that
+/// can't be appended (i.e: patterns or NULL strings) are skipped, and pieces may
+/// reference the string itself.
+/// @param str 
+/// @param vals array of typed values
+/// @param count number of values
+/// @attention i.e: 'APPEND_MANY(s, VAL_PCHAR("ts="), VAL_INT(42))-> "ts=42"'
+void  append_many_to_string(string *str, const typed_value *vals, ui64 count)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        old_base;
+  ui64        total_len;
+  ui64        len;
+  ui64        i;
+
+  if (!str || !vals || !str->s)
+    return ;
+  total_len = str->len;
+  for (i = 0; i < count; i++)
+  {
+    if (vals[i].type == TYPE_PATTERN || !typed_value_bytes(vals[i], buf, &bytes, &len))
+      continue ;
+    if (total_len + len < total_len)
+      return ;
+    total_len += len;
+  }
+  old_base = (ui64)str->s;
+  if (total_len == str->len || !ensure_capacity(str, total_len))
+    return ;
+  total_len = str->len;
+  for (i = 0; i < count; i++)
+  {
+    len = format_number(str->s + total_len, vals[i]);
+    if (!len)
+    {
+      if (vals[i].type == TYPE_PATTERN || !typed_value_bytes(vals[i], buf, &bytes, &len))
+        continue ;
+      if ((ui64)bytes >= old_base && (ui64)bytes < old_base + str->len)
+        bytes = str->s + ((ui64)bytes - old_base);
+      memorycopy(str->s + total_len, (void *)bytes, len);
+    }
+    total_len += len;
+  }
+  str->len = total_len;
+  str->s[total_len] = '\0';
+  str->hash = 0;
+}
+
 /// @brief Compares the string content with a pointer to char.
 /// @param str 
 /// @param cmp 
 /// @return int (1 if equal, 0 if not equal)
 int  equals_string(const string *str, const char *cmp)
 {
-  ui64  cmp_len;
-  ui64  i;
-
   if (!str || !cmp)
     return (!str && !cmp);
   if (!str->s)
     return (0);
-  cmp_len = stringlen((char *)cmp);
-  if (str->len != cmp_len)
+  return (stringlen((char *)cmp) == str->len
+    && memorycompare(str->s, cmp, str->len) == 0);
+}
+
+/// @brief Compares the string content with the bytes of the given value. The
+/// lengths are checked first, so strings and views of a different length are
+/// told apart without reading their content.
+/// @param str 
+/// @param val typed_value containing type and value
+/// @return int (1 if equal, 0 if not equal)
+int  equals_value(const string *str, typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+
+  if (!str || !str->s)
+    return (0);
+  if (val.type == TYPE_STRING && val.as_str == str)
+    return (1);
+  if (!typed_value_bytes(val, buf, &bytes, &len))
     return (0);
-  i = 0;
-  while (i < str->len)
-  {
-    if (str->s[i] != cmp[i])
-      return (0);
-    i++;
-  }
-  return (1);
+  return (len == str->len && memorycompare(str->s, bytes, len) == 0);
+}
+
+/// @brief Same as equals_value, ignoring the case of ASCII letters. Nothing is
+/// copied nor converted.
+/// @param str 
+/// @param val typed_value containing type and value
+/// @return int (1 if equal, 0 if not equal)
+int  equals_value_ignore_case(const string *str, typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+
+  if (!str || !str->s)
+    return (0);
+  if (!typed_value_bytes(val, buf, &bytes, &len))
+    return (0);
+  return (len == str->len && memorycasecompare(str->s, bytes, len) == 0);
+}
+
+/// @brief Orders the string and the bytes of the given value byte by byte (as
+/// unsigned char), a prefix comes first. Meant for sorting.
+/// @param str 
+/// @param val typed_value containing type and value
+/// @return negative, 0 or positive, like strcmp. NULL strings and values that
+/// hold nothing come first.
+int  compare_string(const string *str, typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *bytes;
+  ui64        len;
+  int         diff;
+  int         valid;
+
+  valid = typed_value_bytes(val, buf, &bytes, &len);
+  if (!str || !str->s || !valid)
+    return ((str && str->s) - valid);
+  diff = memorycompare(str->s, bytes, str->len < len ? str->len : len);
+  if (diff)
+    return (diff);
+  return ((str->len > len) - (str->len < len));
 }
 
-/// @brief Creates a exactly deep copy of the given string.
+/// @brief Creates a exactly deep copy of the given string, from the same allocator.
 /// @param str 
 /// @return string (i.e: 'copy_string(string("hello"))-> string(hello)')
 string  *copy_string(string *str)
 {
-  string  *ptr;
+  string  *copy;
 
   if (!str || !str->s)
     return (NULL);
-  ptr = calloc(1, sizeof(string));
-  if (!ptr)
+  copy = new_string_len(str->alloc, str->s, str->len);
+  if (copy)
+    copy->hash = str->hash;
+  return (copy);
+}
+
+/// @brief Creates a copy of the string that shares its buffer instead of copying
+/// it, in O(1) whatever the length. Both strings stay independent: the first
+/// change made through either of them (append, to_lower, ...) moves it into a
+/// buffer of its own (copy-on-write). The reference count is atomic, so the
+/// copies can be handed to other threads, read and deleted there. Short strings,
+/// stored inline, are simply copied.
+/// @param str 
+/// @return string or NULL on allocation failure
+/// @attention i.e: 'share_string(string(long_line))-> same buffer, no copy'
+string  *share_string(string *str)
+{
+  const allocator *alloc;
+  string          *copy;
+
+  if (!str || !str->s)
     return (NULL);
-  ptr->capacity = str->capacity;
-  ptr->len = str->len;
-  ptr->s = calloc(ptr->capacity, sizeof(char));
-  if (!ptr->s)
-  {
-    free(ptr);
+  if (is_inline(str))
+    return (copy_string(str));
+  alloc = str->alloc;
+  copy = alloc->alloc(alloc->ctx, sizeof(string));
+  if (!copy)
     return (NULL);
-  }
-  memorycopy(ptr->s, str->s, str->len);
-  return (ptr);
+  __atomic_add_fetch(&buffer_of(str)->refs, 1, __ATOMIC_RELAXED);
+  memorycopy(copy, str, sizeof(string));
+  return (copy);
 }
 
-/// @brief Converts all upper case character to lower case.
+/// @brief Hashes the string content with memoryhash(). The hash is computed on
+/// the first call and cached in the string until its content changes, so
+/// repeated lookups with the same key don't read it again.
 /// @param str 
-void  lower_string(string *str)
+/// @return 64-bit hash, equal to the hash of a view or char pointer holding
+/// the same bytes (0 for a NULL string)
+ui64  hash_string(const string *str)
 {
-  char  *ptr;
-  ui64  len;
+  ui64  hash;
 
   if (!str || !str->s)
-    return ;
-  ptr = str->s;
-  len = str->len;
-  while (len--)
-  {
-    if (*ptr >= 'A' && *ptr <= 'Z')
-      *ptr = *ptr + 'a' - 'A';
-    ptr++;
-  }  
+    return (0);
+  if (str->hash)
+    return (str->hash);
+  hash = memoryhash(str->s, str->len);
+  ((string *)str)->hash = hash;
+  return (hash);
 }
 
-/// @brief Converts all lower case character to upper case.
+/// @brief Returns a view of the whole string content. It borrows the buffer, so
+/// it is only valid until the string grows, shrinks or is deleted.
 /// @param str 
-void  upper_string(string *str)
+/// @return string_view (a NULL view for a NULL string)
+string_view get_string_view(const string *str)
 {
-  char  *ptr;
-  ui64  len;
-
   if (!str || !str->s)
+    return ((string_view){NULL, 0});
+  return ((string_view){str->s, str->len});
+}
+
+/// @brief Converts all upper case character to lower case.
+/// @param str 
+void  lower_string(string *str)
+{
+  if (!str || !str->s || !ensure_capacity(str, str->len))
     return ;
-  ptr = str->s;
-  len = str->len;
-  while (len--)
-  {
-    if (*ptr >= 'a' && *ptr <= 'z')
-      *ptr = *ptr + 'A' - 'a';
-    ptr++;
-  }  
+  memorylower(str->s, str->s, str->len);
+  str->hash = 0;
 }
 
-/// @brief This function searches for a string inside another one and returns
-/// the position where it starts in the searched string, if the search_oder
-/// is negative it searches the last index of the given element.
+/// @brief Converts all lower case character to upper case.
 /// @param str 
-/// @param to_find 
-/// @return 
-int find_string(char *str, char *to_find, int search_order)
+void  upper_string(string *str)
 {
-  int i;
-  int j;
-  int k;
+  if (!str || !str->s || !ensure_capacity(str, str->len))
+    return ;
+  memoryupper(str->s, str->s, str->len);
+  str->hash = 0;
+}
 
-  if (!str || !to_find)
-    return (-1);
-  if (search_order >= 0)
-  {
-  i = 0;
-    while (str[i])
-    {
-      j = 0;
-      while (str[i + j] && to_find[j] && str[i + j] == to_find[j])
-      {
-        if (!to_find[j + 1])
-          return (i);
-        j++;
-      }
-      i++;
-    }
-    return (-1);
-  }
-  else
+/// @brief Replaces the content of `dst` with the content of `src` converted by
+/// `convert`, in a single pass over the bytes.
+/// @param src 
+/// @param dst 
+/// @param convert memorylower or memoryupper
+static void  convert_string_into(const string *src, string *dst,
+  void (*convert)(void *, const void *, ui64))
+{
+  if (!src || !dst || !src->s || !dst->s)
+    return ;
+  if (src != dst)
   {
-    i = stringlen(str) - 1;
-    while (i > 0)
+    if (is_shared(dst))
     {
-      j = stringlen(to_find) - 1;
-      k = 0;
-      while (i + k >= 0 && j >= 0 && str[i + k] == to_find[j])
-      {
-        if (!j)
-          return (i + k);
-        j--;
-        k--;
-      }
-      i--;
+      release_buffer(dst);
+      dst->s = dst->sso;
+      dst->capacity = STRING_SSO_CAPACITY;
     }
-    return (-1);
+    dst->len = 0;
+    dst->s[0] = '\0';
+    dst->hash = 0;
+    if (!ensure_capacity(dst, src->len))
+      return ;
   }
+  else if (!ensure_capacity(dst, dst->len))
+    return ;
+  convert(dst->s, src->s, src->len);
+  dst->len = src->len;
+  dst->s[dst->len] = '\0';
+  dst->hash = 0;
 }
 
-char  *convert_types_to_pchar(const string *str, typed_value val)
+/// @brief Writes a lower case copy of `src` into `dst`, replacing its content.
+/// It avoids a clone followed by to_lower, and `dst` can be reused across calls.
+/// @param src 
+/// @param dst 
+/// @attention i.e: 'lower_string_into(string("Host"), dst)-> dst = "host"'
+void  lower_string_into(const string *src, string *dst)
 {
-  char  *ptr;
+  convert_string_into(src, dst, &memorylower);
+}
 
-  if (!str || !str->s)
-    return (NULL);
+/// @brief Writes an upper case copy of `src` into `dst`, replacing its content.
+/// @param src 
+/// @param dst 
+/// @attention i.e: 'upper_string_into(string("Host"), dst)-> dst = "HOST"'
+void  upper_string_into(const string *src, string *dst)
+{
+  convert_string_into(src, dst, &memoryupper);
+}
+
+/// @brief Resolves a typed value into the bytes it stands for when it is searched
+/// or compared, without allocating: strings and pointers to char are borrowed and
+/// characters and numbers are written into `buf` (at least NUMBER_MAX_WIDTH bytes).
+/// @param val 
+/// @param buf 
+/// @param ptr receives the address of the bytes
+/// @param len receives the number of bytes
+/// @return 1 on success, 0 if the value holds nothing searchable
+int typed_value_bytes(typed_value val, char *buf, const char **ptr, ui64 *len)
+{
   switch (val.type)
   {
     case TYPE_STRING:
-      if (!val.as_str)
-        return (NULL);
-      ptr = calloc(val.as_str->capacity, sizeof(char));
-      if (!ptr)
-        return (NULL);
-      memorycopy(ptr, val.as_str->s, val.as_str->capacity);
-      break ;
+      if (!val.as_str || !val.as_str->s)
+        return (0);
+      *ptr = val.as_str->s;
+      *len = val.as_str->len;
+      return (1);
     case TYPE_PCHAR:
       if (!val.as_pchar)
-        return (NULL);
-      ptr = calloc(stringlen((char *)val.as_pchar) + 1, sizeof(char));
-      if (!ptr)
-        return (NULL);
-      memorycopy(ptr, (void *)val.as_pchar, stringlen((char *)val.as_pchar));
-      break ;
+        return (0);
+      *ptr = val.as_pchar;
+      *len = stringlen((char *)val.as_pchar);
+      return (1);
     case TYPE_CHAR:
-      ptr = calloc(2, sizeof(char));
-      if (!ptr)
-        return (NULL);
-      *ptr = val.as_char;
-      break ;
-    case TYPE_INT:
-      ptr = int_to_ascii(val.as_int);
-      if (!ptr)
-        return (NULL);
-      break ;
-    case TYPE_LLONG:
-      ptr = llong_to_ascii(val.as_llong);
-      if (!ptr)
-        return (NULL);
-      break ;
+      buf[0] = val.as_char;
+      *ptr = buf;
+      *len = 1;
+      return (1);
+    case TYPE_VIEW:
+      if (!val.as_view || !val.as_view->ptr)
+        return (0);
+      *ptr = val.as_view->ptr;
+      *len = val.as_view->len;
+      return (1);
     default:
-      return (NULL);
+      *len = format_number(buf, val);
+      *ptr = buf;
+      return (*len != 0);
   }
-  return (ptr);
 }
 
-/// @brief Returns the index of the first match of the given value argument.
+/// @brief Resolves a value used as a key (map, intern pool) into its bytes and
+/// their memoryhash(). A string reuses the hash cached in it.
+/// @param val 
+/// @param buf at least NUMBER_MAX_WIDTH bytes
+/// @param ptr receives the address of the bytes
+/// @param len receives the number of bytes
+/// @param hash receives the hash
+/// @return 1 on success, 0 if the value can't be used as a key
+int typed_value_key(typed_value val, char *buf, const char **ptr, ui64 *len,
+  ui64 *hash)
+{
+  if (!typed_value_bytes(val, buf, ptr, len))
+    return (0);
+  if (val.type == TYPE_STRING)
+    *hash = hash_string(val.as_str);
+  else
+    *hash = memoryhash(*ptr, *len);
+  return (1);
+}
+
+/// @brief Returns the index of the first match of the given value argument at or
+/// after `from`. A TYPE_PATTERN value reuses its precompiled search tables.
 /// @param str 
 /// @param val typed_value containing type and value
-/// @return integer
-int  index_of_element(const string *str, typed_value val)
+/// @param from first index considered (negative values start at 0)
+/// @return index of the match or -1
+i64  index_of_element_from(const string *str, typed_value val, i64 from)
 {
-  char  *ptr;
-  int   index;
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *needle;
+  ui64        len;
 
   if (!str || !str->s)
     return (-1);
-  ptr = convert_types_to_pchar(str, val);
-  if (!ptr)
+  if (from < 0)
+    from = 0;
+  if (val.type == TYPE_PATTERN)
+    return (Pattern()->find(val.as_pattern, str->s, str->len, (ui64)from));
+  if (!typed_value_bytes(val, buf, &needle, &len))
     return (-1);
-  index = find_string(str->s, ptr, 1);
-  free(ptr);
-  return (index);
+  return (search_forward(str->s, str->len, needle, len, (ui64)from));
 }
 
-/// @brief Returns the index of the last match of the given value argument.
+/// @brief Returns the index of the last match of the given value argument that
+/// starts at or before `from`.
 /// @param str 
 /// @param val typed_value containing type and value
-/// @return integer
-int  last_index_of_element(const string *str, typed_value val)
+/// @param from last index considered (values past the end are clamped)
+/// @return index of the match or -1
+i64  last_index_of_element_from(const string *str, typed_value val, i64 from)
 {
-  char  *ptr;
-  int   index;
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *needle;
+  ui64        len;
 
-  if (!str || !str->s)
+  if (!str || !str->s || from < 0)
     return (-1);
-  ptr = convert_types_to_pchar(str, val);
-  if (!ptr)
+  if (val.type == TYPE_PATTERN)
+    return (Pattern()->rfind(val.as_pattern, str->s, str->len, (ui64)from));
+  if (!typed_value_bytes(val, buf, &needle, &len))
+    return (-1);
+  return (search_backward(str->s, str->len, needle, len, (ui64)from));
+}
+
+/// @brief Returns the index of the first match of the given value argument.
+/// @param str 
+/// @param val typed_value containing type and value
+/// @return index of the match or -1
+i64  index_of_element(const string *str, typed_value val)
+{
+  return (index_of_element_from(str, val, 0));
+}
+
+/// @brief Returns the index of the last match of the given value argument.
+/// @param str 
+/// @param val typed_value containing type and value
+/// @return index of the match or -1
+i64  last_index_of_element(const string *str, typed_value val)
+{
+  if (!str)
     return (-1);
-  index = find_string(str->s, ptr, -1);
-  free(ptr);
-  return (index);
+  return (last_index_of_element_from(str, val, (i64)str->len));
+}
+
+// Needle and replacement of a replace, resolved once
+typedef struct replace_job {
+  const char    *needle;
+  ui64          needle_len;
+  const pattern *pat;
+  const char    *with;
+  ui64          with_len;
+  ui64          max;
+}   replace_job;
+
+/// @brief Finds the next match of the needle at or after `from`.
+/// @return index of the match or -1
+static i64  find_replaced(const string *str, const replace_job *job, ui64 from)
+{
+  if (job->pat)
+    return (Pattern()->find(job->pat, str->s, str->len, from));
+  return (search_forward(str->s, str->len, job->needle, job->needle_len, from));
+}
+
+/// @brief Replaces the matches in place when the replacement is not longer than
+/// the needle, in a single pass: the output never catches up with the bytes
+/// still to be searched, so nothing is allocated.
+/// @return number of matches replaced
+static ui64 replace_shrinking(string *str, const replace_job *job)
+{
+  ui64  count;
+  ui64  r;
+  ui64  w;
+  i64   idx;
+
+  count = 0;
+  r = 0;
+  w = 0;
+  while (count < job->max && (idx = find_replaced(str, job, r)) >= 0)
+  {
+    memorycopy(str->s + w, str->s + r, (ui64)idx - r);
+    w += (ui64)idx - r;
+    memorycopy(str->s + w, (void *)job->with, job->with_len);
+    w += job->with_len;
+    r = (ui64)idx + job->needle_len;
+    count++;
+  }
+  if (!count)
+    return (0);
+  memorycopy(str->s + w, str->s + r, str->len - r);
+  str->len = w + str->len - r;
+  str->s[str->len] = '\0';
+  str->hash = 0;
+  return (count);
+}
+
+/// @brief Moves the content apart from the last match to the first, so a
+/// longer replacement is written in the spare capacity of the buffer.
+static void replace_growing(string *str, const replace_job *job,
+  const ui64 *hits, ui64 count, ui64 new_len)
+{
+  ui64  r;
+  ui64  w;
+  ui64  tail;
+
+  r = str->len;
+  w = new_len;
+  while (count--)
+  {
+    tail = r - (hits[count] + job->needle_len);
+    w -= tail;
+    memorycopy(str->s + w, str->s + hits[count] + job->needle_len, tail);
+    w -= job->with_len;
+    memorycopy(str->s + w, (void *)job->with, job->with_len);
+    r = hits[count];
+  }
+  str->len = new_len;
+  str->s[new_len] = '\0';
+  str->hash = 0;
+}
+
+/// @brief Writes the content with its first `count` matches replaced into `dst`.
+/// Matches past the REPLACE_CACHE first ones are searched again.
+static void write_replaced(const string *str, const replace_job *job,
+  const ui64 *hits, ui64 count, char *dst)
+{
+  ui64  r;
+  ui64  w;
+  ui64  k;
+  ui64  idx;
+
+  r = 0;
+  w = 0;
+  for (k = 0; k < count; k++)
+  {
+    idx = k < REPLACE_CACHE ? hits[k] : (ui64)find_replaced(str, job, r);
+    memorycopy(dst + w, str->s + r, idx - r);
+    w += idx - r;
+    memorycopy(dst + w, (void *)job->with, job->with_len);
+    w += job->with_len;
+    r = idx + job->needle_len;
+  }
+  memorycopy(dst + w, str->s + r, str->len - r);
+  dst[w + str->len - r] = '\0';
+}
+
+/// @brief Replaces the matches once they are counted, so the output is sized
+/// exactly: in the spare capacity when it is enough, otherwise in a single new
+/// buffer (or inline, for a short result).
+/// @param in_place 0 when the needle or the replacement lives in the buffer
+/// @return number of matches replaced, 0 on overflow or allocation failure
+static ui64 replace_counted(string *str, const replace_job *job, int in_place)
+{
+  char  small[STRING_SSO_CAPACITY + 1];
+  ui64  hits[REPLACE_CACHE];
+  ui64  count;
+  ui64  new_len;
+  char  *dst;
+  i64   idx;
+
+  count = 0;
+  idx = -(i64)job->needle_len;
+  while (count < job->max
+    && (idx = find_replaced(str, job, (ui64)idx + job->needle_len)) >= 0)
+  {
+    if (count < REPLACE_CACHE)
+      hits[count] = (ui64)idx;
+    count++;
+  }
+  if (!count || (job->with_len > job->needle_len && count
+    > ((ui64)-1 - 1 - str->len) / (job->with_len - job->needle_len)))
+    return (0);
+  new_len = str->len - count * job->needle_len + count * job->with_len;
+  if (in_place && count <= REPLACE_CACHE && new_len <= str->capacity
+    && !is_shared(str))
+  {
+    replace_growing(str, job, hits, count, new_len);
+    return (count);
+  }
+  dst = small;
+  if (new_len > STRING_SSO_CAPACITY)
+    dst = alloc_buffer(str->alloc, new_len);
+  if (!dst)
+    return (0);
+  write_replaced(str, job, hits, count, dst);
+  if (dst == small && !is_shared(str))
+    memorycopy(str->s, small, new_len + 1);
+  else
+  {
+    if (!is_inline(str))
+      release_buffer(str);
+    str->s = (dst == small) ? str->sso : dst;
+    str->capacity = (dst == small) ? STRING_SSO_CAPACITY : new_len;
+    memorycopy(str->s, small, dst == small ? new_len + 1 : 0);
+  }
+  str->len = new_len;
+  str->hash = 0;
+  return (count);
+}
+
+/// @brief Replaces the first `max` matches of `needle` with `with`.
+/// @return number of matches replaced
+static ui64 replace_matches(string *str, typed_value needle, typed_value with,
+  ui64 max)
+{
+  char        needle_buf[NUMBER_MAX_WIDTH];
+  char        with_buf[NUMBER_MAX_WIDTH];
+  replace_job job;
+  int         alias;
+
+  if (!str || !str->s)
+    return (0);
+  job.pat = NULL;
+  job.max = max;
+  if (needle.type == TYPE_PATTERN)
+  {
+    if (!needle.as_pattern)
+      return (0);
+    job.pat = needle.as_pattern;
+    job.needle = pattern_needle(job.pat, &job.needle_len);
+  }
+  else if (!typed_value_bytes(needle, needle_buf, &job.needle, &job.needle_len)
+    || !job.needle_len)
+    return (0);
+  if (with.type == TYPE_PATTERN)
+  {
+    if (!with.as_pattern)
+      return (0);
+    job.with = pattern_needle(with.as_pattern, &job.with_len);
+  }
+  else if (!typed_value_bytes(with, with_buf, &job.with, &job.with_len))
+    return (0);
+  alias = (job.with >= str->s && job.with <= str->s + str->capacity)
+    || (job.needle >= str->s && job.needle <= str->s + str->capacity);
+  if (!alias && job.with_len <= job.needle_len && !is_shared(str))
+    return (replace_shrinking(str, &job));
+  return (replace_counted(str, &job, !alias));
+}
+
+/// @brief Replaces the first match of `needle` with `with`. A replacement no
+/// longer than the needle is written in place, a longer one moves the rest of
+/// the content once.
+/// @param str 
+/// @param needle any typed value index_of accepts
+/// @param with the replacement, any typed value append accepts
+/// @return 1 if a match was replaced, 0 if there was none (or on allocation
+/// failure, the string is then unchanged)
+/// @attention i.e: 'replace_string(string("a-b-c"), VAL_CHAR('-'), VAL_PCHAR("+"))-> "a+b-c"'
+int replace_string(string *str, typed_value needle, typed_value with)
+{
+  return (replace_matches(str, needle, with, 1) != 0);
+}
+
+/// @brief Replaces every match of `needle` with `with`, matches found left to
+/// right without overlapping. A replacement no longer than the needle is done in
+/// place in one pass with no allocation. A longer one counts the matches first,
+/// so the result is written once in a buffer of the exact size: the spare
+/// capacity when it is enough, otherwise a single new allocation. Long needles
+/// searched many times are best given as a TYPE_PATTERN.
+/// @param str 
+/// @param needle any typed value index_of accepts
+/// @param with the replacement, any typed value append accepts
+/// @return number of matches replaced (0 on allocation failure, the string is
+/// then unchanged)
+/// @attention i.e: 'replace_all_string(s, VAL_PCHAR(token), VAL_PCHAR("***"))'
+ui64  replace_all_string(string *str, typed_value needle, typed_value with)
+{
+  return (replace_matches(str, needle, with, (ui64)-1));
+}
+
+/// @brief Parses the whole string as a decimal int: an optional sign then
+/// digits, no blanks (i.e: "-42"-> -42, " 42" is invalid).
+/// @param str 
+/// @param out receives the value, the nearest limit on PARSE_OVERFLOW
+/// @return PARSE_OK, PARSE_EMPTY, PARSE_INVALID or PARSE_OVERFLOW
+parse_status  string_to_int(const string *str, int *out)
+{
+  if (!str)
+    return (parse_int(NULL, 0, out));
+  return (parse_int(str->s, str->len, out));
+}
+
+/// @brief Parses the whole string as a decimal long long, like to_int.
+/// @param str 
+/// @param out 
+/// @return status
+parse_status  string_to_llong(const string *str, long long *out)
+{
+  if (!str)
+    return (parse_llong(NULL, 0, out));
+  return (parse_llong(str->s, str->len, out));
+}
+
+/// @brief Parses the whole string as a decimal unsigned long, like to_int
+/// but any '-' is invalid.
+/// @param str 
+/// @param out 
+/// @return status
+parse_status  string_to_ulong(const string *str, unsigned long *out)
+{
+  if (!str)
+    return (parse_ulong(NULL, 0, out));
+  return (parse_ulong(str->s, str->len, out));
+}
+
+/// @brief Parses the whole string as a correctly rounded double, without
+/// locale (i.e: "1.5", "-2e-3", ".5", "inf"), see parse_double.
+/// @param str 
+/// @param out receives the value, ±inf on PARSE_OVERFLOW
+/// @return status
+parse_status  string_to_double(const string *str, double *out)
+{
+  if (!str)
+    return (parse_double(NULL, 0, out));
+  return (parse_double(str->s, str->len, out));
 }
 
 /// @brief Verifies if the string or the internal pointer to char is NULL.
@@ -495,87 +1296,206 @@ int is_string_null(string *str)
 /// @return 1 or 0
 int is_string_alpha(string *str)
 {
-  char  *ptr;
-  ui64  len;
-
   if (!str || !str->s)
     return (0);
-  len = str->len;
-  ptr = str->s;
-  while (len--)
-  {
-    if ((*ptr < 'A' || *ptr > 'Z') && (*ptr < 'a' || *ptr > 'z'))
-      return (0);
-    ptr++;
-  }
-  return (1);
+  return (memoryspan(str->s, str->len, CHAR_ALPHA) == str->len);
 }
 
-
 /// @brief Verifies if all characters in the string are alphanumeric.
 /// @param str 
 /// @return 1 or 0
 int is_string_alnum(string *str)
 {
-  char  *ptr;
-  ui64  len;
+  if (!str || !str->s)
+    return (0);
+  return (memoryspan(str->s, str->len, CHAR_ALNUM) == str->len);
+}
+
+/// @brief Verifies if all characters in the string are ASCII (0-127).
+/// @param str 
+/// @return 1 or 0
+int is_string_ascii(string *str)
+{
+  if (!str || !str->s)
+    return (0);
+  return (memoryspan(str->s, str->len, CHAR_ASCII) == str->len);
+}
+
+/// @brief Verifies if all characters in the string are digits ('0' to '9').
+/// @param str 
+/// @return 1 or 0
+int is_string_digit(string *str)
+{
+  if (!str || !str->s)
+    return (0);
+  return (memoryspan(str->s, str->len, CHAR_DIGIT) == str->len);
+}
+
+/// @brief Verifies if the string is a decimal number: an optional sign, digits
+/// and at most one decimal point, with at least one digit (i.e: "-12.5", "+.5").
+/// @param str 
+/// @return 1 or 0
+int is_string_decimal(string *str)
+{
+  ui64  i;
+  ui64  digits;
+  ui64  fraction;
 
   if (!str || !str->s)
     return (0);
-  len = str->len;
-  ptr = str->s;
-  while (len--)
+  i = (str->len && (str->s[0] == '+' || str->s[0] == '-'));
+  digits = memoryspan(str->s + i, str->len - i, CHAR_DIGIT);
+  i += digits;
+  if (i < str->len && str->s[i] == '.')
   {
-    if ((*ptr < 'A' || *ptr > 'Z') && (*ptr < 'a' || *ptr > 'z') && (*ptr < '0' || *ptr > '9'))
-      return (0);
-    ptr++;
+    i++;
+    fraction = memoryspan(str->s + i, str->len - i, CHAR_DIGIT);
+    digits += fraction;
+    i += fraction;
   }
-  return (1);
+  return (digits > 0 && i == str->len);
 }
 
+/// @brief Verifies if the string has at least one cased character and all of
+/// them are lower case. Other characters are ignored (i.e: "abc1" is lower).
+/// @param str 
+/// @return 1 or 0
+int is_string_lower(string *str)
+{
+  if (!str || !str->s)
+    return (0);
+  return (memorycspan(str->s, str->len, CHAR_UPPER) == str->len
+    && memorycspan(str->s, str->len, CHAR_LOWER) < str->len);
+}
 
-/// @brief Verifies if all characters in the string are ASCII (0-127).
+/// @brief Verifies if the string has at least one cased character and all of
+/// them are upper case. Other characters are ignored (i.e: "ABC1" is upper).
 /// @param str 
 /// @return 1 or 0
-int is_string_ascii(string *str)
+int is_string_upper(string *str)
+{
+  if (!str || !str->s)
+    return (0);
+  return (memorycspan(str->s, str->len, CHAR_LOWER) == str->len
+    && memorycspan(str->s, str->len, CHAR_UPPER) < str->len);
+}
+
+/// @brief Verifies if all characters in the string are printable ASCII (32-126).
+/// @param str 
+/// @return 1 or 0
+int is_string_printable(string *str)
+{
+  if (!str || !str->s)
+    return (0);
+  return (memoryspan(str->s, str->len, CHAR_PRINT) == str->len);
+}
+
+/// @brief Verifies if all characters in the string are white spaces
+/// (' ', '\t', '\n', '\v', '\f', '\r').
+/// @param str 
+/// @return 1 or 0
+int is_string_space(string *str)
+{
+  if (!str || !str->s)
+    return (0);
+  return (memoryspan(str->s, str->len, CHAR_WHITESPACE) == str->len);
+}
+
+/// @brief Verifies if the string is title cased: every word starts with an upper
+/// case letter followed only by lower case ones, and there is at least one word
+/// (i.e: "Hello World" is title, "Hello world" and "HELLO" are not).
+/// @param str 
+/// @return 1 or 0
+int is_string_title(string *str)
 {
-  char  *ptr;
-  ui64  len;
+  ui64  i;
+  int   cased;
 
   if (!str || !str->s)
     return (0);
-  len = str->len;
-  ptr = str->s;
-  while (len--)
+  i = 0;
+  cased = 0;
+  while (i < str->len)
   {
-    if ((unsigned char)*ptr > 127)
+    i += memorycspan(str->s + i, str->len - i, CHAR_ALPHA);
+    if (i == str->len)
+      break ;
+    if (char_class_of(str->s[i]) != CHAR_UPPER)
+      return (0);
+    cased = 1;
+    i++;
+    i += memoryspan(str->s + i, str->len - i, CHAR_LOWER);
+    if (i < str->len && char_class_of(str->s[i]) == CHAR_UPPER)
       return (0);
-    ptr++;
   }
-  return (1);
+  return (cased);
+}
+
+/// @brief Verifies if the string holds no characters.
+/// @param str 
+/// @return 1 or 0 (a NULL string is not empty)
+int is_string_empty(string *str)
+{
+  return (str && str->s && str->len == 0);
 }
 
 /// @brief This function returns a struct with all functions that
-/// can be used with the string type.
+/// can be used with the string type. The table is built at compile time, so it
+/// is safe to call from any thread.
 /// @param  
 /// @return str_funcs
-str_funcs   *String(void)
-{
-  static  str_funcs string_functions;
-
-  string_functions.len = &get_string_len;
-  string_functions.write = &print_string;
-  string_functions.del = &dealloc_string;
-  string_functions.new = &new_string;
-  string_functions.append = &append_to_string;
-  string_functions.clone = &copy_string;
-  string_functions.to_lower = &lower_string;
-  string_functions.to_upper = &upper_string;
-  string_functions.index_of = &index_of_element;
-  string_functions.last_index_of = &last_index_of_element;
-  string_functions.is_null = &is_string_null;
-  string_functions.is_alpha = &is_string_alpha;
-  string_functions.is_alnum = &is_string_alnum;
-  string_functions.is_ascii = &is_string_ascii;
+const str_funcs *String(void)
+{
+  static const str_funcs  string_functions = {
+    .new = &new_string,
+    .new_in = &new_string_in,
+    .read_fd = &read_fd_to_string,
+    .read_file = &read_file_to_string,
+    .map_file = &map_file_to_string,
+    .len = &get_string_len,
+    .capacity = &get_string_capacity,
+    .reserve = &reserve_string,
+    .shrink_to_fit = &shrink_string,
+    .write = &print_string,
+    .write_many = &print_many_strings,
+    .del = &dealloc_string,
+    .append = &append_to_string,
+    .append_many = &append_many_to_string,
+    .clone = &copy_string,
+    .share = &share_string,
+    .view = &get_string_view,
+    .equals = &equals_value,
+    .equals_ignore_case = &equals_value_ignore_case,
+    .compare = &compare_string,
+    .hash = &hash_string,
+    .to_lower = &lower_string,
+    .to_upper = &upper_string,
+    .to_lower_into = &lower_string_into,
+    .to_upper_into = &upper_string_into,
+    .index_of = &index_of_element,
+    .last_index_of = &last_index_of_element,
+    .index_of_from = &index_of_element_from,
+    .last_index_of_from = &last_index_of_element_from,
+    .replace = &replace_string,
+    .replace_all = &replace_all_string,
+    .format = &string_format,
+    .to_int = &string_to_int,
+    .to_llong = &string_to_llong,
+    .to_ulong = &string_to_ulong,
+    .to_double = &string_to_double,
+    .is_null = &is_string_null,
+    .is_alpha = &is_string_alpha,
+    .is_alnum = &is_string_alnum,
+    .is_ascii = &is_string_ascii,
+    .is_digit = &is_string_digit,
+    .is_decimal = &is_string_decimal,
+    .is_lower = &is_string_lower,
+    .is_upper = &is_string_upper,
+    .is_printable = &is_string_printable,
+    .is_space = &is_string_space,
+    .is_title = &is_string_title,
+    .is_empty = &is_string_empty
+  };
+
   return (&string_functions);
 }
@@ -0,0 +1,60 @@
+#ifndef STRING_INTERNAL_H
+# define STRING_INTERNAL_H
+
+# include <types/string.h>
+# include <types/map.h>
+
+# define STRING_MIN_CAPACITY 15
+# define STRING_SSO_CAPACITY 23
+// Buffer read_fd starts with when the size of what it reads is unknown
+# define READ_MIN_CAPACITY 4096
+// Matches replace_all remembers while counting them, more are searched again
+# define REPLACE_CACHE 64
+
+// Short contents (up to STRING_SSO_CAPACITY characters) live inline in `sso`,
+// so such a string costs a single allocation. `s` always points at the live
+// buffer, either `sso` or a heap block, so readers never need to care which.
+// The struct and its buffer both come from `alloc`.
+// `hash` caches memoryhash() of the content, 0 means it has to be computed
+// again: every function that changes the content resets it.
+struct string {
+  char            *s;
+  ui64            len;
+  ui64            capacity;
+  const allocator *alloc;
+  ui64            hash;
+  char            sso[STRING_SSO_CAPACITY + 1];
+};
+
+// Heap buffers start with the number of strings using them: share() hands out
+// strings pointing at the same buffer. A buffer referenced more than once is
+// never written, the string about to change it moves into a copy of its own
+// first. `refs` is only accessed atomically.
+typedef struct string_buffer {
+  ui64  refs;
+  char  data[];
+}   string_buffer;
+
+// Set in `refs` of a buffer mapped from a file (see map_file_to_string): it is
+// read-only, so it always looks shared and every change goes to a heap copy.
+// The last reference unmaps it instead of freeing it.
+# define STRING_BUFFER_MAPPED (1ULL << 63)
+
+string  *new_string_len(const allocator *alloc, const char *s, ui64 len);
+void  dealloc_string(string **str);
+int   assign_bytes_to_string(string *str, const char *bytes, ui64 len);
+void  append_bytes_to_string(string *str, const char *bytes, ui64 add_len);
+ui64  string_spare(const string *str);
+int   reserve_spare(string *str, ui64 add_len);
+string  *read_fd_to_string(int fd);
+string  *map_file_to_string(const char *path);
+void  unmap_buffer(string_buffer *buf, ui64 capacity);
+ui64  hash_string(const string *str);
+ui64  format_number(char *dst, typed_value val);
+int   typed_value_bytes(typed_value val, char *buf, const char **ptr, ui64 *len);
+int   typed_value_key(typed_value val, char *buf, const char **ptr, ui64 *len,
+  ui64 *hash);
+const char  *pattern_needle(const pattern *p, ui64 *len);
+string  *map_key_of(map *m, const char *bytes, ui64 len, ui64 hash, int insert);
+
+#endif
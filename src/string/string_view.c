@@ -0,0 +1,385 @@
+#include "string_internal.h"
+#include "../io/io_internal.h"
+#include <types/string_view.h>
+#include <types/search.h>
+
+/// @brief Finds the first (or last) match of a typed value in `len` bytes. A
+/// TYPE_PATTERN value reuses its precompiled search tables.
+/// @param ptr 
+/// @param len 
+/// @param val 
+/// @param backward 0 for the first match, 1 for the last one
+/// @param match_len receives the length of the match, may be NULL
+/// @return index of the match or -1
+static i64  find_value(const char *ptr, ui64 len, typed_value val, int backward,
+  ui64 *match_len)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *needle;
+  ui64        needle_len;
+
+  if (val.type == TYPE_PATTERN)
+  {
+    if (!val.as_pattern)
+      return (-1);
+    if (match_len)
+      *match_len = Pattern()->len(val.as_pattern);
+    if (backward)
+      return (Pattern()->rfind(val.as_pattern, ptr, len, len));
+    return (Pattern()->find(val.as_pattern, ptr, len, 0));
+  }
+  if (!typed_value_bytes(val, buf, &needle, &needle_len))
+    return (-1);
+  if (match_len)
+    *match_len = needle_len;
+  if (backward)
+    return (search_backward(ptr, len, needle, needle_len, len));
+  return (search_forward(ptr, len, needle, needle_len, 0));
+}
+
+/// @brief Tells if the bytes at `ptr` are exactly the bytes of a typed value.
+/// @param ptr 
+/// @param len 
+/// @param val 
+/// @return 1 or 0
+static int  matches_value(const char *ptr, ui64 len, typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *needle;
+  ui64        needle_len;
+
+  if (val.type == TYPE_PATTERN)
+    return (val.as_pattern && Pattern()->len(val.as_pattern) == len
+      && Pattern()->find(val.as_pattern, ptr, len, 0) == 0);
+  if (!typed_value_bytes(val, buf, &needle, &needle_len) || needle_len != len)
+    return (0);
+  return (memorycompare(ptr, needle, len) == 0);
+}
+
+/// @brief Reads how many bytes a typed value stands for.
+/// @param val 
+/// @return the length, 0 if the value holds nothing searchable
+static ui64 value_len(typed_value val)
+{
+  char        buf[NUMBER_MAX_WIDTH];
+  const char  *needle;
+  ui64        needle_len;
+
+  if (val.type == TYPE_PATTERN)
+    return (val.as_pattern ? Pattern()->len(val.as_pattern) : 0);
+  if (!typed_value_bytes(val, buf, &needle, &needle_len))
+    return (0);
+  return (needle_len);
+}
+
+/// @brief Creates a view of a null terminated string, the terminator excluded.
+/// @param s 
+/// @return string_view (a NULL view for a NULL pointer)
+string_view new_view(const char *s)
+{
+  if (!s)
+    return ((string_view){NULL, 0});
+  return ((string_view){s, stringlen((char *)s)});
+}
+
+/// @brief Creates a view of the first `len` bytes at `ptr`, which may hold any byte.
+/// @param ptr 
+/// @param len 
+/// @return string_view
+string_view view_from_bytes(const char *ptr, ui64 len)
+{
+  if (!ptr)
+    return ((string_view){NULL, 0});
+  return ((string_view){ptr, len});
+}
+
+/// @brief Creates a view of the bytes held by a typed value. Only values that own
+/// their bytes (strings, pointers to char and views) can be viewed; any other type
+/// yields a NULL view since there is nothing to borrow.
+/// @param val 
+/// @return string_view
+string_view view_of_value(typed_value val)
+{
+  switch (val.type)
+  {
+    case TYPE_STRING:
+      return (String()->view(val.as_str));
+    case TYPE_PCHAR:
+      return (new_view(val.as_pchar));
+    case TYPE_VIEW:
+      if (!val.as_view)
+        return ((string_view){NULL, 0});
+      return (*val.as_view);
+    default:
+      return ((string_view){NULL, 0});
+  }
+}
+
+/// @brief Returns the `len` bytes of the view starting at `start`. Both are
+/// clamped to the view, so the result is always inside it.
+/// @param view 
+/// @param start 
+/// @param len 
+/// @return string_view (i.e: 'substr(view("hello"), 1, 3)-> "ell"')
+string_view view_substr(string_view view, ui64 start, ui64 len)
+{
+  if (!view.ptr)
+    return (view);
+  if (start > view.len)
+    start = view.len;
+  if (len > view.len - start)
+    len = view.len - start;
+  return ((string_view){view.ptr + start, len});
+}
+
+/// @brief Splits the next token off `rest`: `token` receives everything up to the
+/// first separator and `rest` moves past it. Consecutive separators yield empty
+/// tokens, and once the last token is taken `rest` becomes a NULL view.
+/// @param rest view being consumed, updated in place
+/// @param sep separator, any typed value index_of accepts
+/// @param token receives the token
+/// @return 1 if a token was produced, 0 when `rest` is exhausted
+/// @attention i.e: 'while (View()->split(&rest, VAL_CHAR(','), &field)) ...'
+int view_split(string_view *rest, typed_value sep, string_view *token)
+{
+  ui64  sep_len;
+  i64   idx;
+
+  if (!rest || !token || !rest->ptr)
+    return (0);
+  sep_len = 0;
+  idx = find_value(rest->ptr, rest->len, sep, 0, &sep_len);
+  if (idx < 0)
+  {
+    *token = *rest;
+    *rest = (string_view){NULL, 0};
+    return (1);
+  }
+  *token = (string_view){rest->ptr, (ui64)idx};
+  rest->ptr += (ui64)idx + sep_len;
+  rest->len -= (ui64)idx + sep_len;
+  return (1);
+}
+
+/// @brief Drops the leading white spaces of the view.
+/// @param view 
+/// @return string_view
+string_view view_trim_left(string_view view)
+{
+  ui64  n;
+
+  if (!view.ptr)
+    return (view);
+  n = memoryspan(view.ptr, view.len, CHAR_WHITESPACE);
+  view.ptr += n;
+  view.len -= n;
+  return (view);
+}
+
+/// @brief Drops the trailing white spaces of the view.
+/// @param view 
+/// @return string_view
+string_view view_trim_right(string_view view)
+{
+  if (!view.ptr)
+    return (view);
+  while (view.len && (char_class_of(view.ptr[view.len - 1]) & CHAR_WHITESPACE))
+    view.len--;
+  return (view);
+}
+
+/// @brief Drops the leading and trailing white spaces of the view.
+/// @param view 
+/// @return string_view (i.e: 'trim(view("  hi \n"))-> "hi"')
+string_view view_trim(string_view view)
+{
+  return (view_trim_right(view_trim_left(view)));
+}
+
+/// @brief Verifies if the view starts with the given value.
+/// @param view 
+/// @param val typed_value containing type and value
+/// @return 1 or 0
+int view_starts_with(string_view view, typed_value val)
+{
+  ui64  len;
+
+  if (!view.ptr)
+    return (0);
+  len = value_len(val);
+  if (!len || len > view.len)
+    return (0);
+  return (matches_value(view.ptr, len, val));
+}
+
+/// @brief Verifies if the view ends with the given value.
+/// @param view 
+/// @param val typed_value containing type and value
+/// @return 1 or 0
+int view_ends_with(string_view view, typed_value val)
+{
+  ui64  len;
+
+  if (!view.ptr)
+    return (0);
+  len = value_len(val);
+  if (!len || len > view.len)
+    return (0);
+  return (matches_value(view.ptr + view.len - len, len, val));
+}
+
+/// @brief Returns the index of the first match of the given value in the view.
+/// @param view 
+/// @param val typed_value containing type and value
+/// @return index of the match or -1
+i64 view_index_of(string_view view, typed_value val)
+{
+  if (!view.ptr)
+    return (-1);
+  return (find_value(view.ptr, view.len, val, 0, NULL));
+}
+
+/// @brief Returns the index of the last match of the given value in the view.
+/// @param view 
+/// @param val typed_value containing type and value
+/// @return index of the match or -1
+i64 view_last_index_of(string_view view, typed_value val)
+{
+  if (!view.ptr)
+    return (-1);
+  return (find_value(view.ptr, view.len, val, 1, NULL));
+}
+
+/// @brief Compares the bytes of the view with the bytes of the given value.
+/// @param view 
+/// @param val typed_value containing type and value
+/// @return int (1 if equal, 0 if not equal)
+int view_equals(string_view view, typed_value val)
+{
+  if (!view.ptr)
+    return (0);
+  return (matches_value(view.ptr, view.len, val));
+}
+
+/// @brief Orders two views byte by byte (as unsigned char), a view that is a
+/// prefix of the other comes first. NULL views come before any other view.
+/// @param a 
+/// @param b 
+/// @return negative, 0 or positive, like strcmp
+int view_compare(string_view a, string_view b)
+{
+  int   diff;
+
+  if (!a.ptr || !b.ptr)
+    return ((a.ptr != NULL) - (b.ptr != NULL));
+  diff = memorycompare(a.ptr, b.ptr, a.len < b.len ? a.len : b.len);
+  if (diff)
+    return (diff);
+  return ((a.len > b.len) - (a.len < b.len));
+}
+
+/// @brief Copies the viewed bytes into a new heap string.
+/// @param view 
+/// @return string or NULL for a NULL view or on allocation failure
+string  *view_to_string(string_view view)
+{
+  string  *str;
+
+  if (!view.ptr)
+    return (NULL);
+  str = new_string("");
+  if (!str)
+    return (NULL);
+  if (!String()->reserve(str, view.len))
+  {
+    String()->del(&str);
+    return (NULL);
+  }
+  String()->append(str, VAL_VIEW(view));
+  return (str);
+}
+
+/// @brief Parses the viewed bytes as a decimal int (i.e: a tokenizer field),
+/// see String()->to_int.
+/// @param view 
+/// @param out 
+/// @return status, PARSE_EMPTY for a NULL view
+parse_status  view_to_int(string_view view, int *out)
+{
+  return (parse_int(view.ptr, view.len, out));
+}
+
+/// @brief Parses the viewed bytes as a decimal long long.
+/// @param view 
+/// @param out 
+/// @return status
+parse_status  view_to_llong(string_view view, long long *out)
+{
+  return (parse_llong(view.ptr, view.len, out));
+}
+
+/// @brief Parses the viewed bytes as a decimal unsigned long.
+/// @param view 
+/// @param out 
+/// @return status
+parse_status  view_to_ulong(string_view view, unsigned long *out)
+{
+  return (parse_ulong(view.ptr, view.len, out));
+}
+
+/// @brief Parses the viewed bytes as a correctly rounded double.
+/// @param view 
+/// @param out 
+/// @return status
+parse_status  view_to_double(string_view view, double *out)
+{
+  return (parse_double(view.ptr, view.len, out));
+}
+
+/// @brief It writes the viewed bytes into the file descriptor given as argument.
+/// Short writes and EINTR are resumed until the whole view is written.
+/// @param fd 
+/// @param view a NULL view is written as "NULL"
+/// @return 1 on success, 0 on error (errno tells which)
+int print_view(int fd, string_view view)
+{
+  struct iovec  iov;
+
+  if (!view.ptr)
+    return (write_fully(fd, &(struct iovec){"NULL", 4}, 1));
+  iov.iov_base = (void *)view.ptr;
+  iov.iov_len = view.len;
+  return (write_fully(fd, &iov, 1));
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the string_view type.
+/// @param  
+/// @return view_funcs
+const view_funcs *View(void)
+{
+  static const view_funcs view_functions = {
+    .new = &new_view,
+    .from = &view_from_bytes,
+    .of = &view_of_value,
+    .substr = &view_substr,
+    .split = &view_split,
+    .trim = &view_trim,
+    .trim_left = &view_trim_left,
+    .trim_right = &view_trim_right,
+    .starts_with = &view_starts_with,
+    .ends_with = &view_ends_with,
+    .index_of = &view_index_of,
+    .last_index_of = &view_last_index_of,
+    .equals = &view_equals,
+    .compare = &view_compare,
+    .to_string = &view_to_string,
+    .to_int = &view_to_int,
+    .to_llong = &view_to_llong,
+    .to_ulong = &view_to_ulong,
+    .to_double = &view_to_double,
+    .write = &print_view
+  };
+
+  return (&view_functions);
+}
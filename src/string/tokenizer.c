@@ -0,0 +1,456 @@
+#include "string_internal.h"
+#include <types/tokenizer.h>
+#include <types/string_view.h>
+#include <types/search.h>
+
+# if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#  define TOKENIZER_X86 1
+# endif
+
+// Smallest page size: a read that stays inside one can't fault
+# define TOKENIZER_PAGE 4096
+
+// Reading past the text can't fault, but AddressSanitizer reports it: a short
+// last block then takes the word at a time scan
+# if defined(__SANITIZE_ADDRESS__)
+#  define TOKENIZER_ASAN 1
+# elif defined(__has_feature)
+#  if __has_feature(address_sanitizer)
+#   define TOKENIZER_ASAN 1
+#  endif
+# endif
+
+typedef enum {
+  TOKEN_WHOLE,
+  TOKEN_BYTE,
+  TOKEN_SET,
+  TOKEN_SEQUENCE,
+  TOKEN_PATTERN
+} token_kind;
+
+typedef ui64 __attribute__((may_alias, aligned(1)))  uword;
+
+typedef ui64  (*block_fn)(const tokenizer *, const unsigned char *);
+
+static ui64 block_byte_scalar(const tokenizer *tok, const unsigned char *p);
+static ui64 block_set_scalar(const tokenizer *tok, const unsigned char *p);
+
+// Implementations picked once at startup by init_tokenizer()
+static block_fn g_block_byte = block_byte_scalar;
+static block_fn g_block_set = block_set_scalar;
+
+// A set is kept as a nibble lookup: `set_low` and `set_high` give, for the low
+// nibble of a byte, which high nibbles (0-7 and 8-15) complete a byte of the
+// set. The SIMD kernels run the same lookup 32 bytes at a time with shuffles.
+
+/// @brief Tells if a byte belongs to the separator set.
+static int  in_set(const tokenizer *tok, unsigned char c)
+{
+  if (c < 128)
+    return ((tok->set_low[c & 15] >> (c >> 4)) & 1);
+  return ((tok->set_high[c & 15] >> ((c >> 4) - 8)) & 1);
+}
+
+/// @brief Marks the separators of a full block, one byte at a time.
+static ui64 block_byte_scalar(const tokenizer *tok, const unsigned char *p)
+{
+  ui64  mask;
+  int   i;
+
+  mask = 0;
+  for (i = 0; i < TOKENIZER_BLOCK; i++)
+    mask |= (ui64)(p[i] == tok->byte) << i;
+  return (mask);
+}
+
+/// @brief Marks the separators of a full block, one bitmap lookup per byte.
+static ui64 block_set_scalar(const tokenizer *tok, const unsigned char *p)
+{
+  ui64  mask;
+  int   i;
+
+  mask = 0;
+  for (i = 0; i < TOKENIZER_BLOCK; i++)
+    mask |= (ui64)in_set(tok, p[i]) << i;
+  return (mask);
+}
+
+// ============================================================================
+// SSE2 / AVX2 kernels
+// ============================================================================
+
+// g_nibble_bits turns the high nibble of a byte into the bit of the set rows to
+// test: three shuffles per 32 bytes, whatever the size of the set.
+
+# ifdef TOKENIZER_X86
+
+static const unsigned char  g_nibble_bits[16] = {
+  1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128
+};
+
+__attribute__((target("sse2")))
+static ui64 block_byte_sse2(const tokenizer *tok, const unsigned char *p)
+{
+  __m128i c;
+  ui64    mask;
+  int     i;
+
+  c = _mm_set1_epi8((char)tok->byte);
+  mask = 0;
+  for (i = 0; i < TOKENIZER_BLOCK; i += 16)
+    mask |= (ui64)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(c,
+      _mm_loadu_si128((const __m128i *)(p + i)))) << i;
+  return (mask);
+}
+
+__attribute__((target("avx2")))
+static ui64 block_byte_avx2(const tokenizer *tok, const unsigned char *p)
+{
+  __m256i   c;
+  unsigned  lo;
+  unsigned  hi;
+
+  c = _mm256_set1_epi8((char)tok->byte);
+  lo = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c,
+    _mm256_loadu_si256((const __m256i *)p)));
+  hi = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c,
+    _mm256_loadu_si256((const __m256i *)(p + 32))));
+  _mm256_zeroupper();
+  return ((ui64)lo | ((ui64)hi << 32));
+}
+
+/// @brief Marks the bytes of `v` in the set.
+__attribute__((target("avx2"), always_inline))
+static inline unsigned  set_avx2(__m256i v, __m256i low, __m256i high,
+  __m256i bits)
+{
+  __m256i nibbles;
+  __m256i rows;
+  __m256i hit;
+
+  nibbles = _mm256_set1_epi8(0x0f);
+  // The sign of each byte of `v` picks the row of high nibbles 8-15
+  rows = _mm256_blendv_epi8(
+    _mm256_shuffle_epi8(low, _mm256_and_si256(v, nibbles)),
+    _mm256_shuffle_epi8(high, _mm256_and_si256(v, nibbles)), v);
+  hit = _mm256_and_si256(rows, _mm256_shuffle_epi8(bits,
+    _mm256_and_si256(_mm256_srli_epi16(v, 4), nibbles)));
+  return (~(unsigned)_mm256_movemask_epi8(
+    _mm256_cmpeq_epi8(hit, _mm256_setzero_si256())));
+}
+
+__attribute__((target("avx2")))
+static ui64 block_set_avx2(const tokenizer *tok, const unsigned char *p)
+{
+  __m256i   low;
+  __m256i   high;
+  __m256i   bits;
+  unsigned  lo;
+  unsigned  hi;
+
+  low = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)tok->set_low));
+  high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)tok->set_high));
+  bits = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)g_nibble_bits));
+  lo = set_avx2(_mm256_loadu_si256((const __m256i *)p), low, high, bits);
+  hi = set_avx2(_mm256_loadu_si256((const __m256i *)(p + 32)), low, high, bits);
+  _mm256_zeroupper();
+  return ((ui64)lo | ((ui64)hi << 32));
+}
+
+# endif
+
+/// @brief Picks the fastest block scans the CPU supports, once, before main().
+__attribute__((constructor))
+static void init_tokenizer(void)
+{
+# ifdef TOKENIZER_X86
+  if (cpu_supports(CPU_AVX2))
+  {
+    g_block_byte = block_byte_avx2;
+    g_block_set = block_set_avx2;
+  }
+  else if (cpu_supports(CPU_SSE2))
+    g_block_byte = block_byte_sse2;
+# endif
+}
+
+/// @brief Marks the separator bytes among the 8 bytes of a word: the high bit
+/// of every lane equal to `byte` is set, with no carry leaking between lanes,
+/// then the multiplication gathers the 8 high bits into the low byte.
+static ui64 word_byte_mask(ui64 v, unsigned char byte)
+{
+  ui64  x;
+
+  x = v ^ (byte * 0x0101010101010101ULL);
+  x = ~(((x & 0x7f7f7f7f7f7f7f7fULL) + 0x7f7f7f7f7f7f7f7fULL) | x
+    | 0x7f7f7f7f7f7f7f7fULL);
+  return (((x >> 7) * 0x0102040810204080ULL) >> 56);
+}
+
+/// @brief Marks the separators of the block starting at `base`. The last block
+/// of the text may be short (a short text is nothing but that block). When its
+/// 64 bytes fit in the page of its first byte, the SIMD scan reads past the
+/// text, as stringlen does, and the bits past the end are dropped. Otherwise it
+/// is scanned a word, then a byte at a time, as it always is under
+/// AddressSanitizer.
+/// @param tok 
+/// @param base 
+/// @return bit i set when byte base + i is a separator
+static ui64 scan_block(const tokenizer *tok, ui64 base)
+{
+  const unsigned char *p;
+  ui64                mask;
+  ui64                n;
+  ui64                i;
+
+  p = (const unsigned char *)tok->ptr + base;
+  n = tok->len - base;
+  if (n >= TOKENIZER_BLOCK)
+  {
+    if (tok->kind == TOKEN_BYTE)
+      return (g_block_byte(tok, p));
+    return (g_block_set(tok, p));
+  }
+# if defined(TOKENIZER_X86) && !defined(TOKENIZER_ASAN)
+  if (n && ((unsigned long)p & (TOKENIZER_PAGE - 1))
+    <= TOKENIZER_PAGE - TOKENIZER_BLOCK)
+  {
+    if (tok->kind == TOKEN_BYTE)
+      return (g_block_byte(tok, p) & ((1ULL << n) - 1));
+    return (g_block_set(tok, p) & ((1ULL << n) - 1));
+  }
+# endif
+  mask = 0;
+  i = 0;
+  if (tok->kind == TOKEN_BYTE)
+  {
+    for (; i + 8 <= n; i += 8)
+      mask |= word_byte_mask(*(const uword *)(p + i), tok->byte) << i;
+    for (; i < n; i++)
+      mask |= (ui64)(p[i] == tok->byte) << i;
+    return (mask);
+  }
+  for (; i < n; i++)
+    mask |= (ui64)in_set(tok, p[i]) << i;
+  return (mask);
+}
+
+/// @brief Adds a byte to the separator set.
+static void add_to_set(tokenizer *tok, unsigned char c)
+{
+  if (c < 128)
+    tok->set_low[c & 15] |= (unsigned char)(1 << (c >> 4));
+  else
+    tok->set_high[c & 15] |= (unsigned char)(1 << ((c >> 4) - 8));
+}
+
+/// @brief Creates a tokenizer over the bytes of `text` with no separator yet.
+/// @param text 
+/// @return tokenizer, already done for a text that can't be viewed
+static tokenizer  start_tokenizer(typed_value text)
+{
+  tokenizer   tok;
+  string_view view;
+
+  view = View()->of(text);
+  tok.ptr = view.ptr;
+  tok.len = view.len;
+  tok.pos = 0;
+  tok.base = 0;
+  tok.mask = 0;
+  tok.kind = TOKEN_WHOLE;
+  tok.done = (view.ptr == NULL);
+  tok.sep = NULL;
+  tok.sep_len = 0;
+  tok.pat = NULL;
+  return (tok);
+}
+
+/// @brief Switches the tokenizer to a single byte separator and scans the
+/// first block.
+static void start_byte(tokenizer *tok, unsigned char c)
+{
+  tok->kind = TOKEN_BYTE;
+  tok->byte = c;
+  tok->sep_len = 1;
+  if (!tok->done)
+    tok->mask = scan_block(tok, 0);
+}
+
+/// @brief Creates a tokenizer splitting `text` at every match of `sep`. A one
+/// byte separator is found with the SIMD block scan, a longer one with the
+/// substring search engine (a TYPE_PATTERN reuses its precompiled tables).
+/// @param text string, pointer to char or view to split
+/// @param sep separator, any typed value index_of accepts
+/// @return tokenizer (i.e: 'tok = Tokenizer()->new(VAL_STR(csv), VAL_CHAR(','))')
+tokenizer new_tokenizer(typed_value text, typed_value sep)
+{
+  tokenizer   tok;
+  const char  *bytes;
+  ui64        len;
+
+  tok = start_tokenizer(text);
+  if (sep.type == TYPE_PATTERN)
+  {
+    if (!sep.as_pattern)
+      return (tok);
+    bytes = pattern_needle(sep.as_pattern, &len);
+    tok.pat = sep.as_pattern;
+  }
+  else if (!typed_value_bytes(sep, tok.digits, &bytes, &len))
+    return (tok);
+  if (len == 1)
+    start_byte(&tok, (unsigned char)bytes[0]);
+  else if (len > 1)
+  {
+    tok.kind = tok.pat ? TOKEN_PATTERN : TOKEN_SEQUENCE;
+    // Formatted numbers live in `digits`, which moves with the tokenizer
+    tok.sep = (bytes == tok.digits) ? NULL : bytes;
+    tok.sep_len = len;
+  }
+  return (tok);
+}
+
+/// @brief Creates a tokenizer splitting `text` at every byte found in `set`.
+/// @param text string, pointer to char or view to split
+/// @param set the separator bytes (i.e: VAL_PCHAR(" \t\n")), in any order
+/// @return tokenizer
+tokenizer new_tokenizer_any_of(typed_value text, typed_value set)
+{
+  tokenizer   tok;
+  const char  *bytes;
+  ui64        len;
+  ui64        i;
+
+  tok = start_tokenizer(text);
+  if (set.type == TYPE_PATTERN || !typed_value_bytes(set, tok.digits, &bytes, &len)
+    || !len)
+    return (tok);
+  for (i = 1; i < len && bytes[i] == bytes[0]; i++)
+    ;
+  if (i == len)
+  {
+    start_byte(&tok, (unsigned char)bytes[0]);
+    return (tok);
+  }
+  tok.kind = TOKEN_SET;
+  tok.sep_len = 1;
+  memoryset(tok.set_low, 0, sizeof(tok.set_low));
+  memoryset(tok.set_high, 0, sizeof(tok.set_high));
+  for (i = 0; i < len; i++)
+    add_to_set(&tok, (unsigned char)bytes[i]);
+  if (!tok.done)
+    tok.mask = scan_block(&tok, 0);
+  return (tok);
+}
+
+/// @brief Finds where the current token ends with the substring search.
+/// @param tok 
+/// @return offset of the next separator, -1 if there is none left
+static i64  find_separator(const tokenizer *tok)
+{
+  if (tok->kind == TOKEN_PATTERN)
+    return (Pattern()->find(tok->pat, tok->ptr, tok->len, tok->pos));
+  return (search_forward(tok->ptr, tok->len, tok->sep ? tok->sep : tok->digits,
+    tok->sep_len, tok->pos));
+}
+
+/// @brief Finds where the current token ends once the separators of the
+/// current block (if any) are used up.
+/// @param tok 
+/// @return offset of the next separator, the length of the text if none is left
+static ui64 find_end(tokenizer *tok)
+{
+  i64   idx;
+
+  if (tok->kind == TOKEN_BYTE || tok->kind == TOKEN_SET)
+  {
+    while (!tok->mask && tok->base + TOKENIZER_BLOCK < tok->len)
+    {
+      tok->base += TOKENIZER_BLOCK;
+      tok->mask = scan_block(tok, tok->base);
+    }
+    if (!tok->mask)
+      return (tok->len);
+    idx = (i64)(tok->base + (ui64)__builtin_ctzll(tok->mask));
+    tok->mask &= tok->mask - 1;
+    return ((ui64)idx);
+  }
+  if (tok->kind == TOKEN_WHOLE)
+    return (tok->len);
+  idx = find_separator(tok);
+  return (idx < 0 ? tok->len : (ui64)idx);
+}
+
+/// @brief Moves to the next token. The block scans are consumed one bit at a
+/// time: while the current block has separators left, a token costs a few
+/// instructions, so it is inlined into both public iterators.
+/// @param tok 
+/// @param start receives the offset of the token
+/// @param len receives the length of the token
+/// @return 1 if a token was produced, 0 once the text is exhausted
+static inline int next_token(tokenizer *tok, ui64 *start, ui64 *len)
+{
+  ui64  end;
+
+  if (tok->done)
+    return (0);
+  if (tok->mask)
+  {
+    end = tok->base + (ui64)__builtin_ctzll(tok->mask);
+    tok->mask &= tok->mask - 1;
+  }
+  else
+    end = find_end(tok);
+  *start = tok->pos;
+  *len = end - tok->pos;
+  tok->pos = end + tok->sep_len;
+  tok->done = (end == tok->len);
+  return (1);
+}
+
+/// @brief Moves to the next token and gives its offset and length in the text.
+/// @param tok 
+/// @param start receives the offset of the token
+/// @param len receives the length of the token
+/// @return 1 if a token was produced, 0 once the text is exhausted
+/// @attention i.e: 'while (Tokenizer()->next_span(&tok, &start, &len)) ...'
+int tokenizer_next_span(tokenizer *tok, ui64 *start, ui64 *len)
+{
+  if (!tok || !start || !len)
+    return (0);
+  return (next_token(tok, start, len));
+}
+
+/// @brief Moves to the next token and views it.
+/// @param tok 
+/// @param token receives a view into the text
+/// @return 1 if a token was produced, 0 once the text is exhausted
+/// @attention i.e: 'while (Tokenizer()->next(&tok, &field)) ...'
+int tokenizer_next(tokenizer *tok, string_view *token)
+{
+  ui64  start;
+  ui64  len;
+
+  if (!tok || !token || !next_token(tok, &start, &len))
+    return (0);
+  *token = (string_view){tok->ptr + start, len};
+  return (1);
+}
+
+/// @brief This function returns a struct with all functions that
+/// can be used with the tokenizer type.
+/// @param  
+/// @return tokenizer_funcs
+const tokenizer_funcs *Tokenizer(void)
+{
+  static const tokenizer_funcs  tokenizer_functions = {
+    .new = &new_tokenizer,
+    .any_of = &new_tokenizer_any_of,
+    .next = &tokenizer_next,
+    .next_span = &tokenizer_next_span
+  };
+
+  return (&tokenizer_functions);
+}
@@ -0,0 +1,560 @@
+#include <types/utils.h>
+
+# if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#  define UTILS_X86 1
+# endif
+
+// A class mask made of at most this many byte ranges is matched with SIMD,
+// wider masks fall back to the table
+# define CLASS_MAX_RANGES 4
+
+// Unaligned, aliasing-safe word access for the word-at-a-time loops
+typedef ui64 __attribute__((may_alias, aligned(1)))  uword;
+
+typedef ui64  (*span_fn)(const unsigned char *, ui64, int, int);
+typedef void  (*case_fn)(unsigned char *, const unsigned char *, ui64, unsigned char);
+typedef int   (*casecmp_fn)(const unsigned char *, const unsigned char *, ui64);
+
+// Class of every byte, exactly one primitive CHAR_* bit per byte
+static unsigned char  g_char_classes[256];
+
+// Every class mask as the sorted, disjoint byte ranges it matches, built once
+// at startup. `count` is above CLASS_MAX_RANGES for masks SIMD can't handle.
+static struct {
+  unsigned char lo[CLASS_MAX_RANGES];
+  unsigned char hi[CLASS_MAX_RANGES];
+  int           count;
+} g_class_ranges[256];
+
+static ui64 span_table(const unsigned char *p, ui64 n, int classes, int inside);
+static void case_word(unsigned char *d, const unsigned char *s, ui64 n,
+  unsigned char first);
+static int  casecmp_byte(const unsigned char *a, const unsigned char *b, ui64 n);
+
+// Implementations picked once at startup by init_char_classes()
+static span_fn  g_span = span_table;
+static case_fn  g_case = case_word;
+static casecmp_fn g_casecmp = casecmp_byte;
+
+/// @brief Computes the primitive class of a byte.
+static int  classify_byte(int c)
+{
+  if (c >= 'a' && c <= 'z')
+    return (CHAR_LOWER);
+  if (c >= 'A' && c <= 'Z')
+    return (CHAR_UPPER);
+  if (c >= '0' && c <= '9')
+    return (CHAR_DIGIT);
+  if (c == ' ')
+    return (CHAR_BLANK);
+  if (c >= '\t' && c <= '\r')
+    return (CHAR_SPACE);
+  if (c > ' ' && c < 127)
+    return (CHAR_PUNCT);
+  if (c < 128)
+    return (CHAR_CNTRL);
+  return (CHAR_HIGH);
+}
+
+// ============================================================================
+// Table fallback
+// ============================================================================
+
+/// @brief Counts the leading bytes whose class is (`inside` = 1) or is not
+/// (`inside` = 0) in `classes`, one table lookup per byte.
+static ui64 span_table(const unsigned char *p, ui64 n, int classes, int inside)
+{
+  ui64  i;
+
+  i = 0;
+  if (inside)
+  {
+    while (i < n && (g_char_classes[p[i]] & classes))
+      i++;
+  }
+  else
+  {
+    while (i < n && !(g_char_classes[p[i]] & classes))
+      i++;
+  }
+  return (i);
+}
+
+/// @brief Flips the case of the letters in [first, first + 25], 8 bytes at a
+/// time: a byte gets 0x20 xor-ed in when it lies in the range, computed for all
+/// eight lanes at once without carries leaking between them.
+static void case_word(unsigned char *d, const unsigned char *s, ui64 n,
+  unsigned char first)
+{
+  ui64  v;
+  ui64  above;
+  ui64  below;
+
+  while (n >= 8)
+  {
+    v = *(const uword *)s;
+    // High bit set in lanes >= first, then in lanes > first + 25; ASCII lanes
+    // only, bytes above 127 are never letters
+    above = ((v | 0x8080808080808080ULL) - (first * 0x0101010101010101ULL));
+    below = ((v | 0x8080808080808080ULL) - ((first + 26) * 0x0101010101010101ULL));
+    v ^= ((above & ~below & ~v & 0x8080808080808080ULL) >> 2);
+    *(uword *)d = v;
+    d += 8;
+    s += 8;
+    n -= 8;
+  }
+  while (n--)
+  {
+    *d = *s ^ ((unsigned char)(*s - first) < 26 ? 0x20 : 0);
+    d++;
+    s++;
+  }
+}
+
+/// @brief Lower case version of an ASCII byte, other bytes are returned as they are.
+static int  fold_byte(unsigned char c)
+{
+  return (c ^ ((unsigned char)(c - 'A') < 26 ? 0x20 : 0));
+}
+
+/// @brief Compares byte by byte, ignoring the ASCII case.
+static int  casecmp_byte(const unsigned char *a, const unsigned char *b, ui64 n)
+{
+  ui64  i;
+
+  i = 0;
+  while (i < n)
+  {
+    if (a[i] != b[i] && fold_byte(a[i]) != fold_byte(b[i]))
+      return (fold_byte(a[i]) - fold_byte(b[i]));
+    i++;
+  }
+  return (0);
+}
+
+// ============================================================================
+// SSE2 / AVX2 kernels
+// ============================================================================
+
+// A byte b is in [lo, hi] when (b - lo) as unsigned is at most hi - lo. Biasing
+// both sides by 128 turns that into the signed compare SSE2/AVX2 provide, so a
+// range costs one subtraction and one compare per vector.
+
+# ifdef UTILS_X86
+
+__attribute__((target("sse2")))
+static ui64 span_sse2(const unsigned char *p, ui64 n, int classes, int inside)
+{
+  __m128i bias[CLASS_MAX_RANGES];
+  __m128i limit[CLASS_MAX_RANGES];
+  __m128i v;
+  __m128i out;
+  ui64    i;
+  int     count;
+  int     k;
+  int     mask;
+
+  count = g_class_ranges[classes].count;
+  for (k = 0; k < count; k++)
+  {
+    bias[k] = _mm_set1_epi8((char)(g_class_ranges[classes].lo[k] + 128));
+    limit[k] = _mm_set1_epi8((char)(g_class_ranges[classes].hi[k]
+      - g_class_ranges[classes].lo[k] - 128));
+  }
+  i = 0;
+  while (i + 16 <= n)
+  {
+    v = _mm_loadu_si128((const __m128i *)(p + i));
+    out = _mm_set1_epi8(-1);
+    for (k = 0; k < count; k++)
+      out = _mm_and_si128(out, _mm_cmpgt_epi8(_mm_sub_epi8(v, bias[k]), limit[k]));
+    mask = _mm_movemask_epi8(out);
+    if (inside)
+      mask = ~mask & 0xffff;
+    if (mask != 0xffff)
+      return (i + __builtin_ctz(~mask));
+    i += 16;
+  }
+  return (i + span_table(p + i, n - i, classes, inside));
+}
+
+/// @brief Marks the bytes of `v` outside every range of the mask.
+__attribute__((target("avx2"), always_inline))
+static inline __m256i outside_avx2(__m256i v, const __m256i *bias,
+  const __m256i *limit, int count)
+{
+  __m256i out;
+  int     k;
+
+  out = _mm256_cmpgt_epi8(_mm256_sub_epi8(v, bias[0]), limit[0]);
+  for (k = 1; k < count; k++)
+    out = _mm256_and_si256(out,
+      _mm256_cmpgt_epi8(_mm256_sub_epi8(v, bias[k]), limit[k]));
+  return (out);
+}
+
+/// @brief Scans 64 bytes per iteration. `count` is a constant at every call
+/// site so the range loop is fully unrolled.
+__attribute__((target("avx2"), always_inline))
+static inline ui64 span_ranges_avx2(const unsigned char *p, ui64 n, int classes,
+  int inside, int count)
+{
+  __m256i   bias[CLASS_MAX_RANGES];
+  __m256i   limit[CLASS_MAX_RANGES];
+  __m256i   flip;
+  __m256i   a;
+  __m256i   b;
+  ui64      i;
+  ui64      mask;
+  int       k;
+
+  for (k = 0; k < count; k++)
+  {
+    bias[k] = _mm256_set1_epi8((char)(g_class_ranges[classes].lo[k] + 128));
+    limit[k] = _mm256_set1_epi8((char)(g_class_ranges[classes].hi[k]
+      - g_class_ranges[classes].lo[k] - 128));
+  }
+  // Bytes that stop the span are flagged: outside the ranges for memoryspan,
+  // inside them for memorycspan
+  flip = inside ? _mm256_setzero_si256() : _mm256_set1_epi8(-1);
+  i = 0;
+  while (i + 64 <= n)
+  {
+    a = _mm256_xor_si256(flip, outside_avx2(
+      _mm256_loadu_si256((const __m256i *)(p + i)), bias, limit, count));
+    b = _mm256_xor_si256(flip, outside_avx2(
+      _mm256_loadu_si256((const __m256i *)(p + i + 32)), bias, limit, count));
+    if (!_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_or_si256(a, b)))
+    {
+      mask = (unsigned)_mm256_movemask_epi8(a)
+        | ((ui64)(unsigned)_mm256_movemask_epi8(b) << 32);
+      return (i + __builtin_ctzll(mask));
+    }
+    i += 64;
+  }
+  if (i + 32 <= n)
+  {
+    a = _mm256_xor_si256(flip, outside_avx2(
+      _mm256_loadu_si256((const __m256i *)(p + i)), bias, limit, count));
+    mask = (unsigned)_mm256_movemask_epi8(a);
+    if (mask)
+      return (i + __builtin_ctzll(mask));
+    i += 32;
+  }
+  _mm256_zeroupper();
+  return (i + span_sse2(p + i, n - i, classes, inside));
+}
+
+__attribute__((target("avx2")))
+static ui64 span_avx2(const unsigned char *p, ui64 n, int classes, int inside)
+{
+  switch (g_class_ranges[classes].count)
+  {
+    case 1:
+      return (span_ranges_avx2(p, n, classes, inside, 1));
+    case 2:
+      return (span_ranges_avx2(p, n, classes, inside, 2));
+    case 3:
+      return (span_ranges_avx2(p, n, classes, inside, 3));
+    case 4:
+      return (span_ranges_avx2(p, n, classes, inside, 4));
+    default:
+      return (span_table(p, n, classes, inside));
+  }
+}
+
+/// @brief ASCII only span: the high bits of 128 bytes are OR-reduced and
+/// checked with a single movemask, the block is only rescanned on a hit.
+__attribute__((target("avx2")))
+static ui64 span_ascii_avx2(const unsigned char *p, ui64 n)
+{
+  __m256i   a;
+  ui64      i;
+  unsigned  mask;
+
+  i = 0;
+  while (i + 128 <= n)
+  {
+    a = _mm256_or_si256(
+      _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(p + i)),
+        _mm256_loadu_si256((const __m256i *)(p + i + 32))),
+      _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(p + i + 64)),
+        _mm256_loadu_si256((const __m256i *)(p + i + 96))));
+    if (_mm256_movemask_epi8(a))
+      break ;
+    i += 128;
+  }
+  while (i + 32 <= n)
+  {
+    mask = (unsigned)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)(p + i)));
+    if (mask)
+      return (i + __builtin_ctz(mask));
+    i += 32;
+  }
+  while (i < n && p[i] < 128)
+    i++;
+  return (i);
+}
+
+/// @brief Routes masks made of few ranges to the SIMD kernels.
+__attribute__((target("avx2")))
+static ui64 span_dispatch_avx2(const unsigned char *p, ui64 n, int classes, int inside)
+{
+  if (g_class_ranges[classes].count > CLASS_MAX_RANGES || n < 32)
+    return (span_table(p, n, classes, inside));
+  if (inside && classes == CHAR_ASCII)
+    return (span_ascii_avx2(p, n));
+  return (span_avx2(p, n, classes, inside));
+}
+
+__attribute__((target("sse2")))
+static ui64 span_dispatch_sse2(const unsigned char *p, ui64 n, int classes, int inside)
+{
+  if (g_class_ranges[classes].count > CLASS_MAX_RANGES || n < 16)
+    return (span_table(p, n, classes, inside));
+  return (span_sse2(p, n, classes, inside));
+}
+
+__attribute__((target("sse2")))
+static void case_sse2(unsigned char *d, const unsigned char *s, ui64 n,
+  unsigned char first)
+{
+  __m128i bias;
+  __m128i limit;
+  __m128i flip;
+  __m128i v;
+  ui64    i;
+
+  if (n < 16)
+  {
+    case_word(d, s, n, first);
+    return ;
+  }
+  bias = _mm_set1_epi8((char)(first + 128));
+  limit = _mm_set1_epi8((char)(25 - 128));
+  flip = _mm_set1_epi8(0x20);
+  i = 0;
+  while (1)
+  {
+    v = _mm_loadu_si128((const __m128i *)(s + i));
+    v = _mm_xor_si128(v, _mm_andnot_si128(
+      _mm_cmpgt_epi8(_mm_sub_epi8(v, bias), limit), flip));
+    _mm_storeu_si128((__m128i *)(d + i), v);
+    if (i + 16 == n)
+      break ;
+    // The last block overlaps the previous one, converting twice is harmless
+    i = (i + 32 <= n) ? i + 16 : n - 16;
+  }
+}
+
+/// @brief Flips the case of the letters in [first, first + 25], 64 bytes per
+/// iteration (compare-mask-xor on each 32 byte lane).
+__attribute__((target("avx2")))
+static void case_avx2(unsigned char *d, const unsigned char *s, ui64 n,
+  unsigned char first)
+{
+  __m256i bias;
+  __m256i limit;
+  __m256i flip;
+  __m256i a;
+  __m256i b;
+  ui64    i;
+
+  if (n < 32)
+  {
+    case_sse2(d, s, n, first);
+    return ;
+  }
+  bias = _mm256_set1_epi8((char)(first + 128));
+  limit = _mm256_set1_epi8((char)(25 - 128));
+  flip = _mm256_set1_epi8(0x20);
+  i = 0;
+  while (i + 64 <= n)
+  {
+    a = _mm256_loadu_si256((const __m256i *)(s + i));
+    b = _mm256_loadu_si256((const __m256i *)(s + i + 32));
+    a = _mm256_xor_si256(a, _mm256_andnot_si256(
+      _mm256_cmpgt_epi8(_mm256_sub_epi8(a, bias), limit), flip));
+    b = _mm256_xor_si256(b, _mm256_andnot_si256(
+      _mm256_cmpgt_epi8(_mm256_sub_epi8(b, bias), limit), flip));
+    _mm256_storeu_si256((__m256i *)(d + i), a);
+    _mm256_storeu_si256((__m256i *)(d + i + 32), b);
+    i += 64;
+  }
+  while (i < n)
+  {
+    // The last block overlaps the previous one, converting twice is harmless
+    if (i + 32 > n)
+      i = n - 32;
+    a = _mm256_loadu_si256((const __m256i *)(s + i));
+    a = _mm256_xor_si256(a, _mm256_andnot_si256(
+      _mm256_cmpgt_epi8(_mm256_sub_epi8(a, bias), limit), flip));
+    _mm256_storeu_si256((__m256i *)(d + i), a);
+    i += 32;
+  }
+}
+
+/// @brief Compares 32 bytes per iteration, ignoring the ASCII case: both
+/// sides are folded to lower case in registers and compared for equality.
+__attribute__((target("avx2")))
+static int  casecmp_avx2(const unsigned char *a, const unsigned char *b, ui64 n)
+{
+  __m256i   bias;
+  __m256i   limit;
+  __m256i   flip;
+  __m256i   x;
+  __m256i   y;
+  unsigned  mask;
+  int       i;
+
+  bias = _mm256_set1_epi8((char)('A' + 128));
+  limit = _mm256_set1_epi8((char)(25 - 128));
+  flip = _mm256_set1_epi8(0x20);
+  while (n >= 32)
+  {
+    x = _mm256_loadu_si256((const __m256i *)a);
+    y = _mm256_loadu_si256((const __m256i *)b);
+    x = _mm256_xor_si256(x, _mm256_andnot_si256(
+      _mm256_cmpgt_epi8(_mm256_sub_epi8(x, bias), limit), flip));
+    y = _mm256_xor_si256(y, _mm256_andnot_si256(
+      _mm256_cmpgt_epi8(_mm256_sub_epi8(y, bias), limit), flip));
+    mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+    if (mask != 0xffffffffu)
+    {
+      i = __builtin_ctz(~mask);
+      return (fold_byte(a[i]) - fold_byte(b[i]));
+    }
+    a += 32;
+    b += 32;
+    n -= 32;
+  }
+  _mm256_zeroupper();
+  return (casecmp_byte(a, b, n));
+}
+
+# endif
+
+/// @brief Builds the class table and the ranges of every mask, then picks the
+/// fastest span and case implementations the CPU supports, once, before main().
+__attribute__((constructor))
+static void init_char_classes(void)
+{
+  int mask;
+  int c;
+  int k;
+
+  for (c = 0; c < 256; c++)
+    g_char_classes[c] = (unsigned char)classify_byte(c);
+  for (mask = 0; mask < 256; mask++)
+  {
+    k = 0;
+    for (c = 0; c < 256; c++)
+    {
+      if (!(g_char_classes[c] & mask) || (c > 0 && (g_char_classes[c - 1] & mask)))
+        continue ;
+      if (k < CLASS_MAX_RANGES)
+        g_class_ranges[mask].lo[k] = (unsigned char)c;
+      while (c < 255 && (g_char_classes[c + 1] & mask))
+        c++;
+      if (k < CLASS_MAX_RANGES)
+        g_class_ranges[mask].hi[k] = (unsigned char)c;
+      k++;
+    }
+    g_class_ranges[mask].count = k;
+  }
+# ifdef UTILS_X86
+  if (cpu_supports(CPU_AVX2))
+  {
+    g_span = span_dispatch_avx2;
+    g_case = case_avx2;
+    g_casecmp = casecmp_avx2;
+  }
+  else if (cpu_supports(CPU_SSE2))
+  {
+    g_span = span_dispatch_sse2;
+    g_case = case_sse2;
+  }
+# endif
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/// @brief Returns the class of a byte, one of the primitive CHAR_* values.
+/// @param c
+/// @return char_class (i.e: 'char_class_of('a')-> CHAR_LOWER')
+int char_class_of(int c)
+{
+  return (g_char_classes[(unsigned char)c]);
+}
+
+/// @brief Counts the leading bytes of `ptr` whose class is in `classes`, like
+/// strspn does for a set of characters.
+/// @param ptr
+/// @param bytes
+/// @param classes mask of CHAR_* values
+/// @return number of bytes, `bytes` when all of them match.
+/// (i.e: 'memoryspan("abc1", 4, CHAR_ALPHA)-> 3')
+ui64  memoryspan(const void *ptr, ui64 bytes, int classes)
+{
+  if (!ptr || !bytes)
+    return (0);
+  return (g_span(ptr, bytes, classes & CHAR_ANY, 1));
+}
+
+/// @brief Counts the leading bytes of `ptr` whose class is not in `classes`,
+/// like strcspn does for a set of characters.
+/// @param ptr
+/// @param bytes
+/// @param classes mask of CHAR_* values
+/// @return number of bytes, `bytes` when none of them match.
+/// (i.e: 'memorycspan("abc1", 4, CHAR_DIGIT)-> 3')
+ui64  memorycspan(const void *ptr, ui64 bytes, int classes)
+{
+  if (!ptr || !bytes)
+    return (0);
+  return (g_span(ptr, bytes, classes & CHAR_ANY, 0));
+}
+
+/// @brief Writes the `bytes` bytes of `src` into `dst` with the ASCII upper case
+/// letters turned to lower case, other bytes are copied as they are. `dst` may
+/// be `src` to convert in place, but the buffers must not otherwise overlap.
+/// @param dst 
+/// @param src 
+/// @param bytes 
+void  memorylower(void *dst, const void *src, ui64 bytes)
+{
+  if (!dst || !src || !bytes)
+    return ;
+  g_case(dst, src, bytes, 'A');
+}
+
+/// @brief Writes the `bytes` bytes of `src` into `dst` with the ASCII lower case
+/// letters turned to upper case, other bytes are copied as they are. `dst` may
+/// be `src` to convert in place, but the buffers must not otherwise overlap.
+/// @param dst 
+/// @param src 
+/// @param bytes 
+void  memoryupper(void *dst, const void *src, ui64 bytes)
+{
+  if (!dst || !src || !bytes)
+    return ;
+  g_case(dst, src, bytes, 'a');
+}
+
+/// @brief Compares the first `bytes` bytes of `a` and `b` as if both were lower
+/// case (ASCII letters only), without copying them.
+/// @param a 
+/// @param b 
+/// @param bytes 
+/// @return negative, 0 or positive, like strncasecmp
+int memorycasecompare(const void *a, const void *b, ui64 bytes)
+{
+  if (!bytes || a == b)
+    return (0);
+  if (!a || !b)
+    return ((a != NULL) - (b != NULL));
+  return (g_casecmp(a, b, bytes));
+}
@@ -0,0 +1,109 @@
+#include <types/utils.h>
+
+// wyhash (final version 4) with its default secret and a fixed seed: a 64x64
+// multiply folded to 64 bits mixes 16 input bytes per step, so short keys cost
+// a couple of multiplies and long ones run close to memory speed.
+# define HASH_SECRET0 0xa0761d6478bd642fULL
+# define HASH_SECRET1 0xe7037ed1a0b428dbULL
+# define HASH_SECRET2 0x8ebc6af09c88c6e3ULL
+# define HASH_SECRET3 0x589965cc75374cc3ULL
+
+// Unaligned, aliasing-safe word access
+typedef ui64 __attribute__((may_alias, aligned(1)))  uword;
+typedef unsigned int __attribute__((may_alias, aligned(1)))  uhalf;
+
+/// @brief Multiplies `a` by `b`, keeping the low half in `a` and the high half
+/// in `b`.
+static inline void  hash_mum(ui64 *a, ui64 *b)
+{
+  unsigned __int128 r;
+
+  r = (unsigned __int128)*a * *b;
+  *a = (ui64)r;
+  *b = (ui64)(r >> 64);
+}
+
+/// @brief Folds the 128-bit product of `a` and `b` into 64 bits.
+static inline ui64  hash_mix(ui64 a, ui64 b)
+{
+  hash_mum(&a, &b);
+  return (a ^ b);
+}
+
+static inline ui64  read8(const unsigned char *p)
+{
+  return (*(const uword *)p);
+}
+
+static inline ui64  read4(const unsigned char *p)
+{
+  return (*(const uhalf *)p);
+}
+
+/// @brief Packs 1 to 3 bytes, every byte is read at least once.
+static inline ui64  read3(const unsigned char *p, ui64 n)
+{
+  return (((ui64)p[0] << 16) | ((ui64)p[n >> 1] << 8) | p[n - 1]);
+}
+
+/// @brief Hashes `bytes` bytes of memory. The result only depends on the bytes,
+/// so equal contents hash the same whatever holds them (strings, views, ...).
+/// It is fast and well distributed, but not meant to resist crafted inputs.
+/// @param ptr
+/// @param bytes
+/// @return 64-bit hash
+ui64  memoryhash(const void *ptr, ui64 bytes)
+{
+  const unsigned char *p;
+  ui64                seed;
+  ui64                see1;
+  ui64                see2;
+  ui64                a;
+  ui64                b;
+  ui64                i;
+
+  p = ptr;
+  seed = hash_mix(HASH_SECRET0, HASH_SECRET1);
+  if (bytes <= 16)
+  {
+    a = 0;
+    b = 0;
+    if (bytes >= 4)
+    {
+      a = (read4(p) << 32) | read4(p + ((bytes >> 3) << 2));
+      b = (read4(p + bytes - 4) << 32) | read4(p + bytes - 4 - ((bytes >> 3) << 2));
+    }
+    else if (bytes > 0)
+      a = read3(p, bytes);
+  }
+  else
+  {
+    i = bytes;
+    if (i > 48)
+    {
+      see1 = seed;
+      see2 = seed;
+      while (i > 48)
+      {
+        seed = hash_mix(read8(p) ^ HASH_SECRET1, read8(p + 8) ^ seed);
+        see1 = hash_mix(read8(p + 16) ^ HASH_SECRET2, read8(p + 24) ^ see1);
+        see2 = hash_mix(read8(p + 32) ^ HASH_SECRET3, read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      }
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16)
+    {
+      seed = hash_mix(read8(p) ^ HASH_SECRET1, read8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    a = read8(p + i - 16);
+    b = read8(p + i - 8);
+  }
+  a ^= HASH_SECRET1;
+  b ^= seed;
+  hash_mum(&a, &b);
+  return (hash_mix(a ^ HASH_SECRET0 ^ bytes, b ^ HASH_SECRET1));
+}
@@ -1,29 +1,676 @@
 #include <types/utils.h>
 # include <stdio.h>
 
-/// @brief Copies the bytes from the source to the destination.
+# if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#  define UTILS_X86 1
+# endif
+
+# define WORD_ONES  0x0101010101010101ULL
+# define WORD_HIGHS 0x8080808080808080ULL
+
+// Unaligned, aliasing-safe word access for the word-at-a-time loops
+typedef ui64 __attribute__((may_alias, aligned(1)))  uword;
+
+// The terminator searches read whole aligned blocks around the string: that
+// never faults, but AddressSanitizer would report the bytes past the end
+# define READS_WHOLE_BLOCKS __attribute__((no_sanitize_address))
+
+typedef void  (*copy_fn)(unsigned char *, const unsigned char *, ui64);
+typedef void  (*set_fn)(unsigned char *, unsigned char, ui64);
+typedef ui64  (*len_fn)(const char *);
+typedef void  *(*chr_fn)(const unsigned char *, unsigned char, ui64);
+typedef int   (*cmp_fn)(const unsigned char *, const unsigned char *, ui64);
+
+static void copy_forward_word(unsigned char *d, const unsigned char *s, ui64 n);
+static void copy_backward_word(unsigned char *d, const unsigned char *s, ui64 n);
+static void set_word(unsigned char *p, unsigned char c, ui64 n);
+static ui64 len_word(const char *s);
+static void *chr_word(const unsigned char *p, unsigned char c, ui64 n);
+static void *rchr_word(const unsigned char *p, unsigned char c, ui64 n);
+static int  cmp_word(const unsigned char *a, const unsigned char *b, ui64 n);
+
+// Implementations picked once at startup by init_dispatch(), the portable
+// word-at-a-time versions are used until then and on non-x86 targets.
+static struct {
+  copy_fn copy_forward;
+  copy_fn copy_backward;
+  set_fn  set;
+  len_fn  len;
+  chr_fn  chr;
+  chr_fn  rchr;
+  cmp_fn  cmp;
+} g_dispatch = {
+  copy_forward_word,
+  copy_backward_word,
+  set_word,
+  len_word,
+  chr_word,
+  rchr_word,
+  cmp_word
+};
+
+static int  g_cpu_features = -1;
+
+/// @brief Detects the SIMD extensions supported by the CPU (and enabled by the OS).
+/// The result is computed once and cached.
+/// @param feature 
+/// @return 1 if the feature is available, 0 otherwise
+int cpu_supports(cpu_feature feature)
+{
+  int features;
+
+  if (g_cpu_features < 0)
+  {
+    features = 0;
+# ifdef UTILS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+      features |= CPU_SSE2;
+    if (__builtin_cpu_supports("avx2"))
+      features |= CPU_AVX2;
+# endif
+    g_cpu_features = features;
+  }
+  return ((g_cpu_features & feature) != 0);
+}
+
+// ============================================================================
+// Word-at-a-time fallbacks
+// ============================================================================
+
+/// @brief Copies front to back, 8 bytes at a time. Safe when `d` is below `s`.
+static void copy_forward_word(unsigned char *d, const unsigned char *s, ui64 n)
+{
+  ui64  w0;
+  ui64  w1;
+
+  while (n >= 16)
+  {
+    w0 = *(const uword *)s;
+    w1 = *(const uword *)(s + 8);
+    *(uword *)d = w0;
+    *(uword *)(d + 8) = w1;
+    d += 16;
+    s += 16;
+    n -= 16;
+  }
+  while (n--)
+    *d++ = *s++;
+}
+
+/// @brief Copies back to front, 8 bytes at a time. Safe when `d` is above `s`.
+static void copy_backward_word(unsigned char *d, const unsigned char *s, ui64 n)
+{
+  ui64  w0;
+  ui64  w1;
+
+  d += n;
+  s += n;
+  while (n >= 16)
+  {
+    d -= 16;
+    s -= 16;
+    n -= 16;
+    w0 = *(const uword *)s;
+    w1 = *(const uword *)(s + 8);
+    *(uword *)d = w0;
+    *(uword *)(d + 8) = w1;
+  }
+  while (n--)
+    *--d = *--s;
+}
+
+/// @brief Fills with a byte, aligning the destination and then storing words.
+static void set_word(unsigned char *p, unsigned char c, ui64 n)
+{
+  ui64  w;
+
+  while (n && ((unsigned long)p & 7))
+  {
+    *p++ = c;
+    n--;
+  }
+  w = c * WORD_ONES;
+  while (n >= 8)
+  {
+    *(ui64 *)p = w;
+    p += 8;
+    n -= 8;
+  }
+  while (n--)
+    *p++ = c;
+}
+
+/// @brief Finds the terminator 8 bytes at a time. Reads are aligned, so they
+/// never cross into a page the string doesn't touch.
+READS_WHOLE_BLOCKS
+static ui64 len_word(const char *s)
+{
+  const char  *p;
+  const ui64  *w;
+  ui64        v;
+
+  p = s;
+  while ((unsigned long)p & 7)
+  {
+    if (!*p)
+      return ((ui64)(p - s));
+    p++;
+  }
+  w = (const ui64 *)p;
+  while (1)
+  {
+    v = *(const uword *)w;
+    if ((v - WORD_ONES) & ~v & WORD_HIGHS)
+      break ;
+    w++;
+  }
+  p = (const char *)w;
+  while (*p)
+    p++;
+  return ((ui64)(p - s));
+}
+
+/// @brief Finds the first `c` 8 bytes at a time.
+static void *chr_word(const unsigned char *p, unsigned char c, ui64 n)
+{
+  ui64  pattern;
+  ui64  v;
+
+  pattern = c * WORD_ONES;
+  while (n >= 8)
+  {
+    v = *(const uword *)p ^ pattern;
+    if ((v - WORD_ONES) & ~v & WORD_HIGHS)
+      break ;
+    p += 8;
+    n -= 8;
+  }
+  while (n--)
+  {
+    if (*p == c)
+      return ((void *)p);
+    p++;
+  }
+  return (NULL);
+}
+
+/// @brief Finds the last `c` 8 bytes at a time.
+static void *rchr_word(const unsigned char *p, unsigned char c, ui64 n)
+{
+  ui64  pattern;
+  ui64  v;
+
+  pattern = c * WORD_ONES;
+  while (n >= 8)
+  {
+    v = *(const uword *)(p + n - 8) ^ pattern;
+    if ((v - WORD_ONES) & ~v & WORD_HIGHS)
+      break ;
+    n -= 8;
+  }
+  while (n--)
+  {
+    if (p[n] == c)
+      return ((void *)(p + n));
+  }
+  return (NULL);
+}
+
+/// @brief Compares 8 bytes at a time, the first differing byte is located from
+/// the lowest set bit of the xor (words are loaded little endian).
+static int  cmp_word(const unsigned char *a, const unsigned char *b, ui64 n)
+{
+  ui64  x;
+  int   i;
+
+  while (n >= 8)
+  {
+    x = *(const uword *)a ^ *(const uword *)b;
+    if (x)
+    {
+      i = __builtin_ctzll(x) >> 3;
+      return (a[i] - b[i]);
+    }
+    a += 8;
+    b += 8;
+    n -= 8;
+  }
+  while (n--)
+  {
+    if (*a != *b)
+      return (*a - *b);
+    a++;
+    b++;
+  }
+  return (0);
+}
+
+// ============================================================================
+// SSE2 / AVX2 kernels
+// ============================================================================
+
+# ifdef UTILS_X86
+
+__attribute__((target("sse2")))
+static void copy_forward_sse2(unsigned char *d, const unsigned char *s, ui64 n)
+{
+  __m128i a;
+  __m128i b;
+
+  while (n >= 32)
+  {
+    a = _mm_loadu_si128((const __m128i *)s);
+    b = _mm_loadu_si128((const __m128i *)(s + 16));
+    _mm_storeu_si128((__m128i *)d, a);
+    _mm_storeu_si128((__m128i *)(d + 16), b);
+    d += 32;
+    s += 32;
+    n -= 32;
+  }
+  copy_forward_word(d, s, n);
+}
+
+__attribute__((target("sse2")))
+static void copy_backward_sse2(unsigned char *d, const unsigned char *s, ui64 n)
+{
+  __m128i a;
+  __m128i b;
+
+  while (n >= 32)
+  {
+    n -= 32;
+    a = _mm_loadu_si128((const __m128i *)(s + n));
+    b = _mm_loadu_si128((const __m128i *)(s + n + 16));
+    _mm_storeu_si128((__m128i *)(d + n), a);
+    _mm_storeu_si128((__m128i *)(d + n + 16), b);
+  }
+  copy_backward_word(d, s, n);
+}
+
+__attribute__((target("sse2")))
+static void set_sse2(unsigned char *p, unsigned char c, ui64 n)
+{
+  __m128i v;
+
+  v = _mm_set1_epi8((char)c);
+  while (n >= 16)
+  {
+    _mm_storeu_si128((__m128i *)p, v);
+    p += 16;
+    n -= 16;
+  }
+  set_word(p, c, n);
+}
+
+__attribute__((target("sse2"))) READS_WHOLE_BLOCKS
+static ui64 len_sse2(const char *s)
+{
+  const char  *p;
+  __m128i     zero;
+  unsigned    mask;
+  unsigned    shift;
+
+  zero = _mm_setzero_si128();
+  shift = (unsigned)((unsigned long)s & 15);
+  p = s - shift;
+  mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+    _mm_load_si128((const __m128i *)p), zero)) >> shift;
+  if (mask)
+    return (__builtin_ctz(mask));
+  while (1)
+  {
+    p += 16;
+    mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+      _mm_load_si128((const __m128i *)p), zero));
+    if (mask)
+      return ((ui64)(p - s) + __builtin_ctz(mask));
+  }
+}
+
+__attribute__((target("sse2")))
+static void *chr_sse2(const unsigned char *p, unsigned char c, ui64 n)
+{
+  __m128i   v;
+  unsigned  mask;
+
+  v = _mm_set1_epi8((char)c);
+  while (n >= 16)
+  {
+    mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+      _mm_loadu_si128((const __m128i *)p), v));
+    if (mask)
+      return ((void *)(p + __builtin_ctz(mask)));
+    p += 16;
+    n -= 16;
+  }
+  return (chr_word(p, c, n));
+}
+
+__attribute__((target("sse2")))
+static void *rchr_sse2(const unsigned char *p, unsigned char c, ui64 n)
+{
+  __m128i   v;
+  unsigned  mask;
+
+  v = _mm_set1_epi8((char)c);
+  while (n >= 16)
+  {
+    n -= 16;
+    mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+      _mm_loadu_si128((const __m128i *)(p + n)), v));
+    if (mask)
+      return ((void *)(p + n + 31 - __builtin_clz(mask)));
+  }
+  return (rchr_word(p, c, n));
+}
+
+__attribute__((target("avx2")))
+static void copy_forward_avx2(unsigned char *d, const unsigned char *s, ui64 n)
+{
+  __m256i a;
+  __m256i b;
+  __m256i c;
+  __m256i e;
+
+  while (n >= 128)
+  {
+    a = _mm256_loadu_si256((const __m256i *)s);
+    b = _mm256_loadu_si256((const __m256i *)(s + 32));
+    c = _mm256_loadu_si256((const __m256i *)(s + 64));
+    e = _mm256_loadu_si256((const __m256i *)(s + 96));
+    _mm256_storeu_si256((__m256i *)d, a);
+    _mm256_storeu_si256((__m256i *)(d + 32), b);
+    _mm256_storeu_si256((__m256i *)(d + 64), c);
+    _mm256_storeu_si256((__m256i *)(d + 96), e);
+    d += 128;
+    s += 128;
+    n -= 128;
+  }
+  while (n >= 32)
+  {
+    a = _mm256_loadu_si256((const __m256i *)s);
+    _mm256_storeu_si256((__m256i *)d, a);
+    d += 32;
+    s += 32;
+    n -= 32;
+  }
+  copy_forward_word(d, s, n);
+}
+
+__attribute__((target("avx2")))
+static void copy_backward_avx2(unsigned char *d, const unsigned char *s, ui64 n)
+{
+  __m256i a;
+  __m256i b;
+  __m256i c;
+  __m256i e;
+
+  while (n >= 128)
+  {
+    n -= 128;
+    a = _mm256_loadu_si256((const __m256i *)(s + n));
+    b = _mm256_loadu_si256((const __m256i *)(s + n + 32));
+    c = _mm256_loadu_si256((const __m256i *)(s + n + 64));
+    e = _mm256_loadu_si256((const __m256i *)(s + n + 96));
+    _mm256_storeu_si256((__m256i *)(d + n), a);
+    _mm256_storeu_si256((__m256i *)(d + n + 32), b);
+    _mm256_storeu_si256((__m256i *)(d + n + 64), c);
+    _mm256_storeu_si256((__m256i *)(d + n + 96), e);
+  }
+  while (n >= 32)
+  {
+    n -= 32;
+    a = _mm256_loadu_si256((const __m256i *)(s + n));
+    _mm256_storeu_si256((__m256i *)(d + n), a);
+  }
+  copy_backward_word(d, s, n);
+}
+
+__attribute__((target("avx2")))
+static void set_avx2(unsigned char *p, unsigned char c, ui64 n)
+{
+  __m256i       v;
+  unsigned char *end;
+
+  if (n < 32)
+  {
+    set_word(p, c, n);
+    return ;
+  }
+  v = _mm256_set1_epi8((char)c);
+  end = p + n;
+  _mm256_storeu_si256((__m256i *)p, v);
+  p = (unsigned char *)(((unsigned long)p + 32) & ~31UL);
+  while (p + 128 <= end)
+  {
+    _mm256_store_si256((__m256i *)p, v);
+    _mm256_store_si256((__m256i *)(p + 32), v);
+    _mm256_store_si256((__m256i *)(p + 64), v);
+    _mm256_store_si256((__m256i *)(p + 96), v);
+    p += 128;
+  }
+  while (p + 32 <= end)
+  {
+    _mm256_store_si256((__m256i *)p, v);
+    p += 32;
+  }
+  if (p < end)
+    _mm256_storeu_si256((__m256i *)(end - 32), v);
+}
+
+__attribute__((target("avx2"))) READS_WHOLE_BLOCKS
+static ui64 len_avx2(const char *s)
+{
+  const char  *p;
+  __m256i     zero;
+  __m256i     a;
+  __m256i     b;
+  unsigned    mask;
+  unsigned    shift;
+
+  zero = _mm256_setzero_si256();
+  shift = (unsigned)((unsigned long)s & 31);
+  p = s - shift;
+  mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+    _mm256_load_si256((const __m256i *)p), zero)) >> shift;
+  if (mask)
+    return (__builtin_ctz(mask));
+  p += 32;
+  if ((unsigned long)p & 63)
+  {
+    mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+      _mm256_load_si256((const __m256i *)p), zero));
+    if (mask)
+      return ((ui64)(p - s) + __builtin_ctz(mask));
+    p += 32;
+  }
+  while (1)
+  {
+    a = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), zero);
+    b = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)(p + 32)), zero);
+    if (!_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_or_si256(a, b)))
+      break ;
+    p += 64;
+  }
+  mask = (unsigned)_mm256_movemask_epi8(a);
+  if (mask)
+    return ((ui64)(p - s) + __builtin_ctz(mask));
+  mask = (unsigned)_mm256_movemask_epi8(b);
+  return ((ui64)(p - s) + 32 + __builtin_ctz(mask));
+}
+
+__attribute__((target("avx2")))
+static void *chr_avx2(const unsigned char *p, unsigned char c, ui64 n)
+{
+  __m256i   v;
+  __m256i   a;
+  __m256i   b;
+  unsigned  mask;
+
+  v = _mm256_set1_epi8((char)c);
+  while (n >= 64)
+  {
+    a = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), v);
+    b = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + 32)), v);
+    if (!_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_or_si256(a, b)))
+    {
+      mask = (unsigned)_mm256_movemask_epi8(a);
+      if (mask)
+        return ((void *)(p + __builtin_ctz(mask)));
+      mask = (unsigned)_mm256_movemask_epi8(b);
+      return ((void *)(p + 32 + __builtin_ctz(mask)));
+    }
+    p += 64;
+    n -= 64;
+  }
+  while (n >= 32)
+  {
+    mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+      _mm256_loadu_si256((const __m256i *)p), v));
+    if (mask)
+      return ((void *)(p + __builtin_ctz(mask)));
+    p += 32;
+    n -= 32;
+  }
+  _mm256_zeroupper();
+  return (chr_word(p, c, n));
+}
+
+__attribute__((target("avx2")))
+static void *rchr_avx2(const unsigned char *p, unsigned char c, ui64 n)
+{
+  __m256i   v;
+  unsigned  mask;
+
+  v = _mm256_set1_epi8((char)c);
+  while (n >= 32)
+  {
+    n -= 32;
+    mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+      _mm256_loadu_si256((const __m256i *)(p + n)), v));
+    if (mask)
+      return ((void *)(p + n + 31 - __builtin_clz(mask)));
+  }
+  _mm256_zeroupper();
+  return (rchr_word(p, c, n));
+}
+
+__attribute__((target("sse2")))
+static int  cmp_sse2(const unsigned char *a, const unsigned char *b, ui64 n)
+{
+  unsigned  mask;
+  int       i;
+
+  while (n >= 16)
+  {
+    mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+      _mm_loadu_si128((const __m128i *)a), _mm_loadu_si128((const __m128i *)b)));
+    if (mask != 0xffff)
+    {
+      i = __builtin_ctz(~mask);
+      return (a[i] - b[i]);
+    }
+    a += 16;
+    b += 16;
+    n -= 16;
+  }
+  return (cmp_word(a, b, n));
+}
+
+__attribute__((target("avx2")))
+static int  cmp_avx2(const unsigned char *a, const unsigned char *b, ui64 n)
+{
+  __m256i   x;
+  __m256i   y;
+  ui64      mask;
+  int       i;
+
+  while (n >= 64)
+  {
+    x = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)a),
+      _mm256_loadu_si256((const __m256i *)b));
+    y = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + 32)),
+      _mm256_loadu_si256((const __m256i *)(b + 32)));
+    if (!_mm256_testc_si256(_mm256_and_si256(x, y), _mm256_set1_epi8(-1)))
+    {
+      mask = (unsigned)_mm256_movemask_epi8(x)
+        | ((ui64)(unsigned)_mm256_movemask_epi8(y) << 32);
+      i = __builtin_ctzll(~mask);
+      return (a[i] - b[i]);
+    }
+    a += 64;
+    b += 64;
+    n -= 64;
+  }
+  if (n >= 32)
+  {
+    mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+      _mm256_loadu_si256((const __m256i *)a), _mm256_loadu_si256((const __m256i *)b)));
+    if (mask != 0xffffffffu)
+    {
+      i = __builtin_ctz(~(unsigned)mask);
+      return (a[i] - b[i]);
+    }
+    a += 32;
+    b += 32;
+    n -= 32;
+  }
+  // The tail runs legacy SSE code: clear the upper halves first, GCC does not
+  // emit vzeroupper before a sibling call and the dirty state would slow down
+  // every SSE instruction of the caller
+  _mm256_zeroupper();
+  return (cmp_sse2(a, b, n));
+}
+
+# endif
+
+/// @brief Picks the fastest implementation the CPU supports, once, before main().
+__attribute__((constructor))
+static void init_dispatch(void)
+{
+# ifdef UTILS_X86
+  if (cpu_supports(CPU_AVX2))
+  {
+    g_dispatch.copy_forward = copy_forward_avx2;
+    g_dispatch.copy_backward = copy_backward_avx2;
+    g_dispatch.set = set_avx2;
+    g_dispatch.len = len_avx2;
+    g_dispatch.chr = chr_avx2;
+    g_dispatch.rchr = rchr_avx2;
+    g_dispatch.cmp = cmp_avx2;
+  }
+  else if (cpu_supports(CPU_SSE2))
+  {
+    g_dispatch.copy_forward = copy_forward_sse2;
+    g_dispatch.copy_backward = copy_backward_sse2;
+    g_dispatch.set = set_sse2;
+    g_dispatch.len = len_sse2;
+    g_dispatch.chr = chr_sse2;
+    g_dispatch.rchr = rchr_sse2;
+    g_dispatch.cmp = cmp_sse2;
+  }
+# endif
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/// @brief Copies the bytes from the source to the destination. Overlapping
+/// regions are handled like memmove.
 /// @param dst 
 /// @param src 
 /// @param bytes 
 void  memorycopy(void *dst, void *src, ui64 bytes)
 {
-  unsigned char *d;
-  unsigned char *s;
-
-  d = dst;
-  s = src;
-  if (!dst || !src || !bytes)
+  if (!dst || !src || !bytes || dst == src)
     return ;
   if (dst > src)
-  {
-    while (bytes--)
-      d[bytes] = s[bytes];
-  }
+    g_dispatch.copy_backward(dst, src, bytes);
   else
-  {
-    while (bytes--)
-      *d++ = *s++;
-  }
+    g_dispatch.copy_forward(dst, src, bytes);
 }
 
 /// @brief Caculates the number of characters from a pointer to char.
@@ -31,12 +678,9 @@ void  memorycopy(void *dst, void *src, ui64 bytes)
 /// @return unsigned long long. (i.e: 'stringlen("hello")-> 5')
 ui64  stringlen(char *s)
 {
-  ui64  i;
-
-  i = 0;
-  while (s && s[i])
-    i++;
-  return (i);
+  if (!s)
+    return (0);
+  return (g_dispatch.len(s));
 }
 
 /// @brief Sets the n bytes from the ptr address onwards to the second given argument.
@@ -45,47 +689,203 @@ ui64  stringlen(char *s)
 /// @param bytes 
 void  memoryset(void *ptr, int c, ui64 bytes)
 {
-  unsigned char *p;
-
-  p = ptr;
   if (!ptr || !bytes)
     return ;
-  while (bytes--)
-    *p++ = c;
+  g_dispatch.set(ptr, (unsigned char)c, bytes);
 }
 
-/// @brief Converts an integer to a pointer to char (ascii).
+/// @brief Finds the first occurrence of the byte `c` in the first `bytes` bytes of `ptr`.
+/// @param ptr 
+/// @param c 
+/// @param bytes 
+/// @return pointer to the byte or NULL. (i.e: 'memorychr("hello", 'l', 5)-> "llo"')
+void  *memorychr(const void *ptr, int c, ui64 bytes)
+{
+  if (!ptr || !bytes)
+    return (NULL);
+  return (g_dispatch.chr(ptr, (unsigned char)c, bytes));
+}
+
+/// @brief Finds the last occurrence of the byte `c` in the first `bytes` bytes of `ptr`.
+/// @param ptr 
+/// @param c 
+/// @param bytes 
+/// @return pointer to the byte or NULL. (i.e: 'memoryrchr("hello", 'l', 5)-> "lo"')
+void  *memoryrchr(const void *ptr, int c, ui64 bytes)
+{
+  if (!ptr || !bytes)
+    return (NULL);
+  return (g_dispatch.rchr(ptr, (unsigned char)c, bytes));
+}
+
+/// @brief Compares the first `bytes` bytes of `a` and `b` as unsigned chars.
+/// @param a 
+/// @param b 
+/// @param bytes 
+/// @return negative, 0 or positive, like memcmp
+int memorycompare(const void *a, const void *b, ui64 bytes)
+{
+  if (!bytes || a == b)
+    return (0);
+  if (!a || !b)
+    return ((a != NULL) - (b != NULL));
+  return (g_dispatch.cmp(a, b, bytes));
+}
+
+// ============================================================================
+// Integer formatting
+// ============================================================================
+
+static const char   g_digit_pairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static const unsigned long long g_powers_of_ten[20] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+  10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+  100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+  100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+  100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/// @brief Counts the decimal digits of `n` without dividing: the bit length gives
+/// an estimate of log10 that a single table lookup corrects.
 /// @param n 
-/// @return pointer to char. (i.e: 'int_to_ascii(78)-> "78"')
-char  *int_to_ascii(int n)
+/// @return unsigned long long. (i.e: 'count_digits(1337)-> 4')
+ui64  count_digits(unsigned long long n)
+{
+  ui64  t;
+
+  if (!n)
+    return (1);
+  t = ((ui64)(64 - __builtin_clzll(n)) * 1233) >> 12;
+  return (t - (n < g_powers_of_ten[t]) + 1);
+}
+
+/// @brief Writes the decimal digits of `n` backwards, ending right before `end`,
+/// two digits per step through the digit pair table.
+static void write_digits(char *end, unsigned long long n)
+{
+  ui64  pair;
+
+  while (n >= 100)
+  {
+    pair = (n % 100) * 2;
+    n /= 100;
+    *--end = g_digit_pairs[pair + 1];
+    *--end = g_digit_pairs[pair];
+  }
+  if (n >= 10)
+  {
+    *--end = g_digit_pairs[n * 2 + 1];
+    *--end = g_digit_pairs[n * 2];
+  }
+  else
+    *--end = (char)('0' + n);
+}
+
+/// @brief Writes `n` in decimal into `dst` (no terminator). With a NULL `dst`
+/// it only measures.
+/// @param dst 
+/// @param n 
+/// @return number of characters (i.e: 'format_ullong(buf, 42)-> 2, "42"')
+ui64  format_ullong(char *dst, unsigned long long n)
 {
-  char  *ptr;
   ui64  len;
-  int   num;
 
-  num = n;
-  len = 0;
-  if (n <= 0)
-    len++;
-  while (num)
+  len = count_digits(n);
+  if (dst)
+    write_digits(dst + len, n);
+  return (len);
+}
+
+/// @brief Writes `n` in decimal into `dst` (no terminator). With a NULL `dst`
+/// it only measures.
+/// @param dst 
+/// @param n 
+/// @return number of characters (i.e: 'format_llong(buf, -42)-> 3, "-42"')
+ui64  format_llong(char *dst, long long n)
+{
+  unsigned long long  u;
+
+  if (n >= 0)
+    return (format_ullong(dst, (unsigned long long)n));
+  u = 0ULL - (unsigned long long)n;
+  if (dst)
   {
-    len++;
-    num /= 10;
+    *dst = '-';
+    dst++;
   }
-  ptr = calloc(len + 1, sizeof(char));
-  if (!ptr)
-    return (NULL);
-  ptr[len--] = '\0';
-  if (!n)
-    ptr[0] = '0';
-  if (n < 0)
-    ptr[0] = '-';
-  while (n)
+  return (1 + format_ullong(dst, u));
+}
+
+/// @brief Writes `n` in lowercase hexadecimal into `dst` (no prefix, no
+/// terminator). With a NULL `dst` it only measures.
+/// @param dst 
+/// @param n 
+/// @return number of characters (i.e: 'format_hex(buf, 255)-> 2, "ff"')
+ui64  format_hex(char *dst, unsigned long long n)
+{
+  ui64  len;
+  ui64  i;
+
+  len = ((ui64)(64 - __builtin_clzll(n | 1)) + 3) >> 2;
+  if (!dst)
+    return (len);
+  i = len;
+  while (i--)
   {
-    ptr[len--] = ((n % 10) * ((n >> 31) | 1)) + 48;
-    n /= 10;
+    dst[i] = "0123456789abcdef"[n & 15];
+    n >>= 4;
   }
-  return (ptr);
+  return (len);
+}
+
+/// @brief Writes `n` in decimal, zero padded to at least `width` characters
+/// (sign included, clamped to NUMBER_MAX_WIDTH), into `dst`. With a NULL `dst`
+/// it only measures.
+/// @param dst 
+/// @param n 
+/// @param width 
+/// @return number of characters (i.e: 'format_fixed(buf, -7, 4)-> 4, "-007"')
+ui64  format_fixed(char *dst, long long n, int width)
+{
+  unsigned long long  u;
+  ui64                digits;
+  ui64                len;
+  ui64                sign;
+
+  sign = (n < 0);
+  u = sign ? 0ULL - (unsigned long long)n : (unsigned long long)n;
+  digits = count_digits(u);
+  if (width > NUMBER_MAX_WIDTH)
+    width = NUMBER_MAX_WIDTH;
+  len = sign + digits;
+  if (width > 0 && (ui64)width > len)
+    len = (ui64)width;
+  if (!dst)
+    return (len);
+  if (sign)
+    dst[0] = '-';
+  memoryset(dst + sign, '0', len - sign - digits);
+  write_digits(dst + len, u);
+  return (len);
+}
+
+/// @brief Converts an integer to a pointer to char (ascii).
+/// @param n 
+/// @return pointer to char. (i.e: 'int_to_ascii(78)-> "78"')
+char  *int_to_ascii(int n)
+{
+  return (llong_to_ascii(n));
 }
 
 /// @brief Converts an long long to a pointer to char (ascii).
@@ -93,31 +893,14 @@ char  *int_to_ascii(int n)
 /// @return pointer to char. (i.e: 'llong_to_ascii(4294967296)-> "4294967296"')
 char  *llong_to_ascii(long long n)
 {
-  char        *ptr;
-  ui64        len;
-  long long   num;
-  
-  num = n;
-  len = 0;
-  if (n <= 0)
-    len++;
-  while (num)
-  {
-    len++;
-    num /= 10;
-  }
-  ptr = calloc(len + 1, sizeof(char));
+  char  *ptr;
+  ui64  len;
+
+  len = format_llong(NULL, n);
+  ptr = malloc(len + 1);
   if (!ptr)
     return (NULL);
-  ptr[len--] = '\0';
-  if (!n)
-    ptr[0] = '0';
-  if (n < 0)
-    ptr[0] = '-';
-  while (n)
-  {
-    ptr[len--] = ((n % 10) * ((n >> 63) | 1)) + 48;
-    n /= 10;
-  }
+  format_llong(ptr, n);
+  ptr[len] = '\0';
   return (ptr);
 }
@@ -0,0 +1,233 @@
+#include <types/arena.h>
+#include <types/string.h>
+#include "../test_framework.h"
+
+// ============================================================================
+// Test Functions for Arena()
+// ============================================================================
+
+void test_arena_new_del(void)
+{
+    arena *a = Arena()->new(0);
+    ASSERT_NOT_NULL(a);
+    ASSERT_EQ(Arena()->used(a), 0);
+    Arena()->del(&a);
+    ASSERT_NULL(a);
+}
+
+void test_arena_alloc_alignment(void)
+{
+    arena *a = Arena()->new(1024);
+    for (ui64 size = 0; size < 100; size++)
+    {
+        char *ptr = Arena()->alloc(a, size);
+        ASSERT_NOT_NULL(ptr);
+        ASSERT_EQ((ui64)ptr % ARENA_ALIGNMENT, 0);
+        memset(ptr, 0x5a, size);
+    }
+    Arena()->del(&a);
+}
+
+void test_arena_alloc_distinct(void)
+{
+    arena *a = Arena()->new(256);
+    char *ptrs[200];
+    for (int i = 0; i < 200; i++)
+    {
+        ptrs[i] = Arena()->alloc(a, 24);
+        memset(ptrs[i], i, 24);
+    }
+    for (int i = 0; i < 200; i++)
+        for (int j = 0; j < 24; j++)
+            ASSERT_EQ((unsigned char)ptrs[i][j], i);
+    ASSERT_EQ(Arena()->used(a), 200 * 32);
+    Arena()->del(&a);
+}
+
+void test_arena_large_alloc(void)
+{
+    arena *a = Arena()->new(1024);
+    char *small = Arena()->alloc(a, 16);
+    char *large = Arena()->alloc(a, 100000);
+    char *next = Arena()->alloc(a, 16);
+    ASSERT_NOT_NULL(large);
+    memset(large, 'x', 100000);
+    // The large allocation got its own block, the current one keeps serving
+    ASSERT_EQ(next - small, 16);
+    Arena()->del(&a);
+}
+
+void test_arena_reset(void)
+{
+    arena *a = Arena()->new(1024);
+    char *first = Arena()->alloc(a, 64);
+    for (int i = 0; i < 100; i++)
+        Arena()->alloc(a, 200);
+    Arena()->reset(a);
+    ASSERT_EQ(Arena()->used(a), 0);
+    ASSERT_NOT_NULL(Arena()->alloc(a, 64));
+    ASSERT_EQ(Arena()->used(a), 64);
+    (void)first;
+    Arena()->del(&a);
+}
+
+void test_arena_allocator(void)
+{
+    arena *a = Arena()->new(0);
+    const allocator *alloc = Arena()->allocator(a);
+    ASSERT_NOT_NULL(alloc);
+    ASSERT_NULL(alloc->free);
+    char *ptr = alloc->alloc(alloc->ctx, 10);
+    memcpy(ptr, "0123456789", 10);
+    // The last allocation grows in place
+    ASSERT(alloc->resize(alloc->ctx, ptr, 10, 100) == ptr);
+    Arena()->alloc(a, 1);
+    char *moved = alloc->resize(alloc->ctx, ptr, 100, 200);
+    ASSERT(moved != ptr);
+    ASSERT(memcmp(moved, "0123456789", 10) == 0);
+    Arena()->del(&a);
+}
+
+void test_arena_null(void)
+{
+    arena *a = NULL;
+    Arena()->del(&a);
+    Arena()->del(NULL);
+    Arena()->reset(NULL);
+    ASSERT_NULL(Arena()->alloc(NULL, 8));
+    ASSERT_EQ(Arena()->used(NULL), 0);
+    ASSERT_NULL(Arena()->allocator(NULL));
+}
+
+// ============================================================================
+// Test Functions for arena backed strings
+// ============================================================================
+
+void test_string_new_in_arena(void)
+{
+    arena *a = Arena()->new(0);
+    string *s = String()->new_in(Arena()->allocator(a), "hello");
+    ASSERT_NOT_NULL(s);
+    ASSERT(equals_string(s, "hello"));
+    ASSERT(Arena()->used(a) > 0);
+    Arena()->del(&a);
+}
+
+void test_string_new_in_heap(void)
+{
+    string *s = String()->new_in(NULL, "heap backed");
+    ASSERT(equals_string(s, "heap backed"));
+    String()->append(s, VAL_PCHAR(" and growing past the inline capacity"));
+    ASSERT(equals_string(s, "heap backed and growing past the inline capacity"));
+    String()->del(&s);
+    ASSERT_NULL(s);
+}
+
+void test_string_arena_append(void)
+{
+    arena *a = Arena()->new(512);
+    string *s = String()->new_in(Arena()->allocator(a), "");
+    string *other = String()->new_in(Arena()->allocator(a), "other");
+    for (int i = 0; i < 1000; i++)
+        String()->append(s, VAL_CHAR((char)('a' + i % 26)));
+    ASSERT_EQ(String()->len(s), 1000);
+    ASSERT_EQ(String()->index_of(s, VAL_PCHAR("xyzab")), 23);
+    ASSERT(equals_string(other, "other"));
+    Arena()->del(&a);
+}
+
+void test_string_arena_del_is_noop(void)
+{
+    arena *a = Arena()->new(0);
+    string *s = String()->new_in(Arena()->allocator(a), "kept alive by the arena, not the string");
+    string *alias = s;
+    ui64 used = Arena()->used(a);
+    String()->del(&s);
+    ASSERT_NULL(s);
+    ASSERT_EQ(Arena()->used(a), used);
+    ASSERT(equals_string(alias, "kept alive by the arena, not the string"));
+    Arena()->del(&a);
+}
+
+void test_string_arena_clone(void)
+{
+    arena *a = Arena()->new(0);
+    string *s = String()->new_in(Arena()->allocator(a), "cloned into the same arena");
+    ui64 used = Arena()->used(a);
+    string *copy = String()->clone(s);
+    ASSERT(equals_string(copy, "cloned into the same arena"));
+    ASSERT(Arena()->used(a) > used);
+    Arena()->del(&a);
+}
+
+void test_string_arena_shrink_reserve(void)
+{
+    arena *a = Arena()->new(0);
+    string *s = String()->new_in(Arena()->allocator(a), "short");
+    ASSERT(String()->reserve(s, 500));
+    ASSERT(String()->capacity(s) >= 500);
+    String()->shrink_to_fit(s);
+    ASSERT_EQ(String()->capacity(s), 23);
+    ASSERT(equals_string(s, "short"));
+    Arena()->del(&a);
+}
+
+void test_string_arena_reset_reuse(void)
+{
+    arena *a = Arena()->new(4096);
+    for (int round = 0; round < 50; round++)
+    {
+        for (int i = 0; i < 100; i++)
+        {
+            string *s = String()->new_in(Arena()->allocator(a), "request header");
+            String()->append(s, VAL_INT(i));
+            ASSERT_EQ(String()->index_of(s, VAL_INT(i)), 14);
+        }
+        Arena()->reset(a);
+    }
+    Arena()->del(&a);
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Arena() tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Arena()");
+    
+    TEST("arena: new and del", test_arena_new_del());
+    TEST("arena: alloc alignment", test_arena_alloc_alignment());
+    TEST("arena: allocations are distinct", test_arena_alloc_distinct());
+    TEST("arena: large allocation", test_arena_large_alloc());
+    TEST("arena: reset", test_arena_reset());
+    TEST("arena: allocator interface", test_arena_allocator());
+    TEST_NULL_SAFE("arena: NULL input", test_arena_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Arena backed string tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->new_in");
+    
+    TEST("new_in: arena", test_string_new_in_arena());
+    TEST("new_in: NULL allocator uses the heap", test_string_new_in_heap());
+    TEST("new_in: append grows in the arena", test_string_arena_append());
+    TEST("new_in: del is a no-op", test_string_arena_del_is_noop());
+    TEST("new_in: clone keeps the allocator", test_string_arena_clone());
+    TEST("new_in: reserve and shrink", test_string_arena_shrink_reserve());
+    TEST("new_in: reset between requests", test_string_arena_reset_reuse());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+    
+    return get_exit_code();
+}
@@ -0,0 +1,198 @@
+#include <types/intern.h>
+#include <types/string_view.h>
+#include <pthread.h>
+#include <stdio.h>
+#include "../test_framework.h"
+
+#define THREADS         8
+#define THREAD_VALUES   20000
+
+// ============================================================================
+// Test Functions for Intern()
+// ============================================================================
+
+void test_intern_new_del(void)
+{
+    intern_pool *pool = Intern()->new();
+    ASSERT_NOT_NULL(pool);
+    ASSERT_EQ(Intern()->len(pool), 0);
+    Intern()->del(&pool);
+    ASSERT_NULL(pool);
+}
+
+void test_intern_same_pointer(void)
+{
+    intern_pool *pool = Intern()->new();
+    string *s = String()->new("level");
+    const string *a = Intern()->intern(pool, VAL_PCHAR("level"));
+    const string *b = Intern()->intern(pool, VAL_STR(s));
+    const string *c = Intern()->intern(pool, VAL_VIEW(View()->new("level=info")));
+    ASSERT_NOT_NULL(a);
+    ASSERT(a == b);
+    ASSERT(a != c);
+    ASSERT(String()->equals(a, VAL_PCHAR("level")));
+    ASSERT(Intern()->intern(pool, VAL_VIEW(View()->from("level=info", 5))) == a);
+    ASSERT_EQ(Intern()->len(pool), 2);
+    String()->del(&s);
+    Intern()->del(&pool);
+}
+
+void test_intern_copies(void)
+{
+    intern_pool *pool = Intern()->new();
+    char buf[] = "request_id";
+    const string *a = Intern()->intern(pool, VAL_PCHAR(buf));
+    buf[0] = 'R';
+    ASSERT(String()->equals(a, VAL_PCHAR("request_id")));
+    ASSERT(Intern()->intern(pool, VAL_PCHAR(buf)) != a);
+    ASSERT(Intern()->intern(pool, VAL_PCHAR("request_id")) == a);
+    Intern()->del(&pool);
+}
+
+void test_intern_numbers(void)
+{
+    intern_pool *pool = Intern()->new();
+    const string *a = Intern()->intern(pool, VAL_INT(200));
+    ASSERT(String()->equals(a, VAL_PCHAR("200")));
+    ASSERT(Intern()->intern(pool, VAL_PCHAR("200")) == a);
+    ASSERT(Intern()->intern(pool, VAL_ULLONG(200)) == a);
+    ASSERT(Intern()->intern(pool, VAL_CHAR('2')) != a);
+    Intern()->del(&pool);
+}
+
+void test_intern_find(void)
+{
+    intern_pool *pool = Intern()->new();
+    ASSERT_NULL(Intern()->find(pool, VAL_PCHAR("host")));
+    const string *a = Intern()->intern(pool, VAL_PCHAR("host"));
+    ASSERT(Intern()->find(pool, VAL_PCHAR("host")) == a);
+    ASSERT_NULL(Intern()->find(pool, VAL_PCHAR("hos")));
+    ASSERT_EQ(Intern()->len(pool), 1);
+    Intern()->del(&pool);
+}
+
+void test_intern_many(void)
+{
+    intern_pool *pool = Intern()->new();
+    typed_value vals[200];
+    const string *out[200];
+    char names[100][16];
+    int i;
+    for (i = 0; i < 100; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "field_%d", i);
+        vals[i] = VAL_PCHAR(names[i]);
+        vals[100 + i] = VAL_PCHAR(names[i]);
+    }
+    vals[7] = VAL_PCHAR(NULL);
+    ASSERT_EQ(Intern()->intern_many(pool, vals, 200, out), 199);
+    ASSERT_NULL(out[7]);
+    for (i = 0; i < 100; i++)
+    {
+        if (i != 7)
+            ASSERT(out[i] == out[100 + i]);
+        ASSERT(Intern()->intern(pool, VAL_PCHAR(names[i])) == out[100 + i]);
+        ASSERT(String()->equals(out[100 + i], VAL_PCHAR(names[i])));
+    }
+    ASSERT_EQ(Intern()->len(pool), 100);
+    Intern()->del(&pool);
+}
+
+typedef struct {
+    intern_pool     *pool;
+    const string    *seen[THREAD_VALUES];
+    int             many;
+}   thread_job;
+
+static void *intern_from_thread(void *arg)
+{
+    thread_job *job = arg;
+    typed_value vals[100];
+    char names[100][16];
+    int i, j;
+    for (i = 0; i < THREAD_VALUES; i += 100)
+    {
+        for (j = 0; j < 100; j++)
+        {
+            snprintf(names[j], sizeof(names[j]), "v%d", (i + j) % 5000);
+            vals[j] = VAL_PCHAR(names[j]);
+        }
+        if (job->many)
+            Intern()->intern_many(job->pool, vals, 100, job->seen + i);
+        else
+            for (j = 0; j < 100; j++)
+                job->seen[i + j] = Intern()->intern(job->pool, vals[j]);
+    }
+    return (NULL);
+}
+
+void test_intern_threads(void)
+{
+    static thread_job jobs[THREADS];
+    pthread_t threads[THREADS];
+    intern_pool *pool = Intern()->new();
+    int i, j;
+    for (i = 0; i < THREADS; i++)
+    {
+        jobs[i].pool = pool;
+        jobs[i].many = i % 2;
+        ASSERT_EQ(pthread_create(&threads[i], NULL, intern_from_thread, &jobs[i]), 0);
+    }
+    for (i = 0; i < THREADS; i++)
+        pthread_join(threads[i], NULL);
+    ASSERT_EQ(Intern()->len(pool), 5000);
+    // Every thread got the very same string for every content
+    for (i = 1; i < THREADS; i++)
+        for (j = 0; j < THREAD_VALUES; j++)
+            ASSERT(jobs[i].seen[j] == jobs[0].seen[j]);
+    for (j = 0; j < 5000; j++)
+        ASSERT_NOT_NULL(jobs[0].seen[j]);
+    Intern()->del(&pool);
+}
+
+void test_intern_null(void)
+{
+    intern_pool *pool = NULL;
+    const string *out[1];
+    typed_value v = VAL_PCHAR("a");
+    Intern()->del(&pool);
+    Intern()->del(NULL);
+    ASSERT_EQ(Intern()->len(NULL), 0);
+    ASSERT_NULL(Intern()->intern(NULL, VAL_PCHAR("a")));
+    ASSERT_NULL(Intern()->find(NULL, VAL_PCHAR("a")));
+    ASSERT_EQ(Intern()->intern_many(NULL, &v, 1, out), 0);
+    pool = Intern()->new();
+    ASSERT_NULL(Intern()->intern(pool, VAL_STR(NULL)));
+    ASSERT_NULL(Intern()->intern(pool, VAL_PATTERN(NULL)));
+    ASSERT_EQ(Intern()->intern_many(pool, NULL, 1, out), 0);
+    ASSERT_EQ(Intern()->intern_many(pool, &v, 0, out), 0);
+    Intern()->del(&pool);
+}
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Intern() tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Intern()");
+    
+    TEST("intern: new and del", test_intern_new_del());
+    TEST("intern: equal contents share a pointer", test_intern_same_pointer());
+    TEST("intern: contents are copied", test_intern_copies());
+    TEST("intern: numbers", test_intern_numbers());
+    TEST("intern: find does not insert", test_intern_find());
+    TEST("intern_many: batch with duplicates", test_intern_many());
+    TEST("intern: concurrent threads", test_intern_threads());
+    TEST_NULL_SAFE("intern: NULL input", test_intern_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+    
+    return get_exit_code();
+}
@@ -0,0 +1,270 @@
+#include <types/map.h>
+#include <types/arena.h>
+#include <types/string_view.h>
+#include <stdio.h>
+#include "../test_framework.h"
+
+// ============================================================================
+// Test Functions for Map()
+// ============================================================================
+
+void test_map_new_del(void)
+{
+    map *m = Map()->new();
+    ASSERT_NOT_NULL(m);
+    ASSERT_EQ(Map()->len(m), 0);
+    ASSERT_NULL(Map()->get(m, VAL_PCHAR("missing")));
+    Map()->del(&m);
+    ASSERT_NULL(m);
+}
+
+void test_map_set_get(void)
+{
+    map *m = Map()->new();
+    int a = 1, b = 2;
+    ASSERT(Map()->set(m, VAL_PCHAR("alpha"), &a));
+    ASSERT(Map()->set(m, VAL_PCHAR("beta"), &b));
+    ASSERT_EQ(Map()->len(m), 2);
+    ASSERT(Map()->get(m, VAL_PCHAR("alpha")) == &a);
+    ASSERT(Map()->get(m, VAL_PCHAR("beta")) == &b);
+    ASSERT_NULL(Map()->get(m, VAL_PCHAR("gamma")));
+    ASSERT_NULL(Map()->get(m, VAL_PCHAR("alph")));
+    Map()->del(&m);
+}
+
+void test_map_set_replaces(void)
+{
+    map *m = Map()->new();
+    int a = 1, b = 2;
+    Map()->set(m, VAL_PCHAR("key"), &a);
+    ASSERT(Map()->set(m, VAL_PCHAR("key"), &b));
+    ASSERT_EQ(Map()->len(m), 1);
+    ASSERT(Map()->get(m, VAL_PCHAR("key")) == &b);
+    Map()->del(&m);
+}
+
+void test_map_key_types(void)
+{
+    map *m = Map()->new();
+    string *key = String()->new("content-length");
+    int a = 1, b = 2;
+    Map()->set(m, VAL_STR(key), &a);
+    ASSERT(Map()->get(m, VAL_PCHAR("content-length")) == &a);
+    ASSERT(Map()->get(m, VAL_VIEW(View()->new("content-length"))) == &a);
+    ASSERT(Map()->get(m, VAL_STR(key)) == &a);
+    Map()->set(m, VAL_INT(404), &b);
+    ASSERT(Map()->get(m, VAL_PCHAR("404")) == &b);
+    ASSERT(Map()->get(m, VAL_ULLONG(404)) == &b);
+    ASSERT(Map()->has(m, VAL_CHAR('4')) == 0);
+    ASSERT_EQ(Map()->set(m, VAL_PATTERN(NULL), &a), 0);
+    String()->del(&key);
+    Map()->del(&m);
+}
+
+void test_map_keys_are_copied(void)
+{
+    map *m = Map()->new();
+    string *key = String()->new("mutable");
+    int a = 1;
+    Map()->set(m, VAL_STR(key), &a);
+    String()->append(key, VAL_PCHAR(" key"));
+    ASSERT_NULL(Map()->get(m, VAL_STR(key)));
+    ASSERT(Map()->get(m, VAL_PCHAR("mutable")) == &a);
+    String()->del(&key);
+    ASSERT(Map()->get(m, VAL_PCHAR("mutable")) == &a);
+    Map()->del(&m);
+}
+
+void test_map_has_null_value(void)
+{
+    map *m = Map()->new();
+    Map()->set(m, VAL_PCHAR("empty"), NULL);
+    ASSERT_NULL(Map()->get(m, VAL_PCHAR("empty")));
+    ASSERT(Map()->has(m, VAL_PCHAR("empty")));
+    ASSERT(!Map()->has(m, VAL_PCHAR("other")));
+    Map()->set(m, VAL_PCHAR(""), NULL);
+    ASSERT(Map()->has(m, VAL_PCHAR("")));
+    Map()->del(&m);
+}
+
+void test_map_grows(void)
+{
+    map *m = Map()->new();
+    char buf[32];
+    long i;
+    for (i = 0; i < 10000; i++)
+    {
+        snprintf(buf, sizeof(buf), "key-%ld", i);
+        ASSERT(Map()->set(m, VAL_PCHAR(buf), (void *)(i + 1)));
+    }
+    ASSERT_EQ(Map()->len(m), 10000);
+    for (i = 0; i < 10000; i++)
+    {
+        snprintf(buf, sizeof(buf), "key-%ld", i);
+        ASSERT(Map()->get(m, VAL_PCHAR(buf)) == (void *)(i + 1));
+    }
+    ASSERT_NULL(Map()->get(m, VAL_PCHAR("key-10000")));
+    Map()->del(&m);
+}
+
+void test_map_remove(void)
+{
+    map *m = Map()->new();
+    char buf[32];
+    long i;
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf(buf, sizeof(buf), "%ld", i);
+        Map()->set(m, VAL_PCHAR(buf), (void *)(i + 1));
+    }
+    for (i = 0; i < 1000; i += 2)
+        ASSERT(Map()->remove(m, VAL_LLONG(i)));
+    ASSERT_EQ(Map()->len(m), 500);
+    ASSERT_EQ(Map()->remove(m, VAL_INT(0)), 0);
+    for (i = 0; i < 1000; i++)
+        ASSERT_EQ(Map()->has(m, VAL_LLONG(i)), i % 2);
+    Map()->del(&m);
+}
+
+void test_map_remove_reinsert(void)
+{
+    map *m = Map()->new();
+    char buf[48];
+    long round, i;
+    // Keys come and go, deleted slots must not fill the table up
+    for (round = 0; round < 50; round++)
+    {
+        for (i = 0; i < 100; i++)
+        {
+            snprintf(buf, sizeof(buf), "r%ld-%ld", round, i);
+            ASSERT(Map()->set(m, VAL_PCHAR(buf), (void *)(i + 1)));
+        }
+        for (i = 0; i < 100; i++)
+        {
+            snprintf(buf, sizeof(buf), "r%ld-%ld", round, i);
+            ASSERT(Map()->remove(m, VAL_PCHAR(buf)));
+        }
+    }
+    ASSERT_EQ(Map()->len(m), 0);
+    Map()->set(m, VAL_PCHAR("last"), (void *)1);
+    ASSERT(Map()->get(m, VAL_PCHAR("last")) == (void *)1);
+    Map()->del(&m);
+}
+
+void test_map_clear(void)
+{
+    map *m = Map()->new();
+    Map()->set(m, VAL_PCHAR("a"), (void *)1);
+    Map()->set(m, VAL_PCHAR("b"), (void *)2);
+    Map()->clear(m);
+    ASSERT_EQ(Map()->len(m), 0);
+    ASSERT(!Map()->has(m, VAL_PCHAR("a")));
+    Map()->set(m, VAL_PCHAR("a"), (void *)3);
+    ASSERT(Map()->get(m, VAL_PCHAR("a")) == (void *)3);
+    Map()->del(&m);
+}
+
+void test_map_reserve(void)
+{
+    map *m = Map()->new();
+    ASSERT(Map()->reserve(m, 1000));
+    Map()->set(m, VAL_PCHAR("x"), (void *)1);
+    ASSERT(Map()->get(m, VAL_PCHAR("x")) == (void *)1);
+    ASSERT(Map()->reserve(m, 10));
+    ASSERT(Map()->get(m, VAL_PCHAR("x")) == (void *)1);
+    Map()->del(&m);
+}
+
+void test_map_next(void)
+{
+    map *m = Map()->new();
+    const string *key;
+    void *value;
+    ui64 it = 0;
+    long sum = 0;
+    int count = 0;
+    Map()->set(m, VAL_PCHAR("one"), (void *)1);
+    Map()->set(m, VAL_PCHAR("two"), (void *)2);
+    Map()->set(m, VAL_PCHAR("three"), (void *)3);
+    while (Map()->next(m, &it, &key, &value))
+    {
+        ASSERT_EQ((long)String()->len(key), value == (void *)3 ? 5 : 3);
+        sum += (long)value;
+        count++;
+    }
+    ASSERT_EQ(count, 3);
+    ASSERT_EQ(sum, 6);
+    ASSERT_EQ(Map()->next(m, &it, &key, &value), 0);
+    Map()->del(&m);
+}
+
+void test_map_in_arena(void)
+{
+    arena *a = Arena()->new(0);
+    map *m = Map()->new_in(Arena()->allocator(a));
+    char buf[32];
+    long i;
+    ASSERT_NOT_NULL(m);
+    for (i = 0; i < 500; i++)
+    {
+        snprintf(buf, sizeof(buf), "k%ld", i);
+        Map()->set(m, VAL_PCHAR(buf), (void *)(i + 1));
+    }
+    ASSERT(Map()->get(m, VAL_PCHAR("k499")) == (void *)500);
+    ASSERT(Map()->remove(m, VAL_PCHAR("k0")));
+    Map()->del(&m);
+    Arena()->del(&a);
+}
+
+void test_map_null(void)
+{
+    map *m = NULL;
+    ui64 it = 0;
+    Map()->del(&m);
+    Map()->del(NULL);
+    Map()->clear(NULL);
+    ASSERT_EQ(Map()->len(NULL), 0);
+    ASSERT_EQ(Map()->set(NULL, VAL_PCHAR("a"), NULL), 0);
+    ASSERT_NULL(Map()->get(NULL, VAL_PCHAR("a")));
+    ASSERT_EQ(Map()->has(NULL, VAL_PCHAR("a")), 0);
+    ASSERT_EQ(Map()->remove(NULL, VAL_PCHAR("a")), 0);
+    ASSERT_EQ(Map()->next(NULL, &it, NULL, NULL), 0);
+    m = Map()->new();
+    ASSERT_EQ(Map()->set(m, VAL_PCHAR(NULL), NULL), 0);
+    ASSERT_EQ(Map()->set(m, VAL_STR(NULL), NULL), 0);
+    Map()->del(&m);
+}
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Map() tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Map()");
+    
+    TEST("map: new and del", test_map_new_del());
+    TEST("map: set and get", test_map_set_get());
+    TEST("map: set replaces the value", test_map_set_replaces());
+    TEST("map: strings, pchars, views and numbers as keys", test_map_key_types());
+    TEST("map: keys are copied", test_map_keys_are_copied());
+    TEST("map: has tells NULL values apart", test_map_has_null_value());
+    TEST("map: grows past 10000 keys", test_map_grows());
+    TEST("map: remove", test_map_remove());
+    TEST("map: remove and reinsert", test_map_remove_reinsert());
+    TEST("map: clear", test_map_clear());
+    TEST("map: reserve", test_map_reserve());
+    TEST("map: next iterates every entry", test_map_next());
+    TEST("map: new_in arena", test_map_in_arena());
+    TEST_NULL_SAFE("map: NULL input", test_map_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+    
+    return get_exit_code();
+}
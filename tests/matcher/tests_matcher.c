@@ -0,0 +1,232 @@
+#include <types/matcher.h>
+#include <types/search.h>
+#include "../test_framework.h"
+
+// Every match of the needles in `text`, in the order a matcher reports them:
+// by end, then longest first, then by id
+static ui64 naive_matches(const char *const *needles, ui64 count, const char *text,
+    match *out, ui64 cap)
+{
+    ui64 len = strlen(text);
+    ui64 found = 0;
+    ui64 end;
+    ui64 size;
+    ui64 id;
+    for (end = 1; end <= len; end++)
+    {
+        for (size = end; size >= 1; size--)
+        {
+            for (id = 0; id < count; id++)
+            {
+                if (strlen(needles[id]) != size
+                    || memcmp(text + end - size, needles[id], size) != 0)
+                    continue ;
+                if (found < cap)
+                    out[found] = (match){end - size, size, id};
+                found++;
+            }
+        }
+    }
+    return (found);
+}
+
+// ============================================================================
+// Test Functions for Matcher()->new
+// ============================================================================
+
+void test_matcher_new_del(void)
+{
+    matcher *m = MATCHER_OF(VAL_PCHAR("error"), VAL_PCHAR("fatal"), VAL_INT(404));
+    ASSERT_NOT_NULL(m);
+    ASSERT_EQ(Matcher()->len(m), 3);
+    Matcher()->del(&m);
+    ASSERT_NULL(m);
+    // Nothing searchable
+    ASSERT_NULL(MATCHER_OF(VAL_PCHAR(""), VAL_PCHAR(NULL)));
+    ASSERT_NULL(Matcher()->new(NULL, 3));
+}
+
+void test_matcher_find(void)
+{
+    matcher *m = MATCHER_OF(VAL_PCHAR("warn"), VAL_PCHAR("error"), VAL_INT(404));
+    string *line = String()->new("GET /x status=404 level=error");
+    match hit;
+    ASSERT(Matcher()->find(m, VAL_STR(line), 0, &hit));
+    ASSERT_EQ(hit.id, 2);
+    ASSERT_EQ(hit.start, 14);
+    ASSERT_EQ(hit.len, 3);
+    ASSERT(Matcher()->find(m, VAL_STR(line), 15, &hit));
+    ASSERT_EQ(hit.id, 1);
+    ASSERT_EQ(hit.start, 24);
+    ASSERT_EQ(Matcher()->find(m, VAL_PCHAR("all good"), 0, &hit), 0);
+    ASSERT_EQ(Matcher()->find(m, VAL_STR(line), 100, &hit), 0);
+    Matcher()->del(&m);
+    String()->del(&line);
+}
+
+// Needles that are suffixes and prefixes of each other
+void test_matcher_overlaps(void)
+{
+    const char *needles[] = {"he", "she", "his", "hers", "e", "she"};
+    const char *text = "ushers and his sheep shed hershe";
+    matcher *m = Matcher()->new_pchars(needles, 6);
+    match expected[64];
+    match got[64];
+    ui64 n = naive_matches(needles, 6, text, expected, 64);
+    ui64 i;
+    ASSERT_EQ(Matcher()->find_all(m, VAL_PCHAR(text), got, 64), n);
+    for (i = 0; i < n; i++)
+    {
+        ASSERT_EQ(got[i].start, expected[i].start);
+        ASSERT_EQ(got[i].len, expected[i].len);
+        ASSERT_EQ(got[i].id, expected[i].id);
+    }
+    // The first match to end, the longest of those ending together
+    ASSERT(Matcher()->find(m, VAL_PCHAR("ushers"), 0, &got[0]));
+    ASSERT_EQ(got[0].id, 1);
+    ASSERT_EQ(got[0].start, 1);
+    Matcher()->del(&m);
+}
+
+void test_matcher_find_all_cap(void)
+{
+    matcher *m = MATCHER_OF(VAL_CHAR('a'), VAL_PCHAR("aa"));
+    match got[2];
+    ASSERT_EQ(Matcher()->find_all(m, VAL_PCHAR("aaaa"), got, 2), 7);
+    ASSERT_EQ(got[0].start, 0);
+    ASSERT_EQ(got[0].len, 1);
+    ASSERT_EQ(got[1].start, 0);
+    ASSERT_EQ(got[1].len, 2);
+    ASSERT_EQ(Matcher()->find_all(m, VAL_PCHAR("aaaa"), NULL, 0), 7);
+    Matcher()->del(&m);
+}
+
+void test_matcher_count(void)
+{
+    pattern *p = Pattern()->new(VAL_PCHAR("ab"));
+    matcher *m = MATCHER_OF(VAL_PATTERN(p), VAL_CHAR('b'), VAL_PCHAR("zz"),
+        VAL_PCHAR("ab"));
+    ui64 counts[4] = {9, 9, 9, 9};
+    ASSERT_EQ(Matcher()->count(m, VAL_PCHAR("abcabxb"), counts), 7);
+    ASSERT_EQ(counts[0], 2);
+    ASSERT_EQ(counts[1], 3);
+    ASSERT_EQ(counts[2], 0);
+    ASSERT_EQ(counts[3], 2);
+    ASSERT_EQ(Matcher()->count(m, VAL_PCHAR("abcabxb"), NULL), 7);
+    Matcher()->del(&m);
+    Pattern()->del(&p);
+}
+
+// Needles using every byte value: no byte is left for the shared class
+void test_matcher_binary(void)
+{
+    char bytes[256];
+    char text[300];
+    typed_value vals[128];
+    string_view views[128];
+    ui64 counts[128];
+    ui64 i;
+    for (i = 0; i < 256; i++)
+        bytes[i] = (char)i;
+    for (i = 0; i < 128; i++)
+    {
+        views[i] = (string_view){bytes + 2 * i, 2};
+        vals[i] = (typed_value){TYPE_VIEW, 0, {.as_view = &views[i]}};
+    }
+    for (i = 0; i < sizeof(text); i++)
+        text[i] = (char)(i % 256);
+    matcher *m = Matcher()->new(vals, 128);
+    ASSERT_NOT_NULL(m);
+    // 0-1, 2-3, ... appear once, plus 0-1 and 2-3 ... again up to byte 43
+    ASSERT_EQ(Matcher()->count(m, VAL_VIEW(((string_view){text, sizeof(text)})),
+        counts), 128 + 22);
+    ASSERT_EQ(counts[0], 2);
+    ASSERT_EQ(counts[127], 1);
+    Matcher()->del(&m);
+}
+
+// Many needles against the naive search, over random text
+void test_matcher_random(void)
+{
+    static char storage[200][8];
+    const char *needles[200];
+    char text[4001];
+    match expected[512];
+    match got[512];
+    unsigned seed = 42;
+    ui64 i;
+    ui64 k;
+    for (i = 0; i < 200; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        ui64 len = 1 + (seed >> 16) % 6;
+        for (k = 0; k < len; k++)
+        {
+            seed = seed * 1103515245 + 12345;
+            storage[i][k] = (char)('a' + (seed >> 16) % 4);
+        }
+        storage[i][len] = '\0';
+        needles[i] = storage[i];
+    }
+    for (i = 0; i < 4000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        text[i] = (char)('a' + (seed >> 16) % 5);
+    }
+    text[4000] = '\0';
+    matcher *m = Matcher()->new_pchars(needles, 200);
+    ui64 n = naive_matches(needles, 200, text, expected, 512);
+    ASSERT(n > 512);
+    ASSERT_EQ(Matcher()->find_all(m, VAL_PCHAR(text), got, 512), n);
+    for (i = 0; i < 512; i++)
+    {
+        ASSERT_EQ(got[i].start, expected[i].start);
+        ASSERT_EQ(got[i].id, expected[i].id);
+    }
+    Matcher()->del(&m);
+}
+
+void test_matcher_null(void)
+{
+    matcher *m = MATCHER_OF(VAL_PCHAR("x"));
+    match hit;
+    ui64 counts[1];
+    Matcher()->del(NULL);
+    ASSERT_EQ(Matcher()->len(NULL), 0);
+    ASSERT_EQ(Matcher()->find(NULL, VAL_PCHAR("x"), 0, &hit), 0);
+    ASSERT_EQ(Matcher()->find(m, VAL_PCHAR(NULL), 0, &hit), 0);
+    ASSERT_EQ(Matcher()->find(m, VAL_PCHAR("x"), 0, NULL), 0);
+    ASSERT_EQ(Matcher()->find_all(m, VAL_PCHAR("x"), NULL, 1), 0);
+    ASSERT_EQ(Matcher()->count(NULL, VAL_PCHAR("x"), counts), 0);
+    ASSERT_EQ(Matcher()->count(m, VAL_INT(1), counts), 0);
+    ASSERT_NULL(Matcher()->new_pchars(NULL, 1));
+    Matcher()->del(&m);
+}
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+
+    // ─────────────────────────────────────────────────────────────────────
+    // Matcher() tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Matcher()");
+
+    TEST("matcher: new and del", test_matcher_new_del());
+    TEST("matcher: first match", test_matcher_find());
+    TEST("matcher: overlapping needles", test_matcher_overlaps());
+    TEST("matcher: find_all past the capacity", test_matcher_find_all_cap());
+    TEST("matcher: counts per needle", test_matcher_count());
+    TEST("matcher: every byte value", test_matcher_binary());
+    TEST("matcher: against a naive search", test_matcher_random());
+    TEST_NULL_SAFE("matcher: NULL input", test_matcher_null());
+
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+
+    return get_exit_code();
+}
@@ -0,0 +1,250 @@
+#include <types/reader.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include "../test_framework.h"
+
+// Writes `text` to a temporary file and opens it for reading
+static int open_text(const char *text, ui64 len)
+{
+    char path[] = "/tmp/tests_reader_XXXXXX";
+    int fd = mkstemp(path);
+    write(fd, text, len);
+    lseek(fd, 0, SEEK_SET);
+    unlink(path);
+    return (fd);
+}
+
+// ============================================================================
+// Test Functions for Reader()
+// ============================================================================
+
+void test_reader_new_del(void)
+{
+    reader *r = Reader()->new(0);
+    ASSERT_NOT_NULL(r);
+    ASSERT_EQ(Reader()->error(r), 0);
+    Reader()->del(&r);
+    ASSERT_NULL(r);
+}
+
+void test_reader_lines(void)
+{
+    int fd = open_text("first\n\nthird line\nno newline", 28);
+    reader *r = Reader()->new(fd);
+    string *line = String()->new("previous content");
+    ASSERT(Reader()->line(r, line));
+    ASSERT(String()->equals(line, VAL_PCHAR("first")));
+    ASSERT(Reader()->line(r, line));
+    ASSERT_EQ(String()->len(line), 0);
+    ASSERT(Reader()->line(r, line));
+    ASSERT(String()->equals(line, VAL_PCHAR("third line")));
+    ASSERT(Reader()->line(r, line));
+    ASSERT(String()->equals(line, VAL_PCHAR("no newline")));
+    ASSERT_EQ(Reader()->line(r, line), 0);
+    ASSERT_EQ(String()->len(line), 0);
+    ASSERT_EQ(Reader()->line(r, line), 0);
+    ASSERT_EQ(Reader()->error(r), 0);
+    Reader()->del(&r);
+    String()->del(&line);
+    close(fd);
+}
+
+void test_reader_small_buffer(void)
+{
+    string *text = String()->new("");
+    string *line = String()->new("");
+    string *expected = String()->new("");
+    int i;
+    for (i = 0; i < 2000; i++)
+    {
+        APPEND_MANY(text, VAL_PCHAR("line "), VAL_INT(i), VAL_CHAR(' '));
+        // Some lines are longer than the buffer
+        if (i % 100 == 0)
+            APPEND_MANY(text, VAL_PCHAR("this line is longer than the seven byte buffer"));
+        String()->append(text, VAL_CHAR('\n'));
+    }
+    int fd = open_text(String()->view(text).ptr, String()->len(text));
+    reader *r = Reader()->new_sized(fd, 7);
+    i = 0;
+    while (Reader()->line(r, line))
+    {
+        APPEND_MANY(expected, VAL_STR(line), VAL_CHAR('\n'));
+        i++;
+    }
+    ASSERT_EQ(i, 2000);
+    ASSERT(String()->equals(expected, VAL_STR(text)));
+    Reader()->del(&r);
+    close(fd);
+    String()->del(&text);
+    String()->del(&line);
+    String()->del(&expected);
+}
+
+void test_reader_reuses_line(void)
+{
+    string *text = String()->new("");
+    string *line = String()->new("");
+    int i;
+    for (i = 0; i < 1000; i++)
+        APPEND_MANY(text, VAL_PCHAR("2024-05-01 level=info request="), VAL_INT(i), VAL_CHAR('\n'));
+    int fd = open_text(String()->view(text).ptr, String()->len(text));
+    reader *r = Reader()->new(fd);
+    ASSERT(Reader()->line(r, line));
+    const char *buffer = String()->view(line).ptr;
+    ui64 capacity = String()->capacity(line);
+    while (Reader()->line(r, line))
+        ASSERT_EQ(String()->view(line).ptr, buffer);
+    ASSERT_EQ(String()->capacity(line), capacity);
+    // A line shared with another string is copied, not overwritten
+    lseek(fd, 0, SEEK_SET);
+    ASSERT(Reader()->line(r, line));
+    string *kept = String()->share(line);
+    ASSERT(Reader()->line(r, line));
+    ASSERT(String()->equals(kept, VAL_PCHAR("2024-05-01 level=info request=0")));
+    ASSERT(String()->equals(line, VAL_PCHAR("2024-05-01 level=info request=1")));
+    Reader()->del(&r);
+    close(fd);
+    String()->del(&kept);
+    String()->del(&text);
+    String()->del(&line);
+}
+
+void test_reader_until(void)
+{
+    int fd = open_text("a,bb,,ccc", 9);
+    reader *r = Reader()->new_sized(fd, 2);
+    string *field = String()->new("");
+    const char *expected[] = {"a", "bb", "", "ccc"};
+    int i;
+    for (i = 0; Reader()->until(r, field, ','); i++)
+        ASSERT(String()->equals(field, VAL_PCHAR(expected[i])));
+    ASSERT_EQ(i, 4);
+    Reader()->del(&r);
+    String()->del(&field);
+    close(fd);
+}
+
+static void *feed(void *arg)
+{
+    int fd = *(int *)arg;
+    int i;
+    for (i = 0; i < 500; i++)
+    {
+        write(fd, "partial ", 8);
+        usleep(10);
+        write(fd, "line\n", 5);
+    }
+    close(fd);
+    return (NULL);
+}
+
+void test_reader_pipe(void)
+{
+    pthread_t thread;
+    int fds[2];
+    pipe(fds);
+    pthread_create(&thread, NULL, feed, &fds[1]);
+    reader *r = Reader()->new(fds[0]);
+    string *line = String()->new("");
+    int n = 0;
+    while (Reader()->line(r, line))
+        n += String()->equals(line, VAL_PCHAR("partial line"));
+    ASSERT_EQ(n, 500);
+    pthread_join(thread, NULL);
+    Reader()->del(&r);
+    String()->del(&line);
+    close(fds[0]);
+}
+
+// Allocations succeed while they fit in the budget `ctx` points to
+static void *budget_alloc(void *ctx, ui64 size)
+{
+    ui64 *budget = ctx;
+    if (size > *budget)
+        return (NULL);
+    *budget -= size;
+    return (malloc(size));
+}
+
+static void *budget_resize(void *ctx, void *ptr, ui64 old_size, ui64 new_size)
+{
+    ui64 *budget = ctx;
+    if (new_size > old_size && new_size - old_size > *budget)
+        return (NULL);
+    *budget -= new_size > old_size ? new_size - old_size : 0;
+    return (realloc(ptr, new_size));
+}
+
+static void budget_free(void *ctx, void *ptr, ui64 size)
+{
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+// A record the line can't grow to hold is an error, not a shorter record
+void test_reader_out_of_memory(void)
+{
+    char text[300];
+    ui64 budget = 200;
+    allocator alloc = {budget_alloc, budget_resize, budget_free, &budget};
+    memset(text, 'x', sizeof(text));
+    text[sizeof(text) - 1] = '\n';
+    int fd = open_text(text, sizeof(text));
+    reader *r = Reader()->new_sized(fd, 64);
+    string *line = String()->new_in(&alloc, "");
+    ASSERT_NOT_NULL(line);
+    ASSERT_EQ(Reader()->line(r, line), 0);
+    ASSERT_EQ(Reader()->error(r), ENOMEM);
+    ASSERT_EQ(Reader()->line(r, line), 0);
+    String()->del(&line);
+    Reader()->del(&r);
+    close(fd);
+}
+
+void test_reader_null(void)
+{
+    reader *r = NULL;
+    string *line = String()->new("");
+    Reader()->del(&r);
+    Reader()->del(NULL);
+    ASSERT_EQ(Reader()->line(NULL, line), 0);
+    ASSERT_EQ(Reader()->until(NULL, line, ','), 0);
+    ASSERT_EQ(Reader()->error(NULL), EINVAL);
+    r = Reader()->new(-1);
+    ASSERT_EQ(Reader()->line(r, NULL), 0);
+    ASSERT_EQ(Reader()->line(r, line), 0);
+    ASSERT_EQ(Reader()->error(r), EBADF);
+    Reader()->del(&r);
+    String()->del(&line);
+}
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Reader() tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Reader()");
+    
+    TEST("reader: new and del", test_reader_new_del());
+    TEST("reader: lines", test_reader_lines());
+    TEST("reader: lines longer than the buffer", test_reader_small_buffer());
+    TEST("reader: the line buffer is reused", test_reader_reuses_line());
+    TEST("reader: until a delimiter", test_reader_until());
+    TEST("reader: lines split across reads", test_reader_pipe());
+    TEST("reader: ENOMEM when the line can't grow", test_reader_out_of_memory());
+    TEST_NULL_SAFE("reader: NULL input", test_reader_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+    
+    return get_exit_code();
+}
@@ -0,0 +1,277 @@
+#include <types/rope.h>
+#include <types/search.h>
+#include <types/string_view.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include "../test_framework.h"
+
+// Compares the whole rope with a C string
+static int rope_equals(const rope *r, const char *expected)
+{
+    string *flat = Rope()->flatten(r);
+    int ok = String()->equals(flat, VAL_PCHAR(expected));
+    String()->del(&flat);
+    return (ok);
+}
+
+// Builds a rope of `n` lines "line <i>\n"
+static rope *make_lines(int n)
+{
+    rope *r = Rope()->new();
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        Rope()->append(r, VAL_PCHAR("line "));
+        Rope()->append(r, VAL_INT(i));
+        Rope()->append(r, VAL_CHAR('\n'));
+    }
+    return (r);
+}
+
+// ============================================================================
+// Test Functions for Rope()
+// ============================================================================
+
+void test_rope_new_del(void)
+{
+    rope *r = Rope()->new();
+    ASSERT_NOT_NULL(r);
+    ASSERT_EQ(Rope()->len(r), 0);
+    ASSERT(rope_equals(r, ""));
+    Rope()->del(&r);
+    ASSERT_NULL(r);
+}
+
+void test_rope_append(void)
+{
+    rope *r = Rope()->new();
+    string *s = String()->new("str");
+    Rope()->append(r, VAL_PCHAR("pchar "));
+    Rope()->append(r, VAL_STR(s));
+    Rope()->append(r, VAL_CHAR(' '));
+    Rope()->append(r, VAL_INT(-42));
+    Rope()->append(r, VAL_VIEW(View()->new(" view")));
+    Rope()->append(r, VAL_PATTERN(NULL));
+    ASSERT_EQ(Rope()->len(r), 18);
+    ASSERT(rope_equals(r, "pchar str -42 view"));
+    String()->del(&s);
+    Rope()->del(&r);
+}
+
+void test_rope_large(void)
+{
+    rope *r = make_lines(100000);
+    string *expected = String()->new("");
+    int i;
+    for (i = 0; i < 100000; i++)
+        APPEND_MANY(expected, VAL_PCHAR("line "), VAL_INT(i), VAL_CHAR('\n'));
+    string *flat = Rope()->flatten(r);
+    ASSERT_EQ(Rope()->len(r), String()->len(expected));
+    ASSERT(String()->equals(flat, VAL_STR(expected)));
+    String()->del(&flat);
+    String()->del(&expected);
+    Rope()->del(&r);
+}
+
+void test_rope_concat(void)
+{
+    rope *a = Rope()->new();
+    rope *b = Rope()->new();
+    Rope()->append(a, VAL_PCHAR("head,"));
+    Rope()->append(b, VAL_PCHAR("tail"));
+    Rope()->concat(a, b);
+    ASSERT(rope_equals(a, "head,tail"));
+    // b is shared, not moved: both keep working on their own
+    Rope()->append(b, VAL_PCHAR("!"));
+    Rope()->append(a, VAL_PCHAR("?"));
+    ASSERT(rope_equals(a, "head,tail?"));
+    ASSERT(rope_equals(b, "tail!"));
+    Rope()->concat(a, a);
+    ASSERT(rope_equals(a, "head,tail?head,tail?"));
+    Rope()->del(&b);
+    ASSERT(rope_equals(a, "head,tail?head,tail?"));
+    Rope()->del(&a);
+}
+
+void test_rope_insert(void)
+{
+    rope *r = Rope()->new();
+    Rope()->insert(r, 0, VAL_PCHAR("world"));
+    Rope()->insert(r, 0, VAL_PCHAR("hello "));
+    Rope()->insert(r, 5, VAL_CHAR(','));
+    Rope()->insert(r, 100, VAL_PCHAR("!"));
+    Rope()->insert(r, 7, VAL_INT(2));
+    ASSERT(rope_equals(r, "hello, 2world!"));
+    Rope()->del(&r);
+}
+
+void test_rope_insert_many(void)
+{
+    rope *r = make_lines(1000);
+    string *flat = Rope()->flatten(r);
+    ui64 pos = String()->len(flat) / 2;
+    int i;
+    for (i = 0; i < 500; i++)
+        Rope()->insert(r, pos, VAL_CHAR('#'));
+    string *after = Rope()->flatten(r);
+    ASSERT_EQ(Rope()->len(r), String()->len(flat) + 500);
+    ASSERT_EQ(memcmp(String()->view(after).ptr, String()->view(flat).ptr, pos), 0);
+    ASSERT_EQ(String()->view(after).ptr[pos], '#');
+    ASSERT_EQ(String()->view(after).ptr[pos + 499], '#');
+    ASSERT_EQ(memcmp(String()->view(after).ptr + pos + 500,
+        String()->view(flat).ptr + pos, String()->len(flat) - pos), 0);
+    String()->del(&flat);
+    String()->del(&after);
+    Rope()->del(&r);
+}
+
+void test_rope_substring(void)
+{
+    rope *r = make_lines(10000);
+    string *flat = Rope()->flatten(r);
+    rope *sub = Rope()->substring(r, 12345, 50000);
+    string *part = Rope()->flatten(sub);
+    ASSERT_EQ(Rope()->len(sub), 50000);
+    ASSERT_EQ(memcmp(String()->view(part).ptr, String()->view(flat).ptr + 12345, 50000), 0);
+    String()->del(&part);
+    Rope()->del(&sub);
+    sub = Rope()->substring(r, Rope()->len(r) - 3, 100);
+    ASSERT(rope_equals(sub, "99\n"));
+    Rope()->del(&sub);
+    sub = Rope()->substring(r, Rope()->len(r), 10);
+    ASSERT_EQ(Rope()->len(sub), 0);
+    Rope()->del(&sub);
+    // Substrings outlive the rope they were taken from
+    sub = Rope()->substring(r, 0, 14);
+    Rope()->del(&r);
+    ASSERT(rope_equals(sub, "line 0\nline 1\n"));
+    Rope()->del(&sub);
+    String()->del(&flat);
+}
+
+void test_rope_next(void)
+{
+    rope *r = make_lines(5000);
+    string *flat = Rope()->flatten(r);
+    string_view chunk;
+    ui64 it = 0;
+    ui64 total = 0;
+    int chunks = 0;
+    while (Rope()->next(r, &it, &chunk))
+    {
+        ASSERT_EQ(memcmp(chunk.ptr, String()->view(flat).ptr + total, chunk.len), 0);
+        total += chunk.len;
+        chunks++;
+    }
+    ASSERT_EQ(total, Rope()->len(r));
+    ASSERT(chunks > 1);
+    // It resumes from any position
+    it = 10;
+    ASSERT(Rope()->next(r, &it, &chunk));
+    ASSERT_EQ(memcmp(chunk.ptr, String()->view(flat).ptr + 10, chunk.len), 0);
+    String()->del(&flat);
+    Rope()->del(&r);
+}
+
+void test_rope_index_of(void)
+{
+    rope *r = Rope()->new();
+    char chunk[ROPE_CHUNK_SIZE];
+    memset(chunk, 'a', sizeof(chunk));
+    chunk[sizeof(chunk) - 3] = 'x';
+    chunk[sizeof(chunk) - 2] = 'y';
+    chunk[sizeof(chunk) - 1] = 'z';
+    Rope()->append(r, VAL_VIEW(View()->from(chunk, sizeof(chunk))));
+    Rope()->append(r, VAL_PCHAR("-needle-"));
+    Rope()->insert(r, 10, VAL_PCHAR("AB"));
+    ASSERT_EQ(Rope()->index_of(r, VAL_PCHAR("AB")), 10);
+    // Matches across chunk boundaries
+    ASSERT_EQ(Rope()->index_of(r, VAL_PCHAR("aAB")), 9);
+    ASSERT_EQ(Rope()->index_of(r, VAL_PCHAR("xyz-needle")), ROPE_CHUNK_SIZE - 1);
+    ASSERT_EQ(Rope()->index_of(r, VAL_PCHAR("z-n")), ROPE_CHUNK_SIZE + 1);
+    ASSERT_EQ(Rope()->index_of(r, VAL_PCHAR("-needle-")), ROPE_CHUNK_SIZE + 2);
+    ASSERT_EQ(Rope()->index_of(r, VAL_CHAR('-')), ROPE_CHUNK_SIZE + 2);
+    ASSERT_EQ(Rope()->index_of_from(r, VAL_CHAR('-'), ROPE_CHUNK_SIZE + 3), ROPE_CHUNK_SIZE + 9);
+    ASSERT_EQ(Rope()->index_of(r, VAL_PCHAR("needles")), -1);
+    // An empty needle never matches, as in String()->index_of
+    ASSERT_EQ(Rope()->index_of(r, VAL_PCHAR("")), -1);
+    ASSERT_EQ(Rope()->index_of_from(r, VAL_PCHAR(""), 5), -1);
+    pattern *p = Pattern()->new(VAL_PCHAR("yz-ne"));
+    ASSERT_EQ(Rope()->index_of(r, VAL_PATTERN(p)), ROPE_CHUNK_SIZE);
+    Pattern()->del(&p);
+    Rope()->del(&r);
+}
+
+void test_rope_write(void)
+{
+    rope *r = make_lines(20000);
+    string *flat = Rope()->flatten(r);
+    char path[] = "/tmp/tests_rope_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT(fd >= 0);
+    Rope()->write(fd, r);
+    ASSERT_EQ((ui64)lseek(fd, 0, SEEK_END), Rope()->len(r));
+    char *back = malloc(Rope()->len(r));
+    ASSERT_EQ((ui64)pread(fd, back, Rope()->len(r), 0), Rope()->len(r));
+    ASSERT_EQ(memcmp(back, String()->view(flat).ptr, Rope()->len(r)), 0);
+    free(back);
+    close(fd);
+    unlink(path);
+    String()->del(&flat);
+    Rope()->del(&r);
+}
+
+void test_rope_null(void)
+{
+    rope *r = NULL;
+    string_view chunk;
+    ui64 it = 0;
+    Rope()->del(&r);
+    Rope()->del(NULL);
+    ASSERT_EQ(Rope()->len(NULL), 0);
+    Rope()->append(NULL, VAL_PCHAR("a"));
+    Rope()->concat(NULL, NULL);
+    Rope()->insert(NULL, 0, VAL_PCHAR("a"));
+    ASSERT_NULL(Rope()->substring(NULL, 0, 1));
+    ASSERT_EQ(Rope()->next(NULL, &it, &chunk), 0);
+    ASSERT_EQ(Rope()->index_of(NULL, VAL_PCHAR("a")), -1);
+    ASSERT_NULL(Rope()->flatten(NULL));
+    r = Rope()->new();
+    Rope()->append(r, VAL_PCHAR(NULL));
+    Rope()->concat(r, NULL);
+    ASSERT_EQ(Rope()->len(r), 0);
+    ASSERT_EQ(Rope()->next(r, &it, &chunk), 0);
+    ASSERT_EQ(Rope()->index_of(r, VAL_PCHAR("a")), -1);
+    Rope()->del(&r);
+}
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Rope() tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Rope()");
+    
+    TEST("rope: new and del", test_rope_new_del());
+    TEST("rope: append typed values", test_rope_append());
+    TEST("rope: 100k lines", test_rope_large());
+    TEST("rope: concat shares chunks", test_rope_concat());
+    TEST("rope: insert", test_rope_insert());
+    TEST("rope: repeated inserts in the middle", test_rope_insert_many());
+    TEST("rope: substring", test_rope_substring());
+    TEST("rope: next over chunks", test_rope_next());
+    TEST("rope: index_of across chunks", test_rope_index_of());
+    TEST("rope: write with writev", test_rope_write());
+    TEST_NULL_SAFE("rope: NULL input", test_rope_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+    
+    return get_exit_code();
+}
@@ -0,0 +1,264 @@
+#include <types/search.h>
+#include "../test_framework.h"
+
+// Reference implementation every strategy is checked against
+static i64 naive_forward(const char *h, ui64 n, const char *nd, ui64 m, ui64 from)
+{
+    if (!m || m > n)
+        return (-1);
+    for (ui64 i = from; i + m <= n; i++)
+        if (memcmp(h + i, nd, m) == 0)
+            return ((i64)i);
+    return (-1);
+}
+
+static i64 naive_backward(const char *h, ui64 n, const char *nd, ui64 m, ui64 from)
+{
+    if (!m || m > n)
+        return (-1);
+    if (from > n - m)
+        from = n - m;
+    for (i64 i = (i64)from; i >= 0; i--)
+        if (memcmp(h + i, nd, m) == 0)
+            return (i);
+    return (-1);
+}
+
+// Small alphabets make partial matches (and periodic needles) very likely
+static void fill_random(char *buf, ui64 n, int alphabet, unsigned *seed)
+{
+    for (ui64 i = 0; i < n; i++)
+    {
+        *seed = *seed * 1103515245u + 12345u;
+        buf[i] = (char)('a' + (*seed >> 16) % alphabet);
+    }
+}
+
+// Checks the search of `m`-byte needles (taken from the haystack or random)
+// against the reference, forward and backward, compiled and not.
+static int check_needle_length(ui64 m, int alphabet, unsigned seed)
+{
+    static char hay[4096];
+    char        needle[1024];
+    ui64        n = sizeof(hay);
+
+    fill_random(hay, n, alphabet, &seed);
+    for (int round = 0; round < 12; round++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        if (round & 1)
+            fill_random(needle, m, alphabet, &seed);
+        else
+            memcpy(needle, hay + (seed >> 8) % (n - m), m);
+        needle[m] = '\0';
+        pattern *pat = Pattern()->new(VAL_PCHAR(needle));
+        if (!pat)
+            return (0);
+        ui64 from = (round % 3 == 0) ? 0 : (seed >> 4) % n;
+        i64 ref = naive_forward(hay, n, needle, m, from);
+        i64 rref = naive_backward(hay, n, needle, m, from);
+        int ok = search_forward(hay, n, needle, m, from) == ref
+            && Pattern()->find(pat, hay, n, from) == ref
+            && search_backward(hay, n, needle, m, from) == rref
+            && Pattern()->rfind(pat, hay, n, from) == rref;
+        Pattern()->del(&pat);
+        if (!ok)
+            return (0);
+    }
+    return (1);
+}
+
+// ============================================================================
+// Test Functions for search_forward / search_backward
+// ============================================================================
+
+void test_search_forward_basic(void)
+{
+    ASSERT_EQ(search_forward("hello world", 11, "world", 5, 0), 6);
+    ASSERT_EQ(search_forward("hello world", 11, "o", 1, 5), 7);
+    ASSERT_EQ(search_forward("hello world", 11, "xyz", 3, 0), -1);
+}
+
+void test_search_backward_basic(void)
+{
+    ASSERT_EQ(search_backward("abcabc", 6, "abc", 3, 6), 3);
+    ASSERT_EQ(search_backward("abcabc", 6, "abc", 3, 2), 0);
+    ASSERT_EQ(search_backward("abcabc", 6, "c", 1, 1), -1);
+}
+
+void test_search_backward_position_zero(void)
+{
+    ASSERT_EQ(search_backward("abxyz", 5, "ab", 2, 5), 0);
+    ASSERT_EQ(search_backward("a", 1, "a", 1, 0), 0);
+}
+
+void test_search_empty_needle(void)
+{
+    ASSERT_EQ(search_forward("abc", 3, "", 0, 0), -1);
+    ASSERT_EQ(search_backward("abc", 3, "", 0, 3), -1);
+}
+
+void test_search_needle_longer_than_hay(void)
+{
+    ASSERT_EQ(search_forward("abc", 3, "abcd", 4, 0), -1);
+    ASSERT_EQ(search_backward("abc", 3, "abcd", 4, 3), -1);
+}
+
+void test_search_from_past_end(void)
+{
+    ASSERT_EQ(search_forward("abcabc", 6, "abc", 3, 4), -1);
+    ASSERT_EQ(search_forward("abcabc", 6, "abc", 3, 100), -1);
+}
+
+void test_search_null(void)
+{
+    ASSERT_EQ(search_forward(NULL, 3, "a", 1, 0), -1);
+    ASSERT_EQ(search_backward("abc", 3, NULL, 1, 0), -1);
+}
+
+void test_search_binary_bytes(void)
+{
+    const char hay[] = "ab\0cd\xff\x80" "ef";
+    ASSERT_EQ(search_forward(hay, 9, "\0cd", 3, 0), 2);
+    ASSERT_EQ(search_forward(hay, 9, "\xff\x80", 2, 0), 5);
+    ASSERT_EQ(search_backward(hay, 9, "\0", 1, 9), 2);
+}
+
+void test_search_matches_reference_filter(void)
+{
+    for (ui64 m = 1; m <= SEARCH_FILTER_MAX; m++)
+        ASSERT(check_needle_length(m, 3, (unsigned)m * 7));
+}
+
+void test_search_matches_reference_horspool(void)
+{
+    for (ui64 m = SEARCH_FILTER_MAX + 1; m < SEARCH_TWOWAY_MIN; m += 17)
+        ASSERT(check_needle_length(m, 2, (unsigned)m * 13));
+}
+
+void test_search_matches_reference_twoway(void)
+{
+    for (ui64 m = SEARCH_TWOWAY_MIN; m < 1000; m += 61)
+    {
+        ASSERT(check_needle_length(m, 2, (unsigned)m * 31));
+        ASSERT(check_needle_length(m, 1, (unsigned)m));
+    }
+}
+
+void test_search_periodic_needle(void)
+{
+    char hay[2048];
+    char needle[400];
+
+    memset(hay, 'a', sizeof(hay));
+    memset(needle, 'a', sizeof(needle));
+    needle[399] = 'b';
+    hay[1500] = 'b';
+    ASSERT_EQ(search_forward(hay, sizeof(hay), needle, sizeof(needle), 0), 1101);
+    ASSERT_EQ(search_backward(hay, sizeof(hay), needle, sizeof(needle), 2048), 1101);
+}
+
+// ============================================================================
+// Test Functions for Pattern()
+// ============================================================================
+
+void test_pattern_new_pchar(void)
+{
+    pattern *pat = Pattern()->new(VAL_PCHAR("needle"));
+    ASSERT_NOT_NULL(pat);
+    ASSERT_EQ(Pattern()->len(pat), 6);
+    ASSERT_EQ(Pattern()->find(pat, "haystack needle", 15, 0), 9);
+    Pattern()->del(&pat);
+    ASSERT_NULL(pat);
+}
+
+void test_pattern_new_int(void)
+{
+    pattern *pat = Pattern()->new(VAL_INT(-42));
+    ASSERT_NOT_NULL(pat);
+    ASSERT_EQ(Pattern()->len(pat), 3);
+    ASSERT_EQ(Pattern()->find(pat, "x=-42", 5, 0), 2);
+    Pattern()->del(&pat);
+}
+
+void test_pattern_new_empty(void)
+{
+    ASSERT_NULL(Pattern()->new(VAL_PCHAR("")));
+    ASSERT_NULL(Pattern()->new(VAL_PCHAR(NULL)));
+}
+
+void test_pattern_reuse(void)
+{
+    pattern *pat = Pattern()->new(VAL_PCHAR("ERROR"));
+    const char *lines[] = {"INFO ok", "ERROR disk", "WARN ERROR", "ERR"};
+    i64 expected[] = {-1, 0, 5, -1};
+    for (int i = 0; i < 4; i++)
+        ASSERT_EQ(Pattern()->find(pat, lines[i], strlen(lines[i]), 0), expected[i]);
+    Pattern()->del(&pat);
+}
+
+void test_pattern_with_string_index_of(void)
+{
+    string *s = String()->new("a-b-c-b-a");
+    pattern *pat = Pattern()->new(VAL_PCHAR("b"));
+    ASSERT_EQ(String()->index_of(s, VAL_PATTERN(pat)), 2);
+    ASSERT_EQ(String()->last_index_of(s, VAL_PATTERN(pat)), 6);
+    ASSERT_EQ(String()->index_of_from(s, VAL_PATTERN(pat), 3), 6);
+    ASSERT_EQ(String()->last_index_of_from(s, VAL_PATTERN(pat), 5), 2);
+    Pattern()->del(&pat);
+    String()->del(&s);
+}
+
+void test_pattern_del_null(void)
+{
+    Pattern()->del(NULL);
+    ASSERT_EQ(Pattern()->find(NULL, "abc", 3, 0), -1);
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // search_forward / search_backward tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("search_forward / search_backward");
+    
+    TEST("search: forward basic", test_search_forward_basic());
+    TEST("search: backward basic", test_search_backward_basic());
+    TEST("search: backward position zero", test_search_backward_position_zero());
+    TEST("search: empty needle", test_search_empty_needle());
+    TEST("search: needle longer than haystack", test_search_needle_longer_than_hay());
+    TEST("search: from past end", test_search_from_past_end());
+    TEST("search: binary bytes", test_search_binary_bytes());
+    TEST("search: filter vs reference", test_search_matches_reference_filter());
+    TEST("search: horspool vs reference", test_search_matches_reference_horspool());
+    TEST("search: two-way vs reference", test_search_matches_reference_twoway());
+    TEST("search: periodic needle", test_search_periodic_needle());
+    TEST_NULL_SAFE("search: NULL input", test_search_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Pattern() tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Pattern()");
+    
+    TEST("pattern: new pchar", test_pattern_new_pchar());
+    TEST("pattern: new int", test_pattern_new_int());
+    TEST("pattern: new empty", test_pattern_new_empty());
+    TEST("pattern: reuse", test_pattern_reuse());
+    TEST("pattern: with String()->index_of", test_pattern_with_string_index_of());
+    TEST_NULL_SAFE("pattern: NULL input", test_pattern_del_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+    
+    return get_exit_code();
+}
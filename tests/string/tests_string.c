@@ -1,6 +1,9 @@
 #include <types/string.h>
+#include <types/search.h>
 #include "../test_framework.h"
+#include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
 
 // ============================================================================
 // Test Functions for String()->new
@@ -129,10 +132,213 @@ void test_write_null(void)
 void test_write_invalid_fd(void)
 {
     string *s = String()->new("test");
-    String()->write(-1, s);
+    ASSERT_EQ(String()->write(-1, s), 0);
+    String()->del(&s);
+}
+
+void test_write_many(void)
+{
+    string *parts[4];
+    char buf[64];
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    parts[0] = String()->new("key");
+    parts[1] = String()->new("=");
+    parts[2] = NULL;
+    parts[3] = String()->new(" a value long enough to live on the heap\n");
+    ASSERT(String()->write(fds[1], parts[0]));
+    ASSERT(String()->write_many(fds[1], parts, 4));
+    ASSERT(String()->write_many(fds[1], parts, 0));
+    ASSERT_EQ(String()->write_many(fds[1], NULL, 1), 0);
+    ASSERT_EQ(String()->write_many(-1, parts, 2), 0);
+    close(fds[1]);
+    ASSERT_EQ(read(fds[0], buf, sizeof(buf)), 52);
+    ASSERT_EQ(memcmp(buf, "keykey=NULL a value long enough to live on the heap\n", 52), 0);
+    close(fds[0]);
+    String()->del(&parts[0]);
+    String()->del(&parts[1]);
+    String()->del(&parts[3]);
+}
+
+// ============================================================================
+// Test Functions for String()->read_fd / read_file
+// ============================================================================
+
+void test_read_file(void)
+{
+    char path[] = "/tmp/tests_string_XXXXXX";
+    int fd = mkstemp(path);
+    string *content = String()->new("");
+    int i;
+    for (i = 0; i < 10000; i++)
+        APPEND_MANY(content, VAL_PCHAR("row "), VAL_INT(i), VAL_CHAR('\n'));
+    ASSERT(String()->write(fd, content));
+    close(fd);
+    string *s = String()->read_file(path);
+    ASSERT_NOT_NULL(s);
+    ASSERT(String()->equals(s, VAL_STR(content)));
+    // Sized from fstat: a single buffer, no growth
+    ASSERT_EQ(String()->capacity(s), String()->len(content) + 1);
+    String()->del(&s);
+    // read_fd reads what is left from the current offset
+    fd = open(path, O_RDONLY);
+    ASSERT_EQ(lseek(fd, 6, SEEK_SET), 6);
+    s = String()->read_fd(fd);
+    ASSERT_EQ(String()->len(s), String()->len(content) - 6);
+    ASSERT_EQ(String()->index_of(s, VAL_PCHAR("row 1\n")), 0);
+    String()->del(&s);
+    close(fd);
+    unlink(path);
+    String()->del(&content);
+}
+
+static void *feed_pipe(void *arg)
+{
+    int fd = *(int *)arg;
+    int i;
+    for (i = 0; i < 20000; i++)
+        write(fd, "0123456789abcdef", 16);
+    close(fd);
+    return (NULL);
+}
+
+void test_read_fd_pipe(void)
+{
+    pthread_t thread;
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    pthread_create(&thread, NULL, feed_pipe, &fds[1]);
+    string *s = String()->read_fd(fds[0]);
+    pthread_join(thread, NULL);
+    close(fds[0]);
+    ASSERT_NOT_NULL(s);
+    ASSERT_EQ(String()->len(s), 320000);
+    ASSERT_EQ(String()->index_of(s, VAL_PCHAR("f0")), 15);
+    ASSERT_EQ(String()->last_index_of(s, VAL_CHAR('0')), 320000 - 16);
     String()->del(&s);
 }
 
+void test_read_errors(void)
+{
+    ASSERT_NULL(String()->read_file(NULL));
+    ASSERT_NULL(String()->read_file("/nonexistent/tests_string"));
+    ASSERT_EQ(errno, ENOENT);
+    ASSERT_NULL(String()->read_fd(-1));
+    ASSERT_EQ(errno, EBADF);
+    string *s = String()->read_file("/dev/null");
+    ASSERT_NOT_NULL(s);
+    ASSERT_EQ(String()->len(s), 0);
+    String()->del(&s);
+}
+
+// ============================================================================
+// Test Functions for String()->map_file
+// ============================================================================
+
+// Creates a file of `len` bytes cycling through the alphabet
+static void make_file(char *path, ui64 len)
+{
+    int fd = mkstemp(path);
+    string *content = String()->new("");
+    ui64 i;
+    for (i = 0; i < len; i++)
+        String()->append(content, VAL_CHAR('a' + i % 26));
+    String()->write(fd, content);
+    String()->del(&content);
+    close(fd);
+}
+
+// Tells if `path` is mapped in this process
+static int is_mapped(const char *path)
+{
+    string *maps = String()->read_file("/proc/self/maps");
+    int found = String()->index_of(maps, VAL_PCHAR(path)) >= 0;
+    String()->del(&maps);
+    return (found);
+}
+
+void test_map_file(void)
+{
+    ui64 sizes[] = {1, 100, 4096, 3 * 4096, 100000};
+    char path[] = "/tmp/tests_string_XXXXXX";
+    ui64 i;
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        make_file(strcpy(path, "/tmp/tests_string_XXXXXX"), sizes[i]);
+        string *s = String()->map_file(path);
+        string *copy = String()->read_file(path);
+        ASSERT_NOT_NULL(s);
+        ASSERT(is_mapped(path));
+        ASSERT_EQ(String()->len(s), sizes[i]);
+        ASSERT(String()->equals(s, VAL_STR(copy)));
+        // Terminated, even when the file fills its last page
+        ASSERT_EQ(String()->view(s).ptr[sizes[i]], '\0');
+        ASSERT(String()->is_alpha(s));
+        ASSERT(String()->is_lower(s));
+        ASSERT_EQ(String()->hash(s), String()->hash(copy));
+        ASSERT_EQ(String()->last_index_of(s, VAL_CHAR('a')), (i64)((sizes[i] - 1) / 26 * 26));
+        String()->del(&s);
+        ASSERT_NULL(s);
+        ASSERT_EQ(is_mapped(path), 0);
+        String()->del(&copy);
+        unlink(path);
+    }
+}
+
+void test_map_file_copy_on_write(void)
+{
+    char path[] = "/tmp/tests_string_XXXXXX";
+    make_file(path, 10000);
+    string *s = String()->map_file(path);
+    string *shared = String()->share(s);
+    string *lower = String()->map_file(path);
+    // Changes go to a heap copy, the file and the other strings are untouched
+    String()->to_upper(s);
+    ASSERT_EQ(String()->view(s).ptr[0], 'A');
+    String()->append(shared, VAL_PCHAR("!"));
+    ASSERT_EQ(String()->len(shared), 10001);
+    ASSERT_EQ(String()->view(shared).ptr[0], 'a');
+    ASSERT(String()->reserve(lower, 20000));
+    ASSERT_EQ(String()->view(lower).ptr[1], 'b');
+    ASSERT_EQ(is_mapped(path), 0);
+    string *again = String()->read_file(path);
+    ASSERT_EQ(String()->view(again).ptr[0], 'a');
+    ASSERT_EQ(String()->len(again), 10000);
+    // Shared mappings are unmapped with the last string
+    string *kept = String()->map_file(path);
+    String()->del(&shared);
+    shared = String()->share(kept);
+    String()->del(&kept);
+    ASSERT(is_mapped(path));
+    ASSERT(String()->equals(shared, VAL_STR(again)));
+    String()->del(&shared);
+    ASSERT_EQ(is_mapped(path), 0);
+    String()->del(&s);
+    String()->del(&lower);
+    String()->del(&again);
+    unlink(path);
+}
+
+void test_map_file_fallback(void)
+{
+    char path[] = "/tmp/tests_string_XXXXXX";
+    make_file(path, 0);
+    string *s = String()->map_file(path);
+    ASSERT_NOT_NULL(s);
+    ASSERT_EQ(String()->len(s), 0);
+    String()->append(s, VAL_PCHAR("writable"));
+    ASSERT(String()->equals(s, VAL_PCHAR("writable")));
+    String()->del(&s);
+    unlink(path);
+    // /proc files report a size of 0, they are read
+    s = String()->map_file("/proc/self/status");
+    ASSERT(String()->index_of(s, VAL_PCHAR("Name:")) == 0);
+    String()->del(&s);
+    ASSERT_NULL(String()->map_file(NULL));
+    ASSERT_NULL(String()->map_file("/nonexistent/tests_string"));
+    ASSERT_EQ(errno, ENOENT);
+}
+
 // ============================================================================
 // Test Functions for String()->append
 // ============================================================================
@@ -263,13 +469,13 @@ void test_append_int_zero(void)
 
 void test_string_struct_not_null(void)
 {
-    str_funcs *funcs = String();
+    const str_funcs *funcs = String();
     ASSERT_NOT_NULL(funcs);
 }
 
 void test_string_struct_functions_not_null(void)
 {
-    str_funcs *funcs = String();
+    const str_funcs *funcs = String();
     ASSERT_NOT_NULL(funcs->new);
     ASSERT_NOT_NULL(funcs->len);
     ASSERT_NOT_NULL(funcs->write);
@@ -284,8 +490,8 @@ void test_string_struct_functions_not_null(void)
 
 void test_string_struct_singleton(void)
 {
-    str_funcs *funcs1 = String();
-    str_funcs *funcs2 = String();
+    const str_funcs *funcs1 = String();
+    const str_funcs *funcs2 = String();
     ASSERT_EQ(funcs1, funcs2);  // Should return same static struct
 }
 
@@ -935,6 +1141,1152 @@ void test_is_ascii_null(void)
     ASSERT_EQ(String()->is_ascii(NULL), 0);
 }
 
+// ============================================================================
+// Test Functions for String()->capacity / reserve / shrink_to_fit
+// ============================================================================
+
+void test_capacity_new(void)
+{
+    string *s = String()->new("hello");
+    ASSERT(String()->capacity(s) >= String()->len(s));
+    String()->del(&s);
+}
+
+void test_capacity_null(void)
+{
+    ASSERT_EQ(String()->capacity(NULL), 0);
+}
+
+void test_capacity_grows_geometrically(void)
+{
+    string *s = String()->new("");
+    ui64 growths = 0;
+    ui64 last = String()->capacity(s);
+
+    for (int i = 0; i < 100000; i++)
+    {
+        String()->append(s, VAL_CHAR('x'));
+        if (String()->capacity(s) != last)
+        {
+            growths++;
+            last = String()->capacity(s);
+        }
+    }
+    ASSERT_EQ(String()->len(s), 100000);
+    ASSERT(growths < 40);
+    String()->del(&s);
+}
+
+void test_reserve_basic(void)
+{
+    string *s = String()->new("abc");
+    ASSERT_EQ(String()->reserve(s, 1000), 1);
+    ASSERT(String()->capacity(s) >= 1000);
+    ASSERT(equals_string(s, "abc"));
+    String()->del(&s);
+}
+
+void test_reserve_no_realloc_on_append(void)
+{
+    string *s = String()->new("");
+    String()->reserve(s, 256);
+    ui64 cap = String()->capacity(s);
+    for (int i = 0; i < 256; i++)
+        String()->append(s, VAL_CHAR('a'));
+    ASSERT_EQ(String()->capacity(s), cap);
+    ASSERT_EQ(String()->len(s), 256);
+    String()->del(&s);
+}
+
+void test_reserve_smaller_keeps_capacity(void)
+{
+    string *s = String()->new("hello world");
+    ui64 cap = String()->capacity(s);
+    ASSERT_EQ(String()->reserve(s, 2), 1);
+    ASSERT_EQ(String()->capacity(s), cap);
+    ASSERT(equals_string(s, "hello world"));
+    String()->del(&s);
+}
+
+void test_reserve_null(void)
+{
+    ASSERT_EQ(String()->reserve(NULL, 10), 0);
+}
+
+void test_shrink_to_fit_basic(void)
+{
+    string *s = String()->new("");
+    String()->reserve(s, 4096);
+    String()->append(s, VAL_PCHAR("hello"));
+    String()->shrink_to_fit(s);
+    ASSERT(String()->capacity(s) < 4096);
+    ASSERT(String()->capacity(s) >= 5);
+    ASSERT(equals_string(s, "hello"));
+    String()->append(s, VAL_PCHAR(" world"));
+    ASSERT(equals_string(s, "hello world"));
+    String()->del(&s);
+}
+
+void test_shrink_to_fit_null(void)
+{
+    String()->shrink_to_fit(NULL);
+}
+
+// ============================================================================
+// Test Functions for the small-string layout
+// ============================================================================
+
+void test_sso_short_string(void)
+{
+    string *s = String()->new("short key");
+    ASSERT_EQ(String()->len(s), 9);
+    ASSERT(String()->capacity(s) >= 23);
+    ASSERT(equals_string(s, "short key"));
+    String()->del(&s);
+}
+
+void test_sso_boundary(void)
+{
+    string *s23 = String()->new("abcdefghijklmnopqrstuvw");
+    string *s24 = String()->new("abcdefghijklmnopqrstuvwx");
+    ASSERT_EQ(String()->len(s23), 23);
+    ASSERT_EQ(String()->len(s24), 24);
+    ASSERT(equals_string(s23, "abcdefghijklmnopqrstuvw"));
+    ASSERT(equals_string(s24, "abcdefghijklmnopqrstuvwx"));
+    String()->del(&s23);
+    String()->del(&s24);
+}
+
+void test_sso_grow_to_heap(void)
+{
+    string *s = String()->new("0123456789");
+    String()->append(s, VAL_PCHAR("0123456789"));
+    String()->append(s, VAL_PCHAR("0123456789"));
+    String()->append(s, VAL_CHAR('!'));
+    ASSERT_EQ(String()->len(s), 31);
+    ASSERT(equals_string(s, "012345678901234567890123456789!"));
+    ASSERT_EQ(String()->index_of(s, VAL_CHAR('!')), 30);
+    String()->del(&s);
+}
+
+void test_sso_self_append(void)
+{
+    string *s = String()->new("abcdefghijklmnop");
+    String()->append(s, VAL_STR(s));
+    ASSERT_EQ(String()->len(s), 32);
+    ASSERT(equals_string(s, "abcdefghijklmnopabcdefghijklmnop"));
+    String()->del(&s);
+}
+
+void test_sso_shrink_back_inline(void)
+{
+    string *s = String()->new("tiny");
+    String()->reserve(s, 1000);
+    ASSERT(String()->capacity(s) >= 1000);
+    String()->shrink_to_fit(s);
+    ASSERT(String()->capacity(s) < 1000);
+    ASSERT(equals_string(s, "tiny"));
+    String()->append(s, VAL_PCHAR(" and then some more text"));
+    ASSERT(equals_string(s, "tiny and then some more text"));
+    String()->del(&s);
+}
+
+void test_sso_clone_independence(void)
+{
+    string *s = String()->new("token");
+    string *clone = String()->clone(s);
+    String()->to_upper(s);
+    ASSERT(equals_string(s, "TOKEN"));
+    ASSERT(equals_string(clone, "token"));
+    String()->del(&s);
+    String()->del(&clone);
+}
+
+// ============================================================================
+// Test Functions for String()->index_of_from / last_index_of_from
+// ============================================================================
+
+void test_index_of_from_basic(void)
+{
+    string *s = String()->new("one two one two");
+    const char *needle = "two";
+    ASSERT_EQ(String()->index_of_from(s, VAL_PCHAR(needle), 0), 4);
+    ASSERT_EQ(String()->index_of_from(s, VAL_PCHAR(needle), 5), 12);
+    ASSERT_EQ(String()->index_of_from(s, VAL_PCHAR(needle), 13), -1);
+    String()->del(&s);
+}
+
+void test_index_of_from_negative(void)
+{
+    string *s = String()->new("abc");
+    ASSERT_EQ(String()->index_of_from(s, VAL_CHAR('a'), -5), 0);
+    ASSERT_EQ(String()->last_index_of_from(s, VAL_CHAR('a'), -1), -1);
+    String()->del(&s);
+}
+
+void test_last_index_of_from_basic(void)
+{
+    string *s = String()->new("one two one two");
+    const char *needle = "one";
+    ASSERT_EQ(String()->last_index_of_from(s, VAL_PCHAR(needle), 100), 8);
+    ASSERT_EQ(String()->last_index_of_from(s, VAL_PCHAR(needle), 7), 0);
+    String()->del(&s);
+}
+
+void test_last_index_of_only_at_zero(void)
+{
+    string *s = String()->new("abxyz");
+    const char *needle = "ab";
+    ASSERT_EQ(String()->last_index_of(s, VAL_PCHAR(needle)), 0);
+    String()->del(&s);
+}
+
+void test_index_of_long_needle(void)
+{
+    char hay[2001];
+    char needle[301];
+    memset(hay, 'a', 2000);
+    hay[2000] = '\0';
+    memset(needle, 'a', 300);
+    needle[299] = 'b';
+    needle[300] = '\0';
+    hay[1799] = 'b';
+    string *s = String()->new(hay);
+    ASSERT_EQ(String()->index_of(s, VAL_PCHAR(needle)), 1500);
+    ASSERT_EQ(String()->last_index_of(s, VAL_PCHAR(needle)), 1500);
+    String()->del(&s);
+}
+
+// ============================================================================
+// Test Functions for unsigned / hex / fixed-width appends
+// ============================================================================
+
+void test_append_uint(void)
+{
+    string *s = String()->new("u=");
+    String()->append(s, VAL_UINT(4294967295u));
+    ASSERT(equals_string(s, "u=4294967295"));
+    String()->del(&s);
+}
+
+void test_append_ullong_max(void)
+{
+    string *s = String()->new("");
+    String()->append(s, VAL_ULLONG(18446744073709551615ULL));
+    ASSERT(equals_string(s, "18446744073709551615"));
+    String()->del(&s);
+}
+
+void test_append_llong_min(void)
+{
+    string *s = String()->new("");
+    String()->append(s, VAL_LLONG(-9223372036854775807LL - 1));
+    ASSERT(equals_string(s, "-9223372036854775808"));
+    String()->del(&s);
+}
+
+void test_append_hex(void)
+{
+    string *s = String()->new("0x");
+    String()->append(s, VAL_HEX(0xdeadbeefULL));
+    ASSERT(equals_string(s, "0xdeadbeef"));
+    String()->append(s, VAL_CHAR(' '));
+    String()->append(s, VAL_HEX(0));
+    ASSERT(equals_string(s, "0xdeadbeef 0"));
+    String()->del(&s);
+}
+
+void test_append_fixed(void)
+{
+    string *s = String()->new("");
+    String()->append(s, VAL_FIXED(7, 3));
+    String()->append(s, VAL_CHAR('|'));
+    String()->append(s, VAL_FIXED(-7, 4));
+    String()->append(s, VAL_CHAR('|'));
+    String()->append(s, VAL_FIXED(12345, 2));
+    ASSERT(equals_string(s, "007|-007|12345"));
+    String()->del(&s);
+}
+
+void test_append_double(void)
+{
+    string *s = String()->new("");
+    String()->append(s, VAL_DOUBLE(0.1));
+    String()->append(s, VAL_CHAR('|'));
+    String()->append(s, VAL_DOUBLE(-1e22));
+    String()->append(s, VAL_CHAR('|'));
+    String()->append(s, VAL_FLOAT(3.14f));
+    String()->append(s, VAL_CHAR('|'));
+    String()->append(s, VAL_DOUBLE_FIXED(2.5, 2));
+    String()->append(s, VAL_CHAR('|'));
+    String()->append(s, VAL_FLOAT_FIXED(0.5f, 0));
+    String()->append(s, VAL_CHAR('|'));
+    String()->append(s, VAL_DOUBLE(1.0 / 0.0));
+    ASSERT(equals_string(s, "0.1|-1e+22|3.14|2.50|0|inf"));
+    // Through the measuring path and the values API
+    String()->del(&s);
+    s = String()->new("t=");
+    APPEND_MANY(s, VAL_DOUBLE(1234.5678), VAL_PCHAR(" "), VAL_FLOAT(1e-10f));
+    ASSERT(equals_string(s, "t=1234.5678 1e-10"));
+    ASSERT(String()->equals(s, VAL_PCHAR("t=1234.5678 1e-10")));
+    ASSERT_EQ(String()->index_of(s, VAL_DOUBLE(1e-10)), 12);
+    String()->del(&s);
+}
+
+void test_append_many_numbers(void)
+{
+    string *s = String()->new("");
+    char expected[32];
+    i64 total = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        String()->append(s, VAL_INT(i * 7919));
+        total += snprintf(expected, sizeof(expected), "%d", i * 7919);
+    }
+    ASSERT_EQ((i64)String()->len(s), total);
+    ASSERT_EQ(String()->last_index_of(s, VAL_PCHAR(expected)), total - (i64)strlen(expected));
+    String()->del(&s);
+}
+
+void test_index_of_hex(void)
+{
+    string *s = String()->new("addr=0x7ffe1234");
+    ASSERT_EQ(String()->index_of(s, VAL_HEX(0x7ffe1234)), 7);
+    ASSERT_EQ(String()->index_of(s, VAL_FIXED(12, 4)), -1);
+    String()->del(&s);
+}
+
+// ============================================================================
+// Test Functions for String()->append_many
+// ============================================================================
+
+void test_append_many_mixed(void)
+{
+    string *host = String()->new("db01");
+    string *s = String()->new("");
+    typed_value vals[] = {VAL_PCHAR("ts="), VAL_LLONG(1700000000123LL),
+        VAL_PCHAR(" host="), VAL_STR(host), VAL_CHAR(' '), VAL_PCHAR("code="),
+        VAL_HEX(0xbeef), VAL_PCHAR(" id="), VAL_FIXED(42, 5)};
+    String()->append_many(s, vals, sizeof(vals) / sizeof(*vals));
+    ASSERT(equals_string(s, "ts=1700000000123 host=db01 code=beef id=00042"));
+    String()->del(&s);
+    String()->del(&host);
+}
+
+void test_append_many_macro(void)
+{
+    string *s = String()->new("a");
+    APPEND_MANY(s, VAL_CHAR('b'), VAL_INT(-1), VAL_UINT(2));
+    ASSERT(equals_string(s, "ab-12"));
+    String()->del(&s);
+}
+
+void test_append_many_grows_once(void)
+{
+    string *s = String()->new("");
+    APPEND_MANY(s, VAL_PCHAR("0123456789012345678901234567890123456789"),
+        VAL_PCHAR("0123456789012345678901234567890123456789"), VAL_INT(12345));
+    ASSERT_EQ(String()->len(s), 85);
+    ASSERT_EQ(String()->capacity(s), 85);
+    String()->del(&s);
+}
+
+void test_append_many_self(void)
+{
+    string *s = String()->new("0123456789abcdef");
+    APPEND_MANY(s, VAL_CHAR('|'), VAL_STR(s), VAL_CHAR('|'), VAL_VIEW(String()->view(s)));
+    ASSERT(equals_string(s, "0123456789abcdef|0123456789abcdef|0123456789abcdef"));
+    String()->del(&s);
+}
+
+void test_append_many_skips_invalid(void)
+{
+    string *s = String()->new("x");
+    pattern *pat = Pattern()->new(VAL_PCHAR("p"));
+    APPEND_MANY(s, VAL_PCHAR(NULL), VAL_PATTERN(pat), VAL_STR(NULL), VAL_CHAR('y'));
+    ASSERT(equals_string(s, "xy"));
+    String()->append_many(s, NULL, 3);
+    String()->append_many(NULL, NULL, 0);
+    String()->append_many(s, (typed_value[]){VAL_INT(1)}, 0);
+    ASSERT(equals_string(s, "xy"));
+    Pattern()->del(&pat);
+    String()->del(&s);
+}
+
+// ============================================================================
+// Test Functions for String()->is_digit / is_decimal / is_lower / is_upper /
+// is_printable / is_space / is_title / is_empty
+// ============================================================================
+
+// Runs a predicate over a C string
+static int check_predicate(int (*pred)(string *), char *text)
+{
+    string *s = String()->new(text);
+    int result = pred(s);
+    String()->del(&s);
+    return (result);
+}
+
+void test_is_digit(void)
+{
+    ASSERT_EQ(check_predicate(String()->is_digit, "0123456789"), 1);
+    ASSERT_EQ(check_predicate(String()->is_digit, "12a"), 0);
+    ASSERT_EQ(check_predicate(String()->is_digit, "-12"), 0);
+    ASSERT_EQ(check_predicate(String()->is_digit, "1.5"), 0);
+    ASSERT_EQ(String()->is_digit(NULL), 0);
+}
+
+void test_is_decimal(void)
+{
+    ASSERT_EQ(check_predicate(String()->is_decimal, "42"), 1);
+    ASSERT_EQ(check_predicate(String()->is_decimal, "-12.5"), 1);
+    ASSERT_EQ(check_predicate(String()->is_decimal, "+.5"), 1);
+    ASSERT_EQ(check_predicate(String()->is_decimal, "3."), 1);
+    ASSERT_EQ(check_predicate(String()->is_decimal, "1.2.3"), 0);
+    ASSERT_EQ(check_predicate(String()->is_decimal, "-"), 0);
+    ASSERT_EQ(check_predicate(String()->is_decimal, "."), 0);
+    ASSERT_EQ(check_predicate(String()->is_decimal, "1e5"), 0);
+    ASSERT_EQ(check_predicate(String()->is_decimal, ""), 0);
+    ASSERT_EQ(String()->is_decimal(NULL), 0);
+}
+
+// ============================================================================
+// Test Functions for String()->to_int / to_llong / to_ulong / to_double
+// ============================================================================
+
+void test_to_int_llong_ulong(void)
+{
+    string *s = String()->new("-2147483648");
+    int i = 0;
+    long long ll = 0;
+    unsigned long ul = 0;
+    ASSERT_EQ(String()->to_int(s, &i), PARSE_OK);
+    ASSERT_EQ(i, -2147483647 - 1);
+    ASSERT_EQ(String()->to_ulong(s, &ul), PARSE_INVALID);
+    String()->append(s, VAL_CHAR('0'));
+    ASSERT_EQ(String()->to_int(s, &i), PARSE_OVERFLOW);
+    ASSERT_EQ(i, -2147483647 - 1);
+    ASSERT_EQ(String()->to_llong(s, &ll), PARSE_OK);
+    ASSERT_EQ(ll, -21474836480LL);
+    String()->del(&s);
+    // Longer than the small-string buffer
+    s = String()->new("000000000000000000000000018446744073709551615");
+    ASSERT_EQ(String()->to_ulong(s, &ul), PARSE_OK);
+    ASSERT_EQ(ul, 18446744073709551615UL);
+    ASSERT_EQ(String()->to_llong(s, &ll), PARSE_OVERFLOW);
+    String()->del(&s);
+    s = String()->new("12 ");
+    ASSERT_EQ(String()->to_int(s, &i), PARSE_INVALID);
+    String()->del(&s);
+    s = String()->new("");
+    ASSERT_EQ(String()->to_int(s, &i), PARSE_EMPTY);
+    String()->del(&s);
+}
+
+// What append writes reads back
+void test_to_double(void)
+{
+    string *s = String()->new("");
+    double d = 0;
+    String()->append(s, VAL_DOUBLE(0.1 + 0.2));
+    ASSERT_EQ(String()->to_double(s, &d), PARSE_OK);
+    ASSERT(d == 0.1 + 0.2);
+    String()->del(&s);
+    s = String()->new("-1.5e-3");
+    ASSERT_EQ(String()->to_double(s, &d), PARSE_OK);
+    ASSERT(d == -0.0015);
+    String()->del(&s);
+    s = String()->new("1.5.");
+    ASSERT_EQ(String()->to_double(s, &d), PARSE_INVALID);
+    ASSERT(d == -0.0015);
+    String()->del(&s);
+}
+
+void test_to_number_null(void)
+{
+    string *s = String()->new("1");
+    int i = 3;
+    double d = 3;
+    ASSERT_EQ(String()->to_int(NULL, &i), PARSE_EMPTY);
+    ASSERT_EQ(String()->to_double(NULL, &d), PARSE_EMPTY);
+    ASSERT_EQ(String()->to_int(s, NULL), PARSE_INVALID);
+    ASSERT_EQ(String()->to_ulong(s, NULL), PARSE_INVALID);
+    ASSERT_EQ(i, 3);
+    String()->del(&s);
+}
+
+void test_is_lower_upper(void)
+{
+    ASSERT_EQ(check_predicate(String()->is_lower, "hello world 42"), 1);
+    ASSERT_EQ(check_predicate(String()->is_lower, "Hello"), 0);
+    ASSERT_EQ(check_predicate(String()->is_lower, "123"), 0);
+    ASSERT_EQ(check_predicate(String()->is_upper, "HELLO_WORLD 42"), 1);
+    ASSERT_EQ(check_predicate(String()->is_upper, "HELLo"), 0);
+    ASSERT_EQ(check_predicate(String()->is_upper, ""), 0);
+    ASSERT_EQ(String()->is_lower(NULL), 0);
+    ASSERT_EQ(String()->is_upper(NULL), 0);
+}
+
+void test_is_printable(void)
+{
+    ASSERT_EQ(check_predicate(String()->is_printable, "Hello, World! ~"), 1);
+    ASSERT_EQ(check_predicate(String()->is_printable, "tab\there"), 0);
+    ASSERT_EQ(check_predicate(String()->is_printable, "del\x7f"), 0);
+    ASSERT_EQ(check_predicate(String()->is_printable, "caf\xc3\xa9"), 0);
+    ASSERT_EQ(String()->is_printable(NULL), 0);
+}
+
+void test_is_space(void)
+{
+    ASSERT_EQ(check_predicate(String()->is_space, " \t\n\v\f\r"), 1);
+    ASSERT_EQ(check_predicate(String()->is_space, "  x  "), 0);
+    ASSERT_EQ(String()->is_space(NULL), 0);
+}
+
+void test_is_title(void)
+{
+    ASSERT_EQ(check_predicate(String()->is_title, "Hello World"), 1);
+    ASSERT_EQ(check_predicate(String()->is_title, "Hello, World 2 Go"), 1);
+    ASSERT_EQ(check_predicate(String()->is_title, "Hello world"), 0);
+    ASSERT_EQ(check_predicate(String()->is_title, "HEllo"), 0);
+    ASSERT_EQ(check_predicate(String()->is_title, "123"), 0);
+    ASSERT_EQ(check_predicate(String()->is_title, ""), 0);
+    ASSERT_EQ(String()->is_title(NULL), 0);
+}
+
+void test_is_empty(void)
+{
+    ASSERT_EQ(check_predicate(String()->is_empty, ""), 1);
+    ASSERT_EQ(check_predicate(String()->is_empty, " "), 0);
+    ASSERT_EQ(String()->is_empty(NULL), 0);
+}
+
+void test_string_table_complete(void)
+{
+    const str_funcs *funcs = String();
+    void *const *entry = (void *const *)funcs;
+    for (ui64 i = 0; i < sizeof(str_funcs) / sizeof(void *); i++)
+        ASSERT_NOT_NULL(entry[i]);
+}
+
+// ============================================================================
+// Test Functions for String()->to_lower_into / to_upper_into
+// ============================================================================
+
+void test_to_lower_into(void)
+{
+    string *src = String()->new("Content-Type: Application/JSON");
+    string *dst = String()->new("previous content");
+    String()->to_lower_into(src, dst);
+    ASSERT(equals_string(dst, "content-type: application/json"));
+    ASSERT(equals_string(src, "Content-Type: Application/JSON"));
+    String()->to_upper_into(src, dst);
+    ASSERT(equals_string(dst, "CONTENT-TYPE: APPLICATION/JSON"));
+    String()->del(&src);
+    String()->del(&dst);
+}
+
+void test_to_lower_into_shorter(void)
+{
+    string *src = String()->new("HOST");
+    string *dst = String()->new("a much longer previous content that lives on the heap");
+    String()->to_lower_into(src, dst);
+    ASSERT(equals_string(dst, "host"));
+    ASSERT_EQ(String()->len(dst), 4);
+    String()->del(&src);
+    String()->del(&dst);
+}
+
+void test_to_lower_into_same(void)
+{
+    string *s = String()->new("MiXeD");
+    String()->to_lower_into(s, s);
+    ASSERT(equals_string(s, "mixed"));
+    String()->to_lower_into(NULL, s);
+    String()->to_lower_into(s, NULL);
+    ASSERT(equals_string(s, "mixed"));
+    String()->del(&s);
+}
+
+void test_to_upper_long(void)
+{
+    string *s = String()->new("");
+    for (int i = 0; i < 1000; i++)
+        String()->append(s, VAL_CHAR((char)('a' + i % 26)));
+    String()->append(s, VAL_PCHAR("\xe9\xc3!"));
+    String()->to_upper(s);
+    ASSERT_EQ(String()->index_of(s, VAL_CHAR('a')), -1);
+    ASSERT_EQ(String()->index_of(s, VAL_PCHAR("XYZABC")), 23);
+    ASSERT_EQ(String()->index_of(s, VAL_PCHAR("\xe9\xc3!")), 1000);
+    String()->del(&s);
+}
+
+// ============================================================================
+// Test Functions for String()->equals / equals_ignore_case / compare
+// ============================================================================
+
+void test_equals_value(void)
+{
+    string *a = String()->new("a string long enough to live on the heap");
+    string *b = String()->new("a string long enough to live on the heap");
+    string *c = String()->new("a string long enough to live on the heaP");
+    ASSERT(String()->equals(a, VAL_STR(b)));
+    ASSERT(!String()->equals(a, VAL_STR(c)));
+    ASSERT(String()->equals(a, VAL_STR(a)));
+    ASSERT(String()->equals(a, VAL_PCHAR("a string long enough to live on the heap")));
+    ASSERT(!String()->equals(a, VAL_PCHAR("a string")));
+    ASSERT(String()->equals(a, VAL_VIEW(String()->view(b))));
+    String()->del(&a);
+    String()->del(&b);
+    String()->del(&c);
+}
+
+void test_equals_value_numbers(void)
+{
+    string *s = String()->new("42");
+    ASSERT(String()->equals(s, VAL_INT(42)));
+    ASSERT(!String()->equals(s, VAL_INT(420)));
+    ASSERT(String()->equals(s, VAL_HEX(0x42)));
+    String()->del(&s);
+}
+
+void test_equals_ignore_case(void)
+{
+    string *s = String()->new("Content-Type");
+    ASSERT(String()->equals_ignore_case(s, VAL_PCHAR("content-type")));
+    ASSERT(String()->equals_ignore_case(s, VAL_PCHAR("CONTENT-TYPE")));
+    ASSERT(!String()->equals_ignore_case(s, VAL_PCHAR("content_type")));
+    ASSERT(!String()->equals_ignore_case(s, VAL_PCHAR("content-typ")));
+    ASSERT(equals_string(s, "Content-Type"));
+    String()->del(&s);
+}
+
+void test_compare_ordering(void)
+{
+    string *s = String()->new("banana");
+    ASSERT_EQ(String()->compare(s, VAL_PCHAR("banana")), 0);
+    ASSERT(String()->compare(s, VAL_PCHAR("apple")) > 0);
+    ASSERT(String()->compare(s, VAL_PCHAR("cherry")) < 0);
+    ASSERT(String()->compare(s, VAL_PCHAR("ban")) > 0);
+    ASSERT(String()->compare(s, VAL_PCHAR("bananas")) < 0);
+    ASSERT(String()->compare(s, VAL_PCHAR("banan\xe1")) < 0);
+    String()->del(&s);
+}
+
+static int compare_strings(const void *a, const void *b)
+{
+    return (String()->compare(*(string *const *)a, VAL_STR(*(string *const *)b)));
+}
+
+void test_compare_sorts(void)
+{
+    char *words[] = {"pear", "apple", "fig", "apricot", "banana", "app"};
+    char *sorted[] = {"app", "apple", "apricot", "banana", "fig", "pear"};
+    string *strs[6];
+    for (int i = 0; i < 6; i++)
+        strs[i] = String()->new(words[i]);
+    qsort(strs, 6, sizeof(*strs), compare_strings);
+    for (int i = 0; i < 6; i++)
+    {
+        ASSERT(equals_string(strs[i], sorted[i]));
+        String()->del(&strs[i]);
+    }
+}
+
+void test_compare_null(void)
+{
+    string *s = String()->new("");
+    ASSERT_EQ(String()->equals(NULL, VAL_PCHAR("")), 0);
+    ASSERT_EQ(String()->equals(s, VAL_PCHAR(NULL)), 0);
+    ASSERT(String()->equals(s, VAL_PCHAR("")));
+    ASSERT_EQ(String()->compare(NULL, VAL_PCHAR(NULL)), 0);
+    ASSERT(String()->compare(NULL, VAL_PCHAR("")) < 0);
+    ASSERT(String()->compare(s, VAL_PCHAR(NULL)) > 0);
+    ASSERT_EQ(String()->equals_ignore_case(NULL, VAL_PCHAR("")), 0);
+    String()->del(&s);
+}
+
+// ============================================================================
+// Test Functions for String()->hash
+// ============================================================================
+
+void test_hash_matches_bytes(void)
+{
+    string *s = String()->new("content-type");
+    string *t = String()->new("content-type");
+    ASSERT_EQ(String()->hash(s), memoryhash("content-type", 12));
+    ASSERT_EQ(String()->hash(s), String()->hash(t));
+    ASSERT_EQ(String()->hash(s), String()->hash(s));
+    String()->del(&s);
+    String()->del(&t);
+}
+
+void test_hash_invalidated(void)
+{
+    string *s = String()->new("Key");
+    string *dst = String()->new("");
+    ui64 before = String()->hash(s);
+    String()->append(s, VAL_CHAR('s'));
+    ASSERT_EQ(String()->hash(s), memoryhash("Keys", 4));
+    ASSERT_NE(String()->hash(s), before);
+    String()->to_lower(s);
+    ASSERT_EQ(String()->hash(s), memoryhash("keys", 4));
+    String()->to_upper(s);
+    ASSERT_EQ(String()->hash(s), memoryhash("KEYS", 4));
+    APPEND_MANY(s, VAL_INT(1), VAL_PCHAR("!"));
+    ASSERT_EQ(String()->hash(s), memoryhash("KEYS1!", 6));
+    String()->hash(dst);
+    String()->to_lower_into(s, dst);
+    ASSERT_EQ(String()->hash(dst), memoryhash("keys1!", 6));
+    String()->del(&s);
+    String()->del(&dst);
+}
+
+void test_hash_clone(void)
+{
+    string *s = String()->new("a key long enough to live on the heap");
+    ui64 hash = String()->hash(s);
+    string *c = String()->clone(s);
+    ASSERT_EQ(String()->hash(c), hash);
+    String()->append(c, VAL_CHAR('!'));
+    ASSERT_NE(String()->hash(c), hash);
+    ASSERT_EQ(String()->hash(s), hash);
+    ASSERT_EQ(String()->hash(NULL), 0);
+    String()->del(&s);
+    String()->del(&c);
+}
+
+// ============================================================================
+// Test Functions for String()->share
+// ============================================================================
+
+#define SHARED_TEXT "GET /api/v1/orders?page=2 HTTP/1.1 user-agent=curl"
+
+void test_share_same_buffer(void)
+{
+    string *s = String()->new(SHARED_TEXT);
+    string *c = String()->share(s);
+    ASSERT_NOT_NULL(c);
+    ASSERT(c != s);
+    ASSERT(String()->view(c).ptr == String()->view(s).ptr);
+    ASSERT_EQ(String()->len(c), String()->len(s));
+    ASSERT(String()->equals(c, VAL_STR(s)));
+    ASSERT_EQ(String()->hash(c), String()->hash(s));
+    String()->del(&s);
+    // The buffer outlives the string it was shared from
+    ASSERT(String()->equals(c, VAL_PCHAR(SHARED_TEXT)));
+    String()->del(&c);
+}
+
+void test_share_copy_on_write(void)
+{
+    string *s = String()->new(SHARED_TEXT);
+    string *a = String()->share(s);
+    string *b = String()->share(a);
+    const char *buf = String()->view(s).ptr;
+    String()->append(a, VAL_PCHAR(" HTTP/2"));
+    ASSERT(String()->view(a).ptr != buf);
+    ASSERT(String()->equals(a, VAL_PCHAR(SHARED_TEXT " HTTP/2")));
+    ASSERT(String()->equals(s, VAL_PCHAR(SHARED_TEXT)));
+    ASSERT(String()->view(b).ptr == buf);
+    String()->to_upper(b);
+    ASSERT(String()->view(b).ptr != buf);
+    ASSERT(String()->equals_ignore_case(b, VAL_PCHAR(SHARED_TEXT)));
+    ASSERT(String()->equals(s, VAL_PCHAR(SHARED_TEXT)));
+    // The last reference writes in place again
+    String()->to_lower(s);
+    ASSERT(String()->view(s).ptr == buf);
+    String()->del(&s);
+    String()->del(&a);
+    String()->del(&b);
+}
+
+void test_share_every_mutation(void)
+{
+    string *s = String()->new(SHARED_TEXT);
+    string *c;
+    c = String()->share(s);
+    String()->append(c, VAL_CHAR('!'));
+    ASSERT(String()->equals(s, VAL_PCHAR(SHARED_TEXT)));
+    String()->del(&c);
+    c = String()->share(s);
+    String()->append(c, VAL_INT(42));
+    ASSERT(String()->equals(s, VAL_PCHAR(SHARED_TEXT)));
+    String()->del(&c);
+    c = String()->share(s);
+    APPEND_MANY(c, VAL_PCHAR("a"), VAL_INT(1));
+    ASSERT(String()->equals(s, VAL_PCHAR(SHARED_TEXT)));
+    String()->del(&c);
+    c = String()->share(s);
+    String()->to_lower(c);
+    ASSERT(String()->equals(s, VAL_PCHAR(SHARED_TEXT)));
+    String()->del(&c);
+    c = String()->share(s);
+    String()->to_lower_into(c, c);
+    ASSERT(String()->equals(s, VAL_PCHAR(SHARED_TEXT)));
+    String()->del(&c);
+    c = String()->share(s);
+    String()->to_upper_into(s, c);
+    ASSERT(String()->equals(s, VAL_PCHAR(SHARED_TEXT)));
+    ASSERT(String()->equals_ignore_case(c, VAL_PCHAR(SHARED_TEXT)));
+    String()->del(&c);
+    c = String()->share(s);
+    ASSERT(String()->reserve(c, 1000));
+    ASSERT(String()->view(c).ptr != String()->view(s).ptr);
+    ASSERT(String()->equals(c, VAL_STR(s)));
+    String()->del(&c);
+    String()->del(&s);
+}
+
+void test_share_shrink(void)
+{
+    string *s = String()->new("");
+    String()->append(s, VAL_PCHAR(SHARED_TEXT SHARED_TEXT));
+    string *c = String()->share(s);
+    const char *buf = String()->view(s).ptr;
+    String()->shrink_to_fit(c);
+    ASSERT(String()->view(c).ptr == buf);
+    ASSERT(String()->equals(c, VAL_STR(s)));
+    String()->del(&s);
+    // Alone again, it can be shrunk
+    String()->shrink_to_fit(c);
+    ASSERT_EQ(String()->capacity(c), String()->len(c));
+    ASSERT(String()->equals(c, VAL_PCHAR(SHARED_TEXT SHARED_TEXT)));
+    String()->del(&c);
+}
+
+void test_share_inline(void)
+{
+    string *s = String()->new("short");
+    string *c = String()->share(s);
+    ASSERT(String()->equals(c, VAL_PCHAR("short")));
+    ASSERT(String()->view(c).ptr != String()->view(s).ptr);
+    String()->append(c, VAL_CHAR('!'));
+    ASSERT(String()->equals(s, VAL_PCHAR("short")));
+    String()->del(&s);
+    String()->del(&c);
+}
+
+#define SHARE_THREADS 8
+
+static void *read_shared(void *arg)
+{
+    string *c = arg;
+    int ok = String()->equals(c, VAL_PCHAR(SHARED_TEXT));
+    String()->append(c, VAL_CHAR('!'));
+    ok &= String()->equals(c, VAL_PCHAR(SHARED_TEXT "!"));
+    String()->del(&c);
+    return ((void *)(long)ok);
+}
+
+void test_share_threads(void)
+{
+    pthread_t threads[SHARE_THREADS];
+    void *ok;
+    int round, i;
+    for (round = 0; round < 200; round++)
+    {
+        string *s = String()->new(SHARED_TEXT);
+        for (i = 0; i < SHARE_THREADS; i++)
+            ASSERT_EQ(pthread_create(&threads[i], NULL, read_shared,
+                String()->share(s)), 0);
+        String()->del(&s);
+        for (i = 0; i < SHARE_THREADS; i++)
+        {
+            pthread_join(threads[i], &ok);
+            ASSERT(ok != NULL);
+        }
+    }
+}
+
+void test_share_null(void)
+{
+    ASSERT_NULL(String()->share(NULL));
+}
+
+// ============================================================================
+// Test Functions for String()->replace / replace_all
+// ============================================================================
+
+void test_replace_first(void)
+{
+    string *s = String()->new("a-b-c");
+    ASSERT_EQ(String()->replace(s, VAL_CHAR('-'), VAL_PCHAR("+")), 1);
+    ASSERT(equals_string(s, "a+b-c"));
+    ASSERT_EQ(String()->replace(s, VAL_PCHAR("b-"), VAL_PCHAR("")), 1);
+    ASSERT(equals_string(s, "a+c"));
+    ASSERT_EQ(String()->replace(s, VAL_PCHAR("zz"), VAL_PCHAR("y")), 0);
+    ASSERT(equals_string(s, "a+c"));
+    String()->del(&s);
+}
+
+// Replacements no longer than the needle stay in the same buffer
+void test_replace_all_shrinking(void)
+{
+    string *s = String()->new("");
+    String()->append(s, VAL_PCHAR("token=abc123 user=x token=abc123 token=abc123 end"));
+    const char *buf = String()->view(s).ptr;
+    ui64 capacity = String()->capacity(s);
+    ASSERT_EQ(String()->replace_all(s, VAL_PCHAR("abc123"), VAL_PCHAR("***")), 3);
+    ASSERT(equals_string(s, "token=*** user=x token=*** token=*** end"));
+    ASSERT(String()->view(s).ptr == buf);
+    ASSERT_EQ(String()->capacity(s), capacity);
+    ASSERT_EQ(String()->replace_all(s, VAL_PCHAR("token="), VAL_PCHAR("")), 3);
+    ASSERT(equals_string(s, "*** user=x *** *** end"));
+    ASSERT_EQ(String()->replace_all(s, VAL_CHAR('*'), VAL_CHAR('#')), 9);
+    ASSERT(equals_string(s, "### user=x ### ### end"));
+    String()->del(&s);
+}
+
+void test_replace_all_growing(void)
+{
+    string *s = String()->new("a,b,,c");
+    ASSERT_EQ(String()->replace_all(s, VAL_CHAR(','), VAL_PCHAR(", ")), 3);
+    ASSERT(equals_string(s, "a, b, , c"));
+    // Past the inline buffer: one allocation of the exact size
+    ASSERT_EQ(String()->replace_all(s, VAL_CHAR(' '), VAL_PCHAR(" <sp> ")), 3);
+    ASSERT(equals_string(s, "a, <sp> b, <sp> , <sp> c"));
+    ASSERT_EQ(String()->capacity(s), String()->len(s));
+    // Enough spare capacity: expanded in place
+    ASSERT(String()->reserve(s, 200));
+    const char *buf = String()->view(s).ptr;
+    ASSERT_EQ(String()->replace_all(s, VAL_PCHAR("<sp>"), VAL_INT(12345)), 3);
+    ASSERT(equals_string(s, "a, 12345 b, 12345 , 12345 c"));
+    ASSERT(String()->view(s).ptr == buf);
+    String()->del(&s);
+}
+
+// More matches than replace_all remembers while counting them
+void test_replace_all_many(void)
+{
+    string *s = String()->new("");
+    string *expected = String()->new("");
+    for (int i = 0; i < 1000; i++)
+    {
+        String()->append(s, VAL_PCHAR("x."));
+        String()->append(expected, VAL_PCHAR("xyz."));
+    }
+    ASSERT(String()->reserve(s, 10000));
+    ASSERT_EQ(String()->replace_all(s, VAL_CHAR('x'), VAL_PCHAR("xyz")), 1000);
+    ASSERT(String()->equals(s, VAL_STR(expected)));
+    ASSERT_EQ(String()->replace_all(s, VAL_PCHAR("xyz"), VAL_CHAR('x')), 1000);
+    ASSERT_EQ(String()->replace_all(s, VAL_PCHAR("x."), VAL_PCHAR("xyz.")), 1000);
+    ASSERT(String()->equals(s, VAL_STR(expected)));
+    String()->del(&s);
+    String()->del(&expected);
+}
+
+void test_replace_all_pattern(void)
+{
+    pattern *p = Pattern()->new(VAL_PCHAR("secret"));
+    string *s = String()->new("a secret, another secret, secrets");
+    ASSERT_EQ(String()->replace_all(s, VAL_PATTERN(p), VAL_PCHAR("[redacted]")), 3);
+    ASSERT(equals_string(s, "a [redacted], another [redacted], [redacted]s"));
+    // Matches do not overlap
+    String()->del(&s);
+    s = String()->new("aaaaa");
+    ASSERT_EQ(String()->replace_all(s, VAL_PCHAR("aa"), VAL_CHAR('b')), 2);
+    ASSERT(equals_string(s, "bba"));
+    Pattern()->del(&p);
+    String()->del(&s);
+}
+
+// The needle or the replacement taken from the string itself
+void test_replace_self(void)
+{
+    string *s = String()->new("");
+    String()->append(s, VAL_PCHAR("abcabcabcabcabcabcabcabcabc"));
+    string_view head = {String()->view(s).ptr, 3};
+    ASSERT_EQ(String()->replace_all(s, VAL_VIEW(head), VAL_CHAR('-')), 9);
+    ASSERT(equals_string(s, "---------"));
+    String()->append(s, VAL_PCHAR("0123456789012345678901234567890123456789"));
+    string_view digits = {String()->view(s).ptr + 9, 10};
+    ASSERT_EQ(String()->replace_all(s, VAL_CHAR('-'), VAL_VIEW(digits)), 9);
+    ASSERT_EQ(String()->len(s), 90 + 40);
+    ASSERT_EQ(String()->index_of(s, VAL_CHAR('-')), -1);
+    ASSERT_EQ(String()->index_of(s, VAL_PCHAR("01234567890123456789")), 0);
+    String()->del(&s);
+}
+
+void test_replace_shared(void)
+{
+    string *s = String()->new(SHARED_TEXT);
+    string *c = String()->share(s);
+    ASSERT_EQ(String()->replace_all(c, VAL_PCHAR("orders"), VAL_PCHAR("items")), 1);
+    ASSERT(equals_string(s, SHARED_TEXT));
+    ASSERT(String()->view(c).ptr != String()->view(s).ptr);
+    ASSERT(String()->index_of(c, VAL_PCHAR("/api/v1/items?")) > 0);
+    String()->del(&c);
+    c = String()->share(s);
+    ASSERT_EQ(String()->replace_all(c, VAL_PCHAR(SHARED_TEXT), VAL_PCHAR("short")), 1);
+    ASSERT(equals_string(c, "short"));
+    ASSERT(equals_string(s, SHARED_TEXT));
+    String()->del(&c);
+    c = String()->share(s);
+    ui64 hash = String()->hash(c);
+    ASSERT_EQ(String()->replace(c, VAL_CHAR('/'), VAL_CHAR('|')), 1);
+    ASSERT_NE(String()->hash(c), hash);
+    ASSERT(equals_string(s, SHARED_TEXT));
+    String()->del(&c);
+    String()->del(&s);
+}
+
+void test_replace_null(void)
+{
+    string *s = String()->new("abc");
+    ASSERT_EQ(String()->replace(NULL, VAL_CHAR('a'), VAL_CHAR('b')), 0);
+    ASSERT_EQ(String()->replace_all(NULL, VAL_CHAR('a'), VAL_CHAR('b')), 0);
+    ASSERT_EQ(String()->replace_all(s, VAL_PCHAR(""), VAL_CHAR('b')), 0);
+    ASSERT_EQ(String()->replace_all(s, VAL_PCHAR(NULL), VAL_CHAR('b')), 0);
+    ASSERT_EQ(String()->replace_all(s, VAL_CHAR('a'), VAL_PCHAR(NULL)), 0);
+    ASSERT(equals_string(s, "abc"));
+    String()->del(&s);
+}
+
+// ============================================================================
+// Test Functions for String()->format
+// ============================================================================
+
+void test_format_values(void)
+{
+    string *s = String()->new("");
+    string *name = String()->new("api");
+    string_view path = {"/v1/orders?x", 10};
+    ASSERT(String()->format(s, "%s %v %d %i %u %c|%v %v|%v%%",
+        VAL_PCHAR("GET"), VAL_VIEW(path), VAL_INT(-42), VAL_LLONG(-9000000000LL),
+        VAL_UINT(7), VAL_CHAR('!'), VAL_STR(name), VAL_ULLONG(18446744073709551615ULL),
+        VAL_HEX(255)));
+    ASSERT(equals_string(s, "GET /v1/orders -42 -9000000000 7 !|api 18446744073709551615|ff%"));
+    String()->del(&s);
+    String()->del(&name);
+}
+
+void test_format_width_precision(void)
+{
+    string *s = String()->new("");
+    ASSERT(String()->format(s, "[%5v][%-5v][%05d][%+d][%.2s][%8.3v]",
+        VAL_INT(42), VAL_INT(42), VAL_INT(-42), VAL_INT(3), VAL_PCHAR("abc"),
+        VAL_PCHAR("abcdef")));
+    ASSERT(equals_string(s, "[   42][42   ][-0042][+3][ab][     abc]"));
+    String()->del(&s);
+    s = String()->new("");
+    ASSERT(String()->format(s, "[%.4d][%6.4d][%*v][%-*v][%.*s][%v]",
+        VAL_INT(7), VAL_INT(-7), VAL_INT(4), VAL_CHAR('x'), VAL_INT(3),
+        VAL_CHAR('y'), VAL_INT(1), VAL_PCHAR("zzz"), VAL_FIXED(5, 3)));
+    ASSERT(equals_string(s, "[0007][ -0007][   x][y  ][z][005]"));
+    String()->del(&s);
+}
+
+void test_format_hex(void)
+{
+    string *s = String()->new("");
+    ASSERT(String()->format(s, "%x %X %#x %08x %x %x",
+        VAL_INT(255), VAL_ULLONG(0xABCDEFULL), VAL_UINT(16), VAL_INT(0xbeef),
+        VAL_INT(-1), VAL_LLONG(-1)));
+    ASSERT(equals_string(s, "ff ABCDEF 0x10 0000beef ffffffff ffffffffffffffff"));
+    String()->del(&s);
+    // Text as pairs of hex digits
+    s = String()->new("");
+    ASSERT(String()->format(s, "%x|%X|%.2x", VAL_PCHAR("\x01\xfe"), VAL_PCHAR("az"),
+        VAL_PCHAR("abc")));
+    ASSERT(equals_string(s, "01fe|617A|6162"));
+    String()->del(&s);
+}
+
+void test_format_double(void)
+{
+    string *s = String()->new("");
+    ASSERT(String()->format(s, "[%v][%.3v][%8.2v][%-8v][%+v][%08.1v][%5v]",
+        VAL_DOUBLE(0.1), VAL_DOUBLE(3.14159), VAL_DOUBLE(-2.5), VAL_FLOAT(1.5f),
+        VAL_DOUBLE(2.0), VAL_DOUBLE(-3.25), VAL_DOUBLE(0.0 / 0.0)));
+    ASSERT(equals_string(s, "[0.1][3.142][   -2.50][1.5     ][+2][-00003.2][  nan]"));
+    String()->del(&s);
+}
+
+// Written in the spare capacity when it fits, one growth when it does not
+void test_format_growth(void)
+{
+    string *s = String()->new("");
+    ASSERT(String()->reserve(s, 100));
+    const char *buf = String()->view(s).ptr;
+    ASSERT(String()->format(s, "id=%v ", VAL_INT(1)));
+    ASSERT(String()->format(s, "name=%-10v|", VAL_PCHAR("bob")));
+    ASSERT(String()->view(s).ptr == buf);
+    ASSERT(equals_string(s, "id=1 name=bob       |"));
+    ASSERT(String()->format(s, "%200v", VAL_CHAR('!')));
+    ASSERT_EQ(String()->len(s), 21 + 200);
+    ASSERT_EQ(String()->view(s).ptr[220], '!');
+    ASSERT_EQ(String()->view(s).ptr[21], ' ');
+    String()->del(&s);
+}
+
+// Arguments referencing the string being formatted into
+void test_format_self(void)
+{
+    string *s = String()->new("abc");
+    ASSERT(String()->format(s, "-%v", VAL_STR(s)));
+    ASSERT(equals_string(s, "abc-abc"));
+    for (int i = 0; i < 4; i++)
+    {
+        string_view v = String()->view(s);
+        ASSERT(String()->format(s, "%v|%v", VAL_VIEW(v), VAL_VIEW(v)));
+    }
+    ASSERT_EQ(String()->len(s), 7 * 81 + 40);
+    ASSERT_EQ(String()->index_of(s, VAL_PCHAR("abc-abcabc-abc|abc-abc")), 0);
+    String()->del(&s);
+}
+
+void test_format_shared(void)
+{
+    string *s = String()->new(SHARED_TEXT);
+    string *c = String()->share(s);
+    ui64 hash = String()->hash(c);
+    ASSERT(String()->format(c, " %v", VAL_INT(200)));
+    ASSERT(equals_string(c, SHARED_TEXT " 200"));
+    ASSERT(equals_string(s, SHARED_TEXT));
+    ASSERT_NE(String()->hash(c), hash);
+    String()->del(&c);
+    String()->del(&s);
+}
+
+// An empty format writes nothing, not even the terminator: a mapped file is
+// read only and a shared buffer belongs to other strings too
+void test_format_empty_untouched(void)
+{
+    char path[] = "/tmp/tests_string_XXXXXX";
+    make_file(path, 5);
+    string *mapped = String()->map_file(path);
+    ASSERT(String()->format(mapped, ""));
+    ASSERT(equals_string(mapped, "abcde"));
+    String()->del(&mapped);
+    unlink(path);
+    string *s = String()->new(SHARED_TEXT);
+    string *c = String()->share(s);
+    const char *buf = String()->view(s).ptr;
+    ASSERT(String()->format(c, ""));
+    ASSERT(String()->view(c).ptr == buf);
+    ASSERT(equals_string(c, SHARED_TEXT));
+    String()->del(&c);
+    String()->del(&s);
+}
+
+void test_format_invalid(void)
+{
+    string *s = String()->new("keep");
+    ASSERT_EQ(String()->format(s, "%q", VAL_INT(1)), 0);
+    ASSERT_EQ(String()->format(s, "abc %", VAL_INT(1)), 0);
+    ASSERT_EQ(String()->format(s, "%5", VAL_INT(1)), 0);
+    ASSERT(equals_string(s, "keep"));
+    // Values holding nothing write nothing, padding included
+    ASSERT(String()->format(s, "[%v][%3s]", VAL_PCHAR(NULL), VAL_STR(NULL)));
+    ASSERT(equals_string(s, "keep[][   ]"));
+    ASSERT_EQ(String()->format(NULL, "x"), 0);
+    ASSERT_EQ(String()->format(s, NULL), 0);
+    ASSERT(string_format(s, ""));
+    ASSERT(equals_string(s, "keep[][   ]"));
+    String()->del(&s);
+}
+
 // ============================================================================
 // Edge Cases
 // ============================================================================
@@ -1019,6 +2371,13 @@ int main(int argc, char **argv)
     TEST("write: basic write", test_write_basic());
     TEST_NULL_SAFE("write: NULL string", test_write_null());
     TEST("write: invalid fd", test_write_invalid_fd());
+    TEST("write_many: one writev for many strings", test_write_many());
+    TEST("read_file: sized from fstat", test_read_file());
+    TEST("read_fd: pipe of unknown size", test_read_fd_pipe());
+    TEST_NULL_SAFE("read_fd / read_file: errors", test_read_errors());
+    TEST("map_file: read in place, unmapped on del", test_map_file());
+    TEST("map_file: changes are copied", test_map_file_copy_on_write());
+    TEST_NULL_SAFE("map_file: empty and special files", test_map_file_fallback());
     
     // ─────────────────────────────────────────────────────────────────────
     // String()->append tests
@@ -1175,6 +2534,165 @@ int main(int argc, char **argv)
     TEST("is_ascii: empty string", test_is_ascii_empty());
     TEST_NULL_SAFE("is_ascii: NULL input", test_is_ascii_null());
     
+    // ─────────────────────────────────────────────────────────────────────
+    // String()->capacity / reserve / shrink_to_fit tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->capacity / reserve / shrink_to_fit");
+    
+    TEST("capacity: new string", test_capacity_new());
+    TEST("capacity: NULL string", test_capacity_null());
+    TEST("capacity: grows geometrically", test_capacity_grows_geometrically());
+    TEST("reserve: basic", test_reserve_basic());
+    TEST("reserve: no realloc on append", test_reserve_no_realloc_on_append());
+    TEST("reserve: smaller keeps capacity", test_reserve_smaller_keeps_capacity());
+    TEST("reserve: NULL string", test_reserve_null());
+    TEST("shrink_to_fit: basic", test_shrink_to_fit_basic());
+    TEST_NULL_SAFE("shrink_to_fit: NULL string", test_shrink_to_fit_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Small-string layout tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Small-string layout");
+    
+    TEST("sso: short string", test_sso_short_string());
+    TEST("sso: inline boundary", test_sso_boundary());
+    TEST("sso: grow to heap", test_sso_grow_to_heap());
+    TEST("sso: self append", test_sso_self_append());
+    TEST("sso: shrink back inline", test_sso_shrink_back_inline());
+    TEST("sso: clone independence", test_sso_clone_independence());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // String()->index_of_from / last_index_of_from tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->index_of_from / last_index_of_from");
+    
+    TEST("index_of_from: basic", test_index_of_from_basic());
+    TEST("index_of_from: negative offsets", test_index_of_from_negative());
+    TEST("last_index_of_from: basic", test_last_index_of_from_basic());
+    TEST("last_index_of: only at zero", test_last_index_of_only_at_zero());
+    TEST("index_of: long needle", test_index_of_long_needle());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Unsigned / hex / fixed-width append tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->append numbers");
+    
+    TEST("append: uint", test_append_uint());
+    TEST("append: ullong max", test_append_ullong_max());
+    TEST("append: llong min", test_append_llong_min());
+    TEST("append: hex", test_append_hex());
+    TEST("append: fixed width", test_append_fixed());
+    TEST("append: double and float", test_append_double());
+    TEST("append: many numbers", test_append_many_numbers());
+    TEST("index_of: hex and fixed", test_index_of_hex());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // append_many tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->append_many");
+    
+    TEST("append_many: mixed types", test_append_many_mixed());
+    TEST("append_many: APPEND_MANY macro", test_append_many_macro());
+    TEST("append_many: grows once", test_append_many_grows_once());
+    TEST("append_many: references itself", test_append_many_self());
+    TEST("append_many: skips invalid values", test_append_many_skips_invalid());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Character class predicate tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->is_digit ... is_empty");
+    
+    TEST("is_digit", test_is_digit());
+    TEST("is_decimal", test_is_decimal());
+    TEST("is_lower / is_upper", test_is_lower_upper());
+    TEST("is_printable", test_is_printable());
+    TEST("is_space", test_is_space());
+    TEST("is_title", test_is_title());
+    TEST("is_empty", test_is_empty());
+    TEST("String(): every entry is set", test_string_table_complete());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Number parsing tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->to_int / to_llong / to_ulong / to_double");
+    
+    TEST("to_int / to_llong / to_ulong: ranges", test_to_int_llong_ulong());
+    TEST("to_double: reads append back", test_to_double());
+    TEST_NULL_SAFE("to_int / to_double: NULL input", test_to_number_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Copy-out case conversion tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->to_lower_into / to_upper_into");
+    
+    TEST("to_lower_into / to_upper_into: basic", test_to_lower_into());
+    TEST("to_lower_into: shorter than dst", test_to_lower_into_shorter());
+    TEST("to_lower_into: same string", test_to_lower_into_same());
+    TEST("to_upper: long string", test_to_upper_long());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // equals / compare tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->equals / equals_ignore_case / compare");
+    
+    TEST("equals: strings, pchar and views", test_equals_value());
+    TEST("equals: numbers", test_equals_value_numbers());
+    TEST("equals_ignore_case", test_equals_ignore_case());
+    TEST("compare: ordering", test_compare_ordering());
+    TEST("compare: qsort", test_compare_sorts());
+    TEST_NULL_SAFE("equals / compare: NULL input", test_compare_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // hash tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->hash");
+    
+    TEST("hash: same as memoryhash of the content", test_hash_matches_bytes());
+    TEST("hash: reset by append, to_lower, to_upper", test_hash_invalidated());
+    TEST("hash: clone keeps it", test_hash_clone());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // share tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->share");
+    
+    TEST("share: same buffer, no copy", test_share_same_buffer());
+    TEST("share: copy on write", test_share_copy_on_write());
+    TEST("share: every mutation detaches", test_share_every_mutation());
+    TEST("share: shrink_to_fit", test_share_shrink());
+    TEST("share: inline strings are copied", test_share_inline());
+    TEST("share: concurrent readers and writers", test_share_threads());
+    TEST_NULL_SAFE("share: NULL input", test_share_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // String()->replace / replace_all tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->replace / replace_all");
+    
+    TEST("replace: first match", test_replace_first());
+    TEST("replace_all: shorter replacement in place", test_replace_all_shrinking());
+    TEST("replace_all: longer replacement", test_replace_all_growing());
+    TEST("replace_all: more matches than cached", test_replace_all_many());
+    TEST("replace_all: pattern needle", test_replace_all_pattern());
+    TEST("replace_all: needle or replacement in the string", test_replace_self());
+    TEST("replace_all: shared buffer", test_replace_shared());
+    TEST_NULL_SAFE("replace: NULL input", test_replace_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // String()->format tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String()->format");
+    
+    TEST("format: every value type", test_format_values());
+    TEST("format: width and precision", test_format_width_precision());
+    TEST("format: hexadecimal", test_format_hex());
+    TEST("format: double and float", test_format_double());
+    TEST("format: spare capacity, then one growth", test_format_growth());
+    TEST("format: arguments from the string itself", test_format_self());
+    TEST("format: shared buffer", test_format_shared());
+    TEST("format: empty format on a mapped or shared buffer", test_format_empty_untouched());
+    TEST_NULL_SAFE("format: invalid conversions", test_format_invalid());
+    
     // ─────────────────────────────────────────────────────────────────────
     // Edge case tests
     // ─────────────────────────────────────────────────────────────────────
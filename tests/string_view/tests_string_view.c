@@ -0,0 +1,309 @@
+#include <types/string_view.h>
+#include <types/search.h>
+#include "../test_framework.h"
+
+// ============================================================================
+// Test Functions for View()->new / from / of
+// ============================================================================
+
+void test_view_new(void)
+{
+    string_view v = View()->new("hello");
+    ASSERT_EQ(v.len, 5);
+    ASSERT(View()->equals(v, VAL_PCHAR("hello")));
+}
+
+void test_view_from_bytes(void)
+{
+    char bytes[] = {'a', '\0', 'b'};
+    string_view v = View()->from(bytes, 3);
+    ASSERT_EQ(v.len, 3);
+    ASSERT_EQ(View()->index_of(v, VAL_CHAR('b')), 2);
+}
+
+void test_view_of_values(void)
+{
+    string *s = String()->new("owned");
+    string_view v = View()->of(VAL_STR(s));
+    ASSERT(v.ptr == String()->view(s).ptr);
+    ASSERT_EQ(v.len, 5);
+    ASSERT_EQ(View()->of(VAL_PCHAR("abc")).len, 3);
+    ASSERT(View()->of(VAL_VIEW(v)).ptr == v.ptr);
+    ASSERT_NULL(View()->of(VAL_INT(42)).ptr);
+    String()->del(&s);
+}
+
+void test_string_view_borrows(void)
+{
+    string *s = String()->new("borrowed buffer");
+    string_view v = String()->view(s);
+    ASSERT_EQ(v.len, 15);
+    ASSERT(View()->equals(v, VAL_STR(s)));
+    ASSERT_NULL(String()->view(NULL).ptr);
+    String()->del(&s);
+}
+
+// ============================================================================
+// Test Functions for View()->substr / split / trim
+// ============================================================================
+
+void test_view_substr(void)
+{
+    string_view v = View()->new("hello world");
+    ASSERT(View()->equals(View()->substr(v, 6, 5), VAL_PCHAR("world")));
+    ASSERT(View()->equals(View()->substr(v, 1, 3), VAL_PCHAR("ell")));
+    ASSERT(View()->equals(View()->substr(v, 6, 100), VAL_PCHAR("world")));
+    ASSERT_EQ(View()->substr(v, 100, 5).len, 0);
+    ASSERT(View()->substr(v, 100, 5).ptr == v.ptr + v.len);
+}
+
+void test_view_split_char(void)
+{
+    string_view rest = View()->new("a,bb,,ccc");
+    string_view tok;
+    char *expected[] = {"a", "bb", "", "ccc"};
+    int n = 0;
+    while (View()->split(&rest, VAL_CHAR(','), &tok))
+    {
+        ASSERT(n < 4);
+        ASSERT(View()->equals(tok, VAL_PCHAR(expected[n])));
+        n++;
+    }
+    ASSERT_EQ(n, 4);
+    ASSERT_NULL(rest.ptr);
+}
+
+void test_view_split_multibyte(void)
+{
+    string_view rest = View()->new("k1: v1\r\nk2: v2\r\n");
+    string_view tok;
+    int n = 0;
+    while (View()->split(&rest, VAL_PCHAR("\r\n"), &tok))
+        n++;
+    // The trailing separator leaves one empty token
+    ASSERT_EQ(n, 3);
+    ASSERT_EQ(tok.len, 0);
+}
+
+void test_view_split_pattern(void)
+{
+    pattern *pat = Pattern()->new(VAL_PCHAR(" | "));
+    string_view rest = View()->new("x | y | z");
+    string_view tok;
+    ASSERT(View()->split(&rest, VAL_PATTERN(pat), &tok));
+    ASSERT(View()->equals(tok, VAL_CHAR('x')));
+    ASSERT(View()->equals(rest, VAL_PCHAR("y | z")));
+    Pattern()->del(&pat);
+}
+
+void test_view_split_no_separator(void)
+{
+    string_view rest = View()->new("single");
+    string_view tok;
+    ASSERT(View()->split(&rest, VAL_CHAR(','), &tok));
+    ASSERT(View()->equals(tok, VAL_PCHAR("single")));
+    ASSERT(!View()->split(&rest, VAL_CHAR(','), &tok));
+}
+
+void test_view_trim(void)
+{
+    string_view v = View()->new(" \t hi there \r\n");
+    ASSERT(View()->equals(View()->trim(v), VAL_PCHAR("hi there")));
+    ASSERT(View()->equals(View()->trim_left(v), VAL_PCHAR("hi there \r\n")));
+    ASSERT(View()->equals(View()->trim_right(v), VAL_PCHAR(" \t hi there")));
+    ASSERT_EQ(View()->trim(View()->new("   ")).len, 0);
+}
+
+// ============================================================================
+// Test Functions for View() searching and comparing
+// ============================================================================
+
+void test_view_starts_ends_with(void)
+{
+    string_view v = View()->new("GET /index.html");
+    ASSERT(View()->starts_with(v, VAL_PCHAR("GET ")));
+    ASSERT(View()->ends_with(v, VAL_PCHAR(".html")));
+    ASSERT(View()->starts_with(v, VAL_CHAR('G')));
+    ASSERT(!View()->starts_with(v, VAL_PCHAR("POST")));
+    ASSERT(!View()->ends_with(v, VAL_PCHAR("GET /index.html!")));
+    ASSERT(!View()->starts_with(v, VAL_PCHAR("")));
+    ASSERT(View()->ends_with(View()->new("port 8080"), VAL_INT(8080)));
+}
+
+void test_view_index_of(void)
+{
+    string_view v = View()->new("abcabc");
+    ASSERT_EQ(View()->index_of(v, VAL_PCHAR("bc")), 1);
+    ASSERT_EQ(View()->last_index_of(v, VAL_PCHAR("bc")), 4);
+    ASSERT_EQ(View()->index_of(View()->substr(v, 2, 4), VAL_PCHAR("bc")), 2);
+    ASSERT_EQ(View()->index_of(v, VAL_PCHAR("x")), -1);
+}
+
+void test_view_compare(void)
+{
+    ASSERT_EQ(View()->compare(View()->new("abc"), View()->new("abc")), 0);
+    ASSERT(View()->compare(View()->new("abc"), View()->new("abd")) < 0);
+    ASSERT(View()->compare(View()->new("abd"), View()->new("abc")) > 0);
+    ASSERT(View()->compare(View()->new("ab"), View()->new("abc")) < 0);
+    ASSERT(View()->compare(View()->new("\xff"), View()->new("a")) > 0);
+}
+
+void test_view_to_string(void)
+{
+    string_view v = View()->substr(View()->new("copy me out"), 5, 2);
+    string *s = View()->to_string(v);
+    ASSERT(equals_string(s, "me"));
+    String()->del(&s);
+}
+
+// Fields of a line parsed in place, without copies
+void test_view_to_number(void)
+{
+    string_view rest = View()->new("42,-7,3.25,x,,18446744073709551616");
+    string_view field;
+    int i = 0;
+    long long ll = 0;
+    double d = 0;
+    unsigned long ul = 0;
+    ASSERT(View()->split(&rest, VAL_CHAR(','), &field));
+    ASSERT_EQ(View()->to_int(field, &i), PARSE_OK);
+    ASSERT_EQ(i, 42);
+    ASSERT(View()->split(&rest, VAL_CHAR(','), &field));
+    ASSERT_EQ(View()->to_llong(field, &ll), PARSE_OK);
+    ASSERT_EQ(ll, -7);
+    ASSERT(View()->split(&rest, VAL_CHAR(','), &field));
+    ASSERT_EQ(View()->to_double(field, &d), PARSE_OK);
+    ASSERT(d == 3.25);
+    ASSERT(View()->split(&rest, VAL_CHAR(','), &field));
+    ASSERT_EQ(View()->to_double(field, &d), PARSE_INVALID);
+    ASSERT(View()->split(&rest, VAL_CHAR(','), &field));
+    ASSERT_EQ(View()->to_int(field, &i), PARSE_EMPTY);
+    ASSERT(View()->split(&rest, VAL_CHAR(','), &field));
+    ASSERT_EQ(View()->to_ulong(field, &ul), PARSE_OVERFLOW);
+    ASSERT_EQ(View()->to_int((string_view){NULL, 0}, &i), PARSE_EMPTY);
+}
+
+// ============================================================================
+// Test Functions for views consumed by String()
+// ============================================================================
+
+void test_string_append_view(void)
+{
+    string *s = String()->new("key=");
+    string_view v = View()->substr(View()->new("xxvaluexx"), 2, 5);
+    String()->append(s, VAL_VIEW(v));
+    ASSERT(equals_string(s, "key=value"));
+    String()->del(&s);
+}
+
+void test_string_append_own_view(void)
+{
+    string *s = String()->new("0123456789abcdefghij");
+    // The view points into the buffer the append is about to grow
+    String()->append(s, VAL_VIEW(String()->view(s)));
+    ASSERT(equals_string(s, "0123456789abcdefghij0123456789abcdefghij"));
+    String()->del(&s);
+}
+
+void test_string_index_of_view(void)
+{
+    string *s = String()->new("find the needle here");
+    string_view v = View()->substr(View()->new("a needle"), 2, 6);
+    ASSERT_EQ(String()->index_of(s, VAL_VIEW(v)), 9);
+    String()->del(&s);
+}
+
+void test_view_write(void)
+{
+    char buf[32];
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT(View()->write(fds[1], View()->substr(View()->new("a view written"), 2, 4)));
+    ASSERT(View()->write(fds[1], View()->new(NULL)));
+    close(fds[1]);
+    ASSERT_EQ(read(fds[0], buf, sizeof(buf)), 8);
+    ASSERT_EQ(memcmp(buf, "viewNULL", 8), 0);
+    close(fds[0]);
+    // The write end is closed now
+    ASSERT_EQ(View()->write(fds[1], View()->new("lost")), 0);
+    ASSERT_EQ(View()->write(-1, View()->new("lost")), 0);
+}
+
+void test_view_null(void)
+{
+    string_view nv = View()->new(NULL);
+    string_view tok;
+    ASSERT_NULL(nv.ptr);
+    ASSERT(!View()->split(&nv, VAL_CHAR(','), &tok));
+    ASSERT(!View()->split(NULL, VAL_CHAR(','), &tok));
+    ASSERT_EQ(View()->index_of(nv, VAL_CHAR('a')), -1);
+    ASSERT(!View()->equals(nv, VAL_PCHAR("")));
+    ASSERT_NULL(View()->to_string(nv));
+    ASSERT_NULL(View()->trim(nv).ptr);
+    string *s = String()->new("x");
+    String()->append(s, VAL_VIEW(nv));
+    ASSERT(equals_string(s, "x"));
+    String()->del(&s);
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // View construction tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("View()->new / from / of");
+    
+    TEST("new: C string", test_view_new());
+    TEST("from: raw bytes", test_view_from_bytes());
+    TEST("of: typed values", test_view_of_values());
+    TEST("String()->view: borrows the buffer", test_string_view_borrows());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Slicing tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("View()->substr / split / trim");
+    
+    TEST("substr: clamped", test_view_substr());
+    TEST("split: single char", test_view_split_char());
+    TEST("split: multi byte separator", test_view_split_multibyte());
+    TEST("split: pattern separator", test_view_split_pattern());
+    TEST("split: no separator", test_view_split_no_separator());
+    TEST("trim: both sides", test_view_trim());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Searching and comparing tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("View() search / compare");
+    
+    TEST("starts_with / ends_with", test_view_starts_ends_with());
+    TEST("index_of / last_index_of", test_view_index_of());
+    TEST("compare: ordering", test_view_compare());
+    TEST("to_string: copies", test_view_to_string());
+    TEST("write: whole view, 0 on a closed fd", test_view_write());
+    TEST("to_int / to_llong / to_ulong / to_double", test_view_to_number());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // String() consuming views
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("String() with VAL_VIEW");
+    
+    TEST("append: view", test_string_append_view());
+    TEST("append: view of itself", test_string_append_own_view());
+    TEST("index_of: view", test_string_index_of_view());
+    TEST_NULL_SAFE("view: NULL input", test_view_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+    
+    return get_exit_code();
+}
@@ -0,0 +1,295 @@
+#include <types/tokenizer.h>
+#include <types/string_view.h>
+#include <types/search.h>
+#include <sys/mman.h>
+#include "../test_framework.h"
+
+// Builds a text of `len` pseudo random bytes drawn from `alphabet`
+static string *random_text(ui64 len, const char *alphabet, unsigned seed)
+{
+    string *s = String()->new("");
+    ui64 n = strlen(alphabet);
+    ui64 i;
+    for (i = 0; i < len; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        String()->append(s, VAL_CHAR(alphabet[(seed >> 16) % n]));
+    }
+    return (s);
+}
+
+// Tells if the tokenizer yields exactly the tokens View()->split yields
+static int same_as_split(tokenizer tok, string_view rest, typed_value sep)
+{
+    string_view expected;
+    string_view token;
+    while (View()->split(&rest, sep, &expected))
+    {
+        if (!Tokenizer()->next(&tok, &token) || token.ptr != expected.ptr
+            || token.len != expected.len)
+            return (0);
+    }
+    return (!Tokenizer()->next(&tok, &token));
+}
+
+// ============================================================================
+// Test Functions for Tokenizer()->new
+// ============================================================================
+
+void test_tokenizer_byte(void)
+{
+    tokenizer tok = Tokenizer()->new(VAL_PCHAR("a,bc,,d,"), VAL_CHAR(','));
+    string_view token;
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("a")));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("bc")));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT_EQ(token.len, 0);
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("d")));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT_EQ(token.len, 0);
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+}
+
+void test_tokenizer_empty_text(void)
+{
+    tokenizer tok = Tokenizer()->new(VAL_PCHAR(""), VAL_CHAR(','));
+    string_view token;
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT_EQ(token.len, 0);
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+}
+
+void test_tokenizer_spans(void)
+{
+    string *s = String()->new("key=value;other=1");
+    tokenizer tok = Tokenizer()->new(VAL_STR(s), VAL_PCHAR(";"));
+    ui64 start;
+    ui64 len;
+    ASSERT(Tokenizer()->next_span(&tok, &start, &len));
+    ASSERT_EQ(start, 0);
+    ASSERT_EQ(len, 9);
+    ASSERT(Tokenizer()->next_span(&tok, &start, &len));
+    ASSERT_EQ(start, 10);
+    ASSERT_EQ(len, 7);
+    ASSERT_EQ(Tokenizer()->next_span(&tok, &start, &len), 0);
+    String()->del(&s);
+}
+
+// Separators on both sides of every block boundary, and a short last block
+void test_tokenizer_byte_blocks(void)
+{
+    string *s = random_text(10007, "abc,", 7);
+    string_view all = String()->view(s);
+    ASSERT(same_as_split(Tokenizer()->new(VAL_STR(s), VAL_CHAR(',')), all,
+        VAL_CHAR(',')));
+    ASSERT(same_as_split(Tokenizer()->new(VAL_STR(s), VAL_CHAR('a')), all,
+        VAL_CHAR('a')));
+    // A separator that never occurs: one token over every block
+    ASSERT(same_as_split(Tokenizer()->new(VAL_STR(s), VAL_CHAR('z')), all,
+        VAL_CHAR('z')));
+    String()->del(&s);
+}
+
+// Short texts ending right before an unreadable page: nothing past them is read
+void test_tokenizer_page_end(void)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    char *map = mmap(NULL, (size_t)page * 2, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT(map != MAP_FAILED);
+    mprotect(map + page, (size_t)page, PROT_NONE);
+    ui64 len;
+    for (len = 0; len < 80; len++)
+    {
+        char *text = map + page - len;
+        memset(text, 'a', len);
+        if (len > 2)
+            text[len - 2] = ',';
+        string_view all = View()->from(text, len);
+        ASSERT(same_as_split(Tokenizer()->new(VAL_VIEW(all), VAL_CHAR(',')), all,
+            VAL_CHAR(',')));
+        ASSERT(same_as_split(Tokenizer()->any_of(VAL_VIEW(all), VAL_PCHAR(",;")),
+            all, VAL_CHAR(',')));
+    }
+    munmap(map, (size_t)page * 2);
+}
+
+void test_tokenizer_sequence(void)
+{
+    string *s = random_text(5000, "ab-", 11);
+    string_view all = String()->view(s);
+    string_view token;
+    ASSERT(same_as_split(Tokenizer()->new(VAL_STR(s), VAL_PCHAR("--")), all,
+        VAL_PCHAR("--")));
+    ASSERT(same_as_split(Tokenizer()->new(VAL_STR(s), VAL_PCHAR("ab-a")), all,
+        VAL_PCHAR("ab-a")));
+    tokenizer tok = Tokenizer()->new(VAL_PCHAR("a::b::"), VAL_PCHAR("::"));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("a")));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("b")));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT_EQ(token.len, 0);
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+    String()->del(&s);
+}
+
+void test_tokenizer_pattern(void)
+{
+    pattern *p = Pattern()->new(VAL_PCHAR("<sep>"));
+    pattern *one = Pattern()->new(VAL_CHAR('|'));
+    string_view all = View()->new("x<sep>yy<sep><sep>z|w");
+    ASSERT(same_as_split(Tokenizer()->new(VAL_VIEW(all), VAL_PATTERN(p)), all,
+        VAL_PATTERN(p)));
+    ASSERT(same_as_split(Tokenizer()->new(VAL_VIEW(all), VAL_PATTERN(one)), all,
+        VAL_PATTERN(one)));
+    Pattern()->del(&p);
+    Pattern()->del(&one);
+}
+
+// The formatted number moves with the tokenizer, which is returned by value
+void test_tokenizer_number_separator(void)
+{
+    tokenizer tok = Tokenizer()->new(VAL_PCHAR("a42b42c"), VAL_INT(42));
+    tokenizer copy = tok;
+    string_view token;
+    memset(&tok, 0, sizeof(tok));
+    ASSERT(Tokenizer()->next(&copy, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("a")));
+    ASSERT(Tokenizer()->next(&copy, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("b")));
+    ASSERT(Tokenizer()->next(&copy, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("c")));
+    ASSERT_EQ(Tokenizer()->next(&copy, &token), 0);
+}
+
+void test_tokenizer_no_separator(void)
+{
+    string_view token;
+    tokenizer tok = Tokenizer()->new(VAL_PCHAR("a,b"), VAL_PCHAR(""));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("a,b")));
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+    tok = Tokenizer()->any_of(VAL_PCHAR("a,b"), VAL_PCHAR(""));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT_EQ(token.len, 3);
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+}
+
+// ============================================================================
+// Test Functions for Tokenizer()->any_of
+// ============================================================================
+
+void test_tokenizer_any_of(void)
+{
+    tokenizer tok = Tokenizer()->any_of(VAL_PCHAR("one two\tthree\n"),
+        VAL_PCHAR(" \t\n"));
+    string_view token;
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("one")));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("two")));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT(View()->equals(token, VAL_PCHAR("three")));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT_EQ(token.len, 0);
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+}
+
+// Every byte value in and out of the set, over many blocks
+void test_tokenizer_any_of_all_bytes(void)
+{
+    char text[256 * 40];
+    const char set[] = {',', ';', '\0', (char)0x80, (char)0xff, (char)0xa5, 'z'};
+    string_view token;
+    ui64 i;
+    ui64 last;
+    for (i = 0; i < sizeof(text); i++)
+        text[i] = (char)((i * 151) % 256);
+    tokenizer tok = Tokenizer()->any_of(VAL_VIEW(View()->from(text, sizeof(text))),
+        VAL_VIEW(View()->from(set, sizeof(set))));
+    last = 0;
+    for (i = 0; i <= sizeof(text); i++)
+    {
+        if (i < sizeof(text) && !memchr(set, text[i], sizeof(set)))
+            continue ;
+        ASSERT(Tokenizer()->next(&tok, &token));
+        ASSERT(token.ptr == text + last);
+        ASSERT_EQ(token.len, i - last);
+        last = i + 1;
+    }
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+}
+
+// A set made of a single byte, repeated, is a byte separator
+void test_tokenizer_any_of_one_byte(void)
+{
+    string *s = random_text(3000, "xy;", 3);
+    ASSERT(same_as_split(Tokenizer()->any_of(VAL_STR(s), VAL_PCHAR(";;")),
+        String()->view(s), VAL_CHAR(';')));
+    String()->del(&s);
+}
+
+void test_tokenizer_null(void)
+{
+    string_view token;
+    ui64 start;
+    ui64 len;
+    tokenizer tok = Tokenizer()->new(VAL_PCHAR(NULL), VAL_CHAR(','));
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+    tok = Tokenizer()->new(VAL_INT(42), VAL_CHAR(','));
+    ASSERT_EQ(Tokenizer()->next(&tok, &token), 0);
+    tok = Tokenizer()->new(VAL_PCHAR("a,b"), VAL_PATTERN(NULL));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT_EQ(token.len, 3);
+    tok = Tokenizer()->any_of(VAL_PCHAR("a,b"), VAL_STR(NULL));
+    ASSERT(Tokenizer()->next(&tok, &token));
+    ASSERT_EQ(token.len, 3);
+    ASSERT_EQ(Tokenizer()->next(NULL, &token), 0);
+    ASSERT_EQ(Tokenizer()->next(&tok, NULL), 0);
+    ASSERT_EQ(Tokenizer()->next_span(NULL, &start, &len), 0);
+    ASSERT_EQ(Tokenizer()->next_span(&tok, NULL, &len), 0);
+}
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+
+    // ─────────────────────────────────────────────────────────────────────
+    // Tokenizer()->new tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Tokenizer()->new");
+
+    TEST("tokenizer: byte separator", test_tokenizer_byte());
+    TEST("tokenizer: empty text", test_tokenizer_empty_text());
+    TEST("tokenizer: offsets and lengths", test_tokenizer_spans());
+    TEST("tokenizer: byte separator across blocks", test_tokenizer_byte_blocks());
+    TEST("tokenizer: text ending at a page end", test_tokenizer_page_end());
+    TEST("tokenizer: multi-byte separator", test_tokenizer_sequence());
+    TEST("tokenizer: pattern separator", test_tokenizer_pattern());
+    TEST("tokenizer: number separator", test_tokenizer_number_separator());
+    TEST("tokenizer: empty separator", test_tokenizer_no_separator());
+
+    // ─────────────────────────────────────────────────────────────────────
+    // Tokenizer()->any_of tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Tokenizer()->any_of");
+
+    TEST("any_of: white spaces", test_tokenizer_any_of());
+    TEST("any_of: every byte value", test_tokenizer_any_of_all_bytes());
+    TEST("any_of: a single byte", test_tokenizer_any_of_one_byte());
+    TEST_NULL_SAFE("tokenizer: NULL input", test_tokenizer_null());
+
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+
+    return get_exit_code();
+}
@@ -0,0 +1,997 @@
+#include <types/utils.h>
+#include "../test_framework.h"
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+
+// ============================================================================
+// Test Functions for memorycopy
+// ============================================================================
+
+void test_memorycopy_basic(void)
+{
+    char dst[6] = {0};
+    memorycopy(dst, "hello", 5);
+    ASSERT_STR_EQ(dst, "hello");
+}
+
+void test_memorycopy_sizes_and_alignments(void)
+{
+    unsigned char src[1100];
+    unsigned char dst[1100];
+    unsigned char ref[1100];
+
+    for (int i = 0; i < 1100; i++)
+        src[i] = (unsigned char)(i * 7 + 3);
+    for (int off = 0; off < 9; off++)
+    {
+        for (int n = 0; n < 1024; n += (n < 80 ? 1 : 37))
+        {
+            memset(dst, 0xAA, sizeof(dst));
+            memset(ref, 0xAA, sizeof(ref));
+            memorycopy(dst + off, src + (8 - off), n);
+            memcpy(ref + off, src + (8 - off), n);
+            ASSERT(memcmp(dst, ref, sizeof(dst)) == 0);
+        }
+    }
+}
+
+void test_memorycopy_overlap_forward(void)
+{
+    unsigned char buf[1200];
+    unsigned char ref[1200];
+
+    for (int shift = 1; shift < 70; shift += 3)
+    {
+        for (int n = 1; n < 1100; n += (n < 70 ? 1 : 53))
+        {
+            for (int i = 0; i < 1200; i++)
+                buf[i] = ref[i] = (unsigned char)(i * 13);
+            memorycopy(buf, buf + shift, n);
+            memmove(ref, ref + shift, n);
+            ASSERT(memcmp(buf, ref, sizeof(buf)) == 0);
+        }
+    }
+}
+
+void test_memorycopy_overlap_backward(void)
+{
+    unsigned char buf[1200];
+    unsigned char ref[1200];
+
+    for (int shift = 1; shift < 70; shift += 3)
+    {
+        for (int n = 1; n < 1100; n += (n < 70 ? 1 : 53))
+        {
+            for (int i = 0; i < 1200; i++)
+                buf[i] = ref[i] = (unsigned char)(i * 13);
+            memorycopy(buf + shift, buf, n);
+            memmove(ref + shift, ref, n);
+            ASSERT(memcmp(buf, ref, sizeof(buf)) == 0);
+        }
+    }
+}
+
+void test_memorycopy_null(void)
+{
+    char buf[4] = "abc";
+    memorycopy(NULL, buf, 3);
+    memorycopy(buf, NULL, 3);
+    memorycopy(buf, buf, 3);
+}
+
+// ============================================================================
+// Test Functions for memoryset
+// ============================================================================
+
+void test_memoryset_sizes_and_alignments(void)
+{
+    unsigned char buf[1100];
+    unsigned char ref[1100];
+
+    for (int off = 0; off < 33; off++)
+    {
+        for (int n = 0; n < 1024; n += (n < 80 ? 1 : 41))
+        {
+            memset(buf, 0x11, sizeof(buf));
+            memset(ref, 0x11, sizeof(ref));
+            memoryset(buf + off, 0x5A, n);
+            memset(ref + off, 0x5A, n);
+            ASSERT(memcmp(buf, ref, sizeof(buf)) == 0);
+        }
+    }
+}
+
+void test_memoryset_truncates_to_byte(void)
+{
+    unsigned char buf[4];
+    memoryset(buf, 0x1FF, 4);
+    ASSERT_EQ(buf[0], 0xFF);
+    ASSERT_EQ(buf[3], 0xFF);
+}
+
+void test_memoryset_null(void)
+{
+    memoryset(NULL, 0, 10);
+}
+
+// ============================================================================
+// Test Functions for stringlen
+// ============================================================================
+
+void test_stringlen_basic(void)
+{
+    ASSERT_EQ(stringlen("hello"), 5);
+    ASSERT_EQ(stringlen(""), 0);
+}
+
+void test_stringlen_sizes_and_alignments(void)
+{
+    char buf[1200];
+
+    for (int off = 0; off < 64; off++)
+    {
+        for (int n = 0; n < 1000; n += (n < 100 ? 1 : 61))
+        {
+            memset(buf, 'x', sizeof(buf));
+            buf[off + n] = '\0';
+            ASSERT_EQ(stringlen(buf + off), (ui64)n);
+        }
+    }
+}
+
+void test_stringlen_high_bytes(void)
+{
+    char buf[] = "\x80\xff\x81\x7f\x01 abc \xc3\xa9";
+    ASSERT_EQ(stringlen(buf), strlen(buf));
+}
+
+void test_stringlen_null(void)
+{
+    ASSERT_EQ(stringlen(NULL), 0);
+}
+
+// ============================================================================
+// Test Functions for integer formatting
+// ============================================================================
+
+void test_count_digits_boundaries(void)
+{
+    unsigned long long p = 1;
+    ASSERT_EQ(count_digits(0), 1);
+    for (ui64 d = 1; d <= 19; d++)
+    {
+        ASSERT_EQ(count_digits(p), d);
+        ASSERT_EQ(count_digits(p * 10 - 1), d);
+        p *= 10;
+    }
+    ASSERT_EQ(count_digits(18446744073709551615ULL), 20);
+}
+
+void test_format_llong_matches_printf(void)
+{
+    char buf[NUMBER_MAX_WIDTH];
+    char ref[32];
+    long long values[] = {0, 1, -1, 9, 10, -10, 99, 100, 12345, -987654321,
+        2147483647LL, -2147483648LL, 9223372036854775807LL,
+        -9223372036854775807LL - 1};
+
+    for (ui64 i = 0; i < sizeof(values) / sizeof(*values); i++)
+    {
+        ui64 len = format_llong(buf, values[i]);
+        snprintf(ref, sizeof(ref), "%lld", values[i]);
+        ASSERT_EQ(len, strlen(ref));
+        ASSERT(memcmp(buf, ref, len) == 0);
+        ASSERT_EQ(format_llong(NULL, values[i]), len);
+    }
+}
+
+void test_format_ullong_and_hex(void)
+{
+    char buf[NUMBER_MAX_WIDTH];
+    char ref[32];
+    unsigned long long v = 1;
+
+    for (int i = 0; i < 64; i++, v = v * 3 + 1)
+    {
+        ui64 len = format_ullong(buf, v);
+        snprintf(ref, sizeof(ref), "%llu", v);
+        ASSERT(len == strlen(ref) && memcmp(buf, ref, len) == 0);
+        len = format_hex(buf, v);
+        snprintf(ref, sizeof(ref), "%llx", v);
+        ASSERT(len == strlen(ref) && memcmp(buf, ref, len) == 0);
+    }
+    ASSERT_EQ(format_hex(buf, 0), 1);
+    ASSERT_EQ(buf[0], '0');
+}
+
+void test_format_fixed(void)
+{
+    char buf[NUMBER_MAX_WIDTH];
+
+    ASSERT_EQ(format_fixed(buf, 42, 6), 6);
+    ASSERT(memcmp(buf, "000042", 6) == 0);
+    ASSERT_EQ(format_fixed(buf, -42, 6), 6);
+    ASSERT(memcmp(buf, "-00042", 6) == 0);
+    ASSERT_EQ(format_fixed(buf, 123456, 3), 6);
+    ASSERT_EQ(format_fixed(NULL, 1, 1000), NUMBER_MAX_WIDTH);
+}
+
+void test_llong_to_ascii(void)
+{
+    char *s = llong_to_ascii(-9223372036854775807LL - 1);
+    ASSERT_NOT_NULL(s);
+    ASSERT_STR_EQ(s, "-9223372036854775808");
+    free(s);
+    s = int_to_ascii(0);
+    ASSERT_STR_EQ(s, "0");
+    free(s);
+}
+
+// ============================================================================
+// Test Functions for format_double / format_float
+// ============================================================================
+
+// xorshift64, so the random values are the same on every run
+static unsigned long long next_random(unsigned long long *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (*state);
+}
+
+// Fewest significant digits printf needs for `x` to read back the same
+static int shortest_digits(double x, int is_float)
+{
+    char ref[64];
+    for (int p = 1; p < 17; p++)
+    {
+        snprintf(ref, sizeof(ref), "%.*e", p - 1, x);
+        if (is_float ? strtof(ref, NULL) == (float)x : strtod(ref, NULL) == x)
+            return (p);
+    }
+    return (17);
+}
+
+// Significant digits of a decimal, exponent excluded
+static int significant_digits(const char *s)
+{
+    int count = 0;
+    int pending = 0;
+    int started = 0;
+    for (; *s && *s != 'e'; s++)
+    {
+        if (*s < '0' || *s > '9')
+            continue ;
+        started |= (*s != '0');
+        if (!started)
+            continue ;
+        pending++;
+        if (*s != '0')
+        {
+            count += pending;
+            pending = 0;
+        }
+    }
+    return (count ? count : 1);
+}
+
+void test_format_double_shortest(void)
+{
+    char buf[NUMBER_MAX_WIDTH + 1];
+    struct { double x; const char *text; } cases[] = {
+        {0.1, "0.1"}, {0.3, "0.3"}, {1.0, "1"}, {-2.5, "-2.5"}, {100, "100"},
+        {123456.789, "123456.789"}, {1e20, "100000000000000000000"},
+        {1e21, "1e+21"}, {1.5e300, "1.5e+300"}, {0.000001, "0.000001"},
+        {1e-7, "1e-7"}, {-1.25e-10, "-1.25e-10"}, {5e-324, "4.9e-324"},
+        {1.7976931348623157e308, "1.7976931348623157e+308"},
+        {2.2250738585072014e-308, "2.2250738585072014e-308"},
+        {9007199254740993.0, "9007199254740992"}, {0.0, "0"}, {-0.0, "-0"},
+        {1.0 / 0.0, "inf"}, {-1.0 / 0.0, "-inf"}, {0.0 / 0.0, "nan"}
+    };
+    for (ui64 i = 0; i < sizeof(cases) / sizeof(*cases); i++)
+    {
+        ui64 len = format_double(buf, cases[i].x, -1);
+        buf[len] = '\0';
+        ASSERT_STR_EQ(buf, cases[i].text);
+        ASSERT_EQ(format_double(NULL, cases[i].x, -1), len);
+    }
+    ASSERT_EQ(format_float(buf, 0.1f, -1), 3);
+    ASSERT(memcmp(buf, "0.1", 3) == 0);
+    ASSERT_EQ(format_float(buf, 16777216.0f, -1), 8);
+    ASSERT(memcmp(buf, "16777216", 8) == 0);
+    // The smallest subnormals keep two digits, like 4.9e-324
+    ASSERT_EQ(format_float(buf, 1e-45f, -1), 7);
+    ASSERT(memcmp(buf, "1.4e-45", 7) == 0);
+}
+
+// Random bit patterns: every double reads back the same, with the fewest digits
+void test_format_double_round_trip(void)
+{
+    char buf[NUMBER_MAX_WIDTH + 1];
+    unsigned long long state = 88172645463325252ULL;
+    for (int i = 0; i < 100000; i++)
+    {
+        unsigned long long bits = next_random(&state);
+        double x;
+        memcpy(&x, &bits, sizeof(x));
+        if (x != x || x - x != 0)
+            continue ;
+        ui64 len = format_double(buf, x, -1);
+        buf[len] = '\0';
+        ASSERT(strtod(buf, NULL) == x);
+        ASSERT(significant_digits(buf) <= shortest_digits(x, 0));
+    }
+}
+
+void test_format_float_round_trip(void)
+{
+    char buf[NUMBER_MAX_WIDTH + 1];
+    unsigned long long state = 2463534242ULL;
+    for (int i = 0; i < 100000; i++)
+    {
+        unsigned int bits = (unsigned int)next_random(&state);
+        float x;
+        memcpy(&x, &bits, sizeof(x));
+        if (x != x || x - x != 0)
+            continue ;
+        ui64 len = format_float(buf, x, -1);
+        buf[len] = '\0';
+        ASSERT(strtof(buf, NULL) == x);
+        ASSERT(significant_digits(buf) <= shortest_digits(x, 1));
+    }
+}
+
+// Fixed precision rounds the exact binary value, like printf
+void test_format_double_fixed(void)
+{
+    char buf[NUMBER_MAX_WIDTH + 1];
+    char ref[512];
+    unsigned long long state = 1234567ULL;
+    ASSERT_EQ(format_double(buf, 2.675, 2), 4);
+    ASSERT(memcmp(buf, "2.67", 4) == 0);
+    ASSERT_EQ(format_double(buf, 0.125, 2), 4);
+    ASSERT(memcmp(buf, "0.12", 4) == 0);
+    ASSERT_EQ(format_double(buf, -0.001, 2), 5);
+    ASSERT(memcmp(buf, "-0.00", 5) == 0);
+    ASSERT_EQ(format_double(buf, 99.5, 0), 3);
+    ASSERT(memcmp(buf, "100", 3) == 0);
+    // Too large for fixed notation: shortest
+    ASSERT_EQ(format_double(buf, 1e300, 2), 6);
+    ASSERT(memcmp(buf, "1e+300", 6) == 0);
+    ASSERT_EQ(format_double(NULL, 0.5, 1000), 2 + DOUBLE_MAX_PRECISION);
+    for (int i = 0; i < 100000; i++)
+    {
+        unsigned long long bits = next_random(&state);
+        double x;
+        memcpy(&x, &bits, sizeof(x));
+        if (i % 2)
+            x = (double)(long long)(bits % 2000001 - 1000000) / (double)(1 + bits % 977);
+        if (!(x < 1e21 && x > -1e21))
+            continue ;
+        int precision = (int)(next_random(&state) % (DOUBLE_MAX_PRECISION + 1));
+        ui64 len = format_double(buf, x, precision);
+        buf[len] = '\0';
+        snprintf(ref, sizeof(ref), "%.*f", precision, x);
+        ASSERT_STR_EQ(buf, ref);
+    }
+    ASSERT_EQ(format_float(buf, 0.1f, 10), 12);
+    ASSERT(memcmp(buf, "0.1000000015", 12) == 0);
+}
+
+// Too large for fixed notation: the shortest digits of the float, not of the
+// double it widens to
+void test_format_float_fixed_large(void)
+{
+    char buf[NUMBER_MAX_WIDTH + 1];
+    ASSERT_EQ(format_float(buf, 3e38f, 0), 5);
+    ASSERT(memcmp(buf, "3e+38", 5) == 0);
+    ASSERT_EQ(format_float(buf, -3.4028235e38f, 40), 14);
+    ASSERT(memcmp(buf, "-3.4028235e+38", 14) == 0);
+    ASSERT_EQ(format_float(buf, 1e21f, 2), 5);
+    ASSERT(memcmp(buf, "1e+21", 5) == 0);
+    ASSERT_EQ(format_float(buf, 1e20f, 0), 21);
+    ASSERT(memcmp(buf, "100000002004087734272", 21) == 0);
+}
+
+// ============================================================================
+// Test Functions for parse_int / parse_llong / parse_ulong / parse_double
+// ============================================================================
+
+#define PARSE(f, s, out) f((s), strlen(s), (out))
+
+void test_parse_llong(void)
+{
+    long long n = 7;
+    ASSERT_EQ(PARSE(parse_llong, "0", &n), PARSE_OK);
+    ASSERT_EQ(n, 0);
+    ASSERT_EQ(PARSE(parse_llong, "-42", &n), PARSE_OK);
+    ASSERT_EQ(n, -42);
+    ASSERT_EQ(PARSE(parse_llong, "+0000000000000000000000012345678", &n), PARSE_OK);
+    ASSERT_EQ(n, 12345678);
+    ASSERT_EQ(PARSE(parse_llong, "9223372036854775807", &n), PARSE_OK);
+    ASSERT_EQ(n, LLONG_MAX);
+    ASSERT_EQ(PARSE(parse_llong, "-9223372036854775808", &n), PARSE_OK);
+    ASSERT_EQ(n, LLONG_MIN);
+    // Out of range values saturate
+    ASSERT_EQ(PARSE(parse_llong, "9223372036854775808", &n), PARSE_OVERFLOW);
+    ASSERT_EQ(n, LLONG_MAX);
+    ASSERT_EQ(PARSE(parse_llong, "-99999999999999999999999999999999", &n), PARSE_OVERFLOW);
+    ASSERT_EQ(n, LLONG_MIN);
+    // Errors leave the output alone
+    n = 7;
+    ASSERT_EQ(PARSE(parse_llong, "", &n), PARSE_EMPTY);
+    ASSERT_EQ(parse_llong(NULL, 3, &n), PARSE_EMPTY);
+    ASSERT_EQ(PARSE(parse_llong, "-", &n), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_llong, " 1", &n), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_llong, "1234567x", &n), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_llong, "12345678/", &n), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_llong, "99999999999999999999999999x", &n), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_llong, "0x10", &n), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_llong, "1", NULL), PARSE_INVALID);
+    ASSERT_EQ(n, 7);
+    // Only `len` bytes are read
+    ASSERT_EQ(parse_llong("123456789", 4, &n), PARSE_OK);
+    ASSERT_EQ(n, 1234);
+}
+
+// Every digit count and sign, against strtoll
+void test_parse_llong_matches_strtoll(void)
+{
+    char buf[32];
+    unsigned long long state = 42;
+    for (int i = 0; i < 200000; i++)
+    {
+        unsigned long long r = next_random(&state);
+        int len = 0;
+        if (r % 3 == 0)
+            buf[len++] = r % 2 ? '-' : '+';
+        for (int k = 1 + (int)((r >> 8) % 21); k > 0; k--)
+            buf[len++] = (char)('0' + next_random(&state) % 10);
+        buf[len] = '\0';
+        errno = 0;
+        long long expected = strtoll(buf, NULL, 10);
+        long long n;
+        ASSERT_EQ(parse_llong(buf, len, &n), errno ? PARSE_OVERFLOW : PARSE_OK);
+        ASSERT_EQ(n, expected);
+    }
+}
+
+void test_parse_int_ulong(void)
+{
+    int i = 7;
+    unsigned long u = 7;
+    ASSERT_EQ(PARSE(parse_int, "-2147483648", &i), PARSE_OK);
+    ASSERT_EQ(i, INT_MIN);
+    ASSERT_EQ(PARSE(parse_int, "2147483648", &i), PARSE_OVERFLOW);
+    ASSERT_EQ(i, INT_MAX);
+    ASSERT_EQ(PARSE(parse_int, "-9223372036854775809", &i), PARSE_OVERFLOW);
+    ASSERT_EQ(i, INT_MIN);
+    ASSERT_EQ(PARSE(parse_int, "1.5", &i), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_ulong, "18446744073709551615", &u), PARSE_OK);
+    ASSERT_EQ(u, 18446744073709551615UL);
+    ASSERT_EQ(PARSE(parse_ulong, "+18446744073709551616", &u), PARSE_OVERFLOW);
+    ASSERT_EQ(u, ULONG_MAX);
+    u = 7;
+    ASSERT_EQ(PARSE(parse_ulong, "-1", &u), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_ulong, "-0", &u), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_ulong, "+", &u), PARSE_INVALID);
+    ASSERT_EQ(u, 7);
+}
+
+void test_parse_double(void)
+{
+    double d = 7;
+    ASSERT_EQ(PARSE(parse_double, "1.5", &d), PARSE_OK);
+    ASSERT(d == 1.5);
+    ASSERT_EQ(PARSE(parse_double, "-.5e1", &d), PARSE_OK);
+    ASSERT(d == -5.0);
+    ASSERT_EQ(PARSE(parse_double, "5.", &d), PARSE_OK);
+    ASSERT(d == 5.0);
+    ASSERT_EQ(PARSE(parse_double, "-0", &d), PARSE_OK);
+    ASSERT(d == 0 && signbit(d));
+    ASSERT_EQ(PARSE(parse_double, "1e+21", &d), PARSE_OK);
+    ASSERT(d == 1e21);
+    ASSERT_EQ(PARSE(parse_double, "4.9e-324", &d), PARSE_OK);
+    ASSERT(d == 4.9e-324);
+    ASSERT_EQ(PARSE(parse_double, "1e-400", &d), PARSE_OK);
+    ASSERT(d == 0);
+    ASSERT_EQ(PARSE(parse_double, "-INF", &d), PARSE_OK);
+    ASSERT(isinf(d) && d < 0);
+    ASSERT_EQ(PARSE(parse_double, "Infinity", &d), PARSE_OK);
+    ASSERT(isinf(d) && d > 0);
+    ASSERT_EQ(PARSE(parse_double, "nan", &d), PARSE_OK);
+    ASSERT(d != d);
+    ASSERT_EQ(PARSE(parse_double, "1.8e308", &d), PARSE_OVERFLOW);
+    ASSERT(isinf(d) && d > 0);
+    ASSERT_EQ(PARSE(parse_double, "-1e99999999999", &d), PARSE_OVERFLOW);
+    ASSERT(isinf(d) && d < 0);
+    d = 7;
+    const char *invalid[] = {".", "-", "e5", "1e", "1e+", "1.2.3", "1,5", " 1",
+        "1 ", "0x1p3", "infinit", "nana", "--1"};
+    for (ui64 i = 0; i < sizeof(invalid) / sizeof(*invalid); i++)
+        ASSERT_EQ(PARSE(parse_double, invalid[i], &d), PARSE_INVALID);
+    ASSERT_EQ(PARSE(parse_double, "", &d), PARSE_EMPTY);
+    ASSERT(d == 7);
+}
+
+// Random doubles written with 17 digits or fewer, and random digit strings,
+// against strtod
+void test_parse_double_matches_strtod(void)
+{
+    char buf[128];
+    unsigned long long state = 88172645463325252ULL;
+    for (int i = 0; i < 200000; i++)
+    {
+        unsigned long long bits = next_random(&state);
+        double x;
+        double d;
+        memcpy(&x, &bits, sizeof(x));
+        if (x != x || x - x != 0)
+            continue ;
+        // Few digits may round the largest doubles up to infinity
+        int len = snprintf(buf, sizeof(buf), "%.*e", (int)(bits % 18), x);
+        ASSERT(parse_double(buf, len, &d) != PARSE_INVALID);
+        ASSERT(d == strtod(buf, NULL));
+        len = 0;
+        for (int k = 1 + (int)((bits >> 16) % 40); k > 0; k--)
+            buf[len++] = (char)('0' + next_random(&state) % 10);
+        len += snprintf(buf + len, sizeof(buf) - len, "e%d", (int)((bits >> 32) % 700) - 350);
+        ASSERT(parse_double(buf, len, &d) != PARSE_INVALID);
+        ASSERT(d == strtod(buf, NULL));
+    }
+}
+
+// Decimals exactly halfway between two doubles, and just above: the long
+// mantissas are settled with big integers
+void test_parse_double_halfway(void)
+{
+    char buf[1200];
+    double d;
+    // 2^53 + 1 ties to 2^53, 2^53 + 3 to 2^53 + 4
+    ASSERT_EQ(PARSE(parse_double, "9007199254740993", &d), PARSE_OK);
+    ASSERT(d == 9007199254740992.0);
+    ASSERT_EQ(PARSE(parse_double, "9007199254740995", &d), PARSE_OK);
+    ASSERT(d == 9007199254740996.0);
+    ASSERT_EQ(PARSE(parse_double, "9007199254740993.00000000000000000000000001", &d), PARSE_OK);
+    ASSERT(d == 9007199254740994.0);
+    // Halfway between 0 and the smallest subnormal, 2^-1075 has 752 digits:
+    // it ties to 0, anything above it rounds up
+    int len = snprintf(buf, sizeof(buf), "%.760Le", 0x1p-1075L);
+    ASSERT_EQ(parse_double(buf, len, &d), PARSE_OK);
+    ASSERT(d == 0);
+    buf[761] = '1';
+    ASSERT_EQ(parse_double(buf, len, &d), PARSE_OK);
+    ASSERT(d == 4.9406564584124654e-324);
+    // Random midpoints, written exactly by printf from a long double
+    unsigned long long state = 2463534242ULL;
+    for (int i = 0; i < 2000; i++)
+    {
+        unsigned long long bits = next_random(&state) & 0x7fefffffffffffffULL;
+        double lo;
+        double hi;
+        memcpy(&lo, &bits, sizeof(lo));
+        bits++;
+        memcpy(&hi, &bits, sizeof(hi));
+        len = snprintf(buf, sizeof(buf), "%.1100Le", ((long double)lo + hi) / 2);
+        ASSERT_EQ(parse_double(buf, len, &d), PARSE_OK);
+        ASSERT(d == strtod(buf, NULL));
+        ASSERT(d == lo || d == hi);
+    }
+}
+
+// What format_double writes reads back as the same double
+void test_parse_double_round_trip(void)
+{
+    char buf[NUMBER_MAX_WIDTH];
+    unsigned long long state = 1234567ULL;
+    for (int i = 0; i < 200000; i++)
+    {
+        unsigned long long bits = next_random(&state);
+        double x;
+        double d;
+        memcpy(&x, &bits, sizeof(x));
+        if (x != x)
+            continue ;
+        ASSERT_EQ(parse_double(buf, format_double(buf, x, -1), &d), PARSE_OK);
+        ASSERT(memcmp(&d, &x, sizeof(d)) == 0);
+    }
+}
+
+// ============================================================================
+// Test Functions for char_class_of / memoryspan / memorycspan
+// ============================================================================
+
+// Reference span: counts leading bytes whose class matches `inside`
+static ui64 ref_span(const unsigned char *p, ui64 n, int classes, int inside)
+{
+    ui64 i = 0;
+    while (i < n && ((char_class_of(p[i]) & classes) != 0) == inside)
+        i++;
+    return (i);
+}
+
+void test_char_class_of(void)
+{
+    ASSERT_EQ(char_class_of('a'), CHAR_LOWER);
+    ASSERT_EQ(char_class_of('Z'), CHAR_UPPER);
+    ASSERT_EQ(char_class_of('5'), CHAR_DIGIT);
+    ASSERT_EQ(char_class_of(' '), CHAR_BLANK);
+    ASSERT_EQ(char_class_of('\n'), CHAR_SPACE);
+    ASSERT_EQ(char_class_of('~'), CHAR_PUNCT);
+    ASSERT_EQ(char_class_of(127), CHAR_CNTRL);
+    ASSERT_EQ(char_class_of('\0'), CHAR_CNTRL);
+    ASSERT_EQ(char_class_of(0xe9), CHAR_HIGH);
+    for (int c = 0; c < 256; c++)
+        ASSERT_EQ(__builtin_popcount(char_class_of(c)), 1);
+}
+
+void test_memoryspan_basic(void)
+{
+    ASSERT_EQ(memoryspan("abc1", 4, CHAR_ALPHA), 3);
+    ASSERT_EQ(memorycspan("abc1", 4, CHAR_DIGIT), 3);
+    ASSERT_EQ(memoryspan("hello world", 11, CHAR_ALPHA | CHAR_BLANK), 11);
+    ASSERT_EQ(memoryspan("abc", 3, 0), 0);
+    ASSERT_EQ(memorycspan("abc", 3, 0), 3);
+    ASSERT_EQ(memoryspan(NULL, 3, CHAR_ALPHA), 0);
+    ASSERT_EQ(memorycspan("abc", 0, CHAR_ALPHA), 0);
+}
+
+// Every class mask, over lengths crossing the 16/32/128 byte blocks, with the
+// first mismatch planted at every position.
+void test_memoryspan_all_masks(void)
+{
+    unsigned char buf[300];
+    unsigned seed = 7;
+
+    for (int classes = 0; classes < 256; classes++)
+    {
+        unsigned char in = 0;
+        unsigned char out = 0;
+        int has_in = 0;
+        int has_out = 0;
+        for (int c = 255; c >= 0; c--)
+        {
+            if (char_class_of(c) & classes)
+                in = (unsigned char)c, has_in = 1;
+            else
+                out = (unsigned char)c, has_out = 1;
+        }
+        for (ui64 n = 0; n < 300; n += (n < 70 ? 1 : 37))
+        {
+            for (ui64 i = 0; i < n; i++)
+            {
+                seed = seed * 1103515245u + 12345u;
+                buf[i] = (unsigned char)(seed >> 16);
+            }
+            ASSERT_EQ(memoryspan(buf, n, classes), ref_span(buf, n, classes, 1));
+            ASSERT_EQ(memorycspan(buf, n, classes), ref_span(buf, n, classes, 0));
+            if (!has_in || !has_out || !n)
+                continue ;
+            ui64 pos = (seed >> 8) % n;
+            memset(buf, in, n);
+            buf[pos] = out;
+            ASSERT_EQ(memoryspan(buf, n, classes), pos);
+            memset(buf, out, n);
+            buf[pos] = in;
+            ASSERT_EQ(memorycspan(buf, n, classes), pos);
+        }
+    }
+}
+
+void test_memoryspan_ascii(void)
+{
+    char buf[1024];
+    memset(buf, 'a', sizeof(buf));
+    ASSERT_EQ(memoryspan(buf, sizeof(buf), CHAR_ASCII), sizeof(buf));
+    for (ui64 pos = 0; pos < sizeof(buf); pos += 13)
+    {
+        buf[pos] = (char)0x80;
+        ASSERT_EQ(memoryspan(buf, sizeof(buf), CHAR_ASCII), pos);
+        if (pos)
+            ASSERT_EQ(memoryspan(buf + 1, sizeof(buf) - 1, CHAR_ASCII), pos - 1);
+        buf[pos] = 'a';
+    }
+}
+
+// ============================================================================
+// Test Functions for memorylower / memoryupper
+// ============================================================================
+
+// Every byte value, at every length and alignment up to 200 bytes, copied out
+// and converted in place.
+void test_memorylower_upper_reference(void)
+{
+    unsigned char src[256];
+    unsigned char dst[256];
+    unsigned char ref[256];
+
+    for (ui64 off = 0; off < 8; off++)
+    {
+        for (ui64 n = 0; n + off <= 200; n++)
+        {
+            for (ui64 i = 0; i < n; i++)
+                src[off + i] = (unsigned char)(i * 73 + off + n);
+            for (ui64 i = 0; i < n; i++)
+                ref[i] = (src[off + i] >= 'A' && src[off + i] <= 'Z')
+                    ? src[off + i] + 32 : src[off + i];
+            memset(dst, 0xaa, sizeof(dst));
+            memorylower(dst + off, src + off, n);
+            ASSERT(memcmp(dst + off, ref, n) == 0);
+            ASSERT_EQ(dst[off + n], 0xaa);
+            for (ui64 i = 0; i < n; i++)
+                ref[i] = (src[off + i] >= 'a' && src[off + i] <= 'z')
+                    ? src[off + i] - 32 : src[off + i];
+            memoryupper(src + off, src + off, n);
+            ASSERT(memcmp(src + off, ref, n) == 0);
+        }
+    }
+}
+
+void test_memorylower_all_bytes(void)
+{
+    unsigned char buf[256];
+    for (int c = 0; c < 256; c++)
+        buf[c] = (unsigned char)c;
+    memorylower(buf, buf, 256);
+    for (int c = 0; c < 256; c++)
+        ASSERT_EQ(buf[c], (c >= 'A' && c <= 'Z') ? c + 32 : c);
+    memoryupper(buf, buf, 256);
+    for (int c = 0; c < 256; c++)
+        ASSERT_EQ(buf[c], (c >= 'a' && c <= 'z') ? c - 32 : c);
+}
+
+void test_memorylower_null(void)
+{
+    char buf[4] = "AbC";
+    memorylower(NULL, buf, 3);
+    memorylower(buf, NULL, 3);
+    memoryupper(buf, buf, 0);
+    ASSERT_STR_EQ(buf, "AbC");
+}
+
+// ============================================================================
+// Test Functions for memorycompare / memorycasecompare
+// ============================================================================
+
+static int sign_of(int x)
+{
+    return ((x > 0) - (x < 0));
+}
+
+// A single differing byte planted at every position, lengths crossing the
+// 8/16/32/64 byte blocks
+void test_memorycompare_reference(void)
+{
+    unsigned char a[300] = {0};
+    unsigned char b[300] = {0};
+
+    for (ui64 n = 0; n < 300; n += (n < 140 ? 1 : 23))
+    {
+        for (ui64 i = 0; i < n; i++)
+            a[i] = b[i] = (unsigned char)(i * 31 + 7);
+        ASSERT_EQ(memorycompare(a, b, n), 0);
+        for (ui64 pos = 0; pos < n; pos++)
+        {
+            b[pos] = (unsigned char)(a[pos] + 1 + pos % 200);
+            ASSERT_EQ(sign_of(memorycompare(a, b, n)), sign_of(memcmp(a, b, n)));
+            ASSERT_EQ(sign_of(memorycompare(b, a, n)), sign_of(memcmp(b, a, n)));
+            b[pos] = a[pos];
+        }
+    }
+}
+
+void test_memorycompare_unsigned(void)
+{
+    ASSERT(memorycompare("\x80", "\x7f", 1) > 0);
+    ASSERT(memorycompare("abc", "abd", 3) < 0);
+    ASSERT_EQ(memorycompare("abc", "abd", 2), 0);
+    ASSERT_EQ(memorycompare(NULL, NULL, 3), 0);
+    ASSERT(memorycompare(NULL, "a", 1) < 0);
+}
+
+void test_memorycasecompare(void)
+{
+    char a[200];
+    char b[200];
+
+    ASSERT_EQ(memorycasecompare("Content-Type", "content-type", 12), 0);
+    ASSERT(memorycasecompare("apple", "BANANA", 5) < 0);
+    ASSERT(memorycasecompare("[", "a", 1) < 0);
+    ASSERT(memorycasecompare("[", "A", 1) < 0);
+    for (ui64 n = 1; n < 200; n++)
+    {
+        for (ui64 i = 0; i < n; i++)
+        {
+            a[i] = (char)('a' + i % 26);
+            b[i] = (char)('A' + i % 26);
+        }
+        ASSERT_EQ(memorycasecompare(a, b, n), 0);
+        b[n - 1] = '@';
+        ASSERT(memorycasecompare(a, b, n) > 0);
+        ASSERT(memorycasecompare(b, a, n) < 0);
+    }
+}
+
+// ============================================================================
+// Test Functions for memoryhash
+// ============================================================================
+
+void test_memoryhash_deterministic(void)
+{
+    char a[300];
+    char b[301];
+
+    for (int i = 0; i < 300; i++)
+        a[i] = (char)(i * 7);
+    memcpy(b + 1, a, sizeof(a));
+    // Every length path (0, 1-3, 4-16, 17-48, above 48), at another alignment
+    for (ui64 n = 0; n < 200; n++)
+        ASSERT_EQ(memoryhash(a, n), memoryhash(b + 1, n));
+    ASSERT_EQ(memoryhash("hello", 5), memoryhash("hello world", 5));
+}
+
+void test_memoryhash_spreads(void)
+{
+    char    buf[64];
+    ui64    hashes[256];
+    ui64    hash;
+
+    memset(buf, 'x', sizeof(buf));
+    // Flipping any single byte, or the length, changes the hash
+    for (ui64 n = 1; n <= 64; n++)
+    {
+        hash = memoryhash(buf, n);
+        ASSERT_NE(hash, memoryhash(buf, n - 1));
+        for (ui64 i = 0; i < n; i++)
+        {
+            buf[i] = 'y';
+            ASSERT_NE(memoryhash(buf, n), hash);
+            buf[i] = 'x';
+        }
+    }
+    for (int i = 0; i < 256; i++)
+    {
+        buf[0] = (char)i;
+        hashes[i] = memoryhash(buf, 1);
+        for (int j = 0; j < i; j++)
+            ASSERT_NE(hashes[i] & 0xffff, hashes[j] & 0xffff);
+    }
+}
+
+// ============================================================================
+// Test Functions for cpu_supports
+// ============================================================================
+
+void test_cpu_supports_stable(void)
+{
+    ASSERT_EQ(cpu_supports(CPU_SSE2), cpu_supports(CPU_SSE2));
+    ASSERT_EQ(cpu_supports(CPU_AVX2), cpu_supports(CPU_AVX2));
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // memorycopy tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("memorycopy");
+    
+    TEST("memorycopy: basic", test_memorycopy_basic());
+    TEST("memorycopy: sizes and alignments", test_memorycopy_sizes_and_alignments());
+    TEST("memorycopy: overlap forward", test_memorycopy_overlap_forward());
+    TEST("memorycopy: overlap backward", test_memorycopy_overlap_backward());
+    TEST_NULL_SAFE("memorycopy: NULL input", test_memorycopy_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // memoryset tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("memoryset");
+    
+    TEST("memoryset: sizes and alignments", test_memoryset_sizes_and_alignments());
+    TEST("memoryset: truncates to byte", test_memoryset_truncates_to_byte());
+    TEST_NULL_SAFE("memoryset: NULL input", test_memoryset_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // stringlen tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("stringlen");
+    
+    TEST("stringlen: basic", test_stringlen_basic());
+    TEST("stringlen: sizes and alignments", test_stringlen_sizes_and_alignments());
+    TEST("stringlen: high bytes", test_stringlen_high_bytes());
+    TEST("stringlen: NULL input", test_stringlen_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Integer formatting tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Integer formatting");
+    
+    TEST("count_digits: boundaries", test_count_digits_boundaries());
+    TEST("format_llong: matches printf", test_format_llong_matches_printf());
+    TEST("format_ullong / format_hex: match printf", test_format_ullong_and_hex());
+    TEST("format_fixed: padding", test_format_fixed());
+    TEST("llong_to_ascii: extremes", test_llong_to_ascii());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Floating point formatting tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Floating point formatting");
+    
+    TEST("format_double: shortest output", test_format_double_shortest());
+    TEST("format_double: round trip", test_format_double_round_trip());
+    TEST("format_float: round trip", test_format_float_round_trip());
+    TEST("format_double: fixed precision matches printf", test_format_double_fixed());
+    TEST("format_float: fixed precision past 1e21", test_format_float_fixed_large());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Number parsing tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Number parsing");
+    
+    TEST("parse_llong: limits and errors", test_parse_llong());
+    TEST("parse_llong: matches strtoll", test_parse_llong_matches_strtoll());
+    TEST("parse_int / parse_ulong: ranges", test_parse_int_ulong());
+    TEST("parse_double: syntax", test_parse_double());
+    TEST("parse_double: matches strtod", test_parse_double_matches_strtod());
+    TEST("parse_double: halfway cases", test_parse_double_halfway());
+    TEST("parse_double: reads format_double back", test_parse_double_round_trip());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Character class tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("char_class_of / memoryspan / memorycspan");
+    
+    TEST("char_class_of: one class per byte", test_char_class_of());
+    TEST("memoryspan: basic", test_memoryspan_basic());
+    TEST("memoryspan: every mask vs reference", test_memoryspan_all_masks());
+    TEST("memoryspan: ascii fast path", test_memoryspan_ascii());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Case conversion tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("memorylower / memoryupper");
+    
+    TEST("memorylower / memoryupper: vs reference", test_memorylower_upper_reference());
+    TEST("memorylower / memoryupper: every byte", test_memorylower_all_bytes());
+    TEST_NULL_SAFE("memorylower: NULL input", test_memorylower_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Comparison tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("memorycompare / memorycasecompare");
+    
+    TEST("memorycompare: vs memcmp", test_memorycompare_reference());
+    TEST("memorycompare: unsigned and NULL", test_memorycompare_unsigned());
+    TEST("memorycasecompare: ignores ASCII case", test_memorycasecompare());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Hashing tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("memoryhash");
+    
+    TEST("memoryhash: depends only on the bytes", test_memoryhash_deterministic());
+    TEST("memoryhash: every byte and the length count", test_memoryhash_spreads());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // cpu_supports tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("cpu_supports");
+    
+    TEST("cpu_supports: stable", test_cpu_supports_stable());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+    
+    return get_exit_code();
+}
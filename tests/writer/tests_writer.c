@@ -0,0 +1,241 @@
+#define _GNU_SOURCE
+#include <types/writer.h>
+#include <types/string_view.h>
+#include <types/rope.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include "../test_framework.h"
+
+// Everything written to the write end of a pipe, read back by a thread
+typedef struct {
+    int     fds[2];
+    char    *data;
+    ui64    len;
+    int     slow;
+    pthread_t thread;
+}   capture;
+
+static void *drain(void *arg)
+{
+    capture *c = arg;
+    ui64 cap = 1 << 16;
+    ssize_t n;
+    c->data = malloc(cap);
+    c->len = 0;
+    for (;;)
+    {
+        if (c->len + 4096 > cap)
+            c->data = realloc(c->data, cap *= 2);
+        n = read(c->fds[0], c->data + c->len, c->slow ? 512 : 4096);
+        if (n < 0 && errno == EINTR)
+            continue ;
+        if (n <= 0)
+            break ;
+        c->len += (ui64)n;
+        if (c->slow)
+            usleep(20);
+    }
+    return (NULL);
+}
+
+static void capture_start(capture *c, int slow)
+{
+    pipe(c->fds);
+    c->slow = slow;
+    pthread_create(&c->thread, NULL, drain, c);
+}
+
+// Closes the write end and waits for the reader
+static void capture_stop(capture *c)
+{
+    close(c->fds[1]);
+    pthread_join(c->thread, NULL);
+    close(c->fds[0]);
+}
+
+// ============================================================================
+// Test Functions for Writer()
+// ============================================================================
+
+void test_writer_new_del(void)
+{
+    writer *w = Writer()->new(1);
+    ASSERT_NOT_NULL(w);
+    ASSERT_EQ(Writer()->error(w), 0);
+    Writer()->del(&w);
+    ASSERT_NULL(w);
+}
+
+void test_writer_coalesces(void)
+{
+    capture c;
+    capture_start(&c, 0);
+    writer *w = Writer()->new(c.fds[1]);
+    string *s = String()->new("str");
+    ASSERT(Writer()->write(w, VAL_PCHAR("pchar ")));
+    ASSERT(Writer()->write(w, VAL_STR(s)));
+    ASSERT(Writer()->write(w, VAL_CHAR(' ')));
+    ASSERT(Writer()->write(w, VAL_INT(-42)));
+    ASSERT(Writer()->write(w, VAL_FIXED(7, 3)));
+    ASSERT(Writer()->write(w, VAL_VIEW(View()->new(" view"))));
+    ASSERT_EQ(Writer()->write(w, VAL_PATTERN(NULL)), 0);
+    ASSERT_EQ(Writer()->write(w, VAL_PCHAR(NULL)), 0);
+    // Nothing reached the pipe yet
+    usleep(1000);
+    ASSERT_EQ(c.len, 0);
+    ASSERT(Writer()->flush(w));
+    Writer()->del(&w);
+    capture_stop(&c);
+    ASSERT_EQ(c.len, 21);
+    ASSERT_EQ(memcmp(c.data, "pchar str -42007 view", 21), 0);
+    free(c.data);
+    String()->del(&s);
+}
+
+void test_writer_many_lines(void)
+{
+    capture c;
+    capture_start(&c, 0);
+    writer *w = Writer()->new_sized(c.fds[1], 100);
+    string *expected = String()->new("");
+    char big[300];
+    int i;
+    memset(big, 'B', sizeof(big));
+    for (i = 0; i < 10000; i++)
+    {
+        ASSERT(Writer()->write_many(w, (typed_value[]){VAL_PCHAR("line="), VAL_INT(i),
+            VAL_CHAR('\n')}, 3));
+        APPEND_MANY(expected, VAL_PCHAR("line="), VAL_INT(i), VAL_CHAR('\n'));
+        // Values larger than the buffer go out with it, in order
+        if (i % 1000 == 0)
+        {
+            ASSERT(Writer()->write(w, VAL_VIEW(View()->from(big, sizeof(big)))));
+            String()->append(expected, VAL_VIEW(View()->from(big, sizeof(big))));
+        }
+    }
+    Writer()->del(&w);
+    capture_stop(&c);
+    ASSERT_EQ(c.len, String()->len(expected));
+    ASSERT(String()->equals(expected, VAL_VIEW(View()->from(c.data, c.len))));
+    free(c.data);
+    String()->del(&expected);
+}
+
+static volatile int g_interrupts = 0;
+
+static void on_alarm(int sig)
+{
+    (void)sig;
+    g_interrupts++;
+}
+
+void test_writer_interrupted(void)
+{
+    struct sigaction sa;
+    struct itimerval timer = {{0, 200}, {0, 200}};
+    capture c;
+    rope *r = Rope()->new();
+    string *parts[3];
+    writer *w;
+    ui64 total = 0;
+    int i;
+    // Signals without SA_RESTART make the blocked writes return early: short
+    // writes and EINTR, which must all be resumed
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_alarm;
+    sigaction(SIGALRM, &sa, NULL);
+    capture_start(&c, 1);
+    fcntl(c.fds[1], F_SETPIPE_SZ, 4096);
+    setitimer(ITIMER_REAL, &timer, NULL);
+    w = Writer()->new_sized(c.fds[1], 1 << 16);
+    for (i = 0; i < 40000; i++)
+        Writer()->write_many(w, (typed_value[]){VAL_PCHAR("event "), VAL_INT(i),
+            VAL_CHAR('\n')}, 3);
+    ASSERT(Writer()->flush(w));
+    Writer()->del(&w);
+    for (i = 0; i < 40000; i++)
+        total += 8 + (i > 9) + (i > 99) + (i > 999) + (i > 9999);
+    parts[0] = String()->new("[");
+    parts[1] = NULL;
+    parts[2] = String()->new("]\n");
+    ASSERT(String()->write_many(c.fds[1], parts, 3));
+    for (i = 0; i < 20000; i++)
+        Rope()->append(r, VAL_PCHAR("rope chunk "));
+    ASSERT(Rope()->write(c.fds[1], r));
+    timer = (struct itimerval){{0, 0}, {0, 0}};
+    setitimer(ITIMER_REAL, &timer, NULL);
+    capture_stop(&c);
+    ASSERT_EQ(c.len, total + 7 + Rope()->len(r));
+    ASSERT_EQ(memcmp(c.data, "event 0\nevent 1\n", 16), 0);
+    ASSERT_EQ(memcmp(c.data + total, "[NULL]\nrope chunk ", 18), 0);
+    ASSERT(g_interrupts > 0);
+    free(c.data);
+    String()->del(&parts[0]);
+    String()->del(&parts[2]);
+    Rope()->del(&r);
+    signal(SIGALRM, SIG_DFL);
+}
+
+void test_writer_error(void)
+{
+    int fds[2];
+    pipe(fds);
+    close(fds[0]);
+    signal(SIGPIPE, SIG_IGN);
+    writer *w = Writer()->new_sized(fds[1], 16);
+    ASSERT(Writer()->write(w, VAL_PCHAR("buffered")));
+    ASSERT_EQ(Writer()->write(w, VAL_PCHAR("does not fit anymore")), 0);
+    ASSERT_EQ(Writer()->error(w), EPIPE);
+    // The error sticks
+    ASSERT_EQ(Writer()->write(w, VAL_CHAR('x')), 0);
+    ASSERT_EQ(Writer()->flush(w), 0);
+    Writer()->del(&w);
+    close(fds[1]);
+    signal(SIGPIPE, SIG_DFL);
+}
+
+void test_writer_null(void)
+{
+    writer *w = NULL;
+    Writer()->del(&w);
+    Writer()->del(NULL);
+    ASSERT_EQ(Writer()->write(NULL, VAL_PCHAR("a")), 0);
+    ASSERT_EQ(Writer()->write_many(NULL, NULL, 0), 0);
+    ASSERT_EQ(Writer()->flush(NULL), 0);
+    ASSERT_EQ(Writer()->error(NULL), EINVAL);
+    w = Writer()->new_sized(-1, 0);
+    ASSERT_EQ(Writer()->write_many(w, NULL, 1), 0);
+    ASSERT_EQ(Writer()->write(w, VAL_PCHAR("a")), 0);
+    ASSERT_EQ(Writer()->error(w), EBADF);
+    Writer()->del(&w);
+}
+
+int main(int argc, char **argv)
+{
+    // Check for verbose flag
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+        set_verbose(1);
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Writer() tests
+    // ─────────────────────────────────────────────────────────────────────
+    print_suite_header("Writer()");
+    
+    TEST("writer: new and del", test_writer_new_del());
+    TEST("writer: writes are coalesced until flush", test_writer_coalesces());
+    TEST("writer: lines and oversized values", test_writer_many_lines());
+    TEST("writer / write_many: short writes and EINTR", test_writer_interrupted());
+    TEST("writer: errors stick", test_writer_error());
+    TEST_NULL_SAFE("writer: NULL input", test_writer_null());
+    
+    // ─────────────────────────────────────────────────────────────────────
+    // Final Results
+    // ─────────────────────────────────────────────────────────────────────
+    print_final_score();
+    
+    return get_exit_code();
+}